@@ -32,6 +32,7 @@
 #include <stdlib.h>
 #ifndef _WIN32
 #include <pthread.h>
+#include <time.h>
 #endif
 
 #ifdef _MSC_VER
@@ -493,6 +494,17 @@ static inline bool vkd3d_atomic_compare_exchange_u32(uint32_t volatile *x, uint3
 #endif
 }
 
+static inline bool vkd3d_atomic_compare_exchange_u64(uint64_t volatile *x, uint64_t expected, uint64_t val)
+{
+#if HAVE_SYNC_BOOL_COMPARE_AND_SWAP
+    return __sync_bool_compare_and_swap(x, expected, val);
+#elif defined(_WIN32)
+    return InterlockedCompareExchange64((LONG64 *)x, val, expected) == expected;
+#else
+# error "vkd3d_atomic_compare_exchange_u64() not implemented for this platform"
+#endif
+}
+
 static inline bool vkd3d_atomic_compare_exchange_ptr(void * volatile *x, void *expected, void *val)
 {
 #if HAVE_SYNC_BOOL_COMPARE_AND_SWAP
@@ -522,6 +534,24 @@ static inline uint32_t vkd3d_atomic_exchange_u32(uint32_t volatile *x, uint32_t
 #endif
 }
 
+static inline uint64_t vkd3d_atomic_exchange_u64(uint64_t volatile *x, uint64_t val)
+{
+#if HAVE_ATOMIC_EXCHANGE_N
+    return __atomic_exchange_n(x, val, __ATOMIC_SEQ_CST);
+#elif defined(_WIN32)
+    return InterlockedExchange64((LONG64 *)x, val);
+#else
+    uint64_t expected;
+
+    do
+    {
+        expected = *x;
+    } while (!vkd3d_atomic_compare_exchange_u64(x, expected, val));
+
+    return expected;
+#endif
+}
+
 static inline void *vkd3d_atomic_exchange_ptr(void * volatile *x, void *val)
 {
 #if HAVE_ATOMIC_EXCHANGE_N
@@ -540,6 +570,56 @@ static inline void *vkd3d_atomic_exchange_ptr(void * volatile *x, void *val)
 #endif
 }
 
+/* For statistics counters, which need no ordering with other memory accesses. */
+static inline void vkd3d_atomic_add_u64_relaxed(uint64_t volatile *x, uint64_t val)
+{
+#if HAVE_ATOMIC_EXCHANGE_N
+    __atomic_add_fetch(x, val, __ATOMIC_RELAXED);
+#else
+    vkd3d_atomic_add_fetch_u64(x, val);
+#endif
+}
+
+static inline uint64_t vkd3d_atomic_load_u64_relaxed(uint64_t volatile *x)
+{
+#if HAVE_ATOMIC_EXCHANGE_N
+    return __atomic_load_n(x, __ATOMIC_RELAXED);
+#else
+    return vkd3d_atomic_add_fetch_u64(x, 0);
+#endif
+}
+
+static inline uint32_t vkd3d_atomic_load_u32_acquire(uint32_t volatile *x)
+{
+#if HAVE_ATOMIC_EXCHANGE_N
+    return __atomic_load_n(x, __ATOMIC_ACQUIRE);
+#else
+    return vkd3d_atomic_add_fetch_u32(x, 0);
+#endif
+}
+
+static inline void vkd3d_atomic_store_u32_release(uint32_t volatile *x, uint32_t val)
+{
+#if HAVE_ATOMIC_EXCHANGE_N
+    __atomic_store_n(x, val, __ATOMIC_RELEASE);
+#else
+    vkd3d_atomic_exchange_u32(x, val);
+#endif
+}
+
+static inline void vkd3d_atomic_fence_acquire(void)
+{
+#if HAVE_ATOMIC_EXCHANGE_N
+    __atomic_thread_fence(__ATOMIC_ACQUIRE);
+#elif HAVE_SYNC_ADD_AND_FETCH
+    __sync_synchronize();
+#elif defined(_WIN32)
+    MemoryBarrier();
+#else
+# error "vkd3d_atomic_fence_acquire() not implemented for this platform"
+#endif
+}
+
 struct vkd3d_mutex
 {
 #ifdef _WIN32
@@ -673,6 +753,23 @@ static inline void vkd3d_cond_destroy(struct vkd3d_cond *cond)
 #endif
 }
 
+static inline uint64_t vkd3d_get_monotonic_time_ns(void)
+{
+#ifdef _WIN32
+    LARGE_INTEGER counter, frequency;
+
+    QueryPerformanceCounter(&counter);
+    QueryPerformanceFrequency(&frequency);
+    return (counter.QuadPart / frequency.QuadPart) * 1000000000ull
+            + (counter.QuadPart % frequency.QuadPart) * 1000000000ull / frequency.QuadPart;
+#else
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000000ull + ts.tv_nsec;
+#endif
+}
+
 static inline void vkd3d_parse_version(const char *version, int *major, int *minor)
 {
     *major = atoi(version);
@@ -20,6 +20,7 @@
 #define __VKD3D_MEMORY_H
 
 #include <stdbool.h>
+#include <stdint.h>
 #include <stdlib.h>
 #include <string.h>
 
@@ -75,4 +76,18 @@ static inline void *vkd3d_memdup(const void *mem, size_t size)
 
 bool vkd3d_array_reserve(void **elements, size_t *capacity, size_t element_count, size_t element_size);
 
+/* A bump allocator for objects sharing a single lifetime. Individual
+ * allocations are never freed; vkd3d_arena_cleanup() releases them all. */
+struct vkd3d_arena
+{
+    struct vkd3d_arena_block *blocks;
+    uintptr_t ptr, end;
+    size_t block_size;
+};
+
+void vkd3d_arena_init(struct vkd3d_arena *arena, size_t block_size);
+void *vkd3d_arena_alloc(struct vkd3d_arena *arena, size_t size);
+void *vkd3d_arena_calloc(struct vkd3d_arena *arena, size_t count, size_t size);
+void vkd3d_arena_cleanup(struct vkd3d_arena *arena);
+
 #endif  /* __VKD3D_MEMORY_H */
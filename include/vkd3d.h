@@ -79,6 +79,12 @@ enum vkd3d_structure_type
      */
     VKD3D_STRUCTURE_TYPE_HOST_TIME_DOMAIN_INFO,
 
+    /**
+     * The structure is a vkd3d_device_statistics structure.
+     * \since 1.18
+     */
+    VKD3D_STRUCTURE_TYPE_DEVICE_STATISTICS,
+
     VKD3D_FORCE_32_BIT_ENUM(VKD3D_STRUCTURE_TYPE),
 };
 
@@ -374,6 +380,56 @@ struct vkd3d_image_resource_create_info
     D3D12_RESOURCE_STATES present_state;
 };
 
+/**
+ * Cumulative statistics of a device, returned by vkd3d_get_device_statistics().
+ *
+ * Counters count events since the device was created. Times are in
+ * nanoseconds. The counters are updated concurrently, so a snapshot is not
+ * guaranteed to be consistent across members.
+ *
+ * \since 1.18
+ */
+struct vkd3d_device_statistics
+{
+    /** Must be set to VKD3D_STRUCTURE_TYPE_DEVICE_STATISTICS. */
+    enum vkd3d_structure_type type;
+    /** Optional pointer to a structure containing further parameters. */
+    const void *next;
+
+    /** Number of pipeline states created, excluding shared ones. */
+    uint64_t pipeline_state_count;
+    /** Number of pipeline states which shared an existing identical one. */
+    uint64_t pipeline_state_reuse_count;
+    /** Total time spent creating pipeline states. */
+    uint64_t pipeline_state_time;
+    /** Number of Vulkan pipelines created. */
+    uint64_t vk_pipeline_count;
+    /** Total time spent in vkCreateGraphicsPipelines() and vkCreateComputePipelines(). */
+    uint64_t vk_pipeline_time;
+    /** Number of Vulkan render passes created. */
+    uint64_t vk_render_pass_count;
+    /** Number of Vulkan framebuffers created. */
+    uint64_t vk_framebuffer_count;
+    /** Number of Vulkan samplers created. */
+    uint64_t vk_sampler_count;
+    /** Number of Vulkan image views created. */
+    uint64_t vk_image_view_count;
+    /** Number of Vulkan buffer views created. */
+    uint64_t vk_buffer_view_count;
+    /** Number of Vulkan descriptor sets allocated. */
+    uint64_t vk_descriptor_set_count;
+    /** Number of vkQueueSubmit() calls. */
+    uint64_t vk_queue_submit_count;
+    /** Number of descriptor heap updates flushed to Vulkan descriptor sets. */
+    uint64_t descriptor_flush_count;
+    /** Total time spent flushing descriptor heap updates. */
+    uint64_t descriptor_flush_time;
+    /** Number of command list commands recorded for translation after Close(). */
+    uint64_t deferred_command_count;
+    /** Number of times recorded commands were translated before Close(). */
+    uint64_t deferred_flush_count;
+};
+
 #ifdef LIBVKD3D_SOURCE
 # define VKD3D_API VKD3D_EXPORT
 #else
@@ -488,6 +544,21 @@ VKD3D_API void vkd3d_set_log_callback(PFN_vkd3d_log callback);
 VKD3D_API HRESULT vkd3d_queue_signal_on_cpu(ID3D12CommandQueue *queue,
         ID3D12Fence *fence, uint64_t value);
 
+/**
+ * Retrieve the runtime statistics of a device.
+ *
+ * This is intended for profiling and for sizing caches. The statistics are
+ * also periodically written to the log when VKD3D_CONFIG contains
+ * "statistics".
+ *
+ * \param device The device.
+ * \param statistics Receives the current statistics. The type member must be
+ * set by the caller.
+ *
+ * \since 1.18
+ */
+VKD3D_API void vkd3d_get_device_statistics(ID3D12Device *device, struct vkd3d_device_statistics *statistics);
+
 #endif  /* VKD3D_NO_PROTOTYPES */
 
 /*
@@ -538,6 +609,9 @@ typedef void (*PFN_vkd3d_set_log_callback)(PFN_vkd3d_log callback);
 typedef HRESULT (*PFN_vkd3d_queue_signal_on_cpu)(ID3D12CommandQueue *queue,
         ID3D12Fence *fence, uint64_t value);
 
+/** Type of vkd3d_get_device_statistics(). \since 1.18 */
+typedef void (*PFN_vkd3d_get_device_statistics)(ID3D12Device *device, struct vkd3d_device_statistics *statistics);
+
 #ifdef __cplusplus
 }
 #endif  /* __cplusplus */
@@ -120,6 +120,11 @@ enum vkd3d_shader_structure_type
      * \since 1.15
      */
     VKD3D_SHADER_STRUCTURE_TYPE_SCAN_HULL_SHADER_TESSELLATION_INFO,
+    /**
+     * The structure is a vkd3d_shader_buffer_address_info structure.
+     * \since 1.18
+     */
+    VKD3D_SHADER_STRUCTURE_TYPE_BUFFER_ADDRESS_INFO,
 
     VKD3D_FORCE_32_BIT_ENUM(VKD3D_SHADER_STRUCTURE_TYPE),
 };
@@ -1296,6 +1301,40 @@ struct vkd3d_shader_interface_info
     unsigned int uav_counter_count;
 };
 
+/**
+ * A chained structure describing Direct3D constant buffers which are accessed
+ * through 64-bit buffer device addresses stored in push constants, instead of
+ * through descriptors.
+ *
+ * This structure is optional. It is only supported when compiling to SPIR-V,
+ * and requires the target environment to support
+ * SPV_KHR_physical_storage_buffer.
+ *
+ * This structure extends vkd3d_shader_interface_info.
+ *
+ * This structure contains only input parameters.
+ *
+ * \since 1.18
+ */
+struct vkd3d_shader_buffer_address_info
+{
+    /** Must be set to VKD3D_SHADER_STRUCTURE_TYPE_BUFFER_ADDRESS_INFO. */
+    enum vkd3d_shader_structure_type type;
+    /** Optional pointer to a structure containing further parameters. */
+    const void *next;
+
+    /**
+     * Pointer to an array of constant buffers. The 'offset' member of each
+     * element is the byte offset of the 64-bit buffer address within the push
+     * constants, and must be a multiple of 8. The 'size' member is ignored.
+     *
+     * The buffer address must be aligned to 16 bytes.
+     */
+    const struct vkd3d_shader_push_constant_buffer *buffers;
+    /** Size, in elements, of \ref buffers. */
+    unsigned int buffer_count;
+};
+
 struct vkd3d_shader_transform_feedback_element
 {
     unsigned int stream_index;
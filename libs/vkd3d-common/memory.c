@@ -46,3 +46,89 @@ bool vkd3d_array_reserve(void **elements, size_t *capacity, size_t element_count
 
     return true;
 }
+
+#define VKD3D_ARENA_ALIGNMENT 16
+
+struct vkd3d_arena_block
+{
+    struct vkd3d_arena_block *next;
+};
+
+void vkd3d_arena_init(struct vkd3d_arena *arena, size_t block_size)
+{
+    arena->blocks = NULL;
+    arena->ptr = 0;
+    arena->end = 0;
+    arena->block_size = max(block_size, 256);
+}
+
+static uintptr_t vkd3d_arena_block_data(struct vkd3d_arena_block *block)
+{
+    return align((uintptr_t)(block + 1), VKD3D_ARENA_ALIGNMENT);
+}
+
+void *vkd3d_arena_alloc(struct vkd3d_arena *arena, size_t size)
+{
+    struct vkd3d_arena_block *block;
+    size_t block_size;
+    uintptr_t ptr;
+
+    if (!size)
+        size = 1;
+
+    ptr = align(arena->ptr, VKD3D_ARENA_ALIGNMENT);
+    if (arena->blocks && ptr <= arena->end && size <= arena->end - ptr)
+    {
+        arena->ptr = ptr + size;
+        return (void *)ptr;
+    }
+
+    if (size > ~(size_t)0 - sizeof(*block) - VKD3D_ARENA_ALIGNMENT)
+        return NULL;
+    block_size = max(arena->block_size, size);
+    if (!(block = vkd3d_malloc(sizeof(*block) + VKD3D_ARENA_ALIGNMENT + block_size)))
+        return NULL;
+    ptr = vkd3d_arena_block_data(block);
+
+    /* Large allocations get a block of their own, so that the remainder of
+     * the current block is not wasted. */
+    if (arena->blocks && size > arena->block_size / 4)
+    {
+        block->next = arena->blocks->next;
+        arena->blocks->next = block;
+        return (void *)ptr;
+    }
+
+    block->next = arena->blocks;
+    arena->blocks = block;
+    arena->ptr = ptr + size;
+    arena->end = ptr + block_size;
+    return (void *)ptr;
+}
+
+void *vkd3d_arena_calloc(struct vkd3d_arena *arena, size_t count, size_t size)
+{
+    void *ptr;
+
+    if (size && count > ~(size_t)0 / size)
+    {
+        ERR("Out of memory.\n");
+        return NULL;
+    }
+
+    if ((ptr = vkd3d_arena_alloc(arena, count * size)))
+        memset(ptr, 0, count * size);
+    return ptr;
+}
+
+void vkd3d_arena_cleanup(struct vkd3d_arena *arena)
+{
+    struct vkd3d_arena_block *block, *next;
+
+    for (block = arena->blocks; block; block = next)
+    {
+        next = block->next;
+        vkd3d_free(block);
+    }
+    vkd3d_arena_init(arena, arena->block_size);
+}
@@ -1576,6 +1576,15 @@ void hlsl_init_simple_deref_from_var(struct hlsl_deref *deref, struct hlsl_ir_va
     deref->var = var;
 }
 
+static void *hlsl_alloc_instr(struct hlsl_ctx *ctx, size_t size)
+{
+    void *ptr = vkd3d_arena_calloc(&ctx->instr_arena, 1, size);
+
+    if (!ptr)
+        ctx->result = VKD3D_ERROR_OUT_OF_MEMORY;
+    return ptr;
+}
+
 static void init_node(struct hlsl_ir_node *node, enum hlsl_ir_node_type type,
         struct hlsl_type *data_type, const struct vkd3d_shader_location *loc)
 {
@@ -1603,15 +1612,12 @@ struct hlsl_ir_node *hlsl_new_store_index(struct hlsl_ctx *ctx, const struct hls
     VKD3D_ASSERT(lhs);
     VKD3D_ASSERT(!hlsl_deref_is_lowered(lhs));
 
-    if (!(store = hlsl_alloc(ctx, sizeof(*store))))
+    if (!(store = hlsl_alloc_instr(ctx, sizeof(*store))))
         return NULL;
     init_node(&store->node, HLSL_IR_STORE, NULL, loc);
 
     if (!hlsl_init_deref(ctx, &store->lhs, lhs->var, lhs->path_len + !!idx))
-    {
-        vkd3d_free(store);
         return NULL;
-    }
     for (i = 0; i < lhs->path_len; ++i)
         hlsl_src_from_node(&store->lhs.path[i], lhs->path[i].node);
     if (idx)
@@ -1651,15 +1657,12 @@ static struct hlsl_ir_node *hlsl_new_store_parent(struct hlsl_ctx *ctx,
     VKD3D_ASSERT(!hlsl_deref_is_lowered(lhs));
     VKD3D_ASSERT(lhs->path_len >= path_len);
 
-    if (!(store = hlsl_alloc(ctx, sizeof(*store))))
+    if (!(store = hlsl_alloc_instr(ctx, sizeof(*store))))
         return NULL;
     init_node(&store->node, HLSL_IR_STORE, NULL, loc);
 
     if (!hlsl_init_deref(ctx, &store->lhs, lhs->var, path_len))
-    {
-        vkd3d_free(store);
         return NULL;
-    }
     for (unsigned int i = 0; i < path_len; ++i)
         hlsl_src_from_node(&store->lhs.path[i], lhs->path[i].node);
 
@@ -1685,15 +1688,12 @@ void hlsl_block_add_store_component(struct hlsl_ctx *ctx, struct hlsl_block *blo
     struct hlsl_block comp_path_block;
     struct hlsl_ir_store *store;
 
-    if (!(store = hlsl_alloc(ctx, sizeof(*store))))
+    if (!(store = hlsl_alloc_instr(ctx, sizeof(*store))))
         return;
     init_node(&store->node, HLSL_IR_STORE, NULL, &rhs->loc);
 
     if (!init_deref_from_component_index(ctx, &comp_path_block, &store->lhs, lhs, comp, &rhs->loc))
-    {
-        vkd3d_free(store);
         return;
-    }
     hlsl_block_add_block(block, &comp_path_block);
     hlsl_src_from_node(&store->rhs, rhs);
 
@@ -1708,7 +1708,7 @@ struct hlsl_ir_node *hlsl_new_call(struct hlsl_ctx *ctx, struct hlsl_ir_function
 {
     struct hlsl_ir_call *call;
 
-    if (!(call = hlsl_alloc(ctx, sizeof(*call))))
+    if (!(call = hlsl_alloc_instr(ctx, sizeof(*call))))
         return NULL;
 
     init_node(&call->node, HLSL_IR_CALL, NULL, loc);
@@ -1723,7 +1723,7 @@ struct hlsl_ir_node *hlsl_new_constant(struct hlsl_ctx *ctx, struct hlsl_type *t
 
     VKD3D_ASSERT(type->class <= HLSL_CLASS_VECTOR || type->class == HLSL_CLASS_NULL);
 
-    if (!(c = hlsl_alloc(ctx, sizeof(*c))))
+    if (!(c = hlsl_alloc_instr(ctx, sizeof(*c))))
         return NULL;
 
     init_node(&c->node, HLSL_IR_CONSTANT, type, loc);
@@ -1790,7 +1790,7 @@ struct hlsl_ir_node *hlsl_new_string_constant(struct hlsl_ctx *ctx, const char *
 {
     struct hlsl_ir_string_constant *s;
 
-    if (!(s = hlsl_alloc(ctx, sizeof(*s))))
+    if (!(s = hlsl_alloc_instr(ctx, sizeof(*s))))
         return NULL;
 
     init_node(&s->node, HLSL_IR_STRING_CONSTANT, ctx->builtin_types.string, loc);
@@ -1816,7 +1816,7 @@ static struct hlsl_ir_node *hlsl_new_expr(struct hlsl_ctx *ctx, enum hlsl_ir_exp
     struct hlsl_ir_expr *expr;
     unsigned int i;
 
-    if (!(expr = hlsl_alloc(ctx, sizeof(*expr))))
+    if (!(expr = hlsl_alloc_instr(ctx, sizeof(*expr))))
         return NULL;
     init_node(&expr->node, HLSL_IR_EXPR, data_type, loc);
     expr->op = op;
@@ -1900,7 +1900,7 @@ struct hlsl_ir_node *hlsl_new_if(struct hlsl_ctx *ctx, struct hlsl_ir_node *cond
 {
     struct hlsl_ir_if *iff;
 
-    if (!(iff = hlsl_alloc(ctx, sizeof(*iff))))
+    if (!(iff = hlsl_alloc_instr(ctx, sizeof(*iff))))
         return NULL;
     init_node(&iff->node, HLSL_IR_IF, NULL, loc);
     hlsl_src_from_node(&iff->condition, condition);
@@ -1934,7 +1934,7 @@ struct hlsl_ir_switch_case *hlsl_new_switch_case(struct hlsl_ctx *ctx, unsigned
 {
     struct hlsl_ir_switch_case *c;
 
-    if (!(c = hlsl_alloc(ctx, sizeof(*c))))
+    if (!(c = hlsl_alloc_instr(ctx, sizeof(*c))))
         return NULL;
 
     c->value = value;
@@ -1952,7 +1952,7 @@ struct hlsl_ir_node *hlsl_new_switch(struct hlsl_ctx *ctx, struct hlsl_ir_node *
 {
     struct hlsl_ir_switch *s;
 
-    if (!(s = hlsl_alloc(ctx, sizeof(*s))))
+    if (!(s = hlsl_alloc_instr(ctx, sizeof(*s))))
         return NULL;
     init_node(&s->node, HLSL_IR_SWITCH, NULL, loc);
     hlsl_src_from_node(&s->selector, selector);
@@ -1976,15 +1976,12 @@ struct hlsl_ir_load *hlsl_new_load_index(struct hlsl_ctx *ctx, const struct hlsl
     if (idx)
         type = hlsl_get_element_type_from_path_index(ctx, type, idx);
 
-    if (!(load = hlsl_alloc(ctx, sizeof(*load))))
+    if (!(load = hlsl_alloc_instr(ctx, sizeof(*load))))
         return NULL;
     init_node(&load->node, HLSL_IR_LOAD, type, loc);
 
     if (!hlsl_init_deref(ctx, &load->src, deref->var, deref->path_len + !!idx))
-    {
-        vkd3d_free(load);
         return NULL;
-    }
     for (i = 0; i < deref->path_len; ++i)
         hlsl_src_from_node(&load->src.path[i], deref->path[i].node);
     if (idx)
@@ -2039,7 +2036,7 @@ struct hlsl_ir_node *hlsl_block_add_load_component(struct hlsl_ctx *ctx, struct
     struct hlsl_block comp_path_block;
     struct hlsl_ir_load *load;
 
-    if (!(load = hlsl_alloc(ctx, sizeof(*load))))
+    if (!(load = hlsl_alloc_instr(ctx, sizeof(*load))))
     {
         block->value = ctx->error_instr;
         return ctx->error_instr;
@@ -2051,7 +2048,6 @@ struct hlsl_ir_node *hlsl_block_add_load_component(struct hlsl_ctx *ctx, struct
 
     if (!init_deref_from_component_index(ctx, &comp_path_block, &load->src, deref, comp, loc))
     {
-        vkd3d_free(load);
         block->value = ctx->error_instr;
         return ctx->error_instr;
     }
@@ -2067,23 +2063,19 @@ static struct hlsl_ir_resource_load *hlsl_new_resource_load(struct hlsl_ctx *ctx
 {
     struct hlsl_ir_resource_load *load;
 
-    if (!(load = hlsl_alloc(ctx, sizeof(*load))))
+    if (!(load = hlsl_alloc_instr(ctx, sizeof(*load))))
         return NULL;
     init_node(&load->node, HLSL_IR_RESOURCE_LOAD, params->format, loc);
     load->load_type = params->type;
 
     if (!hlsl_init_deref_from_index_chain(ctx, &load->resource, params->resource))
-    {
-        vkd3d_free(load);
         return NULL;
-    }
 
     if (params->sampler)
     {
         if (!hlsl_init_deref_from_index_chain(ctx, &load->sampler, params->sampler))
         {
             hlsl_cleanup_deref(&load->resource);
-            vkd3d_free(load);
             return NULL;
         }
     }
@@ -2118,7 +2110,7 @@ static struct hlsl_ir_node *hlsl_new_resource_store(struct hlsl_ctx *ctx,
 {
     struct hlsl_ir_resource_store *store;
 
-    if (!(store = hlsl_alloc(ctx, sizeof(*store))))
+    if (!(store = hlsl_alloc_instr(ctx, sizeof(*store))))
         return NULL;
     init_node(&store->node, HLSL_IR_RESOURCE_STORE, NULL, loc);
     store->store_type = type;
@@ -2148,7 +2140,7 @@ struct hlsl_ir_node *hlsl_new_swizzle(struct hlsl_ctx *ctx, uint32_t s, unsigned
 
     VKD3D_ASSERT(val->data_type->class <= HLSL_CLASS_VECTOR);
 
-    if (!(swizzle = hlsl_alloc(ctx, sizeof(*swizzle))))
+    if (!(swizzle = hlsl_alloc_instr(ctx, sizeof(*swizzle))))
         return NULL;
     if (component_count > 1)
         type = hlsl_get_vector_type(ctx, val->data_type->e.numeric.type, component_count);
@@ -2175,7 +2167,7 @@ struct hlsl_ir_node *hlsl_new_matrix_swizzle(struct hlsl_ctx *ctx, struct hlsl_m
 
     VKD3D_ASSERT(val->data_type->class == HLSL_CLASS_MATRIX);
 
-    if (!(swizzle = hlsl_alloc(ctx, sizeof(*swizzle))))
+    if (!(swizzle = hlsl_alloc_instr(ctx, sizeof(*swizzle))))
         return NULL;
     if (component_count > 1)
         type = hlsl_get_vector_type(ctx, val->data_type->e.numeric.type, component_count);
@@ -2224,7 +2216,7 @@ struct hlsl_ir_node *hlsl_new_compile(struct hlsl_ctx *ctx, enum hlsl_compile_ty
             break;
     }
 
-    if (!(compile = hlsl_alloc(ctx, sizeof(*compile))))
+    if (!(compile = hlsl_alloc_instr(ctx, sizeof(*compile))))
         return NULL;
 
     init_node(&compile->node, HLSL_IR_COMPILE, type, loc);
@@ -2236,11 +2228,8 @@ struct hlsl_ir_node *hlsl_new_compile(struct hlsl_ctx *ctx, enum hlsl_compile_ty
     hlsl_block_add_block(&compile->instrs, args_instrs);
 
     compile->args_count = args_count;
-    if (!(compile->args = hlsl_alloc(ctx, sizeof(*compile->args) * args_count)))
-    {
-        vkd3d_free(compile);
+    if (!(compile->args = hlsl_alloc_instr(ctx, sizeof(*compile->args) * args_count)))
         return NULL;
-    }
     for (i = 0; i < compile->args_count; ++i)
         hlsl_src_from_node(&compile->args[i], args[i]);
 
@@ -2265,16 +2254,13 @@ struct hlsl_ir_node *hlsl_new_sampler_state(struct hlsl_ctx *ctx,
     struct hlsl_ir_sampler_state *sampler_state;
     struct hlsl_type *type = ctx->builtin_types.sampler[HLSL_SAMPLER_DIM_GENERIC];
 
-    if (!(sampler_state = hlsl_alloc(ctx, sizeof(*sampler_state))))
+    if (!(sampler_state = hlsl_alloc_instr(ctx, sizeof(*sampler_state))))
         return NULL;
 
     init_node(&sampler_state->node, HLSL_IR_SAMPLER_STATE, type, loc);
 
     if (!(sampler_state->state_block = hlsl_alloc(ctx, sizeof(*sampler_state->state_block))))
-    {
-        vkd3d_free(sampler_state);
         return NULL;
-    }
 
     if (state_block)
     {
@@ -2306,16 +2292,13 @@ struct hlsl_ir_node *hlsl_new_stateblock_constant(struct hlsl_ctx *ctx, const ch
     struct hlsl_ir_stateblock_constant *constant;
     struct hlsl_type *type = hlsl_get_scalar_type(ctx, HLSL_TYPE_INT);
 
-    if (!(constant = hlsl_alloc(ctx, sizeof(*constant))))
+    if (!(constant = hlsl_alloc_instr(ctx, sizeof(*constant))))
         return NULL;
 
     init_node(&constant->node, HLSL_IR_STATEBLOCK_CONSTANT, type, loc);
 
     if (!(constant->name = hlsl_alloc(ctx, strlen(name) + 1)))
-    {
-        vkd3d_free(constant);
         return NULL;
-    }
     strcpy(constant->name, name);
 
     return &constant->node;
@@ -2327,7 +2310,7 @@ struct hlsl_ir_node *hlsl_new_interlocked(struct hlsl_ctx *ctx, enum hlsl_interl
 {
     struct hlsl_ir_interlocked *interlocked;
 
-    if (!(interlocked = hlsl_alloc(ctx, sizeof(*interlocked))))
+    if (!(interlocked = hlsl_alloc_instr(ctx, sizeof(*interlocked))))
         return NULL;
 
     init_node(&interlocked->node, HLSL_IR_INTERLOCKED, type, loc);
@@ -2345,7 +2328,7 @@ static struct hlsl_ir_node *hlsl_new_sync(struct hlsl_ctx *ctx,
 {
     struct hlsl_ir_sync *sync;
 
-    if (!(sync = hlsl_alloc(ctx, sizeof(*sync))))
+    if (!(sync = hlsl_alloc_instr(ctx, sizeof(*sync))))
         return NULL;
 
     init_node(&sync->node, HLSL_IR_SYNC, NULL, loc);
@@ -2402,7 +2385,7 @@ static struct hlsl_ir_node *hlsl_new_index(struct hlsl_ctx *ctx, struct hlsl_ir_
     struct hlsl_type *type = val->data_type;
     struct hlsl_ir_index *index;
 
-    if (!(index = hlsl_alloc(ctx, sizeof(*index))))
+    if (!(index = hlsl_alloc_instr(ctx, sizeof(*index))))
         return NULL;
 
     if (type->class == HLSL_CLASS_TEXTURE || type->class == HLSL_CLASS_UAV)
@@ -2429,7 +2412,7 @@ static struct hlsl_ir_node *hlsl_new_jump(struct hlsl_ctx *ctx, enum hlsl_ir_jum
 {
     struct hlsl_ir_jump *jump;
 
-    if (!(jump = hlsl_alloc(ctx, sizeof(*jump))))
+    if (!(jump = hlsl_alloc_instr(ctx, sizeof(*jump))))
         return NULL;
     init_node(&jump->node, HLSL_IR_JUMP, NULL, loc);
     jump->type = type;
@@ -2449,7 +2432,7 @@ static struct hlsl_ir_node *hlsl_new_loop(struct hlsl_ctx *ctx, struct hlsl_bloc
 {
     struct hlsl_ir_loop *loop;
 
-    if (!(loop = hlsl_alloc(ctx, sizeof(*loop))))
+    if (!(loop = hlsl_alloc_instr(ctx, sizeof(*loop))))
         return NULL;
     init_node(&loop->node, HLSL_IR_LOOP, NULL, loc);
     hlsl_block_init(&loop->body);
@@ -2612,15 +2595,12 @@ static struct hlsl_ir_node *clone_load(struct hlsl_ctx *ctx, struct clone_instr_
 {
     struct hlsl_ir_load *dst;
 
-    if (!(dst = hlsl_alloc(ctx, sizeof(*dst))))
+    if (!(dst = hlsl_alloc_instr(ctx, sizeof(*dst))))
         return NULL;
     init_node(&dst->node, HLSL_IR_LOAD, src->node.data_type, &src->node.loc);
 
     if (!clone_deref(ctx, map, &dst->src, &src->src))
-    {
-        vkd3d_free(dst);
         return NULL;
-    }
     return &dst->node;
 }
 
@@ -2652,19 +2632,15 @@ static struct hlsl_ir_node *clone_resource_load(struct hlsl_ctx *ctx,
 {
     struct hlsl_ir_resource_load *dst;
 
-    if (!(dst = hlsl_alloc(ctx, sizeof(*dst))))
+    if (!(dst = hlsl_alloc_instr(ctx, sizeof(*dst))))
         return NULL;
     init_node(&dst->node, HLSL_IR_RESOURCE_LOAD, src->node.data_type, &src->node.loc);
     dst->load_type = src->load_type;
     if (!clone_deref(ctx, map, &dst->resource, &src->resource))
-    {
-        vkd3d_free(dst);
         return NULL;
-    }
     if (!clone_deref(ctx, map, &dst->sampler, &src->sampler))
     {
         hlsl_cleanup_deref(&dst->resource);
-        vkd3d_free(dst);
         return NULL;
     }
     clone_src(map, &dst->byte_offset, &src->byte_offset);
@@ -2684,16 +2660,13 @@ static struct hlsl_ir_node *clone_resource_store(struct hlsl_ctx *ctx,
 {
     struct hlsl_ir_resource_store *dst;
 
-    if (!(dst = hlsl_alloc(ctx, sizeof(*dst))))
+    if (!(dst = hlsl_alloc_instr(ctx, sizeof(*dst))))
         return NULL;
     init_node(&dst->node, HLSL_IR_RESOURCE_STORE, NULL, &src->node.loc);
     dst->store_type = src->store_type;
     dst->writemask = src->writemask;
     if (!clone_deref(ctx, map, &dst->resource, &src->resource))
-    {
-        vkd3d_free(dst);
         return NULL;
-    }
     clone_src(map, &dst->coords, &src->coords);
     clone_src(map, &dst->value, &src->value);
     return &dst->node;
@@ -2708,15 +2681,12 @@ static struct hlsl_ir_node *clone_store(struct hlsl_ctx *ctx, struct clone_instr
 {
     struct hlsl_ir_store *dst;
 
-    if (!(dst = hlsl_alloc(ctx, sizeof(*dst))))
+    if (!(dst = hlsl_alloc_instr(ctx, sizeof(*dst))))
         return NULL;
     init_node(&dst->node, HLSL_IR_STORE, NULL, &src->node.loc);
 
     if (!clone_deref(ctx, map, &dst->lhs, &src->lhs))
-    {
-        vkd3d_free(dst);
         return NULL;
-    }
     clone_src(map, &dst->rhs, &src->rhs);
     dst->writemask = src->writemask;
     return &dst->node;
@@ -2749,16 +2719,13 @@ static struct hlsl_ir_node *clone_interlocked(struct hlsl_ctx *ctx,
 {
     struct hlsl_ir_interlocked *dst;
 
-    if (!(dst = hlsl_alloc(ctx, sizeof(*dst))))
+    if (!(dst = hlsl_alloc_instr(ctx, sizeof(*dst))))
         return NULL;
     init_node(&dst->node, HLSL_IR_INTERLOCKED, src->node.data_type, &src->node.loc);
     dst->op = src->op;
 
     if (!clone_deref(ctx, map, &dst->dst, &src->dst))
-    {
-        vkd3d_free(dst);
         return NULL;
-    }
     clone_src(map, &dst->coords, &src->coords);
     clone_src(map, &dst->cmp_value, &src->cmp_value);
     clone_src(map, &dst->value, &src->value);
@@ -2769,7 +2736,7 @@ static struct hlsl_ir_node *clone_sync(struct hlsl_ctx *ctx, struct hlsl_ir_sync
 {
     struct hlsl_ir_sync *dst;
 
-    if (!(dst = hlsl_alloc(ctx, sizeof(*dst))))
+    if (!(dst = hlsl_alloc_instr(ctx, sizeof(*dst))))
         return NULL;
     init_node(&dst->node, HLSL_IR_SYNC, NULL, &src->node.loc);
     dst->sync_flags = src->sync_flags;
@@ -2882,7 +2849,6 @@ void hlsl_free_ir_switch_case(struct hlsl_ir_switch_case *c)
 {
     hlsl_block_cleanup(&c->body);
     list_remove(&c->entry);
-    vkd3d_free(c);
 }
 
 void hlsl_cleanup_ir_switch_cases(struct list *cases)
@@ -4222,23 +4188,12 @@ void hlsl_block_cleanup(struct hlsl_block *block)
     hlsl_free_instr_list(&block->instrs);
 }
 
-static void free_ir_call(struct hlsl_ir_call *call)
-{
-    vkd3d_free(call);
-}
-
-static void free_ir_constant(struct hlsl_ir_constant *constant)
-{
-    vkd3d_free(constant);
-}
-
 static void free_ir_expr(struct hlsl_ir_expr *expr)
 {
     unsigned int i;
 
     for (i = 0; i < ARRAY_SIZE(expr->operands); ++i)
         hlsl_src_remove(&expr->operands[i]);
-    vkd3d_free(expr);
 }
 
 static void free_ir_if(struct hlsl_ir_if *if_node)
@@ -4246,26 +4201,22 @@ static void free_ir_if(struct hlsl_ir_if *if_node)
     hlsl_block_cleanup(&if_node->then_block);
     hlsl_block_cleanup(&if_node->else_block);
     hlsl_src_remove(&if_node->condition);
-    vkd3d_free(if_node);
 }
 
 static void free_ir_jump(struct hlsl_ir_jump *jump)
 {
     hlsl_src_remove(&jump->condition);
-    vkd3d_free(jump);
 }
 
 static void free_ir_load(struct hlsl_ir_load *load)
 {
     hlsl_cleanup_deref(&load->src);
-    vkd3d_free(load);
 }
 
 static void free_ir_loop(struct hlsl_ir_loop *loop)
 {
     hlsl_block_cleanup(&loop->body);
     hlsl_block_cleanup(&loop->iter);
-    vkd3d_free(loop);
 }
 
 static void free_ir_resource_load(struct hlsl_ir_resource_load *load)
@@ -4280,13 +4231,11 @@ static void free_ir_resource_load(struct hlsl_ir_resource_load *load)
     hlsl_src_remove(&load->cmp);
     hlsl_src_remove(&load->texel_offset);
     hlsl_src_remove(&load->sample_index);
-    vkd3d_free(load);
 }
 
 static void free_ir_string_constant(struct hlsl_ir_string_constant *string)
 {
     vkd3d_free(string->string);
-    vkd3d_free(string);
 }
 
 static void free_ir_resource_store(struct hlsl_ir_resource_store *store)
@@ -4294,35 +4243,29 @@ static void free_ir_resource_store(struct hlsl_ir_resource_store *store)
     hlsl_cleanup_deref(&store->resource);
     hlsl_src_remove(&store->coords);
     hlsl_src_remove(&store->value);
-    vkd3d_free(store);
 }
 
 static void free_ir_store(struct hlsl_ir_store *store)
 {
     hlsl_src_remove(&store->rhs);
     hlsl_cleanup_deref(&store->lhs);
-    vkd3d_free(store);
 }
 
 static void free_ir_swizzle(struct hlsl_ir_swizzle *swizzle)
 {
     hlsl_src_remove(&swizzle->val);
-    vkd3d_free(swizzle);
 }
 
 static void free_ir_switch(struct hlsl_ir_switch *s)
 {
     hlsl_src_remove(&s->selector);
     hlsl_cleanup_ir_switch_cases(&s->cases);
-
-    vkd3d_free(s);
 }
 
 static void free_ir_index(struct hlsl_ir_index *index)
 {
     hlsl_src_remove(&index->val);
     hlsl_src_remove(&index->idx);
-    vkd3d_free(index);
 }
 
 static void free_ir_interlocked(struct hlsl_ir_interlocked *interlocked)
@@ -4331,12 +4274,6 @@ static void free_ir_interlocked(struct hlsl_ir_interlocked *interlocked)
     hlsl_src_remove(&interlocked->coords);
     hlsl_src_remove(&interlocked->cmp_value);
     hlsl_src_remove(&interlocked->value);
-    vkd3d_free(interlocked);
-}
-
-static void free_ir_sync(struct hlsl_ir_sync *sync)
-{
-    vkd3d_free(sync);
 }
 
 static void free_ir_compile(struct hlsl_ir_compile *compile)
@@ -4347,20 +4284,17 @@ static void free_ir_compile(struct hlsl_ir_compile *compile)
         hlsl_src_remove(&compile->args[i]);
 
     hlsl_block_cleanup(&compile->instrs);
-    vkd3d_free(compile);
 }
 
 static void free_ir_sampler_state(struct hlsl_ir_sampler_state *sampler_state)
 {
     if (sampler_state->state_block)
         hlsl_free_state_block(sampler_state->state_block);
-    vkd3d_free(sampler_state);
 }
 
 static void free_ir_stateblock_constant(struct hlsl_ir_stateblock_constant *constant)
 {
     vkd3d_free(constant->name);
-    vkd3d_free(constant);
 }
 
 void hlsl_free_instr(struct hlsl_ir_node *node)
@@ -4370,11 +4304,8 @@ void hlsl_free_instr(struct hlsl_ir_node *node)
     switch (node->type)
     {
         case HLSL_IR_CALL:
-            free_ir_call(hlsl_ir_call(node));
-            break;
-
         case HLSL_IR_CONSTANT:
-            free_ir_constant(hlsl_ir_constant(node));
+        case HLSL_IR_SYNC:
             break;
 
         case HLSL_IR_EXPR:
@@ -4429,10 +4360,6 @@ void hlsl_free_instr(struct hlsl_ir_node *node)
             free_ir_interlocked(hlsl_ir_interlocked(node));
             break;
 
-        case HLSL_IR_SYNC:
-            free_ir_sync(hlsl_ir_sync(node));
-            break;
-
         case HLSL_IR_COMPILE:
             free_ir_compile(hlsl_ir_compile(node));
             break;
@@ -4704,6 +4631,40 @@ static int compare_function_rb(const void *key, const struct rb_entry *entry)
     return strcmp(name, func->name);
 }
 
+struct hlsl_internal_function
+{
+    struct rb_entry entry;
+    char *name;
+    char *hlsl;
+    struct hlsl_ir_function_decl *decl;
+};
+
+struct hlsl_internal_function_key
+{
+    const char *name;
+    const char *hlsl;
+};
+
+static int compare_internal_function_rb(const void *key, const struct rb_entry *entry)
+{
+    const struct hlsl_internal_function *func = RB_ENTRY_VALUE(entry, const struct hlsl_internal_function, entry);
+    const struct hlsl_internal_function_key *k = key;
+    int ret;
+
+    if ((ret = strcmp(k->name, func->name)))
+        return ret;
+    return strcmp(k->hlsl, func->hlsl);
+}
+
+static void free_internal_function_rb(struct rb_entry *entry, void *context)
+{
+    struct hlsl_internal_function *func = RB_ENTRY_VALUE(entry, struct hlsl_internal_function, entry);
+
+    vkd3d_free(func->name);
+    vkd3d_free(func->hlsl);
+    vkd3d_free(func);
+}
+
 static void declare_predefined_types(struct hlsl_ctx *ctx)
 {
     struct vkd3d_string_buffer *name;
@@ -4907,6 +4868,8 @@ static bool hlsl_ctx_init(struct hlsl_ctx *ctx, struct vkd3d_shader_source_list
 
     ctx->profile = profile;
 
+    vkd3d_arena_init(&ctx->instr_arena, 64 * 1024);
+
     ctx->message_context = message_context;
 
     ctx->source_files = source_files;
@@ -4932,6 +4895,7 @@ static bool hlsl_ctx_init(struct hlsl_ctx *ctx, struct vkd3d_shader_source_list
     declare_predefined_types(ctx);
 
     rb_init(&ctx->functions, compare_function_rb);
+    rb_init(&ctx->internal_functions, compare_internal_function_rb);
 
     hlsl_block_init(&ctx->static_initializers);
     list_init(&ctx->extern_vars);
@@ -5009,6 +4973,7 @@ static void hlsl_ctx_cleanup(struct hlsl_ctx *ctx)
 
     vkd3d_string_buffer_cache_cleanup(&ctx->string_buffers);
 
+    rb_destroy(&ctx->internal_functions, free_internal_function_rb, NULL);
     rb_destroy(&ctx->functions, free_function_rb, NULL);
 
     /* State blocks must be free before the variables, because they contain instructions that may
@@ -5046,6 +5011,8 @@ static void hlsl_ctx_cleanup(struct hlsl_ctx *ctx)
     }
 
     vkd3d_free(ctx->constant_defs.regs);
+
+    vkd3d_arena_cleanup(&ctx->instr_arena);
 }
 
 static int hlsl_ctx_parse(struct hlsl_ctx *ctx, struct vkd3d_shader_source_list *source_list,
@@ -5232,12 +5199,21 @@ struct hlsl_ir_function_decl *hlsl_compile_internal_function(struct hlsl_ctx *ct
     struct vkd3d_shader_code code = {.code = hlsl, .size = strlen(hlsl)};
     const char *saved_internal_func_name = ctx->internal_func_name;
     struct vkd3d_string_buffer *internal_name;
+    const struct hlsl_internal_function_key key = {name, hlsl};
+    struct hlsl_internal_function *internal_func;
     struct hlsl_ir_function_decl *func;
     void *saved_scanner = ctx->scanner;
+    struct rb_entry *entry;
     int ret;
 
     TRACE("name %s, hlsl %s.\n", debugstr_a(name), debugstr_a(hlsl));
 
+    /* Intrinsics are usually compiled from the same source for each call
+     * with the same argument types. Calls only reference the declaration,
+     * so it can be shared. */
+    if ((entry = rb_get(&ctx->internal_functions, &key)))
+        return RB_ENTRY_VALUE(entry, struct hlsl_internal_function, entry)->decl;
+
     /* The actual name of the function is mangled with a unique prefix, both to
      * allow defining multiple variants of a function with the same name, and to
      * avoid polluting the user name space. */
@@ -5266,5 +5242,23 @@ struct hlsl_ir_function_decl *hlsl_compile_internal_function(struct hlsl_ctx *ct
     }
     func = hlsl_get_first_func_decl(ctx, internal_name->buffer);
     hlsl_release_string_buffer(ctx, internal_name);
+
+    if (func && (internal_func = hlsl_alloc(ctx, sizeof(*internal_func))))
+    {
+        internal_func->name = hlsl_strdup(ctx, name);
+        internal_func->hlsl = hlsl_strdup(ctx, hlsl);
+        internal_func->decl = func;
+        if (internal_func->name && internal_func->hlsl)
+        {
+            rb_put(&ctx->internal_functions, &key, &internal_func->entry);
+        }
+        else
+        {
+            vkd3d_free(internal_func->name);
+            vkd3d_free(internal_func->hlsl);
+            vkd3d_free(internal_func);
+        }
+    }
+
     return func;
 }
@@ -1100,6 +1100,9 @@ struct hlsl_ctx
     struct vkd3d_shader_message_context *message_context;
     /* Cache for temporary string allocations. */
     struct vkd3d_string_buffer_cache string_buffers;
+    /* Arena holding the IR instructions. They are only released in bulk, when
+     *   the context is destroyed; hlsl_free_instr() merely drops their references. */
+    struct vkd3d_arena instr_arena;
     /* A value from enum vkd3d_result with the current success/failure result of the whole
      *   compilation.
      * It is initialized to VKD3D_OK and set to an error code in case a call to hlsl_fixme() or
@@ -1140,6 +1143,9 @@ struct hlsl_ctx
     /* Tree map for the declared functions, using hlsl_ir_function.name as key.
      * The functions are attached through the hlsl_ir_function.entry fields. */
     struct rb_tree functions;
+    /* Tree map for the functions compiled by hlsl_compile_internal_function(),
+     * keyed by name and source, so that each variant is only compiled once. */
+    struct rb_tree internal_functions;
     /* Pointer to the current function; changes as the parser reads the code. */
     const struct hlsl_ir_function_decl *cur_function;
 
@@ -1995,6 +1995,13 @@ static uint32_t vkd3d_spirv_build_op_load(struct vkd3d_spirv_builder *builder,
                 result_type, pointer_id, memory_access);
 }
 
+static uint32_t vkd3d_spirv_build_op_load_aligned(struct vkd3d_spirv_builder *builder,
+        uint32_t result_type, uint32_t pointer_id, uint32_t alignment)
+{
+    return vkd3d_spirv_build_op_tr3(builder, &builder->function_stream, SpvOpLoad,
+            result_type, pointer_id, SpvMemoryAccessAlignedMask, alignment);
+}
+
 static void vkd3d_spirv_build_op_store(struct vkd3d_spirv_builder *builder,
         uint32_t pointer_id, uint32_t object_id, uint32_t memory_access)
 {
@@ -2678,12 +2685,16 @@ static bool vkd3d_spirv_compile_module(struct vkd3d_spirv_builder *builder,
         vkd3d_spirv_build_op_extension(&stream, "SPV_EXT_shader_stencil_export");
     if (vkd3d_spirv_capability_is_enabled(builder, SpvCapabilityShaderViewportIndexLayerEXT))
         vkd3d_spirv_build_op_extension(&stream, "SPV_EXT_shader_viewport_index_layer");
+    if (vkd3d_spirv_capability_is_enabled(builder, SpvCapabilityPhysicalStorageBufferAddresses))
+        vkd3d_spirv_build_op_extension(&stream, "SPV_KHR_physical_storage_buffer");
 
     if (builder->ext_instr_set_glsl_450)
         vkd3d_spirv_build_op_ext_inst_import(&stream, builder->ext_instr_set_glsl_450, "GLSL.std.450");
 
     /* entry point declarations */
-    vkd3d_spirv_build_op_memory_model(&stream, SpvAddressingModelLogical, SpvMemoryModelGLSL450);
+    vkd3d_spirv_build_op_memory_model(&stream,
+            vkd3d_spirv_capability_is_enabled(builder, SpvCapabilityPhysicalStorageBufferAddresses)
+            ? SpvAddressingModelPhysicalStorageBuffer64 : SpvAddressingModelLogical, SpvMemoryModelGLSL450);
     vkd3d_spirv_build_op_entry_point(&stream, builder->execution_model, builder->main_function_id,
             entry_point, builder->iface, builder->iface_element_count);
 
@@ -2798,6 +2809,7 @@ struct vkd3d_symbol_register_data
     unsigned int write_mask;
     unsigned int structure_stride;
     unsigned int binding_base_idx;
+    uint32_t buffer_address_type_id; /* Pointer type of a buffer address in push constants. */
     bool is_aggregate; /* An aggregate, i.e. a structure or an array. */
 };
 
@@ -2931,6 +2943,7 @@ static void vkd3d_symbol_set_register_info(struct vkd3d_symbol *symbol,
     symbol->info.reg.write_mask = write_mask;
     symbol->info.reg.structure_stride = 0;
     symbol->info.reg.binding_base_idx = 0;
+    symbol->info.reg.buffer_address_type_id = 0;
     symbol->info.reg.is_aggregate = false;
 }
 
@@ -2995,6 +3008,8 @@ struct vkd3d_push_constant_buffer_binding
     struct vkd3d_shader_register reg;
     struct vkd3d_shader_push_constant_buffer pc;
     unsigned int size;
+    /* The push constant holds a buffer device address instead of the data. */
+    bool buffer_address;
 };
 
 struct vkd3d_shader_phase
@@ -3051,6 +3066,7 @@ struct spirv_compiler
     uint32_t push_constants_var_id;
     uint32_t *descriptor_offset_ids;
     struct vkd3d_push_constant_buffer_binding *push_constants;
+    unsigned int push_constant_count;
     const struct vkd3d_shader_spirv_target_info *spirv_target_info;
 
     struct
@@ -3160,11 +3176,12 @@ static struct spirv_compiler *spirv_compiler_create(struct vsir_program *program
         const struct vkd3d_shader_compile_info *compile_info,
         struct vkd3d_shader_message_context *message_context, uint64_t config_flags)
 {
+    const struct vkd3d_shader_buffer_address_info *buffer_address_info;
     const struct vkd3d_shader_interface_info *shader_interface;
     const struct vkd3d_shader_descriptor_offset_info *offset_info;
     const struct vkd3d_shader_spirv_target_info *target_info;
     struct spirv_compiler *compiler;
-    unsigned int i;
+    unsigned int i, j;
 
     if (!(compiler = vkd3d_malloc(sizeof(*compiler))))
         return NULL;
@@ -3272,9 +3289,13 @@ static struct spirv_compiler *spirv_compiler_create(struct vsir_program *program
         compiler->xfb_info = vkd3d_find_struct(compile_info->next, TRANSFORM_FEEDBACK_INFO);
 
         compiler->shader_interface = *shader_interface;
-        if (shader_interface->push_constant_buffer_count)
+        buffer_address_info = vkd3d_find_struct(shader_interface->next, BUFFER_ADDRESS_INFO);
+        compiler->push_constant_count = shader_interface->push_constant_buffer_count;
+        if (buffer_address_info)
+            compiler->push_constant_count += buffer_address_info->buffer_count;
+        if (compiler->push_constant_count)
         {
-            if (!(compiler->push_constants = vkd3d_calloc(shader_interface->push_constant_buffer_count,
+            if (!(compiler->push_constants = vkd3d_calloc(compiler->push_constant_count,
                     sizeof(*compiler->push_constants))))
             {
                 spirv_compiler_destroy(compiler);
@@ -3282,6 +3303,11 @@ static struct spirv_compiler *spirv_compiler_create(struct vsir_program *program
             }
             for (i = 0; i < shader_interface->push_constant_buffer_count; ++i)
                 compiler->push_constants[i].pc = shader_interface->push_constant_buffers[i];
+            for (j = 0; i < compiler->push_constant_count; ++i, ++j)
+            {
+                compiler->push_constants[i].pc = buffer_address_info->buffers[j];
+                compiler->push_constants[i].buffer_address = true;
+            }
         }
 
         if ((offset_info = vkd3d_find_struct(shader_interface->next, DESCRIPTOR_OFFSET_INFO)))
@@ -3384,7 +3410,7 @@ static struct vkd3d_push_constant_buffer_binding *spirv_compiler_find_push_const
     if (range->first != range->last)
         return NULL;
 
-    for (i = 0; i < compiler->shader_interface.push_constant_buffer_count; ++i)
+    for (i = 0; i < compiler->push_constant_count; ++i)
     {
         struct vkd3d_push_constant_buffer_binding *current = &compiler->push_constants[i];
 
@@ -4164,6 +4190,7 @@ struct vkd3d_shader_register_info
     uint32_t member_idx;
     unsigned int structure_stride;
     unsigned int binding_base_idx;
+    uint32_t buffer_address_type_id;
     bool is_aggregate;
 };
 
@@ -4186,6 +4213,7 @@ static bool spirv_compiler_get_register_info(struct spirv_compiler *compiler,
         register_info->write_mask = VKD3DSP_WRITEMASK_ALL;
         register_info->structure_stride = 0;
         register_info->binding_base_idx = 0;
+        register_info->buffer_address_type_id = 0;
         register_info->is_aggregate = false;
         return true;
     }
@@ -4226,6 +4254,7 @@ static bool spirv_compiler_get_register_info(struct spirv_compiler *compiler,
     register_info->write_mask = symbol->info.reg.write_mask;
     register_info->structure_stride = symbol->info.reg.structure_stride;
     register_info->binding_base_idx = symbol->info.reg.binding_base_idx;
+    register_info->buffer_address_type_id = symbol->info.reg.buffer_address_type_id;
     register_info->is_aggregate = symbol->info.reg.is_aggregate;
 
     return true;
@@ -4324,7 +4353,22 @@ static void spirv_compiler_emit_dereference_register(struct spirv_compiler *comp
     uint32_t type_id, ptr_type_id;
     uint32_t indexes[3];
 
-    if (reg->type == VKD3DSPR_CONSTBUFFER)
+    if (reg->type == VKD3DSPR_CONSTBUFFER && register_info->buffer_address_type_id)
+    {
+        /* Load the buffer address from push constants, and index the
+         * PhysicalStorageBuffer block it points to. */
+        VKD3D_ASSERT(!reg->idx[0].rel_addr);
+        ptr_type_id = vkd3d_spirv_get_op_type_pointer(builder,
+                SpvStorageClassPushConstant, register_info->buffer_address_type_id);
+        indexes[0] = spirv_compiler_get_constant_uint(compiler, register_info->member_idx);
+        register_info->id = vkd3d_spirv_build_op_in_bounds_access_chain1(builder,
+                ptr_type_id, register_info->id, indexes[0]);
+        register_info->id = vkd3d_spirv_build_op_load(builder, register_info->buffer_address_type_id,
+                register_info->id, SpvMemoryAccessMaskNone);
+        indexes[index_count++] = spirv_compiler_get_constant_uint(compiler, 0);
+        indexes[index_count++] = spirv_compiler_emit_register_addressing(compiler, &reg->idx[2]);
+    }
+    else if (reg->type == VKD3DSPR_CONSTBUFFER)
     {
         VKD3D_ASSERT(!reg->idx[0].rel_addr);
         if (register_info->descriptor_array)
@@ -4655,7 +4699,10 @@ static uint32_t spirv_compiler_emit_load_scalar(struct spirv_compiler *compiler,
         reg_id = vkd3d_spirv_build_op_in_bounds_access_chain1(builder, ptr_type_id, reg_id, index);
     }
 
-    val_id = vkd3d_spirv_build_op_load(builder, type_id, reg_id, SpvMemoryAccessMaskNone);
+    if (reg_info->storage_class == SpvStorageClassPhysicalStorageBuffer)
+        val_id = vkd3d_spirv_build_op_load_aligned(builder, type_id, reg_id, sizeof(uint32_t));
+    else
+        val_id = vkd3d_spirv_build_op_load(builder, type_id, reg_id, SpvMemoryAccessMaskNone);
 
     if (component_type != reg_info->component_type)
     {
@@ -4798,7 +4845,11 @@ static uint32_t spirv_compiler_emit_load_reg(struct spirv_compiler *compiler,
     {
         type_id = vkd3d_spirv_get_type_id(builder,
                 reg_info.component_type, vsir_write_mask_component_count(reg_info.write_mask));
-        val_id = vkd3d_spirv_build_op_load(builder, type_id, reg_info.id, SpvMemoryAccessMaskNone);
+        if (reg_info.storage_class == SpvStorageClassPhysicalStorageBuffer)
+            val_id = vkd3d_spirv_build_op_load_aligned(builder, type_id, reg_info.id,
+                    VKD3D_VEC4_SIZE * sizeof(uint32_t));
+        else
+            val_id = vkd3d_spirv_build_op_load(builder, type_id, reg_info.id, SpvMemoryAccessMaskNone);
         swizzle = data_type_is_64_bit(reg->data_type) ? vsir_swizzle_32_from_64(swizzle) : swizzle;
     }
 
@@ -6560,11 +6611,12 @@ static void spirv_compiler_emit_push_constant_buffers(struct spirv_compiler *com
     const SpvStorageClass storage_class = SpvStorageClassPushConstant;
     uint32_t vec4_id, length_id, struct_id, pointer_type_id, var_id;
     struct vkd3d_spirv_builder *builder = &compiler->spirv_builder;
+    uint32_t array_type_id, block_type_id;
     struct vkd3d_symbol reg_symbol;
     uint32_t *member_ids;
 
     count = !!compiler->offset_info.descriptor_table_count;
-    for (i = 0; i < compiler->shader_interface.push_constant_buffer_count; ++i)
+    for (i = 0; i < compiler->push_constant_count; ++i)
     {
         const struct vkd3d_push_constant_buffer_binding *cb = &compiler->push_constants[i];
 
@@ -6579,15 +6631,32 @@ static void spirv_compiler_emit_push_constant_buffers(struct spirv_compiler *com
 
     vec4_id = vkd3d_spirv_get_type_id(builder, VKD3D_SHADER_COMPONENT_FLOAT, VKD3D_VEC4_SIZE);
 
-    for (i = 0, j = 0; i < compiler->shader_interface.push_constant_buffer_count; ++i)
+    for (i = 0, j = 0; i < compiler->push_constant_count; ++i)
     {
         const struct vkd3d_push_constant_buffer_binding *cb = &compiler->push_constants[i];
         if (!cb->reg.type)
             continue;
 
         length_id = spirv_compiler_get_constant_uint(compiler, cb->size);
-        member_ids[j]  = vkd3d_spirv_build_op_type_array(builder, vec4_id, length_id);
-        vkd3d_spirv_build_op_decorate1(builder, member_ids[j], SpvDecorationArrayStride, 16);
+        array_type_id = vkd3d_spirv_build_op_type_array(builder, vec4_id, length_id);
+        vkd3d_spirv_build_op_decorate1(builder, array_type_id, SpvDecorationArrayStride, 16);
+
+        if (cb->buffer_address)
+        {
+            /* The member is a pointer to the constant buffer data. */
+            vkd3d_spirv_enable_capability(builder, SpvCapabilityPhysicalStorageBufferAddresses);
+            block_type_id = vkd3d_spirv_build_op_type_struct(builder, &array_type_id, 1);
+            vkd3d_spirv_build_op_decorate(builder, block_type_id, SpvDecorationBlock, NULL, 0);
+            vkd3d_spirv_build_op_member_decorate1(builder, block_type_id, 0, SpvDecorationOffset, 0);
+            vkd3d_spirv_build_op_member_decorate(builder, block_type_id, 0, SpvDecorationNonWritable, NULL, 0);
+            vkd3d_spirv_build_op_name(builder, block_type_id, "cb%u_struct", cb->size);
+            member_ids[j] = vkd3d_spirv_get_op_type_pointer(builder,
+                    SpvStorageClassPhysicalStorageBuffer, block_type_id);
+        }
+        else
+        {
+            member_ids[j] = array_type_id;
+        }
 
         ++j;
     }
@@ -6606,7 +6675,6 @@ static void spirv_compiler_emit_push_constant_buffers(struct spirv_compiler *com
     struct_id = vkd3d_spirv_build_op_type_struct(builder, member_ids, count);
     vkd3d_spirv_build_op_decorate(builder, struct_id, SpvDecorationBlock, NULL, 0);
     vkd3d_spirv_build_op_name(builder, struct_id, "push_cb_struct");
-    vkd3d_free(member_ids);
 
     pointer_type_id = vkd3d_spirv_get_op_type_pointer(builder, storage_class, struct_id);
     var_id = vkd3d_spirv_build_op_variable(builder, &builder->global_stream,
@@ -6614,7 +6682,7 @@ static void spirv_compiler_emit_push_constant_buffers(struct spirv_compiler *com
     compiler->push_constants_var_id = var_id;
     vkd3d_spirv_build_op_name(builder, var_id, "push_cb");
 
-    for (i = 0, j = 0; i < compiler->shader_interface.push_constant_buffer_count; ++i)
+    for (i = 0, j = 0; i < compiler->push_constant_count; ++i)
     {
         const struct vkd3d_push_constant_buffer_binding *cb = &compiler->push_constants[i];
         if (!cb->reg.type)
@@ -6626,9 +6694,12 @@ static void spirv_compiler_emit_push_constant_buffers(struct spirv_compiler *com
         vkd3d_spirv_build_op_member_name(builder, struct_id, j, "cb%u", reg_idx);
 
         vkd3d_symbol_make_register(&reg_symbol, &cb->reg);
-        vkd3d_symbol_set_register_info(&reg_symbol, var_id, storage_class,
+        vkd3d_symbol_set_register_info(&reg_symbol, var_id, cb->buffer_address
+                ? SpvStorageClassPhysicalStorageBuffer : storage_class,
                 VKD3D_SHADER_COMPONENT_FLOAT, VKD3DSP_WRITEMASK_ALL);
         reg_symbol.info.reg.member_idx = j;
+        if (cb->buffer_address)
+            reg_symbol.info.reg.buffer_address_type_id = member_ids[j];
         spirv_compiler_put_symbol(compiler, &reg_symbol);
 
         ++j;
@@ -6638,6 +6709,8 @@ static void spirv_compiler_emit_push_constant_buffers(struct spirv_compiler *com
         vkd3d_spirv_build_op_member_decorate1(builder, struct_id, descriptor_offsets_member_idx,
                 SpvDecorationOffset, compiler->offset_info.descriptor_table_offset);
     }
+
+    vkd3d_free(member_ids);
 }
 
 static const struct vkd3d_shader_descriptor_info1 *spirv_compiler_get_descriptor_info(
@@ -6780,7 +6853,7 @@ static void spirv_compiler_emit_cbv_declaration(struct spirv_compiler *compiler,
          */
         push_cb->reg = reg;
         push_cb->size = size;
-        if (size_in_bytes > push_cb->pc.size)
+        if (!push_cb->buffer_address && size_in_bytes > push_cb->pc.size)
         {
             WARN("Constant buffer size %u exceeds push constant size %u.\n",
                     size_in_bytes, push_cb->pc.size);
@@ -7905,8 +7978,10 @@ static void spirv_compiler_emit_mov(struct spirv_compiler *compiler,
     spirv_compiler_get_register_info(compiler, &dst->reg, &dst_reg_info);
     spirv_compiler_get_register_info(compiler, &src->reg, &src_reg_info);
 
+    /* Loads through buffer addresses require explicit alignment. */
     if (dst_reg_info.component_type != src_reg_info.component_type
-            || dst_reg_info.write_mask != src_reg_info.write_mask)
+            || dst_reg_info.write_mask != src_reg_info.write_mask
+            || src_reg_info.buffer_address_type_id)
         goto general_implementation;
 
     if (dst_reg_info.write_mask == dst->write_mask
@@ -2281,63 +2281,23 @@ void vkd3d_shader_set_log_callback(PFN_vkd3d_log callback)
     vkd3d_dbg_set_log_callback(callback);
 }
 
-static struct vkd3d_shader_param_node *shader_param_allocator_node_create(
-        struct vkd3d_shader_param_allocator *allocator)
-{
-    struct vkd3d_shader_param_node *node;
-
-    if (!(node = vkd3d_malloc(offsetof(struct vkd3d_shader_param_node, param[allocator->count * allocator->stride]))))
-        return NULL;
-    node->next = NULL;
-    return node;
-}
-
 static void shader_param_allocator_init(struct vkd3d_shader_param_allocator *allocator,
         size_t count, size_t stride)
 {
-    allocator->count = max(count, MAX_REG_OUTPUT);
+    vkd3d_arena_init(&allocator->arena, max(count, MAX_REG_OUTPUT) * stride);
     allocator->stride = stride;
-    allocator->head = NULL;
-    allocator->current = NULL;
-    allocator->index = allocator->count;
 }
 
 static void shader_param_allocator_destroy(struct vkd3d_shader_param_allocator *allocator)
 {
-    struct vkd3d_shader_param_node *current = allocator->head;
-
-    while (current)
-    {
-        struct vkd3d_shader_param_node *next = current->next;
-        vkd3d_free(current);
-        current = next;
-    }
+    vkd3d_arena_cleanup(&allocator->arena);
 }
 
 void *shader_param_allocator_get(struct vkd3d_shader_param_allocator *allocator, size_t count)
 {
-    void *params;
-
-    if (!allocator->current || count > allocator->count - allocator->index)
-    {
-        struct vkd3d_shader_param_node *next;
-
-        /* Monolithic switch has no definite parameter count limit. */
-        allocator->count = max(allocator->count, count);
-
-        if (!(next = shader_param_allocator_node_create(allocator)))
-            return NULL;
-        if (allocator->current)
-            allocator->current->next = next;
-        else
-            allocator->head = next;
-        allocator->current = next;
-        allocator->index = 0;
-    }
-
-    params = &allocator->current->param[allocator->index * allocator->stride];
-    allocator->index += count;
-    return params;
+    if (count > ~(size_t)0 / allocator->stride)
+        return NULL;
+    return vkd3d_arena_alloc(&allocator->arena, count * allocator->stride);
 }
 
 bool shader_instruction_array_init(struct vkd3d_shader_instruction_array *instructions, size_t reserve)
@@ -2353,6 +2313,8 @@ bool shader_instruction_array_init(struct vkd3d_shader_instruction_array *instru
 
 bool shader_instruction_array_reserve(struct vkd3d_shader_instruction_array *instructions, size_t reserve)
 {
+    shader_instruction_array_close_gap(instructions);
+
     if (!vkd3d_array_reserve((void **)&instructions->elements, &instructions->capacity, reserve,
             sizeof(*instructions->elements)))
     {
@@ -2362,6 +2324,65 @@ bool shader_instruction_array_reserve(struct vkd3d_shader_instruction_array *ins
     return true;
 }
 
+void shader_instruction_array_close_gap(struct vkd3d_shader_instruction_array *instructions)
+{
+    size_t idx = instructions->gap_idx;
+
+    if (!instructions->gap_size)
+        return;
+
+    memmove(&instructions->elements[idx], &instructions->elements[idx + instructions->gap_size],
+            (instructions->count - idx) * sizeof(*instructions->elements));
+    instructions->gap_size = 0;
+}
+
+/* Insert "count" zeroed instructions at "idx", and keep the unused space of
+ * the array as a gap after them. Insertions at nearby positions then only
+ * need to move the instructions between the two positions. */
+bool shader_instruction_array_insert_before_gap(struct vkd3d_shader_instruction_array *instructions,
+        size_t idx, size_t count)
+{
+    struct vkd3d_shader_instruction *elements;
+    size_t gap_idx, gap_size;
+
+    VKD3D_ASSERT(idx <= instructions->count);
+
+    if (!instructions->gap_size)
+        instructions->gap_idx = idx;
+    gap_idx = instructions->gap_idx;
+
+    if (instructions->gap_size < count)
+    {
+        if (!vkd3d_array_reserve((void **)&instructions->elements, &instructions->capacity,
+                instructions->count + count, sizeof(*instructions->elements)))
+        {
+            ERR("Failed to allocate instructions.\n");
+            return false;
+        }
+
+        /* Grow the gap to cover all of the unused space. */
+        gap_size = instructions->capacity - instructions->count;
+        memmove(&instructions->elements[gap_idx + gap_size],
+                &instructions->elements[gap_idx + instructions->gap_size],
+                (instructions->count - gap_idx) * sizeof(*instructions->elements));
+        instructions->gap_size = gap_size;
+    }
+
+    elements = instructions->elements;
+    gap_size = instructions->gap_size;
+    if (idx < gap_idx)
+        memmove(&elements[idx + gap_size], &elements[idx], (gap_idx - idx) * sizeof(*elements));
+    else if (idx > gap_idx)
+        memmove(&elements[gap_idx], &elements[gap_idx + gap_size], (idx - gap_idx) * sizeof(*elements));
+    memset(&elements[idx], 0, count * sizeof(*elements));
+
+    instructions->gap_idx = idx + count;
+    instructions->gap_size -= count;
+    instructions->count += count;
+
+    return true;
+}
+
 bool shader_instruction_array_insert_at(struct vkd3d_shader_instruction_array *instructions,
         size_t idx, size_t count)
 {
@@ -2455,8 +2476,10 @@ static struct vkd3d_shader_src_param *shader_instruction_array_clone_src_params(
 bool shader_instruction_array_clone_instruction(struct vkd3d_shader_instruction_array *instructions,
         size_t dst, size_t src)
 {
-    struct vkd3d_shader_instruction *ins = &instructions->elements[dst];
+    struct vkd3d_shader_instruction *ins;
 
+    shader_instruction_array_close_gap(instructions);
+    ins = &instructions->elements[dst];
     *ins = instructions->elements[src];
 
     if (ins->dst_count && ins->dst && !(ins->dst = shader_instruction_array_clone_dst_params(instructions,
@@ -1393,19 +1393,10 @@ static inline bool register_is_ssa(const struct vkd3d_shader_register *reg)
     return reg->type == VKD3DSPR_SSA;
 }
 
-struct vkd3d_shader_param_node
-{
-    struct vkd3d_shader_param_node *next;
-    uint8_t param[];
-};
-
 struct vkd3d_shader_param_allocator
 {
-    struct vkd3d_shader_param_node *head;
-    struct vkd3d_shader_param_node *current;
-    size_t count;
+    struct vkd3d_arena arena;
     size_t stride;
-    size_t index;
 };
 
 void *shader_param_allocator_get(struct vkd3d_shader_param_allocator *allocator, size_t count);
@@ -1429,6 +1420,12 @@ struct vkd3d_shader_instruction_array
     struct vkd3d_shader_instruction *elements;
     size_t capacity;
     size_t count;
+    /* Unused elements left before instruction "gap_idx" by
+     * vsir_program_iterator_insert_after(), so that consecutive insertions
+     * don't need to move the whole tail of the array. The gap only exists
+     * while a transformation pass is running. */
+    size_t gap_idx;
+    size_t gap_size;
 
     struct vkd3d_shader_param_allocator src_params;
     struct vkd3d_shader_param_allocator dst_params;
@@ -1443,6 +1440,9 @@ bool shader_instruction_array_init(struct vkd3d_shader_instruction_array *instru
 bool shader_instruction_array_reserve(struct vkd3d_shader_instruction_array *instructions, size_t reserve);
 bool shader_instruction_array_insert_at(struct vkd3d_shader_instruction_array *instructions,
         size_t idx, size_t count);
+bool shader_instruction_array_insert_before_gap(struct vkd3d_shader_instruction_array *instructions,
+        size_t idx, size_t count);
+void shader_instruction_array_close_gap(struct vkd3d_shader_instruction_array *instructions);
 bool shader_instruction_array_add_icb(struct vkd3d_shader_instruction_array *instructions,
         struct vkd3d_shader_immediate_constant_buffer *icb);
 bool shader_instruction_array_clone_instruction(struct vkd3d_shader_instruction_array *instructions,
@@ -1463,10 +1463,14 @@ static inline struct vsir_program_iterator vsir_program_iterator(struct vkd3d_sh
 static inline struct vkd3d_shader_instruction *vsir_program_iterator_current(
         struct vsir_program_iterator *iterator)
 {
-    if (iterator->idx >= iterator->array->count)
+    const struct vkd3d_shader_instruction_array *array = iterator->array;
+
+    if (iterator->idx >= array->count)
         return NULL;
 
-    return &iterator->array->elements[iterator->idx];
+    if (iterator->idx >= array->gap_idx)
+        return &array->elements[iterator->idx + array->gap_size];
+    return &array->elements[iterator->idx];
 }
 
 static inline struct vkd3d_shader_instruction *vsir_program_iterator_head(
@@ -1504,10 +1508,14 @@ static inline struct vkd3d_shader_instruction *vsir_program_iterator_prev(
 
 /* When insertion takes place, argument `it' is updated to point to the same
  * instruction as before the insertion, but all other iterators and pointers
- * to the same container are invalidated and cannot be used any more. */
+ * to the same container are invalidated and cannot be used any more.
+ *
+ * Insertion leaves a gap in the underlying array, which is closed again at
+ * the end of the transformation pass; until then the array must only be
+ * accessed through iterators. */
 static inline bool vsir_program_iterator_insert_after(struct vsir_program_iterator *it, size_t count)
 {
-    return shader_instruction_array_insert_at(it->array, it->idx + 1, count);
+    return shader_instruction_array_insert_before_gap(it->array, it->idx + 1, count);
 }
 
 enum vkd3d_shader_config_flags
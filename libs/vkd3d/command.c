@@ -398,10 +398,13 @@ static void *vkd3d_fence_worker_main(void *arg)
 
         for (i = 0; i < cur_fence_count; ++i)
         {
+            uint64_t trace_start = vkd3d_trace_span_begin();
+
             if (timeline)
                 vkd3d_wait_for_gpu_timeline_semaphore(worker, &cur_fences[i]);
             else
                 vkd3d_wait_for_gpu_fence(worker, &cur_fences[i]);
+            vkd3d_trace_span_end("GPU fence wait", trace_start);
         }
     }
 
@@ -1137,8 +1140,11 @@ static HRESULT STDMETHODCALLTYPE d3d12_fence_SetEventOnCompletion(ID3D12Fence1 *
 
     if (event == &null_event)
     {
+        uint64_t trace_start = vkd3d_trace_span_begin();
+
         vkd3d_null_event_wait(&null_event);
         vkd3d_null_event_cleanup(&null_event);
+        vkd3d_trace_span_end("Fence wait", trace_start);
     }
 
     return S_OK;
@@ -1364,6 +1370,134 @@ static void vkd3d_vk_descriptor_pool_array_destroy_pools(struct vkd3d_vk_descrip
     array->count = 0;
 }
 
+void vkd3d_command_allocator_cache_init(struct vkd3d_command_allocator_cache *cache)
+{
+    unsigned int i;
+
+    vkd3d_mutex_init(&cache->mutex);
+    cache->generation = 0;
+    cache->command_pool_count = 0;
+    for (i = 0; i < ARRAY_SIZE(cache->descriptor_pools); ++i)
+        vkd3d_vk_descriptor_pool_array_init(&cache->descriptor_pools[i]);
+}
+
+void vkd3d_command_allocator_cache_cleanup(struct vkd3d_command_allocator_cache *cache, struct d3d12_device *device)
+{
+    const struct vkd3d_vk_device_procs *vk_procs = &device->vk_procs;
+    struct vkd3d_recycled_command_pool *pool;
+    unsigned int i;
+
+    for (i = 0; i < cache->command_pool_count; ++i)
+    {
+        pool = &cache->command_pools[i];
+        VK_CALL(vkDestroyCommandPool(device->vk_device, pool->vk_pool, NULL));
+        vkd3d_free(pool->command_buffers);
+    }
+
+    for (i = 0; i < ARRAY_SIZE(cache->descriptor_pools); ++i)
+    {
+        vkd3d_vk_descriptor_pool_array_destroy_pools(&cache->descriptor_pools[i], device);
+        vkd3d_vk_descriptor_pool_array_cleanup(&cache->descriptor_pools[i]);
+    }
+
+    vkd3d_mutex_destroy(&cache->mutex);
+}
+
+/* Takes the most recently recycled command pool for the queue family. */
+static bool vkd3d_command_allocator_cache_get_command_pool(struct vkd3d_command_allocator_cache *cache,
+        uint32_t vk_family_index, struct vkd3d_recycled_command_pool *pool)
+{
+    unsigned int i, idx = ~0u;
+
+    vkd3d_mutex_lock(&cache->mutex);
+
+    for (i = 0; i < cache->command_pool_count; ++i)
+    {
+        if (cache->command_pools[i].vk_family_index != vk_family_index)
+            continue;
+        if (idx == ~0u || cache->command_pools[i].generation > cache->command_pools[idx].generation)
+            idx = i;
+    }
+
+    if (idx != ~0u)
+    {
+        *pool = cache->command_pools[idx];
+        cache->command_pools[idx] = cache->command_pools[--cache->command_pool_count];
+    }
+
+    vkd3d_mutex_unlock(&cache->mutex);
+
+    return idx != ~0u;
+}
+
+/* The pool must have been reset. */
+static void vkd3d_command_allocator_cache_put_command_pool(struct vkd3d_command_allocator_cache *cache,
+        struct d3d12_device *device, struct vkd3d_recycled_command_pool *pool)
+{
+    const struct vkd3d_vk_device_procs *vk_procs = &device->vk_procs;
+    struct vkd3d_recycled_command_pool evicted = {0};
+    unsigned int i, idx;
+
+    vkd3d_mutex_lock(&cache->mutex);
+
+    pool->generation = ++cache->generation;
+
+    if (cache->command_pool_count < ARRAY_SIZE(cache->command_pools))
+    {
+        cache->command_pools[cache->command_pool_count++] = *pool;
+    }
+    else
+    {
+        for (i = 1, idx = 0; i < cache->command_pool_count; ++i)
+        {
+            if (cache->command_pools[i].generation < cache->command_pools[idx].generation)
+                idx = i;
+        }
+        evicted = cache->command_pools[idx];
+        cache->command_pools[idx] = *pool;
+    }
+
+    vkd3d_mutex_unlock(&cache->mutex);
+
+    if (evicted.vk_pool)
+    {
+        VK_CALL(vkDestroyCommandPool(device->vk_device, evicted.vk_pool, NULL));
+        vkd3d_free(evicted.command_buffers);
+    }
+}
+
+static VkDescriptorPool vkd3d_command_allocator_cache_get_descriptor_pool(struct vkd3d_command_allocator_cache *cache,
+        enum vkd3d_shader_descriptor_type descriptor_type, unsigned int *descriptor_count)
+{
+    VkDescriptorPool vk_pool;
+
+    vkd3d_mutex_lock(&cache->mutex);
+    vk_pool = vkd3d_vk_descriptor_pool_array_find(&cache->descriptor_pools[descriptor_type], descriptor_count);
+    vkd3d_mutex_unlock(&cache->mutex);
+
+    return vk_pool;
+}
+
+/* Takes ownership of the reset pools in "array". */
+static void vkd3d_command_allocator_cache_put_descriptor_pools(struct vkd3d_command_allocator_cache *cache,
+        struct d3d12_device *device, enum vkd3d_shader_descriptor_type descriptor_type,
+        struct vkd3d_vk_descriptor_pool_array *array)
+{
+    struct vkd3d_vk_descriptor_pool_array *cached = &cache->descriptor_pools[descriptor_type];
+    size_t count;
+
+    vkd3d_mutex_lock(&cache->mutex);
+
+    count = min(array->count, VKD3D_MAX_RECYCLED_DESCRIPTOR_POOLS - min(cached->count,
+            VKD3D_MAX_RECYCLED_DESCRIPTOR_POOLS));
+    if (count && vkd3d_vk_descriptor_pool_array_push_array(cached, &array->pools[array->count - count], count))
+        array->count -= count;
+
+    vkd3d_mutex_unlock(&cache->mutex);
+
+    vkd3d_vk_descriptor_pool_array_destroy_pools(array, device);
+}
+
 /* Command buffers */
 static void d3d12_command_list_mark_as_invalid(struct d3d12_command_list *list,
         const char *message, ...)
@@ -1401,6 +1535,48 @@ static HRESULT d3d12_command_list_begin_command_buffer(struct d3d12_command_list
     return S_OK;
 }
 
+static void d3d12_command_allocator_remove_command_list(struct d3d12_command_allocator *allocator,
+        const struct d3d12_command_list *list)
+{
+    if (allocator->current_command_list == list)
+        allocator->current_command_list = NULL;
+}
+
+/* Deferred command lists keep using their allocator after Close(), until
+ * they have been translated. */
+static void d3d12_command_list_wait_translation(struct d3d12_command_list *list)
+{
+    struct d3d12_device *device = list->device;
+
+    if (!list->deferred.enabled || list->is_recording)
+        return;
+
+    d3d12_device_wait_command_list_translation(device, list);
+
+    /* The list may be waited for concurrently through its allocator and
+     * through ExecuteCommandLists(). */
+    vkd3d_mutex_lock(&device->worker_mutex);
+    if (list->allocator)
+    {
+        d3d12_command_allocator_remove_command_list(list->allocator, list);
+        list->allocator = NULL;
+    }
+    vkd3d_mutex_unlock(&device->worker_mutex);
+}
+
+static void d3d12_command_allocator_wait_translation(struct d3d12_command_allocator *allocator)
+{
+    struct d3d12_device *device = allocator->device;
+    struct d3d12_command_list *list;
+
+    vkd3d_mutex_lock(&device->worker_mutex);
+    list = allocator->current_command_list;
+    vkd3d_mutex_unlock(&device->worker_mutex);
+
+    if (list)
+        d3d12_command_list_wait_translation(list);
+}
+
 static HRESULT d3d12_command_allocator_allocate_command_buffer(struct d3d12_command_allocator *allocator,
         struct d3d12_command_list *list)
 {
@@ -1412,56 +1588,51 @@ static HRESULT d3d12_command_allocator_allocate_command_buffer(struct d3d12_comm
 
     TRACE("allocator %p, list %p.\n", allocator, list);
 
+    d3d12_command_allocator_wait_translation(allocator);
+
     if (allocator->current_command_list)
     {
         WARN("Command allocator is already in use.\n");
         return E_INVALIDARG;
     }
 
-    command_buffer_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
-    command_buffer_info.pNext = NULL;
-    command_buffer_info.commandPool = allocator->vk_command_pool;
-    command_buffer_info.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
-    command_buffer_info.commandBufferCount = 1;
-
-    if ((vr = VK_CALL(vkAllocateCommandBuffers(device->vk_device, &command_buffer_info,
-            &list->vk_command_buffer))) < 0)
+    if (allocator->next_command_buffer == allocator->command_buffer_count)
     {
-        WARN("Failed to allocate Vulkan command buffer, vr %d.\n", vr);
-        return hresult_from_vk_result(vr);
+        if (!vkd3d_array_reserve((void **)&allocator->command_buffers, &allocator->command_buffers_size,
+                allocator->command_buffer_count + 1, sizeof(*allocator->command_buffers)))
+        {
+            WARN("Failed to add command buffer.\n");
+            return E_OUTOFMEMORY;
+        }
+
+        command_buffer_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+        command_buffer_info.pNext = NULL;
+        command_buffer_info.commandPool = allocator->vk_command_pool;
+        command_buffer_info.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+        command_buffer_info.commandBufferCount = 1;
+
+        if ((vr = VK_CALL(vkAllocateCommandBuffers(device->vk_device, &command_buffer_info,
+                &allocator->command_buffers[allocator->command_buffer_count]))) < 0)
+        {
+            WARN("Failed to allocate Vulkan command buffer, vr %d.\n", vr);
+            return hresult_from_vk_result(vr);
+        }
+        ++allocator->command_buffer_count;
     }
 
+    list->vk_command_buffer = allocator->command_buffers[allocator->next_command_buffer];
     list->vk_queue_flags = allocator->vk_queue_flags;
 
+    /* A command buffer which failed to begin is reused by the next allocation. */
     if (FAILED(hr = d3d12_command_list_begin_command_buffer(list)))
-    {
-        VK_CALL(vkFreeCommandBuffers(device->vk_device, allocator->vk_command_pool,
-                1, &list->vk_command_buffer));
         return hr;
-    }
-
-    if (!vkd3d_array_reserve((void **)&allocator->command_buffers, &allocator->command_buffers_size,
-            allocator->command_buffer_count + 1, sizeof(*allocator->command_buffers)))
-    {
-        WARN("Failed to add command buffer.\n");
-        VK_CALL(vkFreeCommandBuffers(device->vk_device, allocator->vk_command_pool,
-                1, &list->vk_command_buffer));
-        return E_OUTOFMEMORY;
-    }
-    allocator->command_buffers[allocator->command_buffer_count++] = list->vk_command_buffer;
 
+    ++allocator->next_command_buffer;
     allocator->current_command_list = list;
 
     return S_OK;
 }
 
-static void d3d12_command_allocator_remove_command_list(struct d3d12_command_allocator *allocator,
-        const struct d3d12_command_list *list)
-{
-    if (allocator->current_command_list == list)
-        allocator->current_command_list = NULL;
-}
-
 static bool d3d12_command_allocator_add_render_pass(struct d3d12_command_allocator *allocator, VkRenderPass pass)
 {
     if (!vkd3d_array_reserve((void **)&allocator->passes, &allocator->passes_size,
@@ -1522,21 +1693,67 @@ static bool d3d12_command_allocator_add_transfer_buffer(struct d3d12_command_all
     return true;
 }
 
+/* Pools past the used count were released by the last Reset(), and are only
+ * reset once they are needed again. */
+static VkDescriptorPool d3d12_command_allocator_reuse_descriptor_pool(struct d3d12_command_allocator *allocator,
+        enum vkd3d_shader_descriptor_type descriptor_type, unsigned int *descriptor_count)
+{
+    struct vkd3d_vk_descriptor_pool_array *array = &allocator->descriptor_pools[descriptor_type];
+    size_t *used = &allocator->used_descriptor_pool_counts[descriptor_type];
+    struct d3d12_device *device = allocator->device;
+    const struct vkd3d_vk_device_procs *vk_procs = &device->vk_procs;
+    struct vkd3d_vk_descriptor_pool pool;
+    size_t i = *used;
+
+    while (i < array->count)
+    {
+        pool = array->pools[i];
+
+        if (pool.descriptor_count < allocator->vk_pool_sizes[descriptor_type])
+        {
+            VK_CALL(vkDestroyDescriptorPool(device->vk_device, pool.vk_pool, NULL));
+            array->pools[i] = array->pools[--array->count];
+            continue;
+        }
+
+        if (pool.descriptor_count < *descriptor_count)
+        {
+            ++i;
+            continue;
+        }
+
+        VK_CALL(vkResetDescriptorPool(device->vk_device, pool.vk_pool, 0));
+        array->pools[i] = array->pools[*used];
+        array->pools[(*used)++] = pool;
+        *descriptor_count = pool.descriptor_count;
+
+        return pool.vk_pool;
+    }
+
+    return VK_NULL_HANDLE;
+}
+
 static VkDescriptorPool d3d12_command_allocator_allocate_descriptor_pool(
         struct d3d12_command_allocator *allocator, enum vkd3d_shader_descriptor_type descriptor_type,
         unsigned int descriptor_count, bool unbounded)
 {
+    struct vkd3d_vk_descriptor_pool_array *array = &allocator->descriptor_pools[descriptor_type];
     struct d3d12_device *device = allocator->device;
     const struct vkd3d_vk_device_procs *vk_procs = &device->vk_procs;
     struct VkDescriptorPoolCreateInfo pool_desc;
+    struct vkd3d_vk_descriptor_pool pool;
     VkDevice vk_device = device->vk_device;
     VkDescriptorPoolSize vk_pool_sizes[4];
     unsigned int pool_size, pool_limit;
     VkDescriptorPool vk_pool;
+    size_t used;
     VkResult vr;
 
-    if (!(vk_pool = vkd3d_vk_descriptor_pool_array_find(&allocator->free_descriptor_pools[descriptor_type],
-            &descriptor_count)))
+    if ((vk_pool = d3d12_command_allocator_reuse_descriptor_pool(allocator, descriptor_type, &descriptor_count)))
+        return vk_pool;
+
+    if (!(vk_pool = vkd3d_command_allocator_cache_get_descriptor_pool(&device->command_allocator_cache,
+            descriptor_type, &descriptor_count)))
     {
         pool_limit = device->vk_pool_limits[descriptor_type];
 
@@ -1608,14 +1825,19 @@ static VkDescriptorPool d3d12_command_allocator_allocate_descriptor_pool(
             allocator->vk_pool_sizes[descriptor_type] = min(pool_limit, descriptor_count * 2);
     }
 
-    if (!(vkd3d_vk_descriptor_pool_array_push(&allocator->descriptor_pools[descriptor_type],
-            descriptor_count, vk_pool)))
+    if (!(vkd3d_vk_descriptor_pool_array_push(array, descriptor_count, vk_pool)))
     {
         ERR("Failed to add descriptor pool.\n");
         VK_CALL(vkDestroyDescriptorPool(vk_device, vk_pool, NULL));
         return VK_NULL_HANDLE;
     }
 
+    /* Keep the pools in use at the start of the array. */
+    used = allocator->used_descriptor_pool_counts[descriptor_type]++;
+    pool = array->pools[used];
+    array->pools[used] = array->pools[array->count - 1];
+    array->pools[array->count - 1] = pool;
+
     return vk_pool;
 }
 
@@ -1655,7 +1877,10 @@ static VkDescriptorSet d3d12_command_allocator_allocate_descriptor_set(struct d3
         set_size.pDescriptorCounts = &variable_binding_size;
     }
     if ((vr = VK_CALL(vkAllocateDescriptorSets(vk_device, &set_desc, &vk_descriptor_set))) >= 0)
+    {
+        d3d12_device_add_statistic(device, vk_descriptor_set_count, 1);
         return vk_descriptor_set;
+    }
 
     allocator->vk_descriptor_pools[descriptor_type] = VK_NULL_HANDLE;
     if (vr == VK_ERROR_FRAGMENTED_POOL || vr == VK_ERROR_OUT_OF_POOL_MEMORY_KHR)
@@ -1673,6 +1898,7 @@ static VkDescriptorSet d3d12_command_allocator_allocate_descriptor_set(struct d3
         FIXME("Failed to allocate descriptor set from a new pool, vr %d.\n", vr);
         return VK_NULL_HANDLE;
     }
+    d3d12_device_add_statistic(device, vk_descriptor_set_count, 1);
 
     return vk_descriptor_set;
 }
@@ -1693,51 +1919,14 @@ static void vkd3d_buffer_destroy(struct vkd3d_buffer *buffer, struct d3d12_devic
     VK_CALL(vkDestroyBuffer(device->vk_device, buffer->vk_buffer, NULL));
 }
 
-static void d3d12_command_allocator_reset_descriptor_pool_array(struct d3d12_command_allocator *allocator,
-        enum vkd3d_shader_descriptor_type type)
-{
-    struct vkd3d_vk_descriptor_pool_array *array = &allocator->descriptor_pools[type];
-    struct d3d12_device *device = allocator->device;
-    const struct vkd3d_vk_device_procs *vk_procs;
-    const struct vkd3d_vk_descriptor_pool *pool;
-    size_t i;
-
-    vk_procs = &device->vk_procs;
-    for (i = 0; i < array->count; ++i)
-    {
-        pool = &array->pools[i];
-        if (pool->descriptor_count < allocator->vk_pool_sizes[type]
-                || !vkd3d_vk_descriptor_pool_array_push_array(&allocator->free_descriptor_pools[type], pool, 1))
-            VK_CALL(vkDestroyDescriptorPool(device->vk_device, pool->vk_pool, NULL));
-        else
-            VK_CALL(vkResetDescriptorPool(device->vk_device, pool->vk_pool, 0));
-    }
-    array->count = 0;
-}
-
-static void d3d12_command_allocator_free_resources(struct d3d12_command_allocator *allocator,
-        bool keep_reusable_resources)
+static void d3d12_command_allocator_free_resources(struct d3d12_command_allocator *allocator)
 {
     struct d3d12_device *device = allocator->device;
     const struct vkd3d_vk_device_procs *vk_procs = &device->vk_procs;
     unsigned int i;
 
     memset(allocator->vk_descriptor_pools, 0, sizeof(allocator->vk_descriptor_pools));
-
-    if (keep_reusable_resources)
-    {
-        for (i = 0; i < ARRAY_SIZE(allocator->descriptor_pools); ++i)
-        {
-            d3d12_command_allocator_reset_descriptor_pool_array(allocator, i);
-        }
-    }
-    else
-    {
-        for (i = 0; i < ARRAY_SIZE(allocator->free_descriptor_pools); ++i)
-        {
-            vkd3d_vk_descriptor_pool_array_destroy_pools(&allocator->free_descriptor_pools[i], device);
-        }
-    }
+    memset(allocator->used_descriptor_pool_counts, 0, sizeof(allocator->used_descriptor_pool_counts));
 
     for (i = 0; i < allocator->transfer_buffer_count; ++i)
     {
@@ -1757,11 +1946,6 @@ static void d3d12_command_allocator_free_resources(struct d3d12_command_allocato
     }
     allocator->view_count = 0;
 
-    for (i = 0; i < ARRAY_SIZE(allocator->descriptor_pools); ++i)
-    {
-        vkd3d_vk_descriptor_pool_array_destroy_pools(&allocator->descriptor_pools[i], device);
-    }
-
     for (i = 0; i < allocator->framebuffer_count; ++i)
     {
         VK_CALL(vkDestroyFramebuffer(device->vk_device, allocator->framebuffers[i], NULL));
@@ -1775,6 +1959,51 @@ static void d3d12_command_allocator_free_resources(struct d3d12_command_allocato
     allocator->pass_count = 0;
 }
 
+/* Hands the command and descriptor pools over to the device, for reuse by
+ * other command allocators. */
+static void d3d12_command_allocator_recycle_pools(struct d3d12_command_allocator *allocator)
+{
+    struct vkd3d_command_allocator_cache *cache = &allocator->device->command_allocator_cache;
+    struct d3d12_device *device = allocator->device;
+    const struct vkd3d_vk_device_procs *vk_procs = &device->vk_procs;
+    struct vkd3d_recycled_command_pool pool;
+    unsigned int i;
+    size_t j;
+    VkResult vr;
+
+    d3d12_command_allocator_free_resources(allocator);
+
+    for (i = 0; i < ARRAY_SIZE(allocator->descriptor_pools); ++i)
+    {
+        for (j = 0; j < allocator->descriptor_pools[i].count; ++j)
+        {
+            VK_CALL(vkResetDescriptorPool(device->vk_device, allocator->descriptor_pools[i].pools[j].vk_pool, 0));
+        }
+        vkd3d_command_allocator_cache_put_descriptor_pools(cache, device, i, &allocator->descriptor_pools[i]);
+    }
+
+    if ((vr = VK_CALL(vkResetCommandPool(device->vk_device, allocator->vk_command_pool, 0))) < 0)
+    {
+        WARN("Failed to reset command pool, vr %d.\n", vr);
+        /* All command buffers are implicitly freed when a pool is destroyed. */
+        VK_CALL(vkDestroyCommandPool(device->vk_device, allocator->vk_command_pool, NULL));
+        vkd3d_free(allocator->command_buffers);
+    }
+    else
+    {
+        pool.vk_pool = allocator->vk_command_pool;
+        pool.vk_family_index = allocator->vk_family_index;
+        pool.command_buffers = allocator->command_buffers;
+        pool.command_buffers_size = allocator->command_buffers_size;
+        pool.command_buffer_count = allocator->command_buffer_count;
+        vkd3d_command_allocator_cache_put_command_pool(cache, device, &pool);
+    }
+
+    allocator->vk_command_pool = VK_NULL_HANDLE;
+    allocator->command_buffers = NULL;
+    allocator->command_buffer_count = 0;
+}
+
 /* ID3D12CommandAllocator */
 static inline struct d3d12_command_allocator *impl_from_ID3D12CommandAllocator(ID3D12CommandAllocator *iface)
 {
@@ -1824,29 +2053,24 @@ static ULONG STDMETHODCALLTYPE d3d12_command_allocator_Release(ID3D12CommandAllo
     if (!refcount)
     {
         struct d3d12_device *device = allocator->device;
-        const struct vkd3d_vk_device_procs *vk_procs = &device->vk_procs;
 
         vkd3d_private_store_destroy(&allocator->private_store);
 
+        d3d12_command_allocator_wait_translation(allocator);
         if (allocator->current_command_list)
             d3d12_command_list_allocator_destroyed(allocator->current_command_list);
 
-        d3d12_command_allocator_free_resources(allocator, false);
+        d3d12_command_allocator_recycle_pools(allocator);
         vkd3d_free(allocator->transfer_buffers);
         vkd3d_free(allocator->buffer_views);
         vkd3d_free(allocator->views);
-        for (i = 0; i < ARRAY_SIZE(allocator->free_descriptor_pools); ++i)
+        for (i = 0; i < ARRAY_SIZE(allocator->descriptor_pools); ++i)
         {
             vkd3d_vk_descriptor_pool_array_cleanup(&allocator->descriptor_pools[i]);
-            vkd3d_vk_descriptor_pool_array_cleanup(&allocator->free_descriptor_pools[i]);
         }
         vkd3d_free(allocator->framebuffers);
         vkd3d_free(allocator->passes);
 
-        /* All command buffers are implicitly freed when a pool is destroyed. */
-        vkd3d_free(allocator->command_buffers);
-        VK_CALL(vkDestroyCommandPool(device->vk_device, allocator->vk_command_pool, NULL));
-
         vkd3d_free(allocator);
 
         d3d12_device_release(device);
@@ -1914,6 +2138,8 @@ static HRESULT STDMETHODCALLTYPE d3d12_command_allocator_Reset(ID3D12CommandAllo
 
     TRACE("iface %p.\n", iface);
 
+    d3d12_command_allocator_wait_translation(allocator);
+
     if ((list = allocator->current_command_list))
     {
         if (list->is_recording)
@@ -1928,13 +2154,9 @@ static HRESULT STDMETHODCALLTYPE d3d12_command_allocator_Reset(ID3D12CommandAllo
     device = allocator->device;
     vk_procs = &device->vk_procs;
 
-    d3d12_command_allocator_free_resources(allocator, true);
-    if (allocator->command_buffer_count)
-    {
-        VK_CALL(vkFreeCommandBuffers(device->vk_device, allocator->vk_command_pool,
-                allocator->command_buffer_count, allocator->command_buffers));
-        allocator->command_buffer_count = 0;
-    }
+    d3d12_command_allocator_free_resources(allocator);
+    /* Resetting the pool returns the command buffers to the initial state. */
+    allocator->next_command_buffer = 0;
 
     /* The intent here is to recycle memory, so do not use RELEASE_RESOURCES_BIT here. */
     if ((vr = VK_CALL(vkResetCommandPool(device->vk_device, allocator->vk_command_pool, 0))))
@@ -1992,6 +2214,7 @@ static HRESULT d3d12_command_allocator_init(struct d3d12_command_allocator *allo
         struct d3d12_device *device, D3D12_COMMAND_LIST_TYPE type)
 {
     const struct vkd3d_vk_device_procs *vk_procs = &device->vk_procs;
+    struct vkd3d_recycled_command_pool recycled_pool;
     VkCommandPoolCreateInfo command_pool_info;
     struct vkd3d_queue *queue;
     VkResult vr;
@@ -2010,28 +2233,41 @@ static HRESULT d3d12_command_allocator_init(struct d3d12_command_allocator *allo
     allocator->type = type;
     allocator->vk_queue_flags = queue->vk_queue_flags;
 
-    command_pool_info.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
-    command_pool_info.pNext = NULL;
-    /* Do not use RESET_COMMAND_BUFFER_BIT. This allows the CommandPool to be a D3D12-style command pool.
-     * Memory is owned by the pool and CommandBuffers become lightweight handles,
-     * assuming a half-decent driver implementation. */
-    command_pool_info.flags = 0;
-    command_pool_info.queueFamilyIndex = queue->vk_family_index;
+    allocator->command_buffers = NULL;
+    allocator->command_buffers_size = 0;
+    allocator->command_buffer_count = 0;
+    allocator->next_command_buffer = 0;
 
-    if ((vr = VK_CALL(vkCreateCommandPool(device->vk_device, &command_pool_info, NULL,
-            &allocator->vk_command_pool))) < 0)
+    if (vkd3d_command_allocator_cache_get_command_pool(&device->command_allocator_cache,
+            queue->vk_family_index, &recycled_pool))
     {
-        WARN("Failed to create Vulkan command pool, vr %d.\n", vr);
-        vkd3d_private_store_destroy(&allocator->private_store);
-        return hresult_from_vk_result(vr);
+        allocator->vk_command_pool = recycled_pool.vk_pool;
+        allocator->command_buffers = recycled_pool.command_buffers;
+        allocator->command_buffers_size = recycled_pool.command_buffers_size;
+        allocator->command_buffer_count = recycled_pool.command_buffer_count;
     }
-
-    memset(allocator->vk_descriptor_pools, 0, sizeof(allocator->vk_descriptor_pools));
-
-    for (i = 0; i < ARRAY_SIZE(allocator->free_descriptor_pools); ++i)
+    else
     {
-        vkd3d_vk_descriptor_pool_array_init(&allocator->free_descriptor_pools[i]);
+        command_pool_info.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+        command_pool_info.pNext = NULL;
+        /* Do not use RESET_COMMAND_BUFFER_BIT. This allows the CommandPool to be a D3D12-style command pool.
+         * Memory is owned by the pool and CommandBuffers become lightweight handles,
+         * assuming a half-decent driver implementation. */
+        command_pool_info.flags = 0;
+        command_pool_info.queueFamilyIndex = queue->vk_family_index;
+
+        if ((vr = VK_CALL(vkCreateCommandPool(device->vk_device, &command_pool_info, NULL,
+                &allocator->vk_command_pool))) < 0)
+        {
+            WARN("Failed to create Vulkan command pool, vr %d.\n", vr);
+            vkd3d_private_store_destroy(&allocator->private_store);
+            return hresult_from_vk_result(vr);
+        }
     }
+    allocator->vk_family_index = queue->vk_family_index;
+
+    memset(allocator->vk_descriptor_pools, 0, sizeof(allocator->vk_descriptor_pools));
+    memset(allocator->used_descriptor_pool_counts, 0, sizeof(allocator->used_descriptor_pool_counts));
 
     allocator->passes = NULL;
     allocator->passes_size = 0;
@@ -2059,10 +2295,6 @@ static HRESULT d3d12_command_allocator_init(struct d3d12_command_allocator *allo
     allocator->transfer_buffers_size = 0;
     allocator->transfer_buffer_count = 0;
 
-    allocator->command_buffers = NULL;
-    allocator->command_buffers_size = 0;
-    allocator->command_buffer_count = 0;
-
     allocator->current_command_list = NULL;
 
     d3d12_device_add_ref(allocator->device = device);
@@ -2202,6 +2434,7 @@ static void d3d12_command_list_invalidate_root_parameters(struct d3d12_command_l
     bindings->push_descriptor_dirty_mask = bindings->push_descriptor_active_mask & bindings->root_signature->push_descriptor_mask;
     bindings->cbv_srv_uav_heap_id = 0;
     bindings->sampler_heap_id = 0;
+    bindings->static_samplers_dirty = true;
 }
 
 static bool vk_barrier_parameters_from_d3d12_resource_state(unsigned int state, unsigned int stencil_state,
@@ -2524,6 +2757,8 @@ static ULONG STDMETHODCALLTYPE d3d12_command_list_Release(ID3D12GraphicsCommandL
     {
         struct d3d12_device *device = list->device;
 
+        d3d12_command_list_wait_translation(list);
+
         vkd3d_private_store_destroy(&list->private_store);
 
         /* When command pool is destroyed, all command buffers are implicitly freed. */
@@ -2533,6 +2768,7 @@ static ULONG STDMETHODCALLTYPE d3d12_command_list_Release(ID3D12GraphicsCommandL
         vkd3d_pipeline_bindings_cleanup(&list->pipeline_bindings[VKD3D_PIPELINE_BIND_POINT_COMPUTE]);
         vkd3d_pipeline_bindings_cleanup(&list->pipeline_bindings[VKD3D_PIPELINE_BIND_POINT_GRAPHICS]);
 
+        vkd3d_free(list->deferred.data);
         vkd3d_free(list);
 
         d3d12_device_release(device);
@@ -2599,40 +2835,589 @@ static D3D12_COMMAND_LIST_TYPE STDMETHODCALLTYPE d3d12_command_list_GetType(ID3D
     return list->type;
 }
 
-static HRESULT STDMETHODCALLTYPE d3d12_command_list_Close(ID3D12GraphicsCommandList6 *iface)
+enum vkd3d_deferred_op
+{
+    VKD3D_DEFERRED_OP_DRAW,
+    VKD3D_DEFERRED_OP_DRAW_INDEXED,
+    VKD3D_DEFERRED_OP_DISPATCH,
+    VKD3D_DEFERRED_OP_SET_PRIMITIVE_TOPOLOGY,
+    VKD3D_DEFERRED_OP_SET_VIEWPORTS,
+    VKD3D_DEFERRED_OP_SET_SCISSOR_RECTS,
+    VKD3D_DEFERRED_OP_SET_BLEND_FACTOR,
+    VKD3D_DEFERRED_OP_SET_STENCIL_REF,
+    VKD3D_DEFERRED_OP_SET_PIPELINE_STATE,
+    VKD3D_DEFERRED_OP_RESOURCE_BARRIER,
+    VKD3D_DEFERRED_OP_SET_COMPUTE_ROOT_SIGNATURE,
+    VKD3D_DEFERRED_OP_SET_GRAPHICS_ROOT_SIGNATURE,
+    VKD3D_DEFERRED_OP_SET_COMPUTE_ROOT_DESCRIPTOR_TABLE,
+    VKD3D_DEFERRED_OP_SET_GRAPHICS_ROOT_DESCRIPTOR_TABLE,
+    VKD3D_DEFERRED_OP_SET_COMPUTE_ROOT_CONSTANTS,
+    VKD3D_DEFERRED_OP_SET_GRAPHICS_ROOT_CONSTANTS,
+    VKD3D_DEFERRED_OP_SET_COMPUTE_ROOT_CBV,
+    VKD3D_DEFERRED_OP_SET_GRAPHICS_ROOT_CBV,
+    VKD3D_DEFERRED_OP_SET_COMPUTE_ROOT_SRV,
+    VKD3D_DEFERRED_OP_SET_GRAPHICS_ROOT_SRV,
+    VKD3D_DEFERRED_OP_SET_COMPUTE_ROOT_UAV,
+    VKD3D_DEFERRED_OP_SET_GRAPHICS_ROOT_UAV,
+    VKD3D_DEFERRED_OP_SET_INDEX_BUFFER,
+    VKD3D_DEFERRED_OP_SET_VERTEX_BUFFERS,
+    VKD3D_DEFERRED_OP_SET_STREAM_OUTPUT_TARGETS,
+    VKD3D_DEFERRED_OP_SET_RENDER_TARGETS,
+    VKD3D_DEFERRED_OP_CLEAR_DEPTH_STENCIL_VIEW,
+    VKD3D_DEFERRED_OP_CLEAR_RENDER_TARGET_VIEW,
+    VKD3D_DEFERRED_OP_CLEAR_UAV,
+    VKD3D_DEFERRED_OP_BEGIN_QUERY,
+    VKD3D_DEFERRED_OP_END_QUERY,
+    VKD3D_DEFERRED_OP_RESOLVE_QUERY_DATA,
+    VKD3D_DEFERRED_OP_SET_PREDICATION,
+    VKD3D_DEFERRED_OP_SET_DEPTH_BOUNDS,
+    VKD3D_DEFERRED_OP_SET_MARKER,
+    VKD3D_DEFERRED_OP_BEGIN_EVENT,
+    VKD3D_DEFERRED_OP_END_EVENT,
+};
+
+/* Each command is followed by its arguments, and the size includes both. */
+struct vkd3d_deferred_command
 {
-    struct d3d12_command_list *list = impl_from_ID3D12GraphicsCommandList6(iface);
-    const struct vkd3d_vk_device_procs *vk_procs;
-    VkResult vr;
+    enum vkd3d_deferred_op op;
+    uint32_t size;
+};
+STATIC_ASSERT(sizeof(struct vkd3d_deferred_command) == sizeof(uint64_t));
 
-    TRACE("iface %p.\n", iface);
+/* Array elements follow, unless the array is NULL. */
+struct vkd3d_deferred_array
+{
+    UINT start;
+    UINT count;
+    UINT offset;
+    UINT has_elements;
+};
 
-    if (!list->is_recording)
-    {
-        WARN("Command list is not in the recording state.\n");
-        return E_FAIL;
-    }
+struct vkd3d_deferred_root_argument
+{
+    UINT index;
+    uint64_t value;
+};
 
-    vk_procs = &list->device->vk_procs;
+/* CPU descriptors are consumed when a command is recorded, so deferred
+ * commands store a copy of the descriptors they use. The RTV descriptors are
+ * followed by the DSV descriptor, if any. */
+struct vkd3d_deferred_render_targets
+{
+    UINT rt_count;
+    UINT has_dsv;
+};
 
-    d3d12_command_list_end_current_render_pass(list);
-    if (list->is_predicated)
-        VK_CALL(vkCmdEndConditionalRenderingEXT(list->vk_command_buffer));
+/* Clear rectangles follow. */
+struct vkd3d_deferred_clear_dsv
+{
+    struct d3d12_dsv_desc dsv_desc;
+    D3D12_CLEAR_FLAGS flags;
+    float depth;
+    UINT stencil;
+    UINT rect_count;
+};
 
-    if ((vr = VK_CALL(vkEndCommandBuffer(list->vk_command_buffer))) < 0)
-    {
-        WARN("Failed to end command buffer, vr %d.\n", vr);
-        return hresult_from_vk_result(vr);
-    }
+struct vkd3d_deferred_clear_rtv
+{
+    struct d3d12_rtv_desc rtv_desc;
+    float colour[4];
+    UINT rect_count;
+};
 
-    if (list->allocator)
-    {
+struct vkd3d_deferred_clear_uav
+{
+    struct d3d12_resource *resource;
+    struct vkd3d_view *view;
+    VkClearColorValue colour;
+    UINT is_float;
+    UINT rect_count;
+};
+
+struct vkd3d_deferred_query
+{
+    ID3D12QueryHeap *heap;
+    D3D12_QUERY_TYPE type;
+    UINT index;
+    UINT count;
+    ID3D12Resource *buffer;
+    UINT64 offset;
+};
+
+struct vkd3d_deferred_predication
+{
+    ID3D12Resource *buffer;
+    UINT64 offset;
+    D3D12_PREDICATION_OP operation;
+};
+
+static bool d3d12_command_list_is_deferring(const struct d3d12_command_list *list)
+{
+    return list->deferred.enabled && !list->deferred.replaying;
+}
+
+static void *d3d12_command_list_defer_command(struct d3d12_command_list *list,
+        enum vkd3d_deferred_op op, size_t args_size)
+{
+    struct d3d12_deferred_commands *deferred = &list->deferred;
+    struct vkd3d_deferred_command *command;
+    size_t size;
+
+    size = align(sizeof(*command) + args_size, sizeof(uint64_t));
+    if (size > UINT32_MAX || !vkd3d_array_reserve((void **)&deferred->data, &deferred->capacity,
+            deferred->size + size, sizeof(*deferred->data)))
+        return NULL;
+
+    command = (struct vkd3d_deferred_command *)&deferred->data[deferred->size];
+    command->op = op;
+    command->size = size;
+    deferred->size += size;
+    d3d12_device_add_statistic(list->device, deferred_command_count, 1);
+
+    return command + 1;
+}
+
+static void d3d12_command_list_replay_deferred(struct d3d12_command_list *list);
+
+/* Returns false if the call should be executed immediately instead. */
+static bool d3d12_command_list_defer(struct d3d12_command_list *list,
+        enum vkd3d_deferred_op op, const void *args, size_t args_size)
+{
+    void *dst;
+
+    if (!d3d12_command_list_is_deferring(list))
+        return false;
+
+    if (!(dst = d3d12_command_list_defer_command(list, op, args_size)))
+    {
+        ERR("Failed to record command, translating immediately.\n");
+        d3d12_command_list_replay_deferred(list);
+        return false;
+    }
+
+    memcpy(dst, args, args_size);
+    return true;
+}
+
+static bool d3d12_command_list_defer_array(struct d3d12_command_list *list, enum vkd3d_deferred_op op,
+        unsigned int start, unsigned int count, unsigned int offset, const void *elements, size_t element_size)
+{
+    struct vkd3d_deferred_array *array;
+    size_t size;
+
+    if (!d3d12_command_list_is_deferring(list))
+        return false;
+
+    size = elements ? count * element_size : 0;
+    if (!(array = d3d12_command_list_defer_command(list, op, sizeof(*array) + size)))
+    {
+        ERR("Failed to record command, translating immediately.\n");
+        d3d12_command_list_replay_deferred(list);
+        return false;
+    }
+
+    array->start = start;
+    array->count = count;
+    array->offset = offset;
+    array->has_elements = !!elements;
+    if (size)
+        memcpy(array + 1, elements, size);
+    return true;
+}
+
+static bool d3d12_command_list_defer_root_argument(struct d3d12_command_list *list,
+        enum vkd3d_deferred_op op, unsigned int index, uint64_t value)
+{
+    struct vkd3d_deferred_root_argument argument;
+
+    argument.index = index;
+    argument.value = value;
+    return d3d12_command_list_defer(list, op, &argument, sizeof(argument));
+}
+
+static bool d3d12_command_list_defer_with_rects(struct d3d12_command_list *list, enum vkd3d_deferred_op op,
+        const void *args, size_t args_size, unsigned int rect_count, const D3D12_RECT *rects)
+{
+    uint8_t *dst;
+
+    if (!d3d12_command_list_is_deferring(list))
+        return false;
+
+    if (!(dst = d3d12_command_list_defer_command(list, op, args_size + rect_count * sizeof(*rects))))
+    {
+        ERR("Failed to record command, translating immediately.\n");
+        d3d12_command_list_replay_deferred(list);
+        return false;
+    }
+
+    memcpy(dst, args, args_size);
+    if (rect_count)
+        memcpy(dst + args_size, rects, rect_count * sizeof(*rects));
+    return true;
+}
+
+static bool d3d12_command_list_defer_query(struct d3d12_command_list *list, enum vkd3d_deferred_op op,
+        ID3D12QueryHeap *heap, D3D12_QUERY_TYPE type, unsigned int index, unsigned int count,
+        ID3D12Resource *buffer, uint64_t offset)
+{
+    struct vkd3d_deferred_query query;
+
+    query.heap = heap;
+    query.type = type;
+    query.index = index;
+    query.count = count;
+    query.buffer = buffer;
+    query.offset = offset;
+    return d3d12_command_list_defer(list, op, &query, sizeof(query));
+}
+
+/* Views referenced by copied descriptors must stay alive until the command is
+ * translated, even if the descriptor is overwritten in the meantime. */
+static void d3d12_command_list_hold_view(struct d3d12_command_list *list, struct vkd3d_view *view)
+{
+    if (view && !d3d12_command_allocator_add_view(list->allocator, view))
+        WARN("Failed to add view.\n");
+}
+
+static bool d3d12_command_list_defer_render_targets(struct d3d12_command_list *list,
+        unsigned int rt_count, const D3D12_CPU_DESCRIPTOR_HANDLE *rt_handles, bool single_handle,
+        const D3D12_CPU_DESCRIPTOR_HANDLE *ds_handle)
+{
+    struct vkd3d_deferred_render_targets *targets;
+    const struct d3d12_rtv_desc *rtv_desc;
+    const struct d3d12_dsv_desc *dsv_desc;
+    struct d3d12_rtv_desc *rtv_descs;
+    struct d3d12_dsv_desc *dsv_copy;
+    unsigned int i;
+
+    if (!d3d12_command_list_is_deferring(list))
+        return false;
+
+    if (!(targets = d3d12_command_list_defer_command(list, VKD3D_DEFERRED_OP_SET_RENDER_TARGETS,
+            sizeof(*targets) + rt_count * sizeof(*rtv_descs) + (ds_handle ? sizeof(*dsv_copy) : 0))))
+    {
+        ERR("Failed to record command, translating immediately.\n");
+        d3d12_command_list_replay_deferred(list);
+        return false;
+    }
+
+    targets->rt_count = rt_count;
+    targets->has_dsv = !!ds_handle;
+
+    rtv_descs = (struct d3d12_rtv_desc *)(targets + 1);
+    for (i = 0; i < rt_count; ++i)
+    {
+        if (single_handle)
+        {
+            if ((rtv_desc = d3d12_rtv_desc_from_cpu_handle(*rt_handles)))
+                rtv_desc += i;
+        }
+        else
+        {
+            rtv_desc = d3d12_rtv_desc_from_cpu_handle(rt_handles[i]);
+        }
+
+        if (rtv_desc && rtv_desc->resource)
+        {
+            rtv_descs[i] = *rtv_desc;
+            d3d12_command_list_hold_view(list, rtv_desc->view);
+        }
+        else
+        {
+            memset(&rtv_descs[i], 0, sizeof(rtv_descs[i]));
+        }
+    }
+
+    if (ds_handle)
+    {
+        dsv_copy = (struct d3d12_dsv_desc *)&rtv_descs[rt_count];
+        if ((dsv_desc = d3d12_dsv_desc_from_cpu_handle(*ds_handle)) && dsv_desc->resource)
+        {
+            *dsv_copy = *dsv_desc;
+            d3d12_command_list_hold_view(list, dsv_desc->view);
+        }
+        else
+        {
+            memset(dsv_copy, 0, sizeof(*dsv_copy));
+        }
+    }
+
+    return true;
+}
+
+static void d3d12_command_list_clear_uav_view(struct d3d12_command_list *list,
+        struct d3d12_resource *resource, struct vkd3d_view *descriptor, VkClearColorValue colour,
+        bool is_float, unsigned int rect_count, const D3D12_RECT *rects);
+
+static void d3d12_command_list_replay_deferred(struct d3d12_command_list *list)
+{
+    ID3D12GraphicsCommandList6 *iface = &list->ID3D12GraphicsCommandList6_iface;
+    const struct vkd3d_deferred_render_targets *targets;
+    struct d3d12_deferred_commands *deferred = &list->deferred;
+    D3D12_CPU_DESCRIPTOR_HANDLE cpu_handle, ds_cpu_handle;
+    const struct vkd3d_deferred_root_argument *argument;
+    const struct vkd3d_deferred_predication *predication;
+    const struct vkd3d_deferred_command *command;
+    const struct vkd3d_deferred_clear_dsv *clear_dsv;
+    const struct vkd3d_deferred_clear_rtv *clear_rtv;
+    const struct vkd3d_deferred_clear_uav *clear_uav;
+    const struct vkd3d_deferred_array *array;
+    const struct vkd3d_deferred_query *query;
+    D3D12_GPU_DESCRIPTOR_HANDLE handle;
+    const float *f;
+    const void *elements;
+    const UINT *u;
+    size_t offset;
+
+    if (!deferred->size)
+        return;
+
+    TRACE("list %p, size %zu.\n", list, deferred->size);
+
+    deferred->replaying = true;
+
+    for (offset = 0; offset < deferred->size; offset += command->size)
+    {
+        command = (const struct vkd3d_deferred_command *)&deferred->data[offset];
+        argument = (const void *)(command + 1);
+        array = (const void *)(command + 1);
+        elements = array->has_elements ? array + 1 : NULL;
+        u = (const void *)(command + 1);
+        f = (const void *)(command + 1);
+
+        switch (command->op)
+        {
+            case VKD3D_DEFERRED_OP_DRAW:
+                ID3D12GraphicsCommandList6_DrawInstanced(iface, u[0], u[1], u[2], u[3]);
+                break;
+            case VKD3D_DEFERRED_OP_DRAW_INDEXED:
+                ID3D12GraphicsCommandList6_DrawIndexedInstanced(iface, u[0], u[1], u[2], (INT)u[3], u[4]);
+                break;
+            case VKD3D_DEFERRED_OP_DISPATCH:
+                ID3D12GraphicsCommandList6_Dispatch(iface, u[0], u[1], u[2]);
+                break;
+            case VKD3D_DEFERRED_OP_SET_PRIMITIVE_TOPOLOGY:
+                ID3D12GraphicsCommandList6_IASetPrimitiveTopology(iface, u[0]);
+                break;
+            case VKD3D_DEFERRED_OP_SET_VIEWPORTS:
+                ID3D12GraphicsCommandList6_RSSetViewports(iface, array->count, elements);
+                break;
+            case VKD3D_DEFERRED_OP_SET_SCISSOR_RECTS:
+                ID3D12GraphicsCommandList6_RSSetScissorRects(iface, array->count, elements);
+                break;
+            case VKD3D_DEFERRED_OP_SET_BLEND_FACTOR:
+                ID3D12GraphicsCommandList6_OMSetBlendFactor(iface, (const FLOAT *)(command + 1));
+                break;
+            case VKD3D_DEFERRED_OP_SET_STENCIL_REF:
+                ID3D12GraphicsCommandList6_OMSetStencilRef(iface, u[0]);
+                break;
+            case VKD3D_DEFERRED_OP_SET_PIPELINE_STATE:
+                ID3D12GraphicsCommandList6_SetPipelineState(iface, *(ID3D12PipelineState * const *)(command + 1));
+                break;
+            case VKD3D_DEFERRED_OP_RESOURCE_BARRIER:
+                ID3D12GraphicsCommandList6_ResourceBarrier(iface, array->count, elements);
+                break;
+            case VKD3D_DEFERRED_OP_SET_COMPUTE_ROOT_SIGNATURE:
+                ID3D12GraphicsCommandList6_SetComputeRootSignature(iface,
+                        *(ID3D12RootSignature * const *)(command + 1));
+                break;
+            case VKD3D_DEFERRED_OP_SET_GRAPHICS_ROOT_SIGNATURE:
+                ID3D12GraphicsCommandList6_SetGraphicsRootSignature(iface,
+                        *(ID3D12RootSignature * const *)(command + 1));
+                break;
+            case VKD3D_DEFERRED_OP_SET_COMPUTE_ROOT_DESCRIPTOR_TABLE:
+                handle.ptr = argument->value;
+                ID3D12GraphicsCommandList6_SetComputeRootDescriptorTable(iface, argument->index, handle);
+                break;
+            case VKD3D_DEFERRED_OP_SET_GRAPHICS_ROOT_DESCRIPTOR_TABLE:
+                handle.ptr = argument->value;
+                ID3D12GraphicsCommandList6_SetGraphicsRootDescriptorTable(iface, argument->index, handle);
+                break;
+            case VKD3D_DEFERRED_OP_SET_COMPUTE_ROOT_CONSTANTS:
+                ID3D12GraphicsCommandList6_SetComputeRoot32BitConstants(iface,
+                        array->start, array->count, elements, array->offset);
+                break;
+            case VKD3D_DEFERRED_OP_SET_GRAPHICS_ROOT_CONSTANTS:
+                ID3D12GraphicsCommandList6_SetGraphicsRoot32BitConstants(iface,
+                        array->start, array->count, elements, array->offset);
+                break;
+            case VKD3D_DEFERRED_OP_SET_COMPUTE_ROOT_CBV:
+                ID3D12GraphicsCommandList6_SetComputeRootConstantBufferView(iface, argument->index, argument->value);
+                break;
+            case VKD3D_DEFERRED_OP_SET_GRAPHICS_ROOT_CBV:
+                ID3D12GraphicsCommandList6_SetGraphicsRootConstantBufferView(iface, argument->index, argument->value);
+                break;
+            case VKD3D_DEFERRED_OP_SET_COMPUTE_ROOT_SRV:
+                ID3D12GraphicsCommandList6_SetComputeRootShaderResourceView(iface, argument->index, argument->value);
+                break;
+            case VKD3D_DEFERRED_OP_SET_GRAPHICS_ROOT_SRV:
+                ID3D12GraphicsCommandList6_SetGraphicsRootShaderResourceView(iface, argument->index, argument->value);
+                break;
+            case VKD3D_DEFERRED_OP_SET_COMPUTE_ROOT_UAV:
+                ID3D12GraphicsCommandList6_SetComputeRootUnorderedAccessView(iface, argument->index, argument->value);
+                break;
+            case VKD3D_DEFERRED_OP_SET_GRAPHICS_ROOT_UAV:
+                ID3D12GraphicsCommandList6_SetGraphicsRootUnorderedAccessView(iface, argument->index, argument->value);
+                break;
+            case VKD3D_DEFERRED_OP_SET_INDEX_BUFFER:
+                ID3D12GraphicsCommandList6_IASetIndexBuffer(iface, (const D3D12_INDEX_BUFFER_VIEW *)(command + 1));
+                break;
+            case VKD3D_DEFERRED_OP_SET_VERTEX_BUFFERS:
+                ID3D12GraphicsCommandList6_IASetVertexBuffers(iface, array->start, array->count, elements);
+                break;
+            case VKD3D_DEFERRED_OP_SET_STREAM_OUTPUT_TARGETS:
+                ID3D12GraphicsCommandList6_SOSetTargets(iface, array->start, array->count, elements);
+                break;
+            case VKD3D_DEFERRED_OP_SET_RENDER_TARGETS:
+                targets = (const void *)(command + 1);
+                cpu_handle.ptr = (SIZE_T)(targets + 1);
+                ds_cpu_handle.ptr = (SIZE_T)((const struct d3d12_rtv_desc *)(targets + 1) + targets->rt_count);
+                ID3D12GraphicsCommandList6_OMSetRenderTargets(iface, targets->rt_count,
+                        &cpu_handle, TRUE, targets->has_dsv ? &ds_cpu_handle : NULL);
+                break;
+            case VKD3D_DEFERRED_OP_CLEAR_DEPTH_STENCIL_VIEW:
+                clear_dsv = (const void *)(command + 1);
+                cpu_handle.ptr = (SIZE_T)&clear_dsv->dsv_desc;
+                ID3D12GraphicsCommandList6_ClearDepthStencilView(iface, cpu_handle, clear_dsv->flags,
+                        clear_dsv->depth, clear_dsv->stencil, clear_dsv->rect_count,
+                        (const D3D12_RECT *)(clear_dsv + 1));
+                break;
+            case VKD3D_DEFERRED_OP_CLEAR_RENDER_TARGET_VIEW:
+                clear_rtv = (const void *)(command + 1);
+                cpu_handle.ptr = (SIZE_T)&clear_rtv->rtv_desc;
+                ID3D12GraphicsCommandList6_ClearRenderTargetView(iface, cpu_handle, clear_rtv->colour,
+                        clear_rtv->rect_count, (const D3D12_RECT *)(clear_rtv + 1));
+                break;
+            case VKD3D_DEFERRED_OP_CLEAR_UAV:
+                clear_uav = (const void *)(command + 1);
+                d3d12_command_list_clear_uav_view(list, clear_uav->resource, clear_uav->view, clear_uav->colour,
+                        clear_uav->is_float, clear_uav->rect_count, (const D3D12_RECT *)(clear_uav + 1));
+                break;
+            case VKD3D_DEFERRED_OP_BEGIN_QUERY:
+                query = (const void *)(command + 1);
+                ID3D12GraphicsCommandList6_BeginQuery(iface, query->heap, query->type, query->index);
+                break;
+            case VKD3D_DEFERRED_OP_END_QUERY:
+                query = (const void *)(command + 1);
+                ID3D12GraphicsCommandList6_EndQuery(iface, query->heap, query->type, query->index);
+                break;
+            case VKD3D_DEFERRED_OP_RESOLVE_QUERY_DATA:
+                query = (const void *)(command + 1);
+                ID3D12GraphicsCommandList6_ResolveQueryData(iface, query->heap, query->type,
+                        query->index, query->count, query->buffer, query->offset);
+                break;
+            case VKD3D_DEFERRED_OP_SET_PREDICATION:
+                predication = (const void *)(command + 1);
+                ID3D12GraphicsCommandList6_SetPredication(iface, predication->buffer,
+                        predication->offset, predication->operation);
+                break;
+            case VKD3D_DEFERRED_OP_SET_DEPTH_BOUNDS:
+                ID3D12GraphicsCommandList6_OMSetDepthBounds(iface, f[0], f[1]);
+                break;
+            case VKD3D_DEFERRED_OP_SET_MARKER:
+                ID3D12GraphicsCommandList6_SetMarker(iface, array->start, elements, array->count);
+                break;
+            case VKD3D_DEFERRED_OP_BEGIN_EVENT:
+                ID3D12GraphicsCommandList6_BeginEvent(iface, array->start, elements, array->count);
+                break;
+            case VKD3D_DEFERRED_OP_END_EVENT:
+                ID3D12GraphicsCommandList6_EndEvent(iface);
+                break;
+            default:
+                ERR("Unhandled deferred op %#x.\n", command->op);
+                break;
+        }
+    }
+
+    deferred->size = 0;
+    deferred->replaying = false;
+}
+
+/* Translates pending commands before a call which is always executed immediately. */
+static void d3d12_command_list_flush_deferred(struct d3d12_command_list *list)
+{
+    if (!d3d12_command_list_is_deferring(list) || !list->deferred.size)
+        return;
+
+    d3d12_device_add_statistic(list->device, deferred_flush_count, 1);
+    d3d12_command_list_replay_deferred(list);
+}
+
+static void d3d12_command_list_reset_deferred(struct d3d12_command_list *list)
+{
+    struct d3d12_deferred_commands *deferred = &list->deferred;
+
+    deferred->size = 0;
+    deferred->pipeline_state = NULL;
+    memset(deferred->root_signatures, 0, sizeof(deferred->root_signatures));
+    deferred->primitive_topology = D3D_PRIMITIVE_TOPOLOGY_POINTLIST;
+}
+
+static HRESULT d3d12_command_list_end_command_buffer(struct d3d12_command_list *list)
+{
+    const struct vkd3d_vk_device_procs *vk_procs = &list->device->vk_procs;
+    VkResult vr;
+
+    d3d12_command_list_end_current_render_pass(list);
+    if (list->is_predicated)
+        VK_CALL(vkCmdEndConditionalRenderingEXT(list->vk_command_buffer));
+
+    if ((vr = VK_CALL(vkEndCommandBuffer(list->vk_command_buffer))) < 0)
+    {
+        WARN("Failed to end command buffer, vr %d.\n", vr);
+        return hresult_from_vk_result(vr);
+    }
+
+    list->has_depth_bounds = false;
+
+    return S_OK;
+}
+
+void d3d12_command_list_translate(struct d3d12_command_list *list)
+{
+    HRESULT hr;
+
+    TRACE("list %p.\n", list);
+
+    d3d12_command_list_replay_deferred(list);
+
+    if (FAILED(hr = d3d12_command_list_end_command_buffer(list)))
+        d3d12_command_list_mark_as_invalid(list, "Failed to end command buffer, hr %s.", debugstr_hresult(hr));
+    else if (!list->is_valid)
+        WARN("Error occurred during command list translation.\n");
+}
+
+static HRESULT STDMETHODCALLTYPE d3d12_command_list_Close(ID3D12GraphicsCommandList6 *iface)
+{
+    struct d3d12_command_list *list = impl_from_ID3D12GraphicsCommandList6(iface);
+    HRESULT hr;
+
+    TRACE("iface %p.\n", iface);
+
+    if (!list->is_recording)
+    {
+        WARN("Command list is not in the recording state.\n");
+        return E_FAIL;
+    }
+
+    if (list->deferred.enabled)
+    {
+        hr = list->is_valid ? S_OK : E_INVALIDARG;
+        list->is_recording = false;
+        d3d12_device_queue_command_list_translation(list->device, list);
+        return hr;
+    }
+
+    if (FAILED(hr = d3d12_command_list_end_command_buffer(list)))
+        return hr;
+
+    if (list->allocator)
+    {
         d3d12_command_allocator_remove_command_list(list->allocator, list);
         list->allocator = NULL;
     }
 
     list->is_recording = false;
-    list->has_depth_bounds = false;
 
     if (!list->is_valid)
     {
@@ -2677,10 +3462,16 @@ static void d3d12_command_list_reset_state(struct d3d12_command_list *list,
 
     list->state = NULL;
 
+    list->dynamic_state.valid_flags = 0;
+    list->dynamic_state.vertex_buffer_mask = 0;
+
     memset(list->so_counter_buffers, 0, sizeof(list->so_counter_buffers));
     memset(list->so_counter_buffer_offsets, 0, sizeof(list->so_counter_buffer_offsets));
 
     list->descriptor_heap_count = 0;
+    memset(list->descriptor_buffer_heaps, 0, sizeof(list->descriptor_buffer_heaps));
+
+    d3d12_command_list_reset_deferred(list);
 
     ID3D12GraphicsCommandList6_SetPipelineState(iface, initial_pipeline_state);
 }
@@ -2707,6 +3498,8 @@ static HRESULT STDMETHODCALLTYPE d3d12_command_list_Reset(ID3D12GraphicsCommandL
         return E_FAIL;
     }
 
+    d3d12_command_list_wait_translation(list);
+
     if (SUCCEEDED(hr = d3d12_command_allocator_allocate_command_buffer(allocator_impl, list)))
     {
         list->allocator = allocator_impl;
@@ -2810,6 +3603,7 @@ static bool d3d12_command_list_update_current_framebuffer(struct d3d12_command_l
         WARN("Failed to create Vulkan framebuffer, vr %d.\n", vr);
         return false;
     }
+    d3d12_device_add_statistic(device, vk_framebuffer_count, 1);
 
     if (!d3d12_command_allocator_add_framebuffer(list->allocator, vk_framebuffer))
     {
@@ -2827,8 +3621,6 @@ static bool d3d12_command_list_update_compute_pipeline(struct d3d12_command_list
 {
     const struct vkd3d_vk_device_procs *vk_procs = &list->device->vk_procs;
 
-    vkd3d_cond_signal(&list->device->worker_cond);
-
     if (list->current_pipeline != VK_NULL_HANDLE)
         return true;
 
@@ -2850,8 +3642,6 @@ static bool d3d12_command_list_update_graphics_pipeline(struct d3d12_command_lis
     VkRenderPass vk_render_pass;
     VkPipeline vk_pipeline;
 
-    vkd3d_cond_signal(&list->device->worker_cond);
-
     if (list->current_pipeline != VK_NULL_HANDLE)
         return true;
 
@@ -3379,7 +4169,8 @@ static void command_list_flush_vk_heap_updates(struct d3d12_command_list *list)
 
 static void command_list_add_descriptor_heap(struct d3d12_command_list *list, struct d3d12_descriptor_heap *heap)
 {
-    if (!list->device->use_vk_heaps)
+    /* Descriptor buffers have no pending updates. */
+    if (!list->device->use_vk_heaps || list->device->use_descriptor_buffers)
         return;
 
     if (!contains_heap(list->descriptor_heaps, list->descriptor_heap_count, heap))
@@ -3397,45 +4188,145 @@ static void command_list_add_descriptor_heap(struct d3d12_command_list *list, st
     }
 }
 
-static void d3d12_command_list_bind_descriptor_heap(struct d3d12_command_list *list,
-        enum vkd3d_pipeline_bind_point bind_point, struct d3d12_descriptor_heap *heap)
+static void d3d12_command_list_set_descriptor_buffer_offsets(struct d3d12_command_list *list,
+        enum vkd3d_pipeline_bind_point bind_point, unsigned int type)
 {
     struct vkd3d_pipeline_bindings *bindings = &list->pipeline_bindings[bind_point];
+    struct d3d12_descriptor_heap *heap = list->descriptor_buffer_heaps[type];
     const struct vkd3d_vk_device_procs *vk_procs = &list->device->vk_procs;
     const struct d3d12_root_signature *rs = bindings->root_signature;
-    enum vkd3d_vk_descriptor_set_index set;
-
-    if (!heap)
-        return;
-
-    if (heap->desc.Type == D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV)
-    {
-        if (heap->serial_id == bindings->cbv_srv_uav_heap_id)
-            return;
-        bindings->cbv_srv_uav_heap_id = heap->serial_id;
-    }
+    enum vkd3d_vk_descriptor_set_index first_set, set;
+    uint32_t buffer_indices[VKD3D_SET_INDEX_COUNT];
+    VkDeviceSize offsets[VKD3D_SET_INDEX_COUNT];
+    unsigned int count = 0;
+
+    /* Samplers use only the sampler set. The CBV/SRV/UAV heap backs the
+     * following UAV counter and mutable sets. */
+    if (type == D3D12_DESCRIPTOR_HEAP_TYPE_SAMPLER)
+        first_set = VKD3D_SET_INDEX_SAMPLER;
     else
+        first_set = VKD3D_SET_INDEX_UAV_COUNTER;
+
+    for (set = first_set; set < ARRAY_SIZE(heap->descriptor_buffer_set_offsets); ++set)
     {
-        if (heap->serial_id == bindings->sampler_heap_id)
-            return;
-        bindings->sampler_heap_id = heap->serial_id;
+        if (list->device->vk_descriptor_heap_layouts[set].applicable_heap_type != type)
+            break;
+        buffer_indices[count] = list->descriptor_buffer_indices[type];
+        offsets[count++] = heap->descriptor_buffer_set_offsets[set];
+        if (set == VKD3D_SET_INDEX_MUTABLE)
+            break;
     }
 
-    vkd3d_mutex_lock(&heap->vk_sets_mutex);
+    VK_CALL(vkCmdSetDescriptorBufferOffsetsEXT(list->vk_command_buffer, bindings->vk_bind_point,
+            rs->vk_pipeline_layout, rs->vk_set_count + first_set, count, buffer_indices, offsets));
+}
 
-    for (set = 0; set < ARRAY_SIZE(heap->vk_descriptor_sets); ++set)
-    {
-        VkDescriptorSet vk_descriptor_set = heap->vk_descriptor_sets[set].vk_set;
+static void d3d12_command_list_bind_descriptor_buffers(struct d3d12_command_list *list)
+{
+    VkDescriptorBufferBindingInfoEXT binding_infos[ARRAY_SIZE(list->descriptor_buffer_heaps)];
+    const struct vkd3d_vk_device_procs *vk_procs = &list->device->vk_procs;
+    struct vkd3d_pipeline_bindings *bindings;
+    struct d3d12_descriptor_heap *heap;
+    unsigned int i, count, type;
+    uint64_t *heap_ids[2];
 
-        /* Null vk_set_layout means set 0 uses mutable descriptors, and this set is unused. */
-        if (!vk_descriptor_set || !list->device->vk_descriptor_heap_layouts[set].vk_set_layout)
+    for (i = 0, count = 0; i < ARRAY_SIZE(list->descriptor_buffer_heaps); ++i)
+    {
+        if (!(heap = list->descriptor_buffer_heaps[i]))
             continue;
 
-        VK_CALL(vkCmdBindDescriptorSets(list->vk_command_buffer, bindings->vk_bind_point, rs->vk_pipeline_layout,
-                rs->vk_set_count + set, 1, &vk_descriptor_set, 0, NULL));
+        binding_infos[count].sType = VK_STRUCTURE_TYPE_DESCRIPTOR_BUFFER_BINDING_INFO_EXT;
+        binding_infos[count].pNext = NULL;
+        binding_infos[count].address = heap->descriptor_buffer_address;
+        binding_infos[count].usage = heap->vk_descriptor_buffer_usage;
+        list->descriptor_buffer_indices[i] = count++;
     }
 
-    vkd3d_mutex_unlock(&heap->vk_sets_mutex);
+    VK_CALL(vkCmdBindDescriptorBuffersEXT(list->vk_command_buffer, count, binding_infos));
+
+    /* Binding descriptor buffers invalidates all offsets, including those of
+     * heaps which are still bound, and of the other bind point. Set them
+     * again, or mark them unset if their heap is no longer bound. */
+    for (i = 0; i < ARRAY_SIZE(list->pipeline_bindings); ++i)
+    {
+        bindings = &list->pipeline_bindings[i];
+        heap_ids[D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV] = &bindings->cbv_srv_uav_heap_id;
+        heap_ids[D3D12_DESCRIPTOR_HEAP_TYPE_SAMPLER] = &bindings->sampler_heap_id;
+
+        for (type = 0; type < ARRAY_SIZE(heap_ids); ++type)
+        {
+            if (!*heap_ids[type])
+                continue;
+            heap = list->descriptor_buffer_heaps[type];
+            if (bindings->root_signature && heap && heap->serial_id == *heap_ids[type])
+                d3d12_command_list_set_descriptor_buffer_offsets(list, i, type);
+            else
+                *heap_ids[type] = 0;
+        }
+    }
+}
+
+/* The heap's id must already be recorded in the pipeline bindings. */
+static void d3d12_command_list_use_descriptor_buffer(struct d3d12_command_list *list,
+        enum vkd3d_pipeline_bind_point bind_point, struct d3d12_descriptor_heap *heap)
+{
+    unsigned int type = heap->desc.Type;
+
+    if (list->descriptor_buffer_heaps[type] == heap)
+    {
+        d3d12_command_list_set_descriptor_buffer_offsets(list, bind_point, type);
+        return;
+    }
+
+    list->descriptor_buffer_heaps[type] = heap;
+    d3d12_command_list_bind_descriptor_buffers(list);
+}
+
+static void d3d12_command_list_bind_descriptor_heap(struct d3d12_command_list *list,
+        enum vkd3d_pipeline_bind_point bind_point, struct d3d12_descriptor_heap *heap)
+{
+    struct vkd3d_pipeline_bindings *bindings = &list->pipeline_bindings[bind_point];
+    const struct vkd3d_vk_device_procs *vk_procs = &list->device->vk_procs;
+    const struct d3d12_root_signature *rs = bindings->root_signature;
+    enum vkd3d_vk_descriptor_set_index set;
+
+    if (!heap)
+        return;
+
+    if (heap->desc.Type == D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV)
+    {
+        if (heap->serial_id == bindings->cbv_srv_uav_heap_id)
+            return;
+        bindings->cbv_srv_uav_heap_id = heap->serial_id;
+    }
+    else
+    {
+        if (heap->serial_id == bindings->sampler_heap_id)
+            return;
+        bindings->sampler_heap_id = heap->serial_id;
+    }
+
+    if (heap->use_descriptor_buffer)
+    {
+        d3d12_command_list_use_descriptor_buffer(list, bind_point, heap);
+        return;
+    }
+
+    vkd3d_mutex_lock(&heap->vk_sets_mutex);
+
+    for (set = 0; set < ARRAY_SIZE(heap->vk_descriptor_sets); ++set)
+    {
+        VkDescriptorSet vk_descriptor_set = heap->vk_descriptor_sets[set].vk_set;
+
+        /* Null vk_set_layout means set 0 uses mutable descriptors, and this set is unused. */
+        if (!vk_descriptor_set || !list->device->vk_descriptor_heap_layouts[set].vk_set_layout)
+            continue;
+
+        VK_CALL(vkCmdBindDescriptorSets(list->vk_command_buffer, bindings->vk_bind_point, rs->vk_pipeline_layout,
+                rs->vk_set_count + set, 1, &vk_descriptor_set, 0, NULL));
+    }
+
+    vkd3d_mutex_unlock(&heap->vk_sets_mutex);
 }
 
 static void d3d12_command_list_update_heap_descriptors(struct d3d12_command_list *list,
@@ -3449,8 +4340,19 @@ static void d3d12_command_list_update_heap_descriptors(struct d3d12_command_list
     if (!rs)
         return;
 
-    if (bindings->descriptor_table_dirty_mask || bindings->push_descriptor_dirty_mask)
+    /* With descriptor buffers, the only root signature set which is not pushed
+     * holds embedded static samplers. */
+    if (list->device->use_descriptor_buffers)
+    {
+        if (bindings->static_samplers_dirty && rs->static_sampler_set != UINT_MAX)
+            VK_CALL(vkCmdBindDescriptorBufferEmbeddedSamplersEXT(list->vk_command_buffer,
+                    bindings->vk_bind_point, rs->vk_pipeline_layout, rs->static_sampler_set));
+        bindings->static_samplers_dirty = false;
+    }
+    else if (bindings->descriptor_table_dirty_mask || bindings->push_descriptor_dirty_mask)
+    {
         d3d12_command_list_prepare_descriptors(list, bind_point);
+    }
     if (bindings->descriptor_table_dirty_mask)
         d3d12_command_list_update_descriptor_tables(list, bindings, &cbv_srv_uav_heap, &sampler_heap);
     bindings->descriptor_table_dirty_mask = 0;
@@ -3581,6 +4483,15 @@ static void STDMETHODCALLTYPE d3d12_command_list_DrawInstanced(ID3D12GraphicsCom
             iface, vertex_count_per_instance, instance_count,
             start_vertex_location, start_instance_location);
 
+    if (d3d12_command_list_is_deferring(list))
+    {
+        const UINT args[] = {vertex_count_per_instance, instance_count,
+                start_vertex_location, start_instance_location};
+
+        if (d3d12_command_list_defer(list, VKD3D_DEFERRED_OP_DRAW, args, sizeof(args)))
+            return;
+    }
+
     vk_procs = &list->device->vk_procs;
 
     if (!d3d12_command_list_begin_render_pass(list))
@@ -3605,6 +4516,15 @@ static void STDMETHODCALLTYPE d3d12_command_list_DrawIndexedInstanced(ID3D12Grap
             iface, index_count_per_instance, instance_count, start_vertex_location,
             base_vertex_location, start_instance_location);
 
+    if (d3d12_command_list_is_deferring(list))
+    {
+        const UINT args[] = {index_count_per_instance, instance_count,
+                start_vertex_location, base_vertex_location, start_instance_location};
+
+        if (d3d12_command_list_defer(list, VKD3D_DEFERRED_OP_DRAW_INDEXED, args, sizeof(args)))
+            return;
+    }
+
     if (!d3d12_command_list_begin_render_pass(list))
     {
         WARN("Failed to begin render pass, ignoring draw call.\n");
@@ -3627,6 +4547,14 @@ static void STDMETHODCALLTYPE d3d12_command_list_Dispatch(ID3D12GraphicsCommandL
 
     TRACE("iface %p, x %u, y %u, z %u.\n", iface, x, y, z);
 
+    if (d3d12_command_list_is_deferring(list))
+    {
+        const UINT args[] = {x, y, z};
+
+        if (d3d12_command_list_defer(list, VKD3D_DEFERRED_OP_DISPATCH, args, sizeof(args)))
+            return;
+    }
+
     if (!d3d12_command_list_update_compute_state(list))
     {
         WARN("Failed to update compute state, ignoring dispatch.\n");
@@ -3650,6 +4578,8 @@ static void STDMETHODCALLTYPE d3d12_command_list_CopyBufferRegion(ID3D12Graphics
             "src_offset %#"PRIx64", byte_count %#"PRIx64".\n",
             iface, dst, dst_offset, src, src_offset, byte_count);
 
+    d3d12_command_list_flush_deferred(list);
+
     vk_procs = &list->device->vk_procs;
 
     dst_resource = unsafe_impl_from_ID3D12Resource(dst);
@@ -3937,6 +4867,8 @@ static void STDMETHODCALLTYPE d3d12_command_list_CopyTextureRegion(ID3D12Graphic
     TRACE("iface %p, dst %p, dst_x %u, dst_y %u, dst_z %u, src %p, src_box %p.\n",
             iface, dst, dst_x, dst_y, dst_z, src, src_box);
 
+    d3d12_command_list_flush_deferred(list);
+
     if (src_box && !validate_d3d12_box(src_box))
     {
         WARN("Empty box %s.\n", debug_d3d12_box(src_box));
@@ -4062,6 +4994,8 @@ static void STDMETHODCALLTYPE d3d12_command_list_CopyResource(ID3D12GraphicsComm
 
     TRACE("iface %p, dst_resource %p, src_resource %p.\n", iface, dst, src);
 
+    d3d12_command_list_flush_deferred(list);
+
     vk_procs = &list->device->vk_procs;
 
     dst_resource = unsafe_impl_from_ID3D12Resource(dst);
@@ -4143,6 +5077,8 @@ static void STDMETHODCALLTYPE d3d12_command_list_ResolveSubresource(ID3D12Graphi
     TRACE("iface %p, dst_resource %p, dst_sub_resource_idx %u, src_resource %p, src_sub_resource_idx %u, "
             "format %#x.\n", iface, dst, dst_sub_resource_idx, src, src_sub_resource_idx, format);
 
+    d3d12_command_list_flush_deferred(list);
+
     device = list->device;
     vk_procs = &device->vk_procs;
 
@@ -4203,6 +5139,15 @@ static void STDMETHODCALLTYPE d3d12_command_list_IASetPrimitiveTopology(ID3D12Gr
 
     TRACE("iface %p, topology %#x.\n", iface, topology);
 
+    if (d3d12_command_list_is_deferring(list))
+    {
+        if (list->deferred.primitive_topology == topology)
+            return;
+        list->deferred.primitive_topology = topology;
+        if (d3d12_command_list_defer(list, VKD3D_DEFERRED_OP_SET_PRIMITIVE_TOPOLOGY, &topology, sizeof(topology)))
+            return;
+    }
+
     if (list->primitive_topology == topology)
         return;
 
@@ -4215,6 +5160,7 @@ static void STDMETHODCALLTYPE d3d12_command_list_RSSetViewports(ID3D12GraphicsCo
 {
     VkViewport vk_viewports[D3D12_VIEWPORT_AND_SCISSORRECT_OBJECT_COUNT_PER_PIPELINE];
     struct d3d12_command_list *list = impl_from_ID3D12GraphicsCommandList6(iface);
+    struct vkd3d_dynamic_state *dynamic_state = &list->dynamic_state;
     const struct vkd3d_vk_device_procs *vk_procs;
     unsigned int i;
 
@@ -4223,6 +5169,10 @@ static void STDMETHODCALLTYPE d3d12_command_list_RSSetViewports(ID3D12GraphicsCo
     if (viewport_count > ARRAY_SIZE(vk_viewports))
         FIXME("Viewport count %u > D3D12_VIEWPORT_AND_SCISSORRECT_OBJECT_COUNT_PER_PIPELINE.\n", viewport_count);
 
+    if (d3d12_command_list_defer_array(list, VKD3D_DEFERRED_OP_SET_VIEWPORTS, 0,
+            min(viewport_count, ARRAY_SIZE(vk_viewports)), 0, viewports, sizeof(*viewports)))
+        return;
+
     for (i = 0; i < ARRAY_SIZE(vk_viewports); ++i)
     {
         if (i >= viewport_count)
@@ -4252,6 +5202,12 @@ static void STDMETHODCALLTYPE d3d12_command_list_RSSetViewports(ID3D12GraphicsCo
         }
     }
 
+    if ((dynamic_state->valid_flags & VKD3D_DYNAMIC_STATE_VIEWPORTS)
+            && !memcmp(dynamic_state->viewports, vk_viewports, sizeof(vk_viewports)))
+        return;
+    memcpy(dynamic_state->viewports, vk_viewports, sizeof(vk_viewports));
+    dynamic_state->valid_flags |= VKD3D_DYNAMIC_STATE_VIEWPORTS;
+
     vk_procs = &list->device->vk_procs;
     VK_CALL(vkCmdSetViewport(list->vk_command_buffer, 0, ARRAY_SIZE(vk_viewports), vk_viewports));
 }
@@ -4261,6 +5217,7 @@ static void STDMETHODCALLTYPE d3d12_command_list_RSSetScissorRects(ID3D12Graphic
 {
     struct d3d12_command_list *list = impl_from_ID3D12GraphicsCommandList6(iface);
     VkRect2D vk_rects[D3D12_VIEWPORT_AND_SCISSORRECT_OBJECT_COUNT_PER_PIPELINE];
+    struct vkd3d_dynamic_state *dynamic_state = &list->dynamic_state;
     const struct vkd3d_vk_device_procs *vk_procs;
     unsigned int i;
 
@@ -4272,6 +5229,10 @@ static void STDMETHODCALLTYPE d3d12_command_list_RSSetScissorRects(ID3D12Graphic
         rect_count = ARRAY_SIZE(vk_rects);
     }
 
+    if (d3d12_command_list_defer_array(list, VKD3D_DEFERRED_OP_SET_SCISSOR_RECTS, 0, rect_count, 0,
+            rects, sizeof(*rects)))
+        return;
+
     memset(vk_rects, 0, sizeof(vk_rects));
     for (i = 0; i < rect_count; ++i)
     {
@@ -4281,6 +5242,12 @@ static void STDMETHODCALLTYPE d3d12_command_list_RSSetScissorRects(ID3D12Graphic
         vk_rects[i].extent.height = rects[i].bottom - rects[i].top;
     }
 
+    if ((dynamic_state->valid_flags & VKD3D_DYNAMIC_STATE_SCISSORS)
+            && !memcmp(dynamic_state->scissors, vk_rects, sizeof(vk_rects)))
+        return;
+    memcpy(dynamic_state->scissors, vk_rects, sizeof(vk_rects));
+    dynamic_state->valid_flags |= VKD3D_DYNAMIC_STATE_SCISSORS;
+
     vk_procs = &list->device->vk_procs;
     VK_CALL(vkCmdSetScissor(list->vk_command_buffer, 0, ARRAY_SIZE(vk_rects), vk_rects));
 }
@@ -4289,10 +5256,20 @@ static void STDMETHODCALLTYPE d3d12_command_list_OMSetBlendFactor(ID3D12Graphics
         const FLOAT blend_factor[4])
 {
     struct d3d12_command_list *list = impl_from_ID3D12GraphicsCommandList6(iface);
+    struct vkd3d_dynamic_state *dynamic_state = &list->dynamic_state;
     const struct vkd3d_vk_device_procs *vk_procs;
 
     TRACE("iface %p, blend_factor %p.\n", iface, blend_factor);
 
+    if (d3d12_command_list_defer(list, VKD3D_DEFERRED_OP_SET_BLEND_FACTOR, blend_factor, 4 * sizeof(*blend_factor)))
+        return;
+
+    if ((dynamic_state->valid_flags & VKD3D_DYNAMIC_STATE_BLEND_FACTOR)
+            && !memcmp(dynamic_state->blend_factor, blend_factor, sizeof(dynamic_state->blend_factor)))
+        return;
+    memcpy(dynamic_state->blend_factor, blend_factor, sizeof(dynamic_state->blend_factor));
+    dynamic_state->valid_flags |= VKD3D_DYNAMIC_STATE_BLEND_FACTOR;
+
     vk_procs = &list->device->vk_procs;
     VK_CALL(vkCmdSetBlendConstants(list->vk_command_buffer, blend_factor));
 }
@@ -4301,10 +5278,19 @@ static void STDMETHODCALLTYPE d3d12_command_list_OMSetStencilRef(ID3D12GraphicsC
         UINT stencil_ref)
 {
     struct d3d12_command_list *list = impl_from_ID3D12GraphicsCommandList6(iface);
+    struct vkd3d_dynamic_state *dynamic_state = &list->dynamic_state;
     const struct vkd3d_vk_device_procs *vk_procs;
 
     TRACE("iface %p, stencil_ref %u.\n", iface, stencil_ref);
 
+    if (d3d12_command_list_defer(list, VKD3D_DEFERRED_OP_SET_STENCIL_REF, &stencil_ref, sizeof(stencil_ref)))
+        return;
+
+    if ((dynamic_state->valid_flags & VKD3D_DYNAMIC_STATE_STENCIL_REF) && dynamic_state->stencil_ref == stencil_ref)
+        return;
+    dynamic_state->stencil_ref = stencil_ref;
+    dynamic_state->valid_flags |= VKD3D_DYNAMIC_STATE_STENCIL_REF;
+
     vk_procs = &list->device->vk_procs;
     VK_CALL(vkCmdSetStencilReference(list->vk_command_buffer, VK_STENCIL_FRONT_AND_BACK, stencil_ref));
 }
@@ -4317,6 +5303,16 @@ static void STDMETHODCALLTYPE d3d12_command_list_SetPipelineState(ID3D12Graphics
 
     TRACE("iface %p, pipeline_state %p.\n", iface, pipeline_state);
 
+    if (d3d12_command_list_is_deferring(list))
+    {
+        if (list->deferred.pipeline_state == pipeline_state)
+            return;
+        list->deferred.pipeline_state = pipeline_state;
+        if (d3d12_command_list_defer(list, VKD3D_DEFERRED_OP_SET_PIPELINE_STATE,
+                &pipeline_state, sizeof(pipeline_state)))
+            return;
+    }
+
     if (list->state == state)
         return;
 
@@ -4376,6 +5372,10 @@ static void STDMETHODCALLTYPE d3d12_command_list_ResourceBarrier(ID3D12GraphicsC
 
     TRACE("iface %p, barrier_count %u, barriers %p.\n", iface, barrier_count, barriers);
 
+    if (d3d12_command_list_defer_array(list, VKD3D_DEFERRED_OP_RESOURCE_BARRIER, 0, barrier_count, 0,
+            barriers, sizeof(*barriers)))
+        return;
+
     vk_procs = &list->device->vk_procs;
     vk_info = &list->device->vk_info;
 
@@ -4616,12 +5616,21 @@ static void d3d12_command_list_set_root_signature(struct d3d12_command_list *lis
         enum vkd3d_pipeline_bind_point bind_point, const struct d3d12_root_signature *root_signature)
 {
     struct vkd3d_pipeline_bindings *bindings = &list->pipeline_bindings[bind_point];
+    const struct d3d12_root_signature *previous = bindings->root_signature;
 
-    if (bindings->root_signature == root_signature)
+    if (previous == root_signature)
         return;
 
     bindings->root_signature = root_signature;
 
+    /* Descriptor sets and push constants stay valid across compatible
+     * Vulkan pipeline layouts, so bound root arguments can be kept. */
+    if (previous && root_signature && d3d12_root_signature_is_layout_compatible(previous, root_signature))
+    {
+        TRACE("Root signature %p is layout compatible with %p.\n", root_signature, previous);
+        return;
+    }
+
     d3d12_command_list_invalidate_root_parameters(list, bind_point);
 }
 
@@ -4632,6 +5641,16 @@ static void STDMETHODCALLTYPE d3d12_command_list_SetComputeRootSignature(ID3D12G
 
     TRACE("iface %p, root_signature %p.\n", iface, root_signature);
 
+    if (d3d12_command_list_is_deferring(list))
+    {
+        if (list->deferred.root_signatures[VKD3D_PIPELINE_BIND_POINT_COMPUTE] == root_signature)
+            return;
+        list->deferred.root_signatures[VKD3D_PIPELINE_BIND_POINT_COMPUTE] = root_signature;
+        if (d3d12_command_list_defer(list, VKD3D_DEFERRED_OP_SET_COMPUTE_ROOT_SIGNATURE,
+                &root_signature, sizeof(root_signature)))
+            return;
+    }
+
     d3d12_command_list_set_root_signature(list, VKD3D_PIPELINE_BIND_POINT_COMPUTE,
             unsafe_impl_from_ID3D12RootSignature(root_signature));
 }
@@ -4643,6 +5662,16 @@ static void STDMETHODCALLTYPE d3d12_command_list_SetGraphicsRootSignature(ID3D12
 
     TRACE("iface %p, root_signature %p.\n", iface, root_signature);
 
+    if (d3d12_command_list_is_deferring(list))
+    {
+        if (list->deferred.root_signatures[VKD3D_PIPELINE_BIND_POINT_GRAPHICS] == root_signature)
+            return;
+        list->deferred.root_signatures[VKD3D_PIPELINE_BIND_POINT_GRAPHICS] = root_signature;
+        if (d3d12_command_list_defer(list, VKD3D_DEFERRED_OP_SET_GRAPHICS_ROOT_SIGNATURE,
+                &root_signature, sizeof(root_signature)))
+            return;
+    }
+
     d3d12_command_list_set_root_signature(list, VKD3D_PIPELINE_BIND_POINT_GRAPHICS,
             unsafe_impl_from_ID3D12RootSignature(root_signature));
 }
@@ -4686,6 +5715,10 @@ static void STDMETHODCALLTYPE d3d12_command_list_SetComputeRootDescriptorTable(I
     TRACE("iface %p, root_parameter_index %u, base_descriptor %s.\n",
             iface, root_parameter_index, debug_gpu_handle(base_descriptor));
 
+    if (d3d12_command_list_defer_root_argument(list, VKD3D_DEFERRED_OP_SET_COMPUTE_ROOT_DESCRIPTOR_TABLE,
+            root_parameter_index, base_descriptor.ptr))
+        return;
+
     d3d12_command_list_set_descriptor_table(list, VKD3D_PIPELINE_BIND_POINT_COMPUTE,
             root_parameter_index, base_descriptor);
 }
@@ -4698,6 +5731,10 @@ static void STDMETHODCALLTYPE d3d12_command_list_SetGraphicsRootDescriptorTable(
     TRACE("iface %p, root_parameter_index %u, base_descriptor %s.\n",
             iface, root_parameter_index, debug_gpu_handle(base_descriptor));
 
+    if (d3d12_command_list_defer_root_argument(list, VKD3D_DEFERRED_OP_SET_GRAPHICS_ROOT_DESCRIPTOR_TABLE,
+            root_parameter_index, base_descriptor.ptr))
+        return;
+
     d3d12_command_list_set_descriptor_table(list, VKD3D_PIPELINE_BIND_POINT_GRAPHICS,
             root_parameter_index, base_descriptor);
 }
@@ -4723,6 +5760,10 @@ static void STDMETHODCALLTYPE d3d12_command_list_SetComputeRoot32BitConstant(ID3
     TRACE("iface %p, root_parameter_index %u, data 0x%08x, dst_offset %u.\n",
             iface, root_parameter_index, data, dst_offset);
 
+    if (d3d12_command_list_defer_array(list, VKD3D_DEFERRED_OP_SET_COMPUTE_ROOT_CONSTANTS,
+            root_parameter_index, 1, dst_offset, &data, sizeof(data)))
+        return;
+
     d3d12_command_list_set_root_constants(list, VKD3D_PIPELINE_BIND_POINT_COMPUTE,
             root_parameter_index, dst_offset, 1, &data);
 }
@@ -4735,6 +5776,10 @@ static void STDMETHODCALLTYPE d3d12_command_list_SetGraphicsRoot32BitConstant(ID
     TRACE("iface %p, root_parameter_index %u, data 0x%08x, dst_offset %u.\n",
             iface, root_parameter_index, data, dst_offset);
 
+    if (d3d12_command_list_defer_array(list, VKD3D_DEFERRED_OP_SET_GRAPHICS_ROOT_CONSTANTS,
+            root_parameter_index, 1, dst_offset, &data, sizeof(data)))
+        return;
+
     d3d12_command_list_set_root_constants(list, VKD3D_PIPELINE_BIND_POINT_GRAPHICS,
             root_parameter_index, dst_offset, 1, &data);
 }
@@ -4747,6 +5792,10 @@ static void STDMETHODCALLTYPE d3d12_command_list_SetComputeRoot32BitConstants(ID
     TRACE("iface %p, root_parameter_index %u, constant_count %u, data %p, dst_offset %u.\n",
             iface, root_parameter_index, constant_count, data, dst_offset);
 
+    if (d3d12_command_list_defer_array(list, VKD3D_DEFERRED_OP_SET_COMPUTE_ROOT_CONSTANTS,
+            root_parameter_index, constant_count, dst_offset, data, sizeof(uint32_t)))
+        return;
+
     d3d12_command_list_set_root_constants(list, VKD3D_PIPELINE_BIND_POINT_COMPUTE,
             root_parameter_index, dst_offset, constant_count, data);
 }
@@ -4759,10 +5808,42 @@ static void STDMETHODCALLTYPE d3d12_command_list_SetGraphicsRoot32BitConstants(I
     TRACE("iface %p, root_parameter_index %u, constant_count %u, data %p, dst_offset %u.\n",
             iface, root_parameter_index, constant_count, data, dst_offset);
 
+    if (d3d12_command_list_defer_array(list, VKD3D_DEFERRED_OP_SET_GRAPHICS_ROOT_CONSTANTS,
+            root_parameter_index, constant_count, dst_offset, data, sizeof(uint32_t)))
+        return;
+
     d3d12_command_list_set_root_constants(list, VKD3D_PIPELINE_BIND_POINT_GRAPHICS,
             root_parameter_index, dst_offset, constant_count, data);
 }
 
+static void d3d12_command_list_set_root_cbv_address(struct d3d12_command_list *list,
+        const struct d3d12_root_signature *root_signature, const struct d3d12_root_parameter *root_parameter,
+        D3D12_GPU_VIRTUAL_ADDRESS gpu_address)
+{
+    const struct vkd3d_vk_device_procs *vk_procs = &list->device->vk_procs;
+    const struct vkd3d_null_resources *null_resources;
+    struct d3d12_resource *resource;
+    VkDeviceAddress address;
+
+    if (gpu_address)
+    {
+        resource = vkd3d_gpu_va_allocator_dereference(&list->device->gpu_va_allocator, gpu_address);
+        address = resource->vk_device_address + (gpu_address - resource->gpu_address);
+    }
+    else
+    {
+        if (!(null_resources = vkd3d_get_null_resources(list->device)))
+        {
+            d3d12_command_list_mark_as_invalid(list, "Failed to create NULL resources.");
+            return;
+        }
+        address = null_resources->vk_buffer_address;
+    }
+
+    VK_CALL(vkCmdPushConstants(list->vk_command_buffer, root_signature->vk_pipeline_layout,
+            root_parameter->u.constant.stage_flags, root_parameter->u.constant.offset, sizeof(address), &address));
+}
+
 static void d3d12_command_list_set_root_cbv(struct d3d12_command_list *list,
         enum vkd3d_pipeline_bind_point bind_point, unsigned int index, D3D12_GPU_VIRTUAL_ADDRESS gpu_address)
 {
@@ -4770,6 +5851,7 @@ static void d3d12_command_list_set_root_cbv(struct d3d12_command_list *list,
     const struct d3d12_root_signature *root_signature = bindings->root_signature;
     const struct vkd3d_vk_device_procs *vk_procs = &list->device->vk_procs;
     const struct vkd3d_vulkan_info *vk_info = &list->device->vk_info;
+    const struct vkd3d_null_resources *null_resources;
     const struct d3d12_root_parameter *root_parameter;
     struct VkWriteDescriptorSet descriptor_write;
     struct VkDescriptorBufferInfo buffer_info;
@@ -4778,6 +5860,12 @@ static void d3d12_command_list_set_root_cbv(struct d3d12_command_list *list,
     root_parameter = root_signature_get_root_descriptor(root_signature, index);
     VKD3D_ASSERT(root_parameter->parameter_type == D3D12_ROOT_PARAMETER_TYPE_CBV);
 
+    if (list->device->use_root_buffer_addresses)
+    {
+        d3d12_command_list_set_root_cbv_address(list, root_signature, root_parameter, gpu_address);
+        return;
+    }
+
     if (gpu_address)
     {
         resource = vkd3d_gpu_va_allocator_dereference(&list->device->gpu_va_allocator, gpu_address);
@@ -4788,7 +5876,12 @@ static void d3d12_command_list_set_root_cbv(struct d3d12_command_list *list,
     }
     else
     {
-        buffer_info.buffer = list->device->null_resources.vk_buffer;
+        if (!(null_resources = vkd3d_get_null_resources(list->device)))
+        {
+            d3d12_command_list_mark_as_invalid(list, "Failed to create NULL resources.");
+            return;
+        }
+        buffer_info.buffer = null_resources->vk_buffer;
         buffer_info.offset = 0;
         buffer_info.range = VK_WHOLE_SIZE;
     }
@@ -4822,6 +5915,10 @@ static void STDMETHODCALLTYPE d3d12_command_list_SetComputeRootConstantBufferVie
     TRACE("iface %p, root_parameter_index %u, address %#"PRIx64".\n",
             iface, root_parameter_index, address);
 
+    if (d3d12_command_list_defer_root_argument(list, VKD3D_DEFERRED_OP_SET_COMPUTE_ROOT_CBV,
+            root_parameter_index, address))
+        return;
+
     d3d12_command_list_set_root_cbv(list, VKD3D_PIPELINE_BIND_POINT_COMPUTE, root_parameter_index, address);
 }
 
@@ -4833,6 +5930,10 @@ static void STDMETHODCALLTYPE d3d12_command_list_SetGraphicsRootConstantBufferVi
     TRACE("iface %p, root_parameter_index %u, address %#"PRIx64".\n",
             iface, root_parameter_index, address);
 
+    if (d3d12_command_list_defer_root_argument(list, VKD3D_DEFERRED_OP_SET_GRAPHICS_ROOT_CBV,
+            root_parameter_index, address))
+        return;
+
     d3d12_command_list_set_root_cbv(list, VKD3D_PIPELINE_BIND_POINT_GRAPHICS, root_parameter_index, address);
 }
 
@@ -4893,6 +5994,10 @@ static void STDMETHODCALLTYPE d3d12_command_list_SetComputeRootShaderResourceVie
     TRACE("iface %p, root_parameter_index %u, address %#"PRIx64".\n",
             iface, root_parameter_index, address);
 
+    if (d3d12_command_list_defer_root_argument(list, VKD3D_DEFERRED_OP_SET_COMPUTE_ROOT_SRV,
+            root_parameter_index, address))
+        return;
+
     d3d12_command_list_set_root_descriptor(list, VKD3D_PIPELINE_BIND_POINT_COMPUTE,
             root_parameter_index, address);
 }
@@ -4905,6 +6010,10 @@ static void STDMETHODCALLTYPE d3d12_command_list_SetGraphicsRootShaderResourceVi
     TRACE("iface %p, root_parameter_index %u, address %#"PRIx64".\n",
             iface, root_parameter_index, address);
 
+    if (d3d12_command_list_defer_root_argument(list, VKD3D_DEFERRED_OP_SET_GRAPHICS_ROOT_SRV,
+            root_parameter_index, address))
+        return;
+
     d3d12_command_list_set_root_descriptor(list, VKD3D_PIPELINE_BIND_POINT_GRAPHICS,
             root_parameter_index, address);
 }
@@ -4917,6 +6026,10 @@ static void STDMETHODCALLTYPE d3d12_command_list_SetComputeRootUnorderedAccessVi
     TRACE("iface %p, root_parameter_index %u, address %#"PRIx64".\n",
             iface, root_parameter_index, address);
 
+    if (d3d12_command_list_defer_root_argument(list, VKD3D_DEFERRED_OP_SET_COMPUTE_ROOT_UAV,
+            root_parameter_index, address))
+        return;
+
     d3d12_command_list_set_root_descriptor(list, VKD3D_PIPELINE_BIND_POINT_COMPUTE,
             root_parameter_index, address);
 }
@@ -4929,6 +6042,10 @@ static void STDMETHODCALLTYPE d3d12_command_list_SetGraphicsRootUnorderedAccessV
     TRACE("iface %p, root_parameter_index %u, address %#"PRIx64".\n",
             iface, root_parameter_index, address);
 
+    if (d3d12_command_list_defer_root_argument(list, VKD3D_DEFERRED_OP_SET_GRAPHICS_ROOT_UAV,
+            root_parameter_index, address))
+        return;
+
     d3d12_command_list_set_root_descriptor(list, VKD3D_PIPELINE_BIND_POINT_GRAPHICS,
             root_parameter_index, address);
 }
@@ -4937,9 +6054,11 @@ static void STDMETHODCALLTYPE d3d12_command_list_IASetIndexBuffer(ID3D12Graphics
         const D3D12_INDEX_BUFFER_VIEW *view)
 {
     struct d3d12_command_list *list = impl_from_ID3D12GraphicsCommandList6(iface);
+    struct vkd3d_dynamic_state *dynamic_state = &list->dynamic_state;
     const struct vkd3d_vk_device_procs *vk_procs;
     struct d3d12_resource *resource;
     enum VkIndexType index_type;
+    VkDeviceSize offset;
 
     TRACE("iface %p, view %p.\n", iface, view);
 
@@ -4954,6 +6073,9 @@ static void STDMETHODCALLTYPE d3d12_command_list_IASetIndexBuffer(ID3D12Graphics
         return;
     }
 
+    if (d3d12_command_list_defer(list, VKD3D_DEFERRED_OP_SET_INDEX_BUFFER, view, sizeof(*view)))
+        return;
+
     vk_procs = &list->device->vk_procs;
 
     switch (view->Format)
@@ -4972,28 +6094,43 @@ static void STDMETHODCALLTYPE d3d12_command_list_IASetIndexBuffer(ID3D12Graphics
     list->index_buffer_format = view->Format;
 
     resource = vkd3d_gpu_va_allocator_dereference(&list->device->gpu_va_allocator, view->BufferLocation);
-    VK_CALL(vkCmdBindIndexBuffer(list->vk_command_buffer, resource->u.vk_buffer,
-            view->BufferLocation - resource->gpu_address, index_type));
+    offset = view->BufferLocation - resource->gpu_address;
+
+    if ((dynamic_state->valid_flags & VKD3D_DYNAMIC_STATE_INDEX_BUFFER)
+            && dynamic_state->index_buffer == resource->u.vk_buffer
+            && dynamic_state->index_buffer_offset == offset && dynamic_state->index_type == index_type)
+        return;
+    dynamic_state->index_buffer = resource->u.vk_buffer;
+    dynamic_state->index_buffer_offset = offset;
+    dynamic_state->index_type = index_type;
+    dynamic_state->valid_flags |= VKD3D_DYNAMIC_STATE_INDEX_BUFFER;
+
+    VK_CALL(vkCmdBindIndexBuffer(list->vk_command_buffer, resource->u.vk_buffer, offset, index_type));
 }
 
 static void STDMETHODCALLTYPE d3d12_command_list_IASetVertexBuffers(ID3D12GraphicsCommandList6 *iface,
         UINT start_slot, UINT view_count, const D3D12_VERTEX_BUFFER_VIEW *views)
 {
     struct d3d12_command_list *list = impl_from_ID3D12GraphicsCommandList6(iface);
+    struct vkd3d_dynamic_state *dynamic_state = &list->dynamic_state;
+    unsigned int i, slot, first, stride, max_view_count;
     const struct vkd3d_null_resources *null_resources;
     struct vkd3d_gpu_va_allocator *gpu_va_allocator;
     VkDeviceSize offsets[ARRAY_SIZE(list->strides)];
     const struct vkd3d_vk_device_procs *vk_procs;
     VkBuffer buffers[ARRAY_SIZE(list->strides)];
     struct d3d12_device *device = list->device;
-    unsigned int i, stride, max_view_count;
     struct d3d12_resource *resource;
     bool invalidate = false;
 
     TRACE("iface %p, start_slot %u, view_count %u, views %p.\n", iface, start_slot, view_count, views);
 
+    if (d3d12_command_list_defer_array(list, VKD3D_DEFERRED_OP_SET_VERTEX_BUFFERS, start_slot, view_count, 0,
+            views, sizeof(*views)))
+        return;
+
     vk_procs = &device->vk_procs;
-    null_resources = &device->null_resources;
+    null_resources = NULL;
     gpu_va_allocator = &device->gpu_va_allocator;
 
     if (!vkd3d_bound_range(start_slot, view_count, ARRAY_SIZE(list->strides)))
@@ -5034,6 +6171,11 @@ static void STDMETHODCALLTYPE d3d12_command_list_IASetVertexBuffers(ID3D12Graphi
         }
         else
         {
+            if (!null_resources && !(null_resources = vkd3d_get_null_resources(device)))
+            {
+                d3d12_command_list_mark_as_invalid(list, "Failed to create NULL resources.");
+                return;
+            }
             buffers[i] = null_resources->vk_buffer;
             offsets[i] = 0;
             stride = 0;
@@ -5043,8 +6185,29 @@ static void STDMETHODCALLTYPE d3d12_command_list_IASetVertexBuffers(ID3D12Graphi
         list->strides[start_slot + i] = stride;
     }
 
-    if (view_count)
-        VK_CALL(vkCmdBindVertexBuffers(list->vk_command_buffer, start_slot, view_count, buffers, offsets));
+    /* Only bind runs of slots which differ from the bound buffers. */
+    for (i = 0, first = UINT_MAX; i <= view_count; ++i)
+    {
+        slot = start_slot + i;
+        if (i < view_count && (!(dynamic_state->vertex_buffer_mask & (1u << slot))
+                || dynamic_state->vertex_buffers[slot] != buffers[i]
+                || dynamic_state->vertex_buffer_offsets[slot] != offsets[i]))
+        {
+            dynamic_state->vertex_buffers[slot] = buffers[i];
+            dynamic_state->vertex_buffer_offsets[slot] = offsets[i];
+            dynamic_state->vertex_buffer_mask |= 1u << slot;
+            if (first == UINT_MAX)
+                first = i;
+            continue;
+        }
+
+        if (first != UINT_MAX)
+        {
+            VK_CALL(vkCmdBindVertexBuffers(list->vk_command_buffer, start_slot + first, i - first,
+                    &buffers[first], &offsets[first]));
+            first = UINT_MAX;
+        }
+    }
 
     if (invalidate)
         d3d12_command_list_invalidate_current_pipeline(list);
@@ -5064,6 +6227,10 @@ static void STDMETHODCALLTYPE d3d12_command_list_SOSetTargets(ID3D12GraphicsComm
 
     TRACE("iface %p, start_slot %u, view_count %u, views %p.\n", iface, start_slot, view_count, views);
 
+    if (d3d12_command_list_defer_array(list, VKD3D_DEFERRED_OP_SET_STREAM_OUTPUT_TARGETS, start_slot, view_count, 0,
+            views, sizeof(*views)))
+        return;
+
     d3d12_command_list_end_current_render_pass(list);
 
     if (!list->device->vk_info.EXT_transform_feedback)
@@ -5138,6 +6305,10 @@ static void STDMETHODCALLTYPE d3d12_command_list_OMSetRenderTargets(ID3D12Graphi
         render_target_descriptor_count = ARRAY_SIZE(list->rtvs);
     }
 
+    if (d3d12_command_list_defer_render_targets(list, render_target_descriptor_count,
+            render_target_descriptors, single_descriptor_handle, depth_stencil_descriptor))
+        return;
+
     list->fb_width = 0;
     list->fb_height = 0;
     list->fb_layer_count = 0;
@@ -5262,7 +6433,7 @@ static void d3d12_command_list_clear(struct d3d12_command_list *list,
     pass_desc.pSubpasses = &sub_pass_desc;
     pass_desc.dependencyCount = 0;
     pass_desc.pDependencies = NULL;
-    if ((vr = VK_CALL(vkCreateRenderPass(list->device->vk_device, &pass_desc, NULL, &vk_render_pass))) < 0)
+    if ((vr = vkd3d_create_render_pass(list->device, &pass_desc, &vk_render_pass)) < 0)
     {
         WARN("Failed to create Vulkan render pass, vr %d.\n", vr);
         return;
@@ -5294,6 +6465,7 @@ static void d3d12_command_list_clear(struct d3d12_command_list *list,
         WARN("Failed to create Vulkan framebuffer, vr %d.\n", vr);
         return;
     }
+    d3d12_device_add_statistic(list->device, vk_framebuffer_count, 1);
 
     if (!d3d12_command_allocator_add_framebuffer(list->allocator, vk_framebuffer))
     {
@@ -5333,6 +6505,23 @@ static void STDMETHODCALLTYPE d3d12_command_list_ClearDepthStencilView(ID3D12Gra
     TRACE("iface %p, dsv %s, flags %#x, depth %.8e, stencil 0x%02x, rect_count %u, rects %p.\n",
             iface, debug_cpu_handle(dsv), flags, depth, stencil, rect_count, rects);
 
+    if (d3d12_command_list_is_deferring(list))
+    {
+        struct vkd3d_deferred_clear_dsv clear;
+
+        clear.dsv_desc = *dsv_desc;
+        clear.flags = flags;
+        clear.depth = depth;
+        clear.stencil = stencil;
+        clear.rect_count = rect_count;
+        if (d3d12_command_list_defer_with_rects(list, VKD3D_DEFERRED_OP_CLEAR_DEPTH_STENCIL_VIEW,
+                &clear, sizeof(clear), rect_count, rects))
+        {
+            d3d12_command_list_hold_view(list, dsv_desc->view);
+            return;
+        }
+    }
+
     d3d12_command_list_track_resource_usage(list, dsv_desc->resource);
 
     attachment_desc.flags = 0;
@@ -5381,6 +6570,21 @@ static void STDMETHODCALLTYPE d3d12_command_list_ClearRenderTargetView(ID3D12Gra
     TRACE("iface %p, rtv %s, color %p, rect_count %u, rects %p.\n",
             iface, debug_cpu_handle(rtv), color, rect_count, rects);
 
+    if (d3d12_command_list_is_deferring(list))
+    {
+        struct vkd3d_deferred_clear_rtv clear;
+
+        clear.rtv_desc = *rtv_desc;
+        memcpy(clear.colour, color, sizeof(clear.colour));
+        clear.rect_count = rect_count;
+        if (d3d12_command_list_defer_with_rects(list, VKD3D_DEFERRED_OP_CLEAR_RENDER_TARGET_VIEW,
+                &clear, sizeof(clear), rect_count, rects))
+        {
+            d3d12_command_list_hold_view(list, rtv_desc->view);
+            return;
+        }
+    }
+
     d3d12_command_list_track_resource_usage(list, rtv_desc->resource);
 
     attachment_desc.flags = 0;
@@ -5431,87 +6635,255 @@ struct vkd3d_uav_clear_pipeline
     VkExtent3D group_size;
 };
 
-static void vkd3d_uav_clear_state_get_buffer_pipeline(const struct vkd3d_uav_clear_state *state,
-        enum vkd3d_format_type format_type, struct vkd3d_uav_clear_pipeline *info)
+static bool vkd3d_uav_clear_state_get_buffer_pipeline(struct vkd3d_uav_clear_state *state,
+        struct d3d12_device *device, enum vkd3d_format_type format_type, struct vkd3d_uav_clear_pipeline *info)
 {
-    const struct vkd3d_uav_clear_pipelines *pipelines;
+    struct vkd3d_uav_clear_pipelines *pipelines;
+    HRESULT hr;
 
     pipelines = format_type == VKD3D_FORMAT_TYPE_UINT ? &state->pipelines_uint : &state->pipelines_float;
+
+    if (FAILED(hr = vkd3d_uav_clear_state_get_pipeline(state, device, pipelines, VKD3D_UAV_CLEAR_PIPELINE_BUFFER)))
+    {
+        ERR("Failed to get buffer clear pipeline, hr %s.\n", debugstr_hresult(hr));
+        return false;
+    }
+
     info->vk_set_layout = state->vk_set_layout_buffer;
     info->vk_pipeline_layout = state->vk_pipeline_layout_buffer;
-    info->vk_pipeline = pipelines->buffer;
+    info->vk_pipeline = pipelines->vk_pipelines[VKD3D_UAV_CLEAR_PIPELINE_BUFFER];
     info->group_size = (VkExtent3D){128, 1, 1};
+
+    return true;
 }
 
-static void vkd3d_uav_clear_state_get_image_pipeline(const struct vkd3d_uav_clear_state *state,
-        VkImageViewType image_view_type, enum vkd3d_format_type format_type, struct vkd3d_uav_clear_pipeline *info)
+static bool vkd3d_uav_clear_state_get_image_pipeline(struct vkd3d_uav_clear_state *state,
+        struct d3d12_device *device, VkImageViewType image_view_type, enum vkd3d_format_type format_type,
+        struct vkd3d_uav_clear_pipeline *info)
 {
-    const struct vkd3d_uav_clear_pipelines *pipelines;
+    struct vkd3d_uav_clear_pipelines *pipelines;
+    enum vkd3d_uav_clear_pipeline_type type;
+    HRESULT hr;
 
     pipelines = format_type == VKD3D_FORMAT_TYPE_UINT ? &state->pipelines_uint : &state->pipelines_float;
-    info->vk_set_layout = state->vk_set_layout_image;
-    info->vk_pipeline_layout = state->vk_pipeline_layout_image;
 
     switch (image_view_type)
     {
         case VK_IMAGE_VIEW_TYPE_1D:
-            info->vk_pipeline = pipelines->image_1d;
+            type = VKD3D_UAV_CLEAR_PIPELINE_IMAGE_1D;
             info->group_size = (VkExtent3D){64, 1, 1};
             break;
 
         case VK_IMAGE_VIEW_TYPE_1D_ARRAY:
-            info->vk_pipeline = pipelines->image_1d_array;
+            type = VKD3D_UAV_CLEAR_PIPELINE_IMAGE_1D_ARRAY;
             info->group_size = (VkExtent3D){64, 1, 1};
             break;
 
         case VK_IMAGE_VIEW_TYPE_2D:
-            info->vk_pipeline = pipelines->image_2d;
+            type = VKD3D_UAV_CLEAR_PIPELINE_IMAGE_2D;
             info->group_size = (VkExtent3D){8, 8, 1};
             break;
 
         case VK_IMAGE_VIEW_TYPE_2D_ARRAY:
-            info->vk_pipeline = pipelines->image_2d_array;
+            type = VKD3D_UAV_CLEAR_PIPELINE_IMAGE_2D_ARRAY;
             info->group_size = (VkExtent3D){8, 8, 1};
             break;
 
         case VK_IMAGE_VIEW_TYPE_3D:
-            info->vk_pipeline = pipelines->image_3d;
+            type = VKD3D_UAV_CLEAR_PIPELINE_IMAGE_3D;
             info->group_size = (VkExtent3D){8, 8, 1};
             break;
 
         default:
             ERR("Unhandled view type %#x.\n", image_view_type);
-            info->vk_pipeline = VK_NULL_HANDLE;
-            info->group_size = (VkExtent3D){0, 0, 0};
-            break;
+            return false;
+    }
+
+    if (FAILED(hr = vkd3d_uav_clear_state_get_pipeline(state, device, pipelines, type)))
+    {
+        ERR("Failed to get image clear pipeline, hr %s.\n", debugstr_hresult(hr));
+        return false;
     }
+
+    info->vk_set_layout = state->vk_set_layout_image;
+    info->vk_pipeline_layout = state->vk_pipeline_layout_image;
+    info->vk_pipeline = pipelines->vk_pipelines[type];
+
+    return true;
 }
 
-static void d3d12_command_list_clear_uav(struct d3d12_command_list *list,
-        struct d3d12_resource *resource, struct vkd3d_view *descriptor, const VkClearColorValue *clear_colour,
-        unsigned int rect_count, const D3D12_RECT *rects)
+enum vkd3d_uav_clear_strategy
 {
-    const VkPhysicalDeviceLimits *device_limits = &list->device->vk_info.device_limits;
-    const struct vkd3d_vk_device_procs *vk_procs = &list->device->vk_procs;
-    unsigned int i, miplevel_idx, layer_count;
-    struct vkd3d_uav_clear_pipeline pipeline;
-    struct vkd3d_uav_clear_args clear_args;
-    const struct vkd3d_resource_view *view;
-    uint32_t count_x, count_y, count_z;
-    VkDescriptorImageInfo image_info;
-    D3D12_RECT full_rect, curr_rect;
-    VkWriteDescriptorSet write_set;
+    VKD3D_UAV_CLEAR_STRATEGY_COMPUTE,
+    VKD3D_UAV_CLEAR_STRATEGY_FILL_BUFFER,
+    VKD3D_UAV_CLEAR_STRATEGY_CLEAR_IMAGE,
+};
 
-    d3d12_command_list_track_resource_usage(list, resource);
-    d3d12_command_list_end_current_render_pass(list);
+static bool vkd3d_rects_cover_full_rect(unsigned int rect_count, const D3D12_RECT *rects, const D3D12_RECT *full_rect)
+{
+    unsigned int i;
 
-    d3d12_command_list_invalidate_current_pipeline(list);
+    if (!rect_count)
+        return true;
+
+    for (i = 0; i < rect_count; ++i)
+    {
+        if (rects[i].left <= full_rect->left && rects[i].top <= full_rect->top
+                && rects[i].right >= full_rect->right && rects[i].bottom >= full_rect->bottom)
+            return true;
+    }
+
+    return false;
+}
+
+/* vkCmdFillBuffer() and vkCmdClearColorImage() don't need a pipeline or a
+ * descriptor set, but they can only be used when they write exactly the same
+ * values as the clear shaders would. */
+static enum vkd3d_uav_clear_strategy vkd3d_select_uav_clear_strategy(const struct d3d12_resource *resource,
+        const struct vkd3d_resource_view *view, unsigned int rect_count, const D3D12_RECT *rects)
+{
+    VkFormat vk_format = view->format->vk_format;
+    D3D12_RECT full_rect;
+
+    if (d3d12_resource_is_buffer(resource))
+    {
+        /* For single component 32-bit formats both clear shaders store the
+         * first component of the clear value unmodified. */
+        if (vk_format != VK_FORMAT_R32_UINT && vk_format != VK_FORMAT_R32_SINT && vk_format != VK_FORMAT_R32_SFLOAT)
+            return VKD3D_UAV_CLEAR_STRATEGY_COMPUTE;
+        if (!view->u.vk_buffer_view || view->info.buffer.offset % 4 || view->info.buffer.size == VK_WHOLE_SIZE)
+            return VKD3D_UAV_CLEAR_STRATEGY_COMPUTE;
+        return VKD3D_UAV_CLEAR_STRATEGY_FILL_BUFFER;
+    }
+
+    /* The clear value is interpreted according to the image format, not the
+     * view format. */
+    if (vk_format != resource->format->vk_format || view->format->vk_aspect_mask != VK_IMAGE_ASPECT_COLOR_BIT)
+        return VKD3D_UAV_CLEAR_STRATEGY_COMPUTE;
+
+    full_rect.left = 0;
+    full_rect.right = d3d12_resource_desc_get_width(&resource->desc, view->info.texture.miplevel_idx);
+    full_rect.top = 0;
+    full_rect.bottom = d3d12_resource_desc_get_height(&resource->desc, view->info.texture.miplevel_idx);
+    if (!vkd3d_rects_cover_full_rect(rect_count, rects, &full_rect))
+        return VKD3D_UAV_CLEAR_STRATEGY_COMPUTE;
+
+    return VKD3D_UAV_CLEAR_STRATEGY_CLEAR_IMAGE;
+}
+
+static void d3d12_command_list_clear_uav_with_transfer(struct d3d12_command_list *list,
+        struct d3d12_resource *resource, const struct vkd3d_resource_view *view,
+        enum vkd3d_uav_clear_strategy strategy, const VkClearColorValue *clear_colour,
+        unsigned int rect_count, const D3D12_RECT *rects)
+{
+    const struct vkd3d_vk_device_procs *vk_procs = &list->device->vk_procs;
+    VkPipelineStageFlags uav_stage_mask;
+    VkDeviceSize element_count, begin, end;
+    VkImageSubresourceRange range;
+    VkAccessFlags uav_access_mask;
+    VkMemoryBarrier vk_barrier;
+    VkImageLayout image_layout;
+    unsigned int i;
+
+    vk_barrier_parameters_from_d3d12_resource_state(D3D12_RESOURCE_STATE_UNORDERED_ACCESS, 0,
+            resource, list->vk_queue_flags, &list->device->vk_info, &uav_access_mask,
+            &uav_stage_mask, &image_layout, list->device);
+
+    /* UAV barriers recorded by the application only synchronise shader
+     * stages, so make transfer writes ordered with respect to them. */
+    vk_barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+    vk_barrier.pNext = NULL;
+    vk_barrier.srcAccessMask = uav_access_mask;
+    vk_barrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    VK_CALL(vkCmdPipelineBarrier(list->vk_command_buffer, uav_stage_mask, VK_PIPELINE_STAGE_TRANSFER_BIT, 0,
+            1, &vk_barrier, 0, NULL, 0, NULL));
+
+    if (strategy == VKD3D_UAV_CLEAR_STRATEGY_FILL_BUFFER)
+    {
+        element_count = view->info.buffer.size / sizeof(uint32_t);
+
+        if (!rect_count)
+        {
+            VK_CALL(vkCmdFillBuffer(list->vk_command_buffer, resource->u.vk_buffer, view->info.buffer.offset,
+                    element_count * sizeof(uint32_t), clear_colour->uint32[0]));
+        }
+
+        for (i = 0; i < rect_count; ++i)
+        {
+            /* Buffer views have a height of 1. */
+            if (rects[i].top > 0 || rects[i].bottom <= 0)
+                continue;
+
+            begin = max(rects[i].left, 0);
+            end = min((VkDeviceSize)max(rects[i].right, 0), element_count);
+            if (begin >= end)
+                continue;
+
+            VK_CALL(vkCmdFillBuffer(list->vk_command_buffer, resource->u.vk_buffer,
+                    view->info.buffer.offset + begin * sizeof(uint32_t), (end - begin) * sizeof(uint32_t),
+                    clear_colour->uint32[0]));
+        }
+    }
+    else
+    {
+        range.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+        range.baseMipLevel = view->info.texture.miplevel_idx;
+        range.levelCount = 1;
+        if (view->info.texture.vk_view_type == VK_IMAGE_VIEW_TYPE_3D)
+        {
+            range.baseArrayLayer = 0;
+            range.layerCount = 1;
+        }
+        else
+        {
+            range.baseArrayLayer = view->info.texture.layer_idx;
+            range.layerCount = view->info.texture.layer_count;
+        }
+
+        VK_CALL(vkCmdClearColorImage(list->vk_command_buffer, resource->u.vk_image,
+                image_layout, clear_colour, 1, &range));
+    }
+
+    vk_barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    vk_barrier.dstAccessMask = uav_access_mask;
+    VK_CALL(vkCmdPipelineBarrier(list->vk_command_buffer, VK_PIPELINE_STAGE_TRANSFER_BIT, uav_stage_mask, 0,
+            1, &vk_barrier, 0, NULL, 0, NULL));
+}
+
+static void d3d12_command_list_clear_uav(struct d3d12_command_list *list,
+        struct d3d12_resource *resource, struct vkd3d_view *descriptor, const VkClearColorValue *clear_colour,
+        unsigned int rect_count, const D3D12_RECT *rects)
+{
+    const VkPhysicalDeviceLimits *device_limits = &list->device->vk_info.device_limits;
+    const struct vkd3d_vk_device_procs *vk_procs = &list->device->vk_procs;
+    unsigned int i, miplevel_idx, layer_count;
+    enum vkd3d_uav_clear_strategy strategy;
+    struct vkd3d_uav_clear_pipeline pipeline;
+    struct vkd3d_uav_clear_args clear_args;
+    const struct vkd3d_resource_view *view;
+    uint32_t count_x, count_y, count_z;
+    VkDescriptorImageInfo image_info;
+    D3D12_RECT full_rect, curr_rect;
+    VkWriteDescriptorSet write_set;
+
+    d3d12_command_list_track_resource_usage(list, resource);
+    d3d12_command_list_end_current_render_pass(list);
+
+    view = &descriptor->v;
+
+    if ((strategy = vkd3d_select_uav_clear_strategy(resource, view, rect_count, rects))
+            != VKD3D_UAV_CLEAR_STRATEGY_COMPUTE)
+    {
+        d3d12_command_list_clear_uav_with_transfer(list, resource, view, strategy, clear_colour, rect_count, rects);
+        return;
+    }
+
+    d3d12_command_list_invalidate_current_pipeline(list);
     d3d12_command_list_invalidate_bindings(list, list->state);
     d3d12_command_list_invalidate_root_parameters(list, VKD3D_PIPELINE_BIND_POINT_COMPUTE);
 
     if (!d3d12_command_allocator_add_view(list->allocator, descriptor))
         WARN("Failed to add view.\n");
-    view = &descriptor->v;
 
     clear_args.colour = *clear_colour;
 
@@ -5530,8 +6902,9 @@ static void d3d12_command_list_clear_uav(struct d3d12_command_list *list,
 
         miplevel_idx = 0;
         layer_count = 1;
-        vkd3d_uav_clear_state_get_buffer_pipeline(&list->device->uav_clear_state,
-                view->format->type, &pipeline);
+        if (!vkd3d_uav_clear_state_get_buffer_pipeline(&list->device->uav_clear_state,
+                list->device, view->format->type, &pipeline))
+            return;
     }
     else
     {
@@ -5548,8 +6921,9 @@ static void d3d12_command_list_clear_uav(struct d3d12_command_list *list,
         layer_count = view->info.texture.vk_view_type == VK_IMAGE_VIEW_TYPE_3D
                 ? d3d12_resource_desc_get_depth(&resource->desc, miplevel_idx)
                 : view->info.texture.layer_count;
-        vkd3d_uav_clear_state_get_image_pipeline(&list->device->uav_clear_state,
-                view->info.texture.vk_view_type, view->format->type, &pipeline);
+        if (!vkd3d_uav_clear_state_get_image_pipeline(&list->device->uav_clear_state, list->device,
+                view->info.texture.vk_view_type, view->format->type, &pipeline))
+            return;
     }
 
     if (!(write_set.dstSet = d3d12_command_allocator_allocate_descriptor_set(list->allocator,
@@ -5699,70 +7073,83 @@ static struct vkd3d_view *create_uint_view(struct d3d12_device *device, const st
     return uint_view;
 }
 
-static void STDMETHODCALLTYPE d3d12_command_list_ClearUnorderedAccessViewUint(ID3D12GraphicsCommandList6 *iface,
-        D3D12_GPU_DESCRIPTOR_HANDLE gpu_handle, D3D12_CPU_DESCRIPTOR_HANDLE cpu_handle, ID3D12Resource *resource,
-        const UINT values[4], UINT rect_count, const D3D12_RECT *rects)
+static void d3d12_command_list_clear_uav_view(struct d3d12_command_list *list,
+        struct d3d12_resource *resource, struct vkd3d_view *descriptor, VkClearColorValue colour,
+        bool is_float, unsigned int rect_count, const D3D12_RECT *rects)
 {
-    struct d3d12_command_list *list = impl_from_ID3D12GraphicsCommandList6(iface);
-    struct vkd3d_view *descriptor, *uint_view = NULL;
+    const struct vkd3d_resource_view *view = &descriptor->v;
     struct d3d12_device *device = list->device;
-    const struct vkd3d_resource_view *view;
-    struct d3d12_resource *resource_impl;
-    VkClearColorValue colour;
-
-    TRACE("iface %p, gpu_handle %s, cpu_handle %s, resource %p, values %p, rect_count %u, rects %p.\n",
-            iface, debug_gpu_handle(gpu_handle), debug_cpu_handle(cpu_handle), resource, values, rect_count, rects);
-
-    resource_impl = unsafe_impl_from_ID3D12Resource(resource);
-    if (!(descriptor = d3d12_desc_from_cpu_handle(cpu_handle)->s.u.view))
-        return;
-    view = &descriptor->v;
-    memcpy(colour.uint32, values, sizeof(colour.uint32));
+    struct vkd3d_view *uint_view = NULL;
 
-    if (view->format->type != VKD3D_FORMAT_TYPE_UINT
-            && !(descriptor = uint_view = create_uint_view(device, view, resource_impl, &colour)))
+    if ((is_float ? view->format->type == VKD3D_FORMAT_TYPE_SINT : view->format->type != VKD3D_FORMAT_TYPE_UINT)
+            && !(descriptor = uint_view = create_uint_view(device, view, resource, &colour)))
     {
         ERR("Failed to create UINT view.\n");
         return;
     }
 
-    d3d12_command_list_clear_uav(list, resource_impl, descriptor, &colour, rect_count, rects);
+    d3d12_command_list_clear_uav(list, resource, descriptor, &colour, rect_count, rects);
 
     if (uint_view)
         vkd3d_view_decref(uint_view, device);
 }
 
-static void STDMETHODCALLTYPE d3d12_command_list_ClearUnorderedAccessViewFloat(ID3D12GraphicsCommandList6 *iface,
+static void d3d12_command_list_clear_uav_from_cpu_handle(struct d3d12_command_list *list,
+        D3D12_CPU_DESCRIPTOR_HANDLE cpu_handle, ID3D12Resource *resource, const VkClearColorValue *colour,
+        bool is_float, unsigned int rect_count, const D3D12_RECT *rects)
+{
+    struct d3d12_resource *resource_impl = unsafe_impl_from_ID3D12Resource(resource);
+    struct vkd3d_view *descriptor;
+
+    if (!(descriptor = d3d12_desc_from_cpu_handle(cpu_handle)->s.u.view))
+        return;
+
+    if (d3d12_command_list_is_deferring(list))
+    {
+        struct vkd3d_deferred_clear_uav clear;
+
+        clear.resource = resource_impl;
+        clear.view = descriptor;
+        clear.colour = *colour;
+        clear.is_float = is_float;
+        clear.rect_count = rect_count;
+        if (d3d12_command_list_defer_with_rects(list, VKD3D_DEFERRED_OP_CLEAR_UAV,
+                &clear, sizeof(clear), rect_count, rects))
+        {
+            d3d12_command_list_hold_view(list, descriptor);
+            return;
+        }
+    }
+
+    d3d12_command_list_clear_uav_view(list, resource_impl, descriptor, *colour, is_float, rect_count, rects);
+}
+
+static void STDMETHODCALLTYPE d3d12_command_list_ClearUnorderedAccessViewUint(ID3D12GraphicsCommandList6 *iface,
         D3D12_GPU_DESCRIPTOR_HANDLE gpu_handle, D3D12_CPU_DESCRIPTOR_HANDLE cpu_handle, ID3D12Resource *resource,
-        const float values[4], UINT rect_count, const D3D12_RECT *rects)
+        const UINT values[4], UINT rect_count, const D3D12_RECT *rects)
 {
     struct d3d12_command_list *list = impl_from_ID3D12GraphicsCommandList6(iface);
-    struct vkd3d_view *descriptor, *uint_view = NULL;
-    struct d3d12_device *device = list->device;
-    const struct vkd3d_resource_view *view;
-    struct d3d12_resource *resource_impl;
     VkClearColorValue colour;
 
     TRACE("iface %p, gpu_handle %s, cpu_handle %s, resource %p, values %p, rect_count %u, rects %p.\n",
             iface, debug_gpu_handle(gpu_handle), debug_cpu_handle(cpu_handle), resource, values, rect_count, rects);
 
-    resource_impl = unsafe_impl_from_ID3D12Resource(resource);
-    if (!(descriptor = d3d12_desc_from_cpu_handle(cpu_handle)->s.u.view))
-        return;
-    view = &descriptor->v;
-    memcpy(colour.float32, values, sizeof(colour.float32));
+    memcpy(colour.uint32, values, sizeof(colour.uint32));
+    d3d12_command_list_clear_uav_from_cpu_handle(list, cpu_handle, resource, &colour, false, rect_count, rects);
+}
 
-    if (view->format->type == VKD3D_FORMAT_TYPE_SINT
-            && !(descriptor = uint_view = create_uint_view(device, view, resource_impl, &colour)))
-    {
-        ERR("Failed to create UINT view.\n");
-        return;
-    }
+static void STDMETHODCALLTYPE d3d12_command_list_ClearUnorderedAccessViewFloat(ID3D12GraphicsCommandList6 *iface,
+        D3D12_GPU_DESCRIPTOR_HANDLE gpu_handle, D3D12_CPU_DESCRIPTOR_HANDLE cpu_handle, ID3D12Resource *resource,
+        const float values[4], UINT rect_count, const D3D12_RECT *rects)
+{
+    struct d3d12_command_list *list = impl_from_ID3D12GraphicsCommandList6(iface);
+    VkClearColorValue colour;
 
-    d3d12_command_list_clear_uav(list, resource_impl, descriptor, &colour, rect_count, rects);
+    TRACE("iface %p, gpu_handle %s, cpu_handle %s, resource %p, values %p, rect_count %u, rects %p.\n",
+            iface, debug_gpu_handle(gpu_handle), debug_cpu_handle(cpu_handle), resource, values, rect_count, rects);
 
-    if (uint_view)
-        vkd3d_view_decref(uint_view, device);
+    memcpy(colour.float32, values, sizeof(colour.float32));
+    d3d12_command_list_clear_uav_from_cpu_handle(list, cpu_handle, resource, &colour, true, rect_count, rects);
 }
 
 static void STDMETHODCALLTYPE d3d12_command_list_DiscardResource(ID3D12GraphicsCommandList6 *iface,
@@ -5781,6 +7168,9 @@ static void STDMETHODCALLTYPE d3d12_command_list_BeginQuery(ID3D12GraphicsComman
 
     TRACE("iface %p, heap %p, type %#x, index %u.\n", iface, heap, type, index);
 
+    if (d3d12_command_list_defer_query(list, VKD3D_DEFERRED_OP_BEGIN_QUERY, heap, type, index, 1, NULL, 0))
+        return;
+
     vk_procs = &list->device->vk_procs;
 
     d3d12_command_list_end_current_render_pass(list);
@@ -5810,12 +7200,16 @@ static void STDMETHODCALLTYPE d3d12_command_list_EndQuery(ID3D12GraphicsCommandL
 
     TRACE("iface %p, heap %p, type %#x, index %u.\n", iface, heap, type, index);
 
+    /* ResolveQueryData() in other command lists may be translated before this one. */
+    d3d12_query_heap_mark_result_as_available(query_heap, index);
+
+    if (d3d12_command_list_defer_query(list, VKD3D_DEFERRED_OP_END_QUERY, heap, type, index, 1, NULL, 0))
+        return;
+
     vk_procs = &list->device->vk_procs;
 
     d3d12_command_list_end_current_render_pass(list);
 
-    d3d12_query_heap_mark_result_as_available(query_heap, index);
-
     if (type == D3D12_QUERY_TYPE_TIMESTAMP)
     {
         VK_CALL(vkCmdResetQueryPool(list->vk_command_buffer, query_heap->vk_query_pool, index, 1));
@@ -5862,6 +7256,10 @@ static void STDMETHODCALLTYPE d3d12_command_list_ResolveQueryData(ID3D12Graphics
             iface, heap, type, start_index, query_count,
             dst_buffer, aligned_dst_buffer_offset);
 
+    if (d3d12_command_list_defer_query(list, VKD3D_DEFERRED_OP_RESOLVE_QUERY_DATA, heap, type,
+            start_index, query_count, dst_buffer, aligned_dst_buffer_offset))
+        return;
+
     vk_procs = &list->device->vk_procs;
 
     /* Vulkan is less strict than D3D12 here. Vulkan implementations are free
@@ -5938,6 +7336,17 @@ static void STDMETHODCALLTYPE d3d12_command_list_SetPredication(ID3D12GraphicsCo
     TRACE("iface %p, buffer %p, aligned_buffer_offset %#"PRIx64", operation %#x.\n",
             iface, buffer, aligned_buffer_offset, operation);
 
+    if (d3d12_command_list_is_deferring(list))
+    {
+        struct vkd3d_deferred_predication predication;
+
+        predication.buffer = buffer;
+        predication.offset = aligned_buffer_offset;
+        predication.operation = operation;
+        if (d3d12_command_list_defer(list, VKD3D_DEFERRED_OP_SET_PREDICATION, &predication, sizeof(predication)))
+            return;
+    }
+
     if (!vk_info->EXT_conditional_rendering)
     {
         FIXME("Vulkan conditional rendering extension not present. Conditional rendering not supported.\n");
@@ -5999,21 +7408,90 @@ static void STDMETHODCALLTYPE d3d12_command_list_SetPredication(ID3D12GraphicsCo
     }
 }
 
+/* Markers are recorded twice in deferred mode; only trace them the first time. */
+static bool d3d12_command_list_should_trace_marker(const struct d3d12_command_list *list)
+{
+    return vkd3d_trace_enabled && !list->deferred.replaying;
+}
+
+/* Returns false if the marker should be recorded immediately. The metadata is
+ * stored as the array start. */
+static bool d3d12_command_list_defer_marker(struct d3d12_command_list *list,
+        enum vkd3d_deferred_op op, UINT metadata, const void *data, UINT size)
+{
+    return d3d12_command_list_defer_array(list, op, metadata, size, 0, data, 1);
+}
+
 static void STDMETHODCALLTYPE d3d12_command_list_SetMarker(ID3D12GraphicsCommandList6 *iface,
         UINT metadata, const void *data, UINT size)
 {
-    FIXME("iface %p, metadata %#x, data %p, size %u stub!\n", iface, metadata, data, size);
+    struct d3d12_command_list *list = impl_from_ID3D12GraphicsCommandList6(iface);
+    const struct vkd3d_vk_device_procs *vk_procs;
+    VkDebugUtilsLabelEXT label;
+    char *name;
+
+    TRACE("iface %p, metadata %#x, data %p, size %u.\n", iface, metadata, data, size);
+
+    if (d3d12_command_list_should_trace_marker(list))
+        vkd3d_trace_marker('i', metadata, data, size, list->device->wchar_size);
+
+    if (!list->device->vk_info.EXT_debug_utils)
+        return;
+
+    if (d3d12_command_list_defer_marker(list, VKD3D_DEFERRED_OP_SET_MARKER, metadata, data, size))
+        return;
+
+    vk_procs = &list->device->vk_procs;
+    name = vkd3d_strdup_marker(metadata, data, size, list->device->wchar_size);
+    vk_debug_utils_label_init(&label, name);
+    VK_CALL(vkCmdInsertDebugUtilsLabelEXT(list->vk_command_buffer, &label));
+    vkd3d_free(name);
 }
 
 static void STDMETHODCALLTYPE d3d12_command_list_BeginEvent(ID3D12GraphicsCommandList6 *iface,
         UINT metadata, const void *data, UINT size)
 {
-    FIXME("iface %p, metadata %#x, data %p, size %u stub!\n", iface, metadata, data, size);
+    struct d3d12_command_list *list = impl_from_ID3D12GraphicsCommandList6(iface);
+    const struct vkd3d_vk_device_procs *vk_procs;
+    VkDebugUtilsLabelEXT label;
+    char *name;
+
+    TRACE("iface %p, metadata %#x, data %p, size %u.\n", iface, metadata, data, size);
+
+    if (d3d12_command_list_should_trace_marker(list))
+        vkd3d_trace_marker('B', metadata, data, size, list->device->wchar_size);
+
+    if (!list->device->vk_info.EXT_debug_utils)
+        return;
+
+    if (d3d12_command_list_defer_marker(list, VKD3D_DEFERRED_OP_BEGIN_EVENT, metadata, data, size))
+        return;
+
+    vk_procs = &list->device->vk_procs;
+    name = vkd3d_strdup_marker(metadata, data, size, list->device->wchar_size);
+    vk_debug_utils_label_init(&label, name);
+    VK_CALL(vkCmdBeginDebugUtilsLabelEXT(list->vk_command_buffer, &label));
+    vkd3d_free(name);
 }
 
 static void STDMETHODCALLTYPE d3d12_command_list_EndEvent(ID3D12GraphicsCommandList6 *iface)
 {
-    FIXME("iface %p stub!\n", iface);
+    struct d3d12_command_list *list = impl_from_ID3D12GraphicsCommandList6(iface);
+    const struct vkd3d_vk_device_procs *vk_procs;
+
+    TRACE("iface %p.\n", iface);
+
+    if (d3d12_command_list_should_trace_marker(list))
+        vkd3d_trace_marker('E', 0, NULL, 0, list->device->wchar_size);
+
+    if (!list->device->vk_info.EXT_debug_utils)
+        return;
+
+    if (d3d12_command_list_defer_marker(list, VKD3D_DEFERRED_OP_END_EVENT, 0, NULL, 0))
+        return;
+
+    vk_procs = &list->device->vk_procs;
+    VK_CALL(vkCmdEndDebugUtilsLabelEXT(list->vk_command_buffer));
 }
 
 STATIC_ASSERT(sizeof(VkDispatchIndirectCommand) == sizeof(D3D12_DISPATCH_ARGUMENTS));
@@ -6037,6 +7515,8 @@ static void STDMETHODCALLTYPE d3d12_command_list_ExecuteIndirect(ID3D12GraphicsC
             iface, command_signature, max_command_count, arg_buffer, arg_buffer_offset,
             count_buffer, count_buffer_offset);
 
+    d3d12_command_list_flush_deferred(list);
+
     vk_procs = &list->device->vk_procs;
 
     if (count_buffer && !list->device->vk_info.KHR_draw_indirect_count)
@@ -6160,6 +7640,14 @@ static void STDMETHODCALLTYPE d3d12_command_list_OMSetDepthBounds(ID3D12Graphics
 
     TRACE("iface %p, min %.8e, max %.8e.\n", iface, min, max);
 
+    if (d3d12_command_list_is_deferring(list))
+    {
+        const float args[] = {min, max};
+
+        if (d3d12_command_list_defer(list, VKD3D_DEFERRED_OP_SET_DEPTH_BOUNDS, args, sizeof(args)))
+            return;
+    }
+
     if (isnan(max))
         max = 0.0f;
     if (isnan(min))
@@ -6425,6 +7913,9 @@ static HRESULT d3d12_command_list_init(struct d3d12_command_list *list, struct d
 
     list->descriptor_heap_count = 0;
 
+    memset(&list->deferred, 0, sizeof(list->deferred));
+    list->deferred.enabled = !!(device->vkd3d_instance->config_flags & VKD3D_CONFIG_FLAG_DEFERRED_RECORDING);
+
     if (SUCCEEDED(hr = d3d12_command_allocator_allocate_command_buffer(allocator, list)))
     {
         list->pipeline_bindings[VKD3D_PIPELINE_BIND_POINT_GRAPHICS].vk_uav_counter_views = NULL;
@@ -6517,6 +8008,103 @@ static ULONG STDMETHODCALLTYPE d3d12_command_queue_AddRef(ID3D12CommandQueue *if
     return refcount;
 }
 
+#define VKD3D_CS_ARENA_BLOCK_SIZE 0x10000
+
+struct vkd3d_cs_arena_block
+{
+    struct vkd3d_cs_arena_block *next;
+    size_t size;
+    size_t offset;
+    uint64_t data[];
+};
+
+static void vkd3d_cs_arena_init(struct vkd3d_cs_arena *arena)
+{
+    arena->blocks = NULL;
+    arena->free_blocks = NULL;
+}
+
+static void vkd3d_cs_arena_free_blocks(struct vkd3d_cs_arena_block *block)
+{
+    struct vkd3d_cs_arena_block *next;
+
+    for (; block; block = next)
+    {
+        next = block->next;
+        vkd3d_free(block);
+    }
+}
+
+static void vkd3d_cs_arena_destroy(struct vkd3d_cs_arena *arena)
+{
+    vkd3d_cs_arena_free_blocks(arena->blocks);
+    vkd3d_cs_arena_free_blocks(arena->free_blocks);
+}
+
+/* Keeps the blocks around for reuse. */
+static void vkd3d_cs_arena_reset(struct vkd3d_cs_arena *arena)
+{
+    struct vkd3d_cs_arena_block *block;
+
+    while ((block = arena->blocks))
+    {
+        arena->blocks = block->next;
+        block->next = arena->free_blocks;
+        arena->free_blocks = block;
+    }
+}
+
+/* Moves the allocations of "src" into "dst". New allocations from "dst"
+ * continue in its current block. */
+static void vkd3d_cs_arena_move(struct vkd3d_cs_arena *dst, struct vkd3d_cs_arena *src)
+{
+    struct vkd3d_cs_arena_block **block;
+
+    for (block = &dst->blocks; *block; block = &(*block)->next)
+        ;
+    *block = src->blocks;
+    src->blocks = NULL;
+}
+
+static void *vkd3d_cs_arena_alloc(struct vkd3d_cs_arena *arena, size_t size)
+{
+    struct vkd3d_cs_arena_block *block, **free_block;
+    size_t block_size;
+    void *ptr;
+
+    size = align(size, sizeof(uint64_t));
+
+    if (!(block = arena->blocks) || block->size - block->offset < size)
+    {
+        for (free_block = &arena->free_blocks; *free_block; free_block = &(*free_block)->next)
+        {
+            if ((*free_block)->size >= size)
+                break;
+        }
+
+        if ((block = *free_block))
+        {
+            *free_block = block->next;
+        }
+        else
+        {
+            block_size = max(size, VKD3D_CS_ARENA_BLOCK_SIZE);
+            if (!(block = vkd3d_malloc(offsetof(struct vkd3d_cs_arena_block, data[0]) + block_size)))
+                return NULL;
+            block->size = block_size;
+        }
+
+        block->offset = 0;
+        block->next = arena->blocks;
+        arena->blocks = block;
+    }
+
+    ptr = (uint8_t *)block->data + block->offset;
+    block->offset += size;
+
+    return ptr;
+}
+
 static void d3d12_command_queue_destroy_op(struct vkd3d_cs_op_data *op)
 {
     switch (op->opcode)
@@ -6537,6 +8125,12 @@ static void d3d12_command_queue_destroy_op(struct vkd3d_cs_op_data *op)
         case VKD3D_CS_OP_UPDATE_MAPPINGS:
         case VKD3D_CS_OP_COPY_MAPPINGS:
             break;
+
+        case VKD3D_CS_OP_BEGIN_LABEL:
+        case VKD3D_CS_OP_END_LABEL:
+        case VKD3D_CS_OP_INSERT_LABEL:
+            vkd3d_free(op->u.label.name);
+            break;
     }
 }
 
@@ -6548,6 +8142,28 @@ static void d3d12_command_queue_op_array_destroy(struct d3d12_command_queue_op_a
         d3d12_command_queue_destroy_op(&array->ops[i]);
 
     vkd3d_free(array->ops);
+    vkd3d_cs_arena_destroy(&array->arena);
+}
+
+static void d3d12_command_queue_destroy_sparse_semaphores(struct d3d12_command_queue *queue)
+{
+    const struct vkd3d_vk_device_procs *vk_procs = &queue->device->vk_procs;
+    unsigned int i;
+
+    for (i = 0; i < ARRAY_SIZE(queue->vk_sparse_semaphores); ++i)
+        VK_CALL(vkDestroySemaphore(queue->device->vk_device, queue->vk_sparse_semaphores[i], NULL));
+}
+
+static void vkd3d_sparse_bind_arrays_cleanup(struct vkd3d_sparse_bind_arrays *binds)
+{
+    vkd3d_free(binds->memory_binds);
+    vkd3d_free(binds->image_binds);
+    vkd3d_free(binds->buffer_infos);
+    vkd3d_free(binds->opaque_infos);
+    vkd3d_free(binds->image_infos);
+    vkd3d_free(binds->bind_infos);
+    vkd3d_free(binds->timeline_infos);
+    vkd3d_free(binds->semaphore_values);
 }
 
 static ULONG STDMETHODCALLTYPE d3d12_command_queue_Release(ID3D12CommandQueue *iface)
@@ -6566,6 +8182,8 @@ static ULONG STDMETHODCALLTYPE d3d12_command_queue_Release(ID3D12CommandQueue *i
         vkd3d_mutex_destroy(&command_queue->op_mutex);
         d3d12_command_queue_op_array_destroy(&command_queue->op_queue);
         d3d12_command_queue_op_array_destroy(&command_queue->aux_op_queue);
+        vkd3d_sparse_bind_arrays_cleanup(&command_queue->sparse_binds);
+        d3d12_command_queue_destroy_sparse_semaphores(command_queue);
 
         vkd3d_private_store_destroy(&command_queue->private_store);
 
@@ -6644,182 +8262,796 @@ static struct vkd3d_cs_op_data *d3d12_command_queue_op_array_require_space(struc
     return &array->ops[array->count++];
 }
 
-static bool clone_array_parameter(void **dst, const void *src, size_t elem_size, unsigned int count)
+static bool clone_array_parameter(struct vkd3d_cs_arena *arena, void **dst,
+        const void *src, size_t elem_size, unsigned int count)
+{
+    void *buffer;
+
+    *dst = NULL;
+    if (src)
+    {
+        if (!(buffer = vkd3d_cs_arena_alloc(arena, count * elem_size)))
+            return false;
+        memcpy(buffer, src, count * elem_size);
+        *dst = buffer;
+    }
+    return true;
+}
+
+static void STDMETHODCALLTYPE d3d12_command_queue_UpdateTileMappings(ID3D12CommandQueue *iface,
+        ID3D12Resource *resource, UINT region_count,
+        const D3D12_TILED_RESOURCE_COORDINATE *region_start_coordinates, const D3D12_TILE_REGION_SIZE *region_sizes,
+        ID3D12Heap *heap, UINT range_count, const D3D12_TILE_RANGE_FLAGS *range_flags,
+        const UINT *heap_range_offsets, const UINT *range_tile_counts, D3D12_TILE_MAPPING_FLAGS flags)
+{
+    struct d3d12_resource *resource_impl = unsafe_impl_from_ID3D12Resource(resource);
+    struct d3d12_command_queue *command_queue = impl_from_ID3D12CommandQueue(iface);
+    struct d3d12_heap *heap_impl = unsafe_impl_from_ID3D12Heap(heap);
+    struct vkd3d_cs_update_mappings update_mappings = {0};
+    struct vkd3d_cs_op_data *op;
+    struct vkd3d_cs_arena *arena;
+
+    TRACE("iface %p, resource %p, region_count %u, region_start_coordinates %p, "
+            "region_sizes %p, heap %p, range_count %u, range_flags %p, heap_range_offsets %p, "
+            "range_tile_counts %p, flags %#x.\n",
+            iface, resource, region_count, region_start_coordinates, region_sizes, heap, range_count,
+            range_flags, heap_range_offsets, range_tile_counts, flags);
+
+    if (!region_count || !range_count)
+        return;
+
+    if (!command_queue->supports_sparse_binding)
+    {
+        FIXME("Command queue %p does not support sparse binding.\n", command_queue);
+        return;
+    }
+
+    if (!resource_impl->tiles.subresource_count)
+    {
+        WARN("Resource %p is not a tiled resource.\n", resource_impl);
+        return;
+    }
+
+    if (region_count > 1 && !region_start_coordinates)
+    {
+        WARN("Region start coordinates must not be NULL when region count is > 1.\n");
+        return;
+    }
+
+    if (range_count > 1 && !range_tile_counts)
+    {
+        WARN("Range tile counts must not be NULL when range count is > 1.\n");
+        return;
+    }
+
+    update_mappings.resource = resource_impl;
+    update_mappings.heap = heap_impl;
+    update_mappings.region_count = region_count;
+    update_mappings.range_count = range_count;
+    update_mappings.flags = flags;
+
+    vkd3d_mutex_lock(&command_queue->op_mutex);
+
+    /* The arena is owned by the op array and is released once the op has
+     * been executed, so the parameters don't need to be freed here. */
+    arena = &command_queue->op_queue.arena;
+    if (!clone_array_parameter(arena, (void **)&update_mappings.region_start_coordinates,
+            region_start_coordinates, sizeof(*region_start_coordinates), region_count))
+    {
+        ERR("Failed to allocate region start coordinates.\n");
+        goto unlock_mutex;
+    }
+    if (!clone_array_parameter(arena, (void **)&update_mappings.region_sizes,
+            region_sizes, sizeof(*region_sizes), region_count))
+    {
+        ERR("Failed to allocate region sizes.\n");
+        goto unlock_mutex;
+    }
+    if (!clone_array_parameter(arena, (void **)&update_mappings.range_flags,
+            range_flags, sizeof(*range_flags), range_count))
+    {
+        ERR("Failed to allocate range flags.\n");
+        goto unlock_mutex;
+    }
+    if (!clone_array_parameter(arena, (void **)&update_mappings.heap_range_offsets,
+            heap_range_offsets, sizeof(*heap_range_offsets), range_count))
+    {
+        ERR("Failed to allocate heap range offsets.\n");
+        goto unlock_mutex;
+    }
+    if (!clone_array_parameter(arena, (void **)&update_mappings.range_tile_counts,
+            range_tile_counts, sizeof(*range_tile_counts), range_count))
+    {
+        ERR("Failed to allocate range tile counts.\n");
+        goto unlock_mutex;
+    }
+
+    if (!(op = d3d12_command_queue_op_array_require_space(&command_queue->op_queue)))
+    {
+        ERR("Failed to add op.\n");
+        goto unlock_mutex;
+    }
+
+    op->opcode = VKD3D_CS_OP_UPDATE_MAPPINGS;
+    op->u.update_mappings = update_mappings;
+
+    d3d12_command_queue_submit_locked(command_queue);
+
+unlock_mutex:
+    vkd3d_mutex_unlock(&command_queue->op_mutex);
+}
+
+static void STDMETHODCALLTYPE d3d12_command_queue_CopyTileMappings(ID3D12CommandQueue *iface,
+        ID3D12Resource *dst_resource,
+        const D3D12_TILED_RESOURCE_COORDINATE *dst_region_start_coordinate,
+        ID3D12Resource *src_resource,
+        const D3D12_TILED_RESOURCE_COORDINATE *src_region_start_coordinate,
+        const D3D12_TILE_REGION_SIZE *region_size,
+        D3D12_TILE_MAPPING_FLAGS flags)
+{
+    struct d3d12_resource *dst_resource_impl = impl_from_ID3D12Resource(dst_resource);
+    struct d3d12_resource *src_resource_impl = impl_from_ID3D12Resource(src_resource);
+    struct d3d12_command_queue *command_queue = impl_from_ID3D12CommandQueue(iface);
+    struct vkd3d_cs_op_data *op;
+
+    TRACE("iface %p, dst_resource %p, dst_region_start_coordinate %p, "
+            "src_resource %p, src_region_start_coordinate %p, region_size %p, flags %#x.\n",
+            iface, dst_resource, dst_region_start_coordinate, src_resource,
+            src_region_start_coordinate, region_size, flags);
+
+    vkd3d_mutex_lock(&command_queue->op_mutex);
+
+    if (!(op = d3d12_command_queue_op_array_require_space(&command_queue->op_queue)))
+    {
+        ERR("Failed to add op.\n");
+        goto unlock_mutex;
+    }
+    op->opcode = VKD3D_CS_OP_COPY_MAPPINGS;
+    op->u.copy_mappings.dst_resource = dst_resource_impl;
+    op->u.copy_mappings.src_resource = src_resource_impl;
+    op->u.copy_mappings.dst_region_start_coordinate = *dst_region_start_coordinate;
+    op->u.copy_mappings.src_region_start_coordinate = *src_region_start_coordinate;
+    op->u.copy_mappings.region_size = *region_size;
+    op->u.copy_mappings.flags = flags;
+
+    d3d12_command_queue_submit_locked(command_queue);
+
+unlock_mutex:
+    vkd3d_mutex_unlock(&command_queue->op_mutex);
+}
+
+static bool d3d12_command_queue_init_sparse_semaphores(struct d3d12_command_queue *queue)
+{
+    const struct vkd3d_vk_device_procs *vk_procs = &queue->device->vk_procs;
+    struct d3d12_device *device = queue->device;
+    VkSemaphoreCreateInfo semaphore_info;
+    unsigned int i;
+    VkResult vr;
+
+    if (queue->vk_sparse_semaphores[0])
+        return true;
+
+    if (device->vk_info.KHR_timeline_semaphore)
+    {
+        if ((vr = vkd3d_create_timeline_semaphore(device, 0, &queue->vk_sparse_semaphores[0])) < 0)
+        {
+            ERR("Failed to create timeline semaphore, vr %d.\n", vr);
+            return false;
+        }
+        return true;
+    }
+
+    semaphore_info.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+    semaphore_info.pNext = NULL;
+    semaphore_info.flags = 0;
+    for (i = 0; i < ARRAY_SIZE(queue->vk_sparse_semaphores); ++i)
+    {
+        if ((vr = VK_CALL(vkCreateSemaphore(device->vk_device, &semaphore_info,
+                NULL, &queue->vk_sparse_semaphores[i]))) < 0)
+        {
+            ERR("Failed to create semaphore, vr %d.\n", vr);
+            d3d12_command_queue_destroy_sparse_semaphores(queue);
+            memset(queue->vk_sparse_semaphores, 0, sizeof(queue->vk_sparse_semaphores));
+            return false;
+        }
+    }
+
+    return true;
+}
+
+static VkSemaphore d3d12_command_queue_get_sparse_semaphore(const struct d3d12_command_queue *queue,
+        uint64_t value)
+{
+    return queue->vk_sparse_semaphores[queue->device->vk_info.KHR_timeline_semaphore ? 0 : value & 1];
+}
+
+struct vkd3d_sparse_wait
+{
+    VkSemaphore vk_semaphores[2];
+    VkPipelineStageFlags stage_masks[2];
+    uint64_t values[2];
+    VkTimelineSemaphoreSubmitInfoKHR timeline_info;
+};
+
+/* Adds a wait for the last sparse bind to "submit_info", which must wait for
+ * at most one other semaphore, and chain at most a timeline semaphore submit
+ * info. Semaphore waits only order the commands of their own batch, so this
+ * is done for every submission following a bind, instead of submitting an
+ * empty batch which waits. The storage is taken from "wait". The queue must
+ * be acquired; if the submission fails, the device is lost anyway. */
+static void d3d12_command_queue_wait_sparse_binds(struct d3d12_command_queue *queue,
+        VkSubmitInfo *submit_info, struct vkd3d_sparse_wait *wait)
+{
+    VkTimelineSemaphoreSubmitInfoKHR *timeline_info = (VkTimelineSemaphoreSubmitInfoKHR *)submit_info->pNext;
+    unsigned int count = submit_info->waitSemaphoreCount;
+
+    if (!queue->sparse_wait_pending)
+        return;
+
+    VKD3D_ASSERT(count < ARRAY_SIZE(wait->vk_semaphores));
+    if (count)
+    {
+        wait->vk_semaphores[0] = submit_info->pWaitSemaphores[0];
+        wait->stage_masks[0] = submit_info->pWaitDstStageMask[0];
+        wait->values[0] = timeline_info && timeline_info->waitSemaphoreValueCount
+                ? timeline_info->pWaitSemaphoreValues[0] : 0;
+    }
+    wait->vk_semaphores[count] = d3d12_command_queue_get_sparse_semaphore(queue, queue->sparse_semaphore_value);
+    wait->stage_masks[count] = VK_PIPELINE_STAGE_ALL_COMMANDS_BIT;
+    wait->values[count] = queue->sparse_semaphore_value;
+
+    submit_info->waitSemaphoreCount = count + 1;
+    submit_info->pWaitSemaphores = wait->vk_semaphores;
+    submit_info->pWaitDstStageMask = wait->stage_masks;
+
+    if (queue->device->vk_info.KHR_timeline_semaphore)
+    {
+        if (!timeline_info)
+        {
+            timeline_info = &wait->timeline_info;
+            memset(timeline_info, 0, sizeof(*timeline_info));
+            timeline_info->sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO_KHR;
+            submit_info->pNext = timeline_info;
+        }
+        VKD3D_ASSERT(timeline_info->sType == VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO_KHR);
+        timeline_info->waitSemaphoreValueCount = count + 1;
+        timeline_info->pWaitSemaphoreValues = wait->values;
+    }
+
+    queue->sparse_wait_pending = false;
+}
+
+/* Signals the sparse semaphore with an empty submission, for binds which
+ * don't follow a submission which already did. Unlike those of
+ * vkQueueBindSparse(), semaphore signal operations in vkQueueSubmit() are
+ * ordered against all earlier submissions to the queue. */
+static VkResult d3d12_command_queue_signal_sparse_semaphore(struct d3d12_command_queue *queue, VkQueue vk_queue)
+{
+    const struct vkd3d_vk_device_procs *vk_procs = &queue->device->vk_procs;
+    VkTimelineSemaphoreSubmitInfoKHR timeline_submit_info;
+    uint64_t value = queue->sparse_semaphore_value + 1;
+    VkSemaphore vk_semaphore;
+    VkSubmitInfo submit_info;
+    VkResult vr;
+
+    vk_semaphore = d3d12_command_queue_get_sparse_semaphore(queue, value);
+
+    memset(&submit_info, 0, sizeof(submit_info));
+    submit_info.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+    submit_info.signalSemaphoreCount = 1;
+    submit_info.pSignalSemaphores = &vk_semaphore;
+
+    if (queue->device->vk_info.KHR_timeline_semaphore)
+    {
+        memset(&timeline_submit_info, 0, sizeof(timeline_submit_info));
+        timeline_submit_info.sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO_KHR;
+        timeline_submit_info.signalSemaphoreValueCount = 1;
+        timeline_submit_info.pSignalSemaphoreValues = &value;
+        submit_info.pNext = &timeline_submit_info;
+    }
+
+    if ((vr = VK_CALL(vkQueueSubmit(vk_queue, 1, &submit_info, VK_NULL_HANDLE))) < 0)
+        return vr;
+
+    d3d12_device_add_statistic(queue->device, vk_queue_submit_count, 1);
+    queue->sparse_semaphore_value = value;
+    queue->sparse_wait_pending = true;
+
+    return vr;
+}
+
+/* If "signal_sparse" is set, the submission also signals the sparse
+ * semaphore for the mapping updates which follow it. */
+static void d3d12_command_queue_execute(struct d3d12_command_queue *command_queue,
+        VkCommandBuffer *buffers, unsigned int count, bool signal_sparse)
+{
+    const struct vkd3d_vk_device_procs *vk_procs = &command_queue->device->vk_procs;
+    struct vkd3d_queue *vkd3d_queue = command_queue->vkd3d_queue;
+    VkTimelineSemaphoreSubmitInfoKHR timeline_submit_info;
+    struct vkd3d_sparse_wait sparse_wait;
+    VkSemaphore vk_sparse_semaphore;
+    uint64_t sparse_value = 0;
+    VkSubmitInfo submit_desc;
+    VkQueue vk_queue;
+    VkResult vr;
+
+    memset(&submit_desc, 0, sizeof(submit_desc));
+
+    if (signal_sparse && !d3d12_command_queue_init_sparse_semaphores(command_queue))
+        signal_sparse = false;
+
+    if (!(vk_queue = vkd3d_queue_acquire(vkd3d_queue)))
+    {
+        ERR("Failed to acquire queue %p.\n", vkd3d_queue);
+        return;
+    }
+
+    submit_desc.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+    submit_desc.commandBufferCount = count;
+    submit_desc.pCommandBuffers = buffers;
+
+    if (signal_sparse)
+    {
+        sparse_value = command_queue->sparse_semaphore_value + 1;
+        vk_sparse_semaphore = d3d12_command_queue_get_sparse_semaphore(command_queue, sparse_value);
+        submit_desc.signalSemaphoreCount = 1;
+        submit_desc.pSignalSemaphores = &vk_sparse_semaphore;
+
+        if (command_queue->device->vk_info.KHR_timeline_semaphore)
+        {
+            memset(&timeline_submit_info, 0, sizeof(timeline_submit_info));
+            timeline_submit_info.sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO_KHR;
+            timeline_submit_info.signalSemaphoreValueCount = 1;
+            timeline_submit_info.pSignalSemaphoreValues = &sparse_value;
+            submit_desc.pNext = &timeline_submit_info;
+        }
+    }
+    d3d12_command_queue_wait_sparse_binds(command_queue, &submit_desc, &sparse_wait);
+
+    if ((vr = VK_CALL(vkQueueSubmit(vk_queue, 1, &submit_desc, VK_NULL_HANDLE))) < 0)
+    {
+        ERR("Failed to submit queue(s), vr %d.\n", vr);
+    }
+    else
+    {
+        d3d12_device_add_statistic(command_queue->device, vk_queue_submit_count, 1);
+        if (signal_sparse)
+        {
+            command_queue->sparse_semaphore_value = sparse_value;
+            command_queue->sparse_wait_pending = true;
+        }
+    }
+
+    vkd3d_queue_release(vkd3d_queue);
+
+    d3d12_device_dump_statistics(command_queue->device);
+}
+
+static void d3d12_command_queue_label(struct d3d12_command_queue *command_queue, const struct vkd3d_cs_op_data *op)
+{
+    const struct vkd3d_vk_device_procs *vk_procs = &command_queue->device->vk_procs;
+    struct vkd3d_queue *vkd3d_queue = command_queue->vkd3d_queue;
+    VkDebugUtilsLabelEXT label;
+    VkQueue vk_queue;
+
+    if (!(vk_queue = vkd3d_queue_acquire(vkd3d_queue)))
+    {
+        ERR("Failed to acquire queue %p.\n", vkd3d_queue);
+        return;
+    }
+
+    vk_debug_utils_label_init(&label, op->u.label.name);
+    if (op->opcode == VKD3D_CS_OP_BEGIN_LABEL)
+        VK_CALL(vkQueueBeginDebugUtilsLabelEXT(vk_queue, &label));
+    else if (op->opcode == VKD3D_CS_OP_END_LABEL)
+        VK_CALL(vkQueueEndDebugUtilsLabelEXT(vk_queue));
+    else
+        VK_CALL(vkQueueInsertDebugUtilsLabelEXT(vk_queue, &label));
+
+    vkd3d_queue_release(vkd3d_queue);
+}
+
+static bool vkd3d_sparse_bind_arrays_add_memory_bind(struct vkd3d_sparse_bind_arrays *binds,
+        size_t first_bind, VkDeviceSize resource_offset, VkDeviceMemory vk_memory, VkDeviceSize memory_offset)
+{
+    VkSparseMemoryBind *bind;
+
+    /* Merge with the previous bind if both ranges are contiguous. */
+    if (binds->memory_bind_count > first_bind)
+    {
+        bind = &binds->memory_binds[binds->memory_bind_count - 1];
+        if (bind->memory == vk_memory && bind->resourceOffset + bind->size == resource_offset
+                && (!vk_memory || bind->memoryOffset + bind->size == memory_offset))
+        {
+            bind->size += D3D12_TILED_RESOURCE_TILE_SIZE_IN_BYTES;
+            return true;
+        }
+    }
+
+    if (!vkd3d_array_reserve((void **)&binds->memory_binds, &binds->memory_binds_size,
+            binds->memory_bind_count + 1, sizeof(*binds->memory_binds)))
+        return false;
+
+    bind = &binds->memory_binds[binds->memory_bind_count++];
+    bind->resourceOffset = resource_offset;
+    bind->size = D3D12_TILED_RESOURCE_TILE_SIZE_IN_BYTES;
+    bind->memory = vk_memory;
+    bind->memoryOffset = vk_memory ? memory_offset : 0;
+    bind->flags = 0;
+
+    return true;
+}
+
+static bool vkd3d_sparse_bind_arrays_add_image_bind(struct vkd3d_sparse_bind_arrays *binds,
+        const struct d3d12_resource *resource, unsigned int subresource, unsigned int tile_idx,
+        VkDeviceMemory vk_memory, VkDeviceSize memory_offset)
 {
-    void *buffer;
+    const struct vkd3d_subresource_tile_info *tile_info = &resource->tiles.subresources[subresource];
+    const VkExtent3D *tile_extent = &resource->tiles.tile_extent;
+    unsigned int miplevel_idx = subresource % resource->desc.MipLevels;
+    VkSparseImageMemoryBind *bind;
+
+    if (!vkd3d_array_reserve((void **)&binds->image_binds, &binds->image_binds_size,
+            binds->image_bind_count + 1, sizeof(*binds->image_binds)))
+        return false;
+
+    bind = &binds->image_binds[binds->image_bind_count++];
+    bind->subresource.aspectMask = resource->format->vk_aspect_mask;
+    bind->subresource.mipLevel = miplevel_idx;
+    bind->subresource.arrayLayer = subresource / resource->desc.MipLevels;
+    bind->offset.x = (tile_idx % tile_info->extent.width) * tile_extent->width;
+    bind->offset.y = (tile_idx / tile_info->extent.width % tile_info->extent.height) * tile_extent->height;
+    bind->offset.z = (tile_idx / (tile_info->extent.width * tile_info->extent.height)) * tile_extent->depth;
+    /* Tiles on the edge of the subresource are clamped to its extent. */
+    bind->extent.width = min(tile_extent->width,
+            d3d12_resource_desc_get_width(&resource->desc, miplevel_idx) - bind->offset.x);
+    bind->extent.height = min(tile_extent->height,
+            d3d12_resource_desc_get_height(&resource->desc, miplevel_idx) - bind->offset.y);
+    bind->extent.depth = min(tile_extent->depth,
+            d3d12_resource_desc_get_depth(&resource->desc, miplevel_idx) - bind->offset.z);
+    bind->memory = vk_memory;
+    bind->memoryOffset = vk_memory ? memory_offset : 0;
+    bind->flags = 0;
 
-    *dst = NULL;
-    if (src)
-    {
-        if (!(buffer = vkd3d_calloc(count, elem_size)))
-            return false;
-        memcpy(buffer, src, count * elem_size);
-        *dst = buffer;
-    }
     return true;
 }
 
-static void update_mappings_cleanup(struct vkd3d_cs_update_mappings *update_mappings)
+static unsigned int d3d12_resource_get_subresource_tile_count(const struct d3d12_resource *resource,
+        unsigned int subresource)
 {
-    vkd3d_free(update_mappings->region_start_coordinates);
-    vkd3d_free(update_mappings->region_sizes);
-    vkd3d_free(update_mappings->range_flags);
-    vkd3d_free(update_mappings->heap_range_offsets);
-    vkd3d_free(update_mappings->range_tile_counts);
+    unsigned int miplevel_idx = subresource % resource->desc.MipLevels;
+
+    if (miplevel_idx < resource->tiles.standard_mip_count)
+        return resource->tiles.subresources[subresource].count;
+    /* Packed mips are addressed through the first packed mip level. */
+    if (miplevel_idx == resource->tiles.standard_mip_count)
+        return resource->tiles.packed_mip_tile_count;
+    return 0;
 }
 
-static void STDMETHODCALLTYPE d3d12_command_queue_UpdateTileMappings(ID3D12CommandQueue *iface,
-        ID3D12Resource *resource, UINT region_count,
-        const D3D12_TILED_RESOURCE_COORDINATE *region_start_coordinates, const D3D12_TILE_REGION_SIZE *region_sizes,
-        ID3D12Heap *heap, UINT range_count, const D3D12_TILE_RANGE_FLAGS *range_flags,
-        const UINT *heap_range_offsets, const UINT *range_tile_counts, D3D12_TILE_MAPPING_FLAGS flags)
+static bool vkd3d_sparse_bind_arrays_add_tile_bind(struct vkd3d_sparse_bind_arrays *binds,
+        const struct d3d12_resource *resource, size_t first_memory_bind, unsigned int subresource,
+        unsigned int tile_idx, VkDeviceMemory vk_memory, VkDeviceSize memory_offset)
 {
-    struct d3d12_resource *resource_impl = unsafe_impl_from_ID3D12Resource(resource);
-    struct d3d12_command_queue *command_queue = impl_from_ID3D12CommandQueue(iface);
-    struct d3d12_heap *heap_impl = unsafe_impl_from_ID3D12Heap(heap);
-    struct vkd3d_cs_update_mappings update_mappings = {0};
-    struct vkd3d_cs_op_data *op;
+    VkDeviceSize resource_offset;
+    unsigned int layer;
 
-    TRACE("iface %p, resource %p, region_count %u, region_start_coordinates %p, "
-            "region_sizes %p, heap %p, range_count %u, range_flags %p, heap_range_offsets %p, "
-            "range_tile_counts %p, flags %#x.\n",
-            iface, resource, region_count, region_start_coordinates, region_sizes, heap, range_count,
-            range_flags, heap_range_offsets, range_tile_counts, flags);
+    if (d3d12_resource_is_buffer(resource))
+        return vkd3d_sparse_bind_arrays_add_memory_bind(binds, first_memory_bind,
+                (VkDeviceSize)tile_idx * D3D12_TILED_RESOURCE_TILE_SIZE_IN_BYTES, vk_memory, memory_offset);
 
-    if (!region_count || !range_count)
-        return;
+    if (subresource % resource->desc.MipLevels < resource->tiles.standard_mip_count)
+        return vkd3d_sparse_bind_arrays_add_image_bind(binds, resource, subresource, tile_idx,
+                vk_memory, memory_offset);
 
-    if (!command_queue->supports_sparse_binding)
-    {
-        FIXME("Command queue %p does not support sparse binding.\n", command_queue);
-        return;
-    }
+    /* The mip tail is bound as opaque memory. */
+    layer = subresource / resource->desc.MipLevels;
+    resource_offset = resource->tiles.mip_tail_offset + layer * resource->tiles.mip_tail_stride
+            + (VkDeviceSize)tile_idx * D3D12_TILED_RESOURCE_TILE_SIZE_IN_BYTES;
+    return vkd3d_sparse_bind_arrays_add_memory_bind(binds, first_memory_bind, resource_offset,
+            vk_memory, memory_offset);
+}
 
-    if (!resource_impl->tiles.subresource_count)
-    {
-        WARN("Resource %p is not a tiled resource.\n", resource_impl);
-        return;
-    }
+struct vkd3d_tile_range_cursor
+{
+    const struct vkd3d_cs_update_mappings *update_mappings;
+    unsigned int range_idx;
+    unsigned int tile_idx;
+};
 
-    if (region_count > 1 && !region_start_coordinates)
-    {
-        WARN("Region start coordinates must not be NULL when region count is > 1.\n");
-        return;
-    }
+/* Returns false once all ranges have been consumed. */
+static bool vkd3d_tile_range_cursor_next(struct vkd3d_tile_range_cursor *cursor,
+        VkDeviceMemory *vk_memory, VkDeviceSize *memory_offset, bool *skip)
+{
+    const struct vkd3d_cs_update_mappings *update_mappings = cursor->update_mappings;
+    D3D12_TILE_RANGE_FLAGS flags;
+    unsigned int heap_offset;
 
-    if (range_count > 1 && !range_tile_counts)
+    while (update_mappings->range_tile_counts
+            && cursor->range_idx < update_mappings->range_count
+            && cursor->tile_idx >= update_mappings->range_tile_counts[cursor->range_idx])
     {
-        WARN("Range tile counts must not be NULL when range count is > 1.\n");
-        return;
+        ++cursor->range_idx;
+        cursor->tile_idx = 0;
     }
+    if (cursor->range_idx >= update_mappings->range_count)
+        return false;
 
-    update_mappings.resource = resource_impl;
-    update_mappings.heap = heap_impl;
-    if (!clone_array_parameter((void **)&update_mappings.region_start_coordinates,
-            region_start_coordinates, sizeof(*region_start_coordinates), region_count))
+    flags = update_mappings->range_flags ? update_mappings->range_flags[cursor->range_idx] : 0;
+    heap_offset = update_mappings->heap_range_offsets ? update_mappings->heap_range_offsets[cursor->range_idx] : 0;
+    if (!(flags & D3D12_TILE_RANGE_FLAG_REUSE_SINGLE_TILE))
+        heap_offset += cursor->tile_idx;
+    ++cursor->tile_idx;
+
+    *skip = !!(flags & D3D12_TILE_RANGE_FLAG_SKIP);
+    if ((flags & D3D12_TILE_RANGE_FLAG_NULL) || !update_mappings->heap)
     {
-        ERR("Failed to allocate region start coordinates.\n");
-        return;
+        *vk_memory = VK_NULL_HANDLE;
+        *memory_offset = 0;
     }
-    if (!clone_array_parameter((void **)&update_mappings.region_sizes,
-            region_sizes, sizeof(*region_sizes), region_count))
+    else
     {
-        ERR("Failed to allocate region sizes.\n");
-        goto free_clones;
+        *vk_memory = update_mappings->heap->vk_memory;
+        *memory_offset = (VkDeviceSize)heap_offset * D3D12_TILED_RESOURCE_TILE_SIZE_IN_BYTES;
     }
-    if (!clone_array_parameter((void **)&update_mappings.range_flags,
-            range_flags, sizeof(*range_flags), range_count))
+
+    return true;
+}
+
+static bool vkd3d_sparse_bind_arrays_add_update_mappings(struct vkd3d_sparse_bind_arrays *binds,
+        const struct vkd3d_cs_update_mappings *update_mappings)
+{
+    static const D3D12_TILED_RESOURCE_COORDINATE zero_coordinate;
+    static const D3D12_TILE_REGION_SIZE single_tile = {1};
+    const struct d3d12_resource *resource = update_mappings->resource;
+    unsigned int region_idx, subresource, tile_idx, x, y, z;
+    const struct vkd3d_subresource_tile_info *tile_info;
+    const D3D12_TILED_RESOURCE_COORDINATE *coordinate;
+    size_t first_memory_bind = binds->memory_bind_count;
+    struct vkd3d_tile_range_cursor cursor = {0};
+    const D3D12_TILE_REGION_SIZE *region_size;
+    VkDeviceSize memory_offset;
+    VkDeviceMemory vk_memory;
+    unsigned int i, count;
+    bool skip;
+
+    cursor.update_mappings = update_mappings;
+
+    for (region_idx = 0; region_idx < update_mappings->region_count; ++region_idx)
     {
-        ERR("Failed to allocate range flags.\n");
-        goto free_clones;
+        coordinate = update_mappings->region_start_coordinates
+                ? &update_mappings->region_start_coordinates[region_idx] : &zero_coordinate;
+        region_size = update_mappings->region_sizes ? &update_mappings->region_sizes[region_idx] : &single_tile;
+
+        if ((subresource = coordinate->Subresource) >= resource->tiles.subresource_count)
+        {
+            WARN("Invalid subresource %u.\n", subresource);
+            continue;
+        }
+        tile_info = &resource->tiles.subresources[subresource];
+        tile_idx = coordinate->X + tile_info->extent.width * (coordinate->Y + tile_info->extent.height * coordinate->Z);
+
+        if (region_size->UseBox)
+        {
+            for (z = 0; z < region_size->Depth; ++z)
+            {
+                for (y = 0; y < region_size->Height; ++y)
+                {
+                    for (x = 0; x < region_size->Width; ++x)
+                    {
+                        if (!vkd3d_tile_range_cursor_next(&cursor, &vk_memory, &memory_offset, &skip))
+                            return true;
+                        if (skip)
+                            continue;
+                        if (!vkd3d_sparse_bind_arrays_add_tile_bind(binds, resource, first_memory_bind, subresource,
+                                tile_idx + x + tile_info->extent.width * (y + tile_info->extent.height * z),
+                                vk_memory, memory_offset))
+                            return false;
+                    }
+                }
+            }
+            continue;
+        }
+
+        /* Without a box the region runs through the tiles in order, and
+         * may continue into the following subresources. */
+        count = d3d12_resource_get_subresource_tile_count(resource, subresource);
+        for (i = 0; i < region_size->NumTiles; ++i, ++tile_idx)
+        {
+            while (tile_idx >= count)
+            {
+                if (++subresource >= resource->tiles.subresource_count)
+                {
+                    WARN("Region %u exceeds the resource size.\n", region_idx);
+                    return true;
+                }
+                count = d3d12_resource_get_subresource_tile_count(resource, subresource);
+                tile_idx = 0;
+            }
+
+            if (!vkd3d_tile_range_cursor_next(&cursor, &vk_memory, &memory_offset, &skip))
+                return true;
+            if (skip)
+                continue;
+            if (!vkd3d_sparse_bind_arrays_add_tile_bind(binds, resource, first_memory_bind, subresource,
+                    tile_idx, vk_memory, memory_offset))
+                return false;
+        }
     }
-    if (!clone_array_parameter((void **)&update_mappings.heap_range_offsets,
-            heap_range_offsets, sizeof(*heap_range_offsets), range_count))
+
+    return true;
+}
+
+static bool vkd3d_sparse_bind_arrays_add_bind_info(struct vkd3d_sparse_bind_arrays *binds,
+        const struct d3d12_resource *resource, size_t first_memory_bind, size_t first_image_bind)
+{
+    size_t memory_bind_count = binds->memory_bind_count - first_memory_bind;
+    size_t image_bind_count = binds->image_bind_count - first_image_bind;
+    size_t idx = binds->bind_info_count;
+    VkBindSparseInfo *bind_info;
+
+    if (!memory_bind_count && !image_bind_count)
+        return true;
+
+    if (!vkd3d_array_reserve((void **)&binds->bind_infos, &binds->bind_infos_size,
+            idx + 1, sizeof(*binds->bind_infos))
+            || !vkd3d_array_reserve((void **)&binds->buffer_infos, &binds->buffer_infos_size,
+            idx + 1, sizeof(*binds->buffer_infos))
+            || !vkd3d_array_reserve((void **)&binds->opaque_infos, &binds->opaque_infos_size,
+            idx + 1, sizeof(*binds->opaque_infos))
+            || !vkd3d_array_reserve((void **)&binds->image_infos, &binds->image_infos_size,
+            idx + 1, sizeof(*binds->image_infos)))
+        return false;
+
+    /* The bind array pointers are filled in before submission, since the
+     * arrays may still be reallocated. */
+    bind_info = &binds->bind_infos[idx];
+    memset(bind_info, 0, sizeof(*bind_info));
+    bind_info->sType = VK_STRUCTURE_TYPE_BIND_SPARSE_INFO;
+
+    if (d3d12_resource_is_buffer(resource))
     {
-        ERR("Failed to allocate heap range offsets.\n");
-        goto free_clones;
+        binds->buffer_infos[idx].buffer = resource->u.vk_buffer;
+        binds->buffer_infos[idx].bindCount = memory_bind_count;
+        bind_info->bufferBindCount = 1;
     }
-    if (!clone_array_parameter((void **)&update_mappings.range_tile_counts,
-            range_tile_counts, sizeof(*range_tile_counts), range_count))
+    else
     {
-        ERR("Failed to allocate range tile counts.\n");
-        goto free_clones;
+        binds->opaque_infos[idx].image = resource->u.vk_image;
+        binds->opaque_infos[idx].bindCount = memory_bind_count;
+        bind_info->imageOpaqueBindCount = !!memory_bind_count;
+        binds->image_infos[idx].image = resource->u.vk_image;
+        binds->image_infos[idx].bindCount = image_bind_count;
+        bind_info->imageBindCount = !!image_bind_count;
     }
-    update_mappings.region_count = region_count;
-    update_mappings.range_count = range_count;
-    update_mappings.flags = flags;
-
-    vkd3d_mutex_lock(&command_queue->op_mutex);
 
-    if (!(op = d3d12_command_queue_op_array_require_space(&command_queue->op_queue)))
-    {
-        ERR("Failed to add op.\n");
-        goto unlock_mutex;
-    }
+    ++binds->bind_info_count;
 
-    op->opcode = VKD3D_CS_OP_UPDATE_MAPPINGS;
-    op->u.update_mappings = update_mappings;
+    return true;
+}
 
-    d3d12_command_queue_submit_locked(command_queue);
+static void vkd3d_sparse_bind_arrays_finalise(struct vkd3d_sparse_bind_arrays *binds)
+{
+    size_t i, memory_bind_idx = 0, image_bind_idx = 0;
+    VkBindSparseInfo *bind_info;
 
-    vkd3d_mutex_unlock(&command_queue->op_mutex);
-    return;
+    for (i = 0; i < binds->bind_info_count; ++i)
+    {
+        bind_info = &binds->bind_infos[i];
 
-unlock_mutex:
-    vkd3d_mutex_unlock(&command_queue->op_mutex);
-free_clones:
-    update_mappings_cleanup(&update_mappings);
+        if (bind_info->bufferBindCount)
+        {
+            binds->buffer_infos[i].pBinds = &binds->memory_binds[memory_bind_idx];
+            memory_bind_idx += binds->buffer_infos[i].bindCount;
+            bind_info->pBufferBinds = &binds->buffer_infos[i];
+        }
+        if (bind_info->imageOpaqueBindCount)
+        {
+            binds->opaque_infos[i].pBinds = &binds->memory_binds[memory_bind_idx];
+            memory_bind_idx += binds->opaque_infos[i].bindCount;
+            bind_info->pImageOpaqueBinds = &binds->opaque_infos[i];
+        }
+        if (bind_info->imageBindCount)
+        {
+            binds->image_infos[i].pBinds = &binds->image_binds[image_bind_idx];
+            image_bind_idx += binds->image_infos[i].bindCount;
+            bind_info->pImageBinds = &binds->image_infos[i];
+        }
+    }
 }
 
-static void STDMETHODCALLTYPE d3d12_command_queue_CopyTileMappings(ID3D12CommandQueue *iface,
-        ID3D12Resource *dst_resource,
-        const D3D12_TILED_RESOURCE_COORDINATE *dst_region_start_coordinate,
-        ID3D12Resource *src_resource,
-        const D3D12_TILED_RESOURCE_COORDINATE *src_region_start_coordinate,
-        const D3D12_TILE_REGION_SIZE *region_size,
-        D3D12_TILE_MAPPING_FLAGS flags)
+/* Batches of a single vkQueueBindSparse() call may complete in any order, so
+ * chain them through the sparse semaphores, starting from the pending
+ * signal. */
+static bool d3d12_command_queue_chain_sparse_binds(struct d3d12_command_queue *queue)
 {
-    struct d3d12_resource *dst_resource_impl = impl_from_ID3D12Resource(dst_resource);
-    struct d3d12_resource *src_resource_impl = impl_from_ID3D12Resource(src_resource);
-    struct d3d12_command_queue *command_queue = impl_from_ID3D12CommandQueue(iface);
-    struct vkd3d_cs_op_data *op;
+    struct vkd3d_sparse_bind_arrays *binds = &queue->sparse_binds;
+    bool timeline = queue->device->vk_info.KHR_timeline_semaphore;
+    size_t i, count = binds->bind_info_count;
+    VkTimelineSemaphoreSubmitInfoKHR *info;
+    VkBindSparseInfo *bind_info;
 
-    TRACE("iface %p, dst_resource %p, dst_region_start_coordinate %p, "
-            "src_resource %p, src_region_start_coordinate %p, region_size %p, flags %#x.\n",
-            iface, dst_resource, dst_region_start_coordinate, src_resource,
-            src_region_start_coordinate, region_size, flags);
+    if (!vkd3d_array_reserve((void **)&binds->timeline_infos, &binds->timeline_infos_size,
+            count, sizeof(*binds->timeline_infos))
+            || !vkd3d_array_reserve((void **)&binds->semaphore_values, &binds->semaphore_values_size,
+            count + 1, sizeof(*binds->semaphore_values)))
+        return false;
 
-    vkd3d_mutex_lock(&command_queue->op_mutex);
+    for (i = 0; i <= count; ++i)
+        binds->semaphore_values[i] = queue->sparse_semaphore_value + i;
 
-    if (!(op = d3d12_command_queue_op_array_require_space(&command_queue->op_queue)))
+    for (i = 0; i < count; ++i)
     {
-        ERR("Failed to add op.\n");
-        goto unlock_mutex;
-    }
-    op->opcode = VKD3D_CS_OP_COPY_MAPPINGS;
-    op->u.copy_mappings.dst_resource = dst_resource_impl;
-    op->u.copy_mappings.src_resource = src_resource_impl;
-    op->u.copy_mappings.dst_region_start_coordinate = *dst_region_start_coordinate;
-    op->u.copy_mappings.src_region_start_coordinate = *src_region_start_coordinate;
-    op->u.copy_mappings.region_size = *region_size;
-    op->u.copy_mappings.flags = flags;
+        bind_info = &binds->bind_infos[i];
+        bind_info->waitSemaphoreCount = 1;
+        bind_info->pWaitSemaphores = &queue->vk_sparse_semaphores[timeline ? 0 : binds->semaphore_values[i] & 1];
+        bind_info->signalSemaphoreCount = 1;
+        bind_info->pSignalSemaphores = &queue->vk_sparse_semaphores[timeline ? 0 : binds->semaphore_values[i + 1] & 1];
 
-    d3d12_command_queue_submit_locked(command_queue);
+        if (!timeline)
+            continue;
 
-unlock_mutex:
-    vkd3d_mutex_unlock(&command_queue->op_mutex);
+        info = &binds->timeline_infos[i];
+        info->sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO_KHR;
+        info->pNext = NULL;
+        info->waitSemaphoreValueCount = 1;
+        info->pWaitSemaphoreValues = &binds->semaphore_values[i];
+        info->signalSemaphoreValueCount = 1;
+        info->pSignalSemaphoreValues = &binds->semaphore_values[i + 1];
+        bind_info->pNext = info;
+    }
+
+    return true;
 }
 
-static void d3d12_command_queue_execute(struct d3d12_command_queue *command_queue,
-        VkCommandBuffer *buffers, unsigned int count)
+/* Translates "count" consecutive mapping updates into a single
+ * vkQueueBindSparse() call. Each update gets its own batch, and the batches
+ * are chained through the sparse semaphores, so that the updates are applied
+ * in queue order. The chain starts from the signal of the preceding
+ * submission, and the next submission waits for its end. */
+static void d3d12_command_queue_update_mappings(struct d3d12_command_queue *command_queue,
+        const struct vkd3d_cs_op_data *ops, unsigned int count)
 {
     const struct vkd3d_vk_device_procs *vk_procs = &command_queue->device->vk_procs;
+    struct vkd3d_sparse_bind_arrays *binds = &command_queue->sparse_binds;
     struct vkd3d_queue *vkd3d_queue = command_queue->vkd3d_queue;
-    VkSubmitInfo submit_desc;
+    const struct vkd3d_cs_update_mappings *update_mappings;
+    size_t first_memory_bind, first_image_bind;
+    unsigned int i;
     VkQueue vk_queue;
     VkResult vr;
 
-    memset(&submit_desc, 0, sizeof(submit_desc));
+    binds->memory_bind_count = 0;
+    binds->image_bind_count = 0;
+    binds->bind_info_count = 0;
+
+    for (i = 0; i < count; ++i)
+    {
+        update_mappings = &ops[i].u.update_mappings;
+
+        first_memory_bind = binds->memory_bind_count;
+        first_image_bind = binds->image_bind_count;
+        if (!vkd3d_sparse_bind_arrays_add_update_mappings(binds, update_mappings)
+                || !vkd3d_sparse_bind_arrays_add_bind_info(binds, update_mappings->resource,
+                first_memory_bind, first_image_bind))
+        {
+            ERR("Failed to allocate sparse binds.\n");
+            return;
+        }
+    }
+
+    if (!binds->bind_info_count)
+        return;
+
+    vkd3d_sparse_bind_arrays_finalise(binds);
+    if (!d3d12_command_queue_init_sparse_semaphores(command_queue))
+    {
+        ERR("Failed to set up sparse bind synchronisation.\n");
+        return;
+    }
+
+    TRACE("Binding %zu memory and %zu image ranges in %zu batches.\n",
+            binds->memory_bind_count, binds->image_bind_count, binds->bind_info_count);
 
     if (!(vk_queue = vkd3d_queue_acquire(vkd3d_queue)))
     {
@@ -6827,12 +9059,26 @@ static void d3d12_command_queue_execute(struct d3d12_command_queue *command_queu
         return;
     }
 
-    submit_desc.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
-    submit_desc.commandBufferCount = count;
-    submit_desc.pCommandBuffers = buffers;
+    if (!command_queue->sparse_wait_pending
+            && (vr = d3d12_command_queue_signal_sparse_semaphore(command_queue, vk_queue)) < 0)
+    {
+        ERR("Failed to signal sparse semaphore, vr %d.\n", vr);
+        vkd3d_queue_release(vkd3d_queue);
+        return;
+    }
 
-    if ((vr = VK_CALL(vkQueueSubmit(vk_queue, 1, &submit_desc, VK_NULL_HANDLE))) < 0)
-        ERR("Failed to submit queue(s), vr %d.\n", vr);
+    if (!d3d12_command_queue_chain_sparse_binds(command_queue))
+    {
+        ERR("Failed to set up sparse bind synchronisation.\n");
+        vkd3d_queue_release(vkd3d_queue);
+        return;
+    }
+
+    /* On failure the pending signal is left for the next submission. */
+    if ((vr = VK_CALL(vkQueueBindSparse(vk_queue, binds->bind_info_count, binds->bind_infos, VK_NULL_HANDLE))) < 0)
+        ERR("Failed to bind sparse memory, vr %d.\n", vr);
+    else
+        command_queue->sparse_semaphore_value = binds->semaphore_values[binds->bind_info_count];
 
     vkd3d_queue_release(vkd3d_queue);
 }
@@ -6856,6 +9102,7 @@ static void STDMETHODCALLTYPE d3d12_command_queue_ExecuteCommandLists(ID3D12Comm
     struct d3d12_command_list *cmd_list;
     struct vkd3d_cs_op_data *op;
     VkCommandBuffer *buffers;
+    uint64_t trace_start;
     unsigned int i;
 
     TRACE("iface %p, command_list_count %u, command_lists %p.\n",
@@ -6864,6 +9111,8 @@ static void STDMETHODCALLTYPE d3d12_command_queue_ExecuteCommandLists(ID3D12Comm
     if (!command_list_count)
         return;
 
+    trace_start = vkd3d_trace_span_begin();
+
     if (!(buffers = vkd3d_calloc(command_list_count, sizeof(*buffers))))
     {
         ERR("Failed to allocate command buffer array.\n");
@@ -6882,6 +9131,16 @@ static void STDMETHODCALLTYPE d3d12_command_queue_ExecuteCommandLists(ID3D12Comm
             return;
         }
 
+        d3d12_command_list_wait_translation(cmd_list);
+
+        if (cmd_list->deferred.enabled && !cmd_list->is_valid)
+        {
+            d3d12_device_mark_as_removed(command_queue->device, DXGI_ERROR_INVALID_CALL,
+                    "Command list %p failed to translate.", command_lists[i]);
+            vkd3d_free(buffers);
+            return;
+        }
+
         command_list_flush_vk_heap_updates(cmd_list);
 
         buffers[i] = cmd_list->vk_command_buffer;
@@ -6902,26 +9161,76 @@ static void STDMETHODCALLTYPE d3d12_command_queue_ExecuteCommandLists(ID3D12Comm
 
 done:
     vkd3d_mutex_unlock(&command_queue->op_mutex);
-    return;
+    vkd3d_trace_span_end("ExecuteCommandLists", trace_start);
+}
+
+static void d3d12_command_queue_add_label(struct d3d12_command_queue *command_queue,
+        enum vkd3d_cs_op opcode, UINT metadata, const void *data, UINT size)
+{
+    struct vkd3d_cs_op_data *op;
+    char *name = NULL;
+
+    if (!command_queue->device->vk_info.EXT_debug_utils)
+        return;
+
+    if (opcode != VKD3D_CS_OP_END_LABEL)
+        name = vkd3d_strdup_marker(metadata, data, size, command_queue->device->wchar_size);
+
+    vkd3d_mutex_lock(&command_queue->op_mutex);
+
+    if (!(op = d3d12_command_queue_op_array_require_space(&command_queue->op_queue)))
+    {
+        ERR("Failed to add op.\n");
+        vkd3d_free(name);
+        goto done;
+    }
+    op->opcode = opcode;
+    op->u.label.name = name;
+
+    d3d12_command_queue_submit_locked(command_queue);
+
+done:
+    vkd3d_mutex_unlock(&command_queue->op_mutex);
 }
 
 static void STDMETHODCALLTYPE d3d12_command_queue_SetMarker(ID3D12CommandQueue *iface,
         UINT metadata, const void *data, UINT size)
 {
-    FIXME("iface %p, metadata %#x, data %p, size %u stub!\n",
+    struct d3d12_command_queue *command_queue = impl_from_ID3D12CommandQueue(iface);
+
+    TRACE("iface %p, metadata %#x, data %p, size %u.\n",
             iface, metadata, data, size);
+
+    if (vkd3d_trace_enabled)
+        vkd3d_trace_marker('i', metadata, data, size, command_queue->device->wchar_size);
+
+    d3d12_command_queue_add_label(command_queue, VKD3D_CS_OP_INSERT_LABEL, metadata, data, size);
 }
 
 static void STDMETHODCALLTYPE d3d12_command_queue_BeginEvent(ID3D12CommandQueue *iface,
         UINT metadata, const void *data, UINT size)
 {
-    FIXME("iface %p, metadata %#x, data %p, size %u stub!\n",
+    struct d3d12_command_queue *command_queue = impl_from_ID3D12CommandQueue(iface);
+
+    TRACE("iface %p, metadata %#x, data %p, size %u.\n",
             iface, metadata, data, size);
+
+    if (vkd3d_trace_enabled)
+        vkd3d_trace_marker('B', metadata, data, size, command_queue->device->wchar_size);
+
+    d3d12_command_queue_add_label(command_queue, VKD3D_CS_OP_BEGIN_LABEL, metadata, data, size);
 }
 
 static void STDMETHODCALLTYPE d3d12_command_queue_EndEvent(ID3D12CommandQueue *iface)
 {
-    FIXME("iface %p stub!\n", iface);
+    struct d3d12_command_queue *command_queue = impl_from_ID3D12CommandQueue(iface);
+
+    TRACE("iface %p.\n", iface);
+
+    if (vkd3d_trace_enabled)
+        vkd3d_trace_marker('E', 0, NULL, 0, command_queue->device->wchar_size);
+
+    d3d12_command_queue_add_label(command_queue, VKD3D_CS_OP_END_LABEL, 0, NULL, 0);
 }
 
 static HRESULT vkd3d_enqueue_timeline_semaphore(struct vkd3d_fence_worker *worker, VkSemaphore vk_semaphore,
@@ -6991,6 +9300,7 @@ static HRESULT d3d12_command_queue_signal(struct d3d12_command_queue *command_qu
     VkTimelineSemaphoreSubmitInfoKHR timeline_submit_info;
     const struct vkd3d_vk_device_procs *vk_procs;
     VkSemaphore vk_semaphore = VK_NULL_HANDLE;
+    struct vkd3d_sparse_wait sparse_wait;
     VkFence vk_fence = VK_NULL_HANDLE;
     struct vkd3d_queue *vkd3d_queue;
     uint64_t sequence_number = 0;
@@ -7059,8 +9369,10 @@ static HRESULT d3d12_command_queue_signal(struct d3d12_command_queue *command_qu
         timeline_submit_info.pWaitSemaphoreValues = NULL;
         submit_info.pNext = &timeline_submit_info;
     }
+    d3d12_command_queue_wait_sparse_binds(command_queue, &submit_info, &sparse_wait);
 
-    vr = VK_CALL(vkQueueSubmit(vk_queue, 1, &submit_info, vk_fence));
+    if ((vr = VK_CALL(vkQueueSubmit(vk_queue, 1, &submit_info, vk_fence))) >= 0)
+        d3d12_device_add_statistic(device, vk_queue_submit_count, 1);
     if (!device->vk_info.KHR_timeline_semaphore && vr >= 0)
     {
         sequence_number = ++vkd3d_queue->submitted_sequence_number;
@@ -7142,6 +9454,7 @@ static HRESULT d3d12_command_queue_wait_binary_semaphore_locked(struct d3d12_com
     static const VkPipelineStageFlags wait_stage_mask = VK_PIPELINE_STAGE_ALL_COMMANDS_BIT;
     const struct vkd3d_vk_device_procs *vk_procs;
     struct vkd3d_signaled_semaphore *semaphore;
+    struct vkd3d_sparse_wait sparse_wait;
     uint64_t completed_value = 0;
     struct vkd3d_queue *queue;
     VkSubmitInfo submit_info;
@@ -7205,8 +9518,10 @@ static HRESULT d3d12_command_queue_wait_binary_semaphore_locked(struct d3d12_com
         goto fail;
     }
 
+    d3d12_command_queue_wait_sparse_binds(command_queue, &submit_info, &sparse_wait);
     if ((vr = VK_CALL(vkQueueSubmit(vk_queue, 1, &submit_info, VK_NULL_HANDLE))) >= 0)
     {
+        d3d12_device_add_statistic(command_queue->device, vk_queue_submit_count, 1);
         queue->semaphores[queue->semaphore_count].vk_semaphore = semaphore->u.binary.vk_semaphore;
         queue->semaphores[queue->semaphore_count].sequence_number = queue->submitted_sequence_number + 1;
         ++queue->semaphore_count;
@@ -7238,6 +9553,7 @@ static HRESULT d3d12_command_queue_wait_locked(struct d3d12_command_queue *comma
     static const VkPipelineStageFlags wait_stage_mask = VK_PIPELINE_STAGE_ALL_COMMANDS_BIT;
     VkTimelineSemaphoreSubmitInfoKHR timeline_submit_info;
     const struct vkd3d_vk_device_procs *vk_procs;
+    struct vkd3d_sparse_wait sparse_wait;
     struct vkd3d_queue *queue;
     VkSubmitInfo submit_info;
     uint64_t wait_value;
@@ -7280,7 +9596,9 @@ static HRESULT d3d12_command_queue_wait_locked(struct d3d12_command_queue *comma
         return E_FAIL;
     }
 
-    vr = VK_CALL(vkQueueSubmit(vk_queue, 1, &submit_info, VK_NULL_HANDLE));
+    d3d12_command_queue_wait_sparse_binds(command_queue, &submit_info, &sparse_wait);
+    if ((vr = VK_CALL(vkQueueSubmit(vk_queue, 1, &submit_info, VK_NULL_HANDLE))) >= 0)
+        d3d12_device_add_statistic(command_queue->device, vk_queue_submit_count, 1);
 
     vkd3d_queue_release(queue);
 
@@ -7482,6 +9800,7 @@ static HRESULT d3d12_command_queue_fixup_after_flush_locked(struct d3d12_command
     d3d12_command_queue_swap_queues(queue);
 
     d3d12_command_queue_op_array_append(&queue->op_queue, queue->aux_op_queue.count, queue->aux_op_queue.ops);
+    vkd3d_cs_arena_move(&queue->op_queue.arena, &queue->aux_op_queue.arena);
 
     queue->aux_op_queue.count = 0;
     queue->is_flushing = false;
@@ -7516,7 +9835,7 @@ static HRESULT d3d12_command_queue_flush_ops_locked(struct d3d12_command_queue *
 {
     struct vkd3d_cs_op_data *op;
     struct d3d12_fence *fence;
-    unsigned int i;
+    unsigned int i, j;
     HRESULT hr;
 
     queue->is_flushing = true;
@@ -7557,18 +9876,33 @@ static HRESULT d3d12_command_queue_flush_ops_locked(struct d3d12_command_queue *
                     break;
 
                 case VKD3D_CS_OP_EXECUTE:
-                    d3d12_command_queue_execute(queue, op->u.execute.buffers, op->u.execute.buffer_count);
+                    /* Signal the start of the following mapping updates with
+                     * this submission, rather than with an empty one. */
+                    d3d12_command_queue_execute(queue, op->u.execute.buffers, op->u.execute.buffer_count,
+                            i + 1 < queue->aux_op_queue.count
+                            && queue->aux_op_queue.ops[i + 1].opcode == VKD3D_CS_OP_UPDATE_MAPPINGS);
                     break;
 
                 case VKD3D_CS_OP_UPDATE_MAPPINGS:
-                    FIXME("Tiled resource binding is not supported yet.\n");
-                    update_mappings_cleanup(&op->u.update_mappings);
+                    /* Consecutive mapping updates are submitted together. */
+                    for (j = i + 1; j < queue->aux_op_queue.count
+                            && queue->aux_op_queue.ops[j].opcode == VKD3D_CS_OP_UPDATE_MAPPINGS; ++j)
+                        ;
+                    d3d12_command_queue_update_mappings(queue, op, j - i);
+                    i = j - 1;
+                    op = &queue->aux_op_queue.ops[i];
                     break;
 
                 case VKD3D_CS_OP_COPY_MAPPINGS:
                     FIXME("Tiled resource mapping copying is not supported yet.\n");
                     break;
 
+                case VKD3D_CS_OP_BEGIN_LABEL:
+                case VKD3D_CS_OP_END_LABEL:
+                case VKD3D_CS_OP_INSERT_LABEL:
+                    d3d12_command_queue_label(queue, op);
+                    break;
+
                 default:
                     vkd3d_unreachable();
             }
@@ -7579,6 +9913,7 @@ static HRESULT d3d12_command_queue_flush_ops_locked(struct d3d12_command_queue *
         }
 
         queue->aux_op_queue.count = 0;
+        vkd3d_cs_arena_reset(&queue->aux_op_queue.arena);
 
         vkd3d_mutex_lock(&queue->op_mutex);
     }
@@ -7593,6 +9928,7 @@ static void d3d12_command_queue_op_array_init(struct d3d12_command_queue_op_arra
     array->ops = NULL;
     array->count = 0;
     array->size = 0;
+    vkd3d_cs_arena_init(&array->arena);
 }
 
 static HRESULT d3d12_command_queue_init(struct d3d12_command_queue *queue,
@@ -7617,6 +9953,10 @@ static HRESULT d3d12_command_queue_init(struct d3d12_command_queue *queue,
     queue->is_flushing = false;
 
     d3d12_command_queue_op_array_init(&queue->aux_op_queue);
+    memset(&queue->sparse_binds, 0, sizeof(queue->sparse_binds));
+    memset(queue->vk_sparse_semaphores, 0, sizeof(queue->vk_sparse_semaphores));
+    queue->sparse_semaphore_value = 0;
+    queue->sparse_wait_pending = false;
 
     if (desc->Priority == D3D12_COMMAND_QUEUE_PRIORITY_GLOBAL_REALTIME)
     {
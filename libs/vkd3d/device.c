@@ -19,6 +19,10 @@
 #include "vkd3d_private.h"
 #include "vkd3d_version.h"
 
+#ifndef _WIN32
+#include <unistd.h>
+#endif
+
 #define VKD3D_MAX_UAV_CLEAR_DESCRIPTORS_PER_TYPE 256u
 
 struct vkd3d_struct
@@ -68,6 +72,7 @@ static const struct vkd3d_optional_extension_info optional_instance_extensions[]
     VK_EXTENSION(KHR_GET_PHYSICAL_DEVICE_PROPERTIES_2, KHR_get_physical_device_properties2),
     /* EXT extensions */
     VK_DEBUG_EXTENSION(EXT_DEBUG_REPORT, EXT_debug_report),
+    VK_EXTENSION(EXT_DEBUG_UTILS, EXT_debug_utils),
 };
 
 static const char * const required_device_extensions[] =
@@ -88,14 +93,17 @@ static const char * const required_device_extensions[] =
 static const struct vkd3d_optional_extension_info optional_device_extensions[] =
 {
     /* KHR extensions */
+    VK_EXTENSION(KHR_BUFFER_DEVICE_ADDRESS, KHR_buffer_device_address),
     VK_EXTENSION(KHR_DEDICATED_ALLOCATION, KHR_dedicated_allocation),
     VK_EXTENSION(KHR_DRAW_INDIRECT_COUNT, KHR_draw_indirect_count),
     VK_EXTENSION(KHR_GET_MEMORY_REQUIREMENTS_2, KHR_get_memory_requirements2),
     VK_EXTENSION(KHR_IMAGE_FORMAT_LIST, KHR_image_format_list),
     VK_EXTENSION(KHR_MAINTENANCE3, KHR_maintenance3),
+    VK_EXTENSION(KHR_MAINTENANCE4, KHR_maintenance4),
     VK_EXTENSION(KHR_PORTABILITY_SUBSET, KHR_portability_subset),
     VK_EXTENSION(KHR_PUSH_DESCRIPTOR, KHR_push_descriptor),
     VK_EXTENSION(KHR_SAMPLER_MIRROR_CLAMP_TO_EDGE, KHR_sampler_mirror_clamp_to_edge),
+    VK_EXTENSION(KHR_SYNCHRONIZATION_2, KHR_synchronization2),
     VK_EXTENSION(KHR_TIMELINE_SEMAPHORE, KHR_timeline_semaphore),
     VK_EXTENSION(KHR_ZERO_INITIALIZE_WORKGROUP_MEMORY, KHR_zero_initialize_workgroup_memory),
     /* EXT extensions */
@@ -105,9 +113,13 @@ static const struct vkd3d_optional_extension_info optional_device_extensions[] =
     VK_DEBUG_EXTENSION(EXT_DEBUG_MARKER, EXT_debug_marker),
     VK_EXTENSION(EXT_DEPTH_RANGE_UNRESTRICTED, EXT_depth_range_unrestricted),
     VK_EXTENSION(EXT_DEPTH_CLIP_ENABLE, EXT_depth_clip_enable),
+    VK_EXTENSION(EXT_DESCRIPTOR_BUFFER, EXT_descriptor_buffer),
     VK_EXTENSION(EXT_DESCRIPTOR_INDEXING, EXT_descriptor_indexing),
     VK_EXTENSION(EXT_FRAGMENT_SHADER_INTERLOCK, EXT_fragment_shader_interlock),
+    VK_EXTENSION(EXT_MEMORY_BUDGET, EXT_memory_budget),
+    VK_EXTENSION(EXT_MEMORY_PRIORITY, EXT_memory_priority),
     VK_EXTENSION(EXT_MUTABLE_DESCRIPTOR_TYPE, EXT_mutable_descriptor_type),
+    VK_EXTENSION(EXT_PAGEABLE_DEVICE_LOCAL_MEMORY, EXT_pageable_device_local_memory),
     VK_EXTENSION(EXT_ROBUSTNESS_2, EXT_robustness2),
     VK_EXTENSION(EXT_SHADER_DEMOTE_TO_HELPER_INVOCATION, EXT_shader_demote_to_helper_invocation),
     VK_EXTENSION(EXT_SHADER_STENCIL_EXPORT, EXT_shader_stencil_export),
@@ -162,6 +174,13 @@ static HRESULT vkd3d_create_vk_descriptor_heap_layout(struct d3d12_device *devic
             | VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT_EXT | VK_DESCRIPTOR_BINDING_UPDATE_AFTER_BIND_BIT_EXT
             | VK_DESCRIPTOR_BINDING_UPDATE_UNUSED_WHILE_PENDING_BIT_EXT;
 
+    /* Descriptor buffers are written directly, so update-after-bind does not apply. */
+    if (device->use_descriptor_buffers)
+    {
+        set_desc.flags = VK_DESCRIPTOR_SET_LAYOUT_CREATE_DESCRIPTOR_BUFFER_BIT_EXT;
+        set_flags = VK_DESCRIPTOR_BINDING_VARIABLE_DESCRIPTOR_COUNT_BIT_EXT;
+    }
+
     flags_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_BINDING_FLAGS_CREATE_INFO_EXT;
     flags_info.pNext = NULL;
     flags_info.bindingCount = 1;
@@ -218,6 +237,7 @@ static HRESULT vkd3d_vk_descriptor_heap_layouts_init(struct d3d12_device *device
                 {VK_DESCRIPTOR_TYPE_STORAGE_TEXEL_BUFFER, true, D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV},
     };
     const struct vkd3d_device_descriptor_limits *limits = &device->vk_info.descriptor_limits;
+    const struct vkd3d_vk_device_procs *vk_procs = &device->vk_procs;
     enum vkd3d_vk_descriptor_set_index set;
     HRESULT hr;
 
@@ -255,6 +275,11 @@ static HRESULT vkd3d_vk_descriptor_heap_layouts_init(struct d3d12_device *device
             vkd3d_vk_descriptor_heap_layouts_cleanup(device);
             return hr;
         }
+
+        if (device->use_descriptor_buffers && device->vk_descriptor_heap_layouts[set].vk_set_layout)
+            VK_CALL(vkGetDescriptorSetLayoutBindingOffsetEXT(device->vk_device,
+                    device->vk_descriptor_heap_layouts[set].vk_set_layout, 0,
+                    &device->descriptor_buffer.binding_offsets[set]));
     }
 
     return S_OK;
@@ -568,6 +593,10 @@ static void vkd3d_init_debug_report(struct vkd3d_instance *instance)
 
 static const struct vkd3d_debug_option vkd3d_config_options[] =
 {
+    {"deferred_recording", VKD3D_CONFIG_FLAG_DEFERRED_RECORDING}, /* translate command lists in worker threads */
+    {"descriptor_buffer", VKD3D_CONFIG_FLAG_DESCRIPTOR_BUFFER}, /* use descriptor buffers for Vulkan heaps */
+    {"root_buffer_address", VKD3D_CONFIG_FLAG_ROOT_BUFFER_ADDRESS}, /* pass root CBVs as buffer addresses */
+    {"statistics", VKD3D_CONFIG_FLAG_STATISTICS}, /* periodically log device statistics */
     {"virtual_heaps", VKD3D_CONFIG_FLAG_VIRTUAL_HEAPS}, /* always use virtual descriptor heaps */
     {"vk_debug", VKD3D_CONFIG_FLAG_VULKAN_DEBUG}, /* enable Vulkan debug extensions */
 };
@@ -776,6 +805,8 @@ HRESULT vkd3d_create_instance(const struct vkd3d_instance_create_info *create_in
         return hr;
     }
 
+    vkd3d_trace_init();
+
     TRACE("Created instance %p.\n", object);
 
     *instance = object;
@@ -796,6 +827,8 @@ static void vkd3d_destroy_instance(struct vkd3d_instance *instance)
     if (instance->libvulkan)
         vkd3d_dlclose(instance->libvulkan);
 
+    vkd3d_trace_flush();
+
     vkd3d_free(instance);
 }
 
@@ -833,6 +866,7 @@ static bool d3d12_device_environment_is_vulkan_min_1_1(struct d3d12_device *devi
 struct vkd3d_physical_device_info
 {
     /* properties */
+    VkPhysicalDeviceDescriptorBufferPropertiesEXT descriptor_buffer_properties;
     VkPhysicalDeviceDescriptorIndexingPropertiesEXT descriptor_indexing_properties;
     VkPhysicalDeviceMaintenance3Properties maintenance3_properties;
     VkPhysicalDeviceTexelBufferAlignmentPropertiesEXT texel_buffer_alignment_properties;
@@ -843,10 +877,14 @@ struct vkd3d_physical_device_info
     VkPhysicalDeviceProperties2KHR properties2;
 
     /* features */
+    VkPhysicalDeviceBufferDeviceAddressFeaturesKHR buffer_device_address_features;
     VkPhysicalDeviceConditionalRenderingFeaturesEXT conditional_rendering_features;
     VkPhysicalDeviceDepthClipEnableFeaturesEXT depth_clip_features;
+    VkPhysicalDeviceDescriptorBufferFeaturesEXT descriptor_buffer_features;
     VkPhysicalDeviceDescriptorIndexingFeaturesEXT descriptor_indexing_features;
     VkPhysicalDeviceFragmentShaderInterlockFeaturesEXT fragment_shader_interlock_features;
+    VkPhysicalDeviceMaintenance4FeaturesKHR maintenance4_features;
+    VkPhysicalDevicePageableDeviceLocalMemoryFeaturesEXT pageable_device_local_memory_features;
     VkPhysicalDeviceRobustness2FeaturesEXT robustness2_features;
     VkPhysicalDeviceShaderDemoteToHelperInvocationFeaturesEXT demote_features;
     VkPhysicalDeviceTexelBufferAlignmentFeaturesEXT texel_buffer_alignment_features;
@@ -867,14 +905,22 @@ static void vkd3d_chain_physical_device_info_structures(struct vkd3d_physical_de
 
     info->features2.pNext = NULL;
 
+    if (vulkan_info->KHR_buffer_device_address)
+        vk_prepend_struct(&info->features2, &info->buffer_device_address_features);
     if (vulkan_info->EXT_conditional_rendering)
         vk_prepend_struct(&info->features2, &info->conditional_rendering_features);
     if (vulkan_info->EXT_depth_clip_enable)
         vk_prepend_struct(&info->features2, &info->depth_clip_features);
+    if (vulkan_info->EXT_descriptor_buffer)
+        vk_prepend_struct(&info->features2, &info->descriptor_buffer_features);
     if (vulkan_info->EXT_descriptor_indexing)
         vk_prepend_struct(&info->features2, &info->descriptor_indexing_features);
     if (vulkan_info->EXT_fragment_shader_interlock)
         vk_prepend_struct(&info->features2, &info->fragment_shader_interlock_features);
+    if (vulkan_info->KHR_maintenance4)
+        vk_prepend_struct(&info->features2, &info->maintenance4_features);
+    if (vulkan_info->EXT_pageable_device_local_memory)
+        vk_prepend_struct(&info->features2, &info->pageable_device_local_memory_features);
     if (vulkan_info->EXT_robustness2)
         vk_prepend_struct(&info->features2, &info->robustness2_features);
     if (vulkan_info->EXT_shader_demote_to_helper_invocation)
@@ -898,6 +944,8 @@ static void vkd3d_chain_physical_device_info_structures(struct vkd3d_physical_de
 
     if (vulkan_info->KHR_maintenance3)
         vk_prepend_struct(&info->properties2, &info->maintenance3_properties);
+    if (vulkan_info->EXT_descriptor_buffer)
+        vk_prepend_struct(&info->properties2, &info->descriptor_buffer_properties);
     if (vulkan_info->EXT_descriptor_indexing)
         vk_prepend_struct(&info->properties2, &info->descriptor_indexing_properties);
     if (vulkan_info->EXT_texel_buffer_alignment)
@@ -919,10 +967,15 @@ static void vkd3d_physical_device_info_init(struct vkd3d_physical_device_info *i
     memset(info, 0, sizeof(*info));
 
     info->features2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+    info->buffer_device_address_features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_BUFFER_DEVICE_ADDRESS_FEATURES_KHR;
     info->conditional_rendering_features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_CONDITIONAL_RENDERING_FEATURES_EXT;
     info->depth_clip_features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DEPTH_CLIP_ENABLE_FEATURES_EXT;
+    info->descriptor_buffer_features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_BUFFER_FEATURES_EXT;
     info->descriptor_indexing_features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_FEATURES_EXT;
     info->fragment_shader_interlock_features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FRAGMENT_SHADER_INTERLOCK_FEATURES_EXT;
+    info->maintenance4_features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MAINTENANCE_4_FEATURES_KHR;
+    info->pageable_device_local_memory_features.sType
+            = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PAGEABLE_DEVICE_LOCAL_MEMORY_FEATURES_EXT;
     info->robustness2_features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_ROBUSTNESS_2_FEATURES_EXT;
     info->demote_features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_SHADER_DEMOTE_TO_HELPER_INVOCATION_FEATURES_EXT;
     info->texel_buffer_alignment_features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_TEXEL_BUFFER_ALIGNMENT_FEATURES_EXT;
@@ -935,6 +988,7 @@ static void vkd3d_physical_device_info_init(struct vkd3d_physical_device_info *i
 
     info->properties2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2;
     info->maintenance3_properties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MAINTENANCE_3_PROPERTIES;
+    info->descriptor_buffer_properties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_BUFFER_PROPERTIES_EXT;
     info->descriptor_indexing_properties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_PROPERTIES_EXT;
     info->texel_buffer_alignment_properties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_TEXEL_BUFFER_ALIGNMENT_PROPERTIES_EXT;
     info->xfb_properties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_TRANSFORM_FEEDBACK_PROPERTIES_EXT;
@@ -1717,6 +1771,34 @@ static void vkd3d_override_caps(struct d3d12_device *device)
     }
 }
 
+static void vkd3d_descriptor_buffer_info_init(struct vkd3d_descriptor_buffer_info *info,
+        const VkPhysicalDeviceDescriptorBufferPropertiesEXT *properties, bool robust_buffer_access)
+{
+    size_t *sizes = info->type_sizes;
+
+    memset(info, 0, sizeof(*info));
+
+    sizes[VK_DESCRIPTOR_TYPE_SAMPLER] = properties->samplerDescriptorSize;
+    sizes[VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE] = properties->sampledImageDescriptorSize;
+    sizes[VK_DESCRIPTOR_TYPE_STORAGE_IMAGE] = properties->storageImageDescriptorSize;
+    sizes[VK_DESCRIPTOR_TYPE_UNIFORM_TEXEL_BUFFER] = robust_buffer_access
+            ? properties->robustUniformTexelBufferDescriptorSize : properties->uniformTexelBufferDescriptorSize;
+    sizes[VK_DESCRIPTOR_TYPE_STORAGE_TEXEL_BUFFER] = robust_buffer_access
+            ? properties->robustStorageTexelBufferDescriptorSize : properties->storageTexelBufferDescriptorSize;
+    sizes[VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER] = robust_buffer_access
+            ? properties->robustUniformBufferDescriptorSize : properties->uniformBufferDescriptorSize;
+
+    info->descriptor_sizes[VKD3D_SET_INDEX_SAMPLER] = sizes[VK_DESCRIPTOR_TYPE_SAMPLER];
+    info->descriptor_sizes[VKD3D_SET_INDEX_UAV_COUNTER] = sizes[VK_DESCRIPTOR_TYPE_STORAGE_TEXEL_BUFFER];
+    /* A mutable descriptor is as large as the largest type it may hold. */
+    info->descriptor_sizes[VKD3D_SET_INDEX_MUTABLE] = max(max(sizes[VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER],
+            sizes[VK_DESCRIPTOR_TYPE_UNIFORM_TEXEL_BUFFER]), max(sizes[VK_DESCRIPTOR_TYPE_STORAGE_TEXEL_BUFFER],
+            max(sizes[VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE], sizes[VK_DESCRIPTOR_TYPE_STORAGE_IMAGE])));
+    info->offset_alignment = properties->descriptorBufferOffsetAlignment;
+    info->max_descriptor_size = max(info->descriptor_sizes[VKD3D_SET_INDEX_SAMPLER],
+            info->descriptor_sizes[VKD3D_SET_INDEX_MUTABLE]);
+}
+
 static HRESULT vkd3d_init_device_caps(struct d3d12_device *device,
         const struct vkd3d_device_create_info *create_info,
         struct vkd3d_physical_device_info *physical_device_info,
@@ -1851,6 +1933,14 @@ static HRESULT vkd3d_init_device_caps(struct d3d12_device *device,
         vulkan_info->EXT_conditional_rendering = false;
     if (!physical_device_info->depth_clip_features.depthClipEnable)
         vulkan_info->EXT_depth_clip_enable = false;
+    if (!physical_device_info->maintenance4_features.maintenance4)
+        vulkan_info->KHR_maintenance4 = false;
+    /* Memory budgets are queried with vkGetPhysicalDeviceMemoryProperties2(). */
+    if (!vulkan_info->KHR_get_physical_device_properties2)
+        vulkan_info->EXT_memory_budget = false;
+    if (!physical_device_info->pageable_device_local_memory_features.pageableDeviceLocalMemory
+            || !vulkan_info->EXT_memory_priority)
+        vulkan_info->EXT_pageable_device_local_memory = false;
     if (!physical_device_info->robustness2_features.nullDescriptor)
         vulkan_info->EXT_robustness2 = false;
     if (!physical_device_info->demote_features.shaderDemoteToHelperInvocation)
@@ -1981,6 +2071,55 @@ static HRESULT vkd3d_init_device_caps(struct d3d12_device *device,
         }
     }
 
+    /* Root CBVs may be passed to shaders as 64-bit buffer device addresses in
+     * push constants, which avoids push descriptor updates. */
+    device->use_root_buffer_addresses = (device->vkd3d_instance->config_flags & VKD3D_CONFIG_FLAG_ROOT_BUFFER_ADDRESS)
+            && vulkan_info->KHR_buffer_device_address
+            && physical_device_info->buffer_device_address_features.bufferDeviceAddress;
+
+    /* All set layouts in a pipeline layout must be descriptor buffer layouts,
+     * so root descriptors require push descriptors, and null views require
+     * null descriptors. Mutable descriptors keep the set count within limits. */
+    device->use_descriptor_buffers = device->use_vk_heaps
+            && (device->vkd3d_instance->config_flags & VKD3D_CONFIG_FLAG_DESCRIPTOR_BUFFER)
+            && d3d12_device_environment_is_vulkan_min_1_1(device)
+            && vulkan_info->EXT_descriptor_buffer && vulkan_info->KHR_buffer_device_address
+            && vulkan_info->KHR_synchronization2 && vulkan_info->KHR_push_descriptor
+            && vulkan_info->EXT_mutable_descriptor_type && vulkan_info->EXT_robustness2
+            && physical_device_info->buffer_device_address_features.bufferDeviceAddress
+            && physical_device_info->descriptor_buffer_features.descriptorBuffer
+            && physical_device_info->descriptor_buffer_features.descriptorBufferPushDescriptors
+            && physical_device_info->descriptor_buffer_properties.bufferlessPushDescriptors;
+
+    if (device->use_descriptor_buffers || device->use_root_buffer_addresses)
+    {
+        physical_device_info->buffer_device_address_features.bufferDeviceAddressCaptureReplay = VK_FALSE;
+        physical_device_info->buffer_device_address_features.bufferDeviceAddressMultiDevice = VK_FALSE;
+    }
+    else
+    {
+        if (device->vkd3d_instance->config_flags & VKD3D_CONFIG_FLAG_ROOT_BUFFER_ADDRESS)
+            WARN("Buffer device addresses are not supported.\n");
+        vulkan_info->KHR_buffer_device_address = false;
+    }
+
+    if (device->use_descriptor_buffers)
+    {
+        physical_device_info->descriptor_buffer_features.descriptorBufferCaptureReplay = VK_FALSE;
+        physical_device_info->descriptor_buffer_features.descriptorBufferImageLayoutIgnored = VK_FALSE;
+
+        vulkan_info->descriptor_buffer_properties = physical_device_info->descriptor_buffer_properties;
+        vkd3d_descriptor_buffer_info_init(&device->descriptor_buffer,
+                &vulkan_info->descriptor_buffer_properties, features->robustBufferAccess);
+    }
+    else
+    {
+        if (device->vkd3d_instance->config_flags & VKD3D_CONFIG_FLAG_DESCRIPTOR_BUFFER)
+            WARN("Descriptor buffers are not supported.\n");
+        vulkan_info->EXT_descriptor_buffer = false;
+        vulkan_info->KHR_synchronization2 = false;
+    }
+
     if (device->use_vk_heaps)
         vkd3d_device_vk_heaps_descriptor_limits_init(&vulkan_info->descriptor_limits,
                 &physical_device_info->descriptor_indexing_properties);
@@ -1990,7 +2129,7 @@ static HRESULT vkd3d_init_device_caps(struct d3d12_device *device,
 
     TRACE("Device %p: using %s descriptor heaps, with%s descriptor indexing, "
             "with%s push descriptors, with%s mutable descriptors\n",
-            device, device->use_vk_heaps ? "Vulkan" : "virtual",
+            device, device->use_descriptor_buffers ? "descriptor buffer" : device->use_vk_heaps ? "Vulkan" : "virtual",
             device->vk_info.EXT_descriptor_indexing ? "" : "out",
             device->vk_info.KHR_push_descriptor ? "" : "out",
             device->vk_info.EXT_mutable_descriptor_type ? "" : "out");
@@ -2401,6 +2540,15 @@ static void d3d12_device_destroy_pipeline_cache(struct d3d12_device *device)
 #define VKD3D_VA_SLAB_SIZE          (1ull << VKD3D_VA_SLAB_SIZE_SHIFT)
 #define VKD3D_VA_SLAB_COUNT         (64 * 1024)
 
+/* Fallback allocations are aligned to pages, so each page belongs to at most
+ * one allocation. The 63-bit range holds 2^31 pages. */
+#define VKD3D_VA_FALLBACK_PAGE_SHIFT VKD3D_VA_SLAB_SIZE_SHIFT
+#define VKD3D_VA_FALLBACK_PAGE_SIZE  (1ull << VKD3D_VA_FALLBACK_PAGE_SHIFT)
+#define VKD3D_VA_FALLBACK_LEAF_SHIFT 11
+#define VKD3D_VA_FALLBACK_LEAF_SIZE  (1u << VKD3D_VA_FALLBACK_LEAF_SHIFT)
+#define VKD3D_VA_FALLBACK_NODE_SHIFT 10
+#define VKD3D_VA_FALLBACK_NODE_SIZE  (1u << VKD3D_VA_FALLBACK_NODE_SHIFT)
+
 static D3D12_GPU_VIRTUAL_ADDRESS vkd3d_gpu_va_allocator_allocate_slab(struct vkd3d_gpu_va_allocator *allocator,
         uint64_t aligned_size, void *ptr)
 {
@@ -2423,32 +2571,321 @@ static D3D12_GPU_VIRTUAL_ADDRESS vkd3d_gpu_va_allocator_allocate_slab(struct vkd
     return address;
 }
 
+/* Tables are only created and freed with the mutex held, and a table is only
+ * freed once it no longer maps any allocation, so lookups of live addresses
+ * do not need to lock. */
+static struct vkd3d_gpu_va_allocation *vkd3d_gpu_va_allocator_get_fallback_page(
+        struct vkd3d_gpu_va_allocator *allocator, D3D12_GPU_VIRTUAL_ADDRESS address, bool create)
+{
+    uint64_t page = (address - VKD3D_VA_FALLBACK_BASE) >> VKD3D_VA_FALLBACK_PAGE_SHIFT;
+    unsigned int root_idx, node_idx;
+    struct vkd3d_gpu_va_allocation **node, *leaf;
+
+    root_idx = page >> (VKD3D_VA_FALLBACK_NODE_SHIFT + VKD3D_VA_FALLBACK_LEAF_SHIFT);
+    node_idx = (page >> VKD3D_VA_FALLBACK_LEAF_SHIFT) & (VKD3D_VA_FALLBACK_NODE_SIZE - 1);
+
+    if (!(node = allocator->fallback_pages[root_idx]))
+    {
+        if (!create || !(node = vkd3d_calloc(VKD3D_VA_FALLBACK_NODE_SIZE, sizeof(*node))))
+            return NULL;
+        vkd3d_atomic_exchange_ptr((void **)&allocator->fallback_pages[root_idx], node);
+    }
+
+    if (!(leaf = node[node_idx]))
+    {
+        if (!create || !(leaf = vkd3d_calloc(VKD3D_VA_FALLBACK_LEAF_SIZE, sizeof(*leaf))))
+            return NULL;
+        vkd3d_atomic_exchange_ptr((void **)&node[node_idx], leaf);
+    }
+
+    return &leaf[page & (VKD3D_VA_FALLBACK_LEAF_SIZE - 1)];
+}
+
+/* Frees the leaf table containing "page" if it no longer maps any allocation,
+ * and its node table if that becomes empty in turn. */
+static void vkd3d_gpu_va_allocator_trim_fallback_tables(struct vkd3d_gpu_va_allocator *allocator, uint64_t page)
+{
+    struct vkd3d_gpu_va_allocation **node, *leaf;
+    unsigned int root_idx, node_idx, i;
+
+    root_idx = page >> (VKD3D_VA_FALLBACK_NODE_SHIFT + VKD3D_VA_FALLBACK_LEAF_SHIFT);
+    node_idx = (page >> VKD3D_VA_FALLBACK_LEAF_SHIFT) & (VKD3D_VA_FALLBACK_NODE_SIZE - 1);
+
+    if (!(node = allocator->fallback_pages[root_idx]) || !(leaf = node[node_idx]))
+        return;
+
+    for (i = 0; i < VKD3D_VA_FALLBACK_LEAF_SIZE; ++i)
+    {
+        if (leaf[i].ptr)
+            return;
+    }
+    vkd3d_atomic_exchange_ptr((void **)&node[node_idx], NULL);
+    vkd3d_free(leaf);
+
+    for (i = 0; i < VKD3D_VA_FALLBACK_NODE_SIZE; ++i)
+    {
+        if (node[i])
+            return;
+    }
+    vkd3d_atomic_exchange_ptr((void **)&allocator->fallback_pages[root_idx], NULL);
+    vkd3d_free(node);
+}
+
+static void vkd3d_gpu_va_allocator_trim_fallback_range(struct vkd3d_gpu_va_allocator *allocator,
+        D3D12_GPU_VIRTUAL_ADDRESS base, uint64_t page_count)
+{
+    uint64_t page, end;
+
+    page = (base - VKD3D_VA_FALLBACK_BASE) >> VKD3D_VA_FALLBACK_PAGE_SHIFT;
+    end = page + page_count;
+    while (page < end)
+    {
+        vkd3d_gpu_va_allocator_trim_fallback_tables(allocator, page);
+        page = (page | (VKD3D_VA_FALLBACK_LEAF_SIZE - 1)) + 1;
+    }
+}
+
+static int vkd3d_gpu_va_range_compare(const void *key, const struct rb_entry *entry)
+{
+    const struct vkd3d_gpu_va_range *range = RB_ENTRY_VALUE(entry, const struct vkd3d_gpu_va_range, entry);
+
+    return vkd3d_u64_compare(*(const D3D12_GPU_VIRTUAL_ADDRESS *)key, range->base);
+}
+
+/* Free ranges are also indexed by size, with the address breaking ties. */
+static int vkd3d_gpu_va_range_size_compare(const void *key, const struct rb_entry *entry)
+{
+    const struct vkd3d_gpu_va_range *range = RB_ENTRY_VALUE(entry, const struct vkd3d_gpu_va_range, size_entry);
+    const struct vkd3d_gpu_va_range *k = key;
+    int ret;
+
+    if ((ret = vkd3d_u64_compare(k->size, range->size)))
+        return ret;
+    return vkd3d_u64_compare(k->base, range->base);
+}
+
+static void vkd3d_gpu_va_range_destroy(struct rb_entry *entry, void *context)
+{
+    vkd3d_free(RB_ENTRY_VALUE(entry, struct vkd3d_gpu_va_range, entry));
+}
+
+static void vkd3d_gpu_va_allocator_remove_free_range(struct vkd3d_gpu_va_allocator *allocator,
+        struct vkd3d_gpu_va_range *range)
+{
+    rb_remove(&allocator->fallback_free_ranges, &range->entry);
+    rb_remove(&allocator->fallback_free_sizes, &range->size_entry);
+    vkd3d_free(range);
+}
+
+/* Returns the smallest free range which can hold the allocation, or NULL if
+ * there is none. */
+static struct vkd3d_gpu_va_range *vkd3d_gpu_va_allocator_find_free_range(struct vkd3d_gpu_va_allocator *allocator,
+        uint64_t page_alignment, uint64_t extent, D3D12_GPU_VIRTUAL_ADDRESS *base)
+{
+    struct rb_entry *entry = allocator->fallback_free_sizes.root, *first = NULL;
+    struct vkd3d_gpu_va_range *range;
+    uint64_t padding;
+
+    while (entry)
+    {
+        range = RB_ENTRY_VALUE(entry, struct vkd3d_gpu_va_range, size_entry);
+        if (range->size >= extent)
+        {
+            first = entry;
+            entry = entry->left;
+        }
+        else
+        {
+            entry = entry->right;
+        }
+    }
+
+    /* Ranges are page aligned, so larger ones only need to be checked for
+     * larger alignments. */
+    for (entry = first; entry; entry = rb_next(entry))
+    {
+        range = RB_ENTRY_VALUE(entry, struct vkd3d_gpu_va_range, size_entry);
+        padding = ((range->base + (page_alignment - 1)) & ~(page_alignment - 1)) - range->base;
+        if (padding < range->size && range->size - padding >= extent)
+        {
+            *base = range->base + padding;
+            return range;
+        }
+    }
+
+    return NULL;
+}
+
+/* Removes [base, base + extent) from "range", which contains it. */
+static bool vkd3d_gpu_va_allocator_split_free_range(struct vkd3d_gpu_va_allocator *allocator,
+        struct vkd3d_gpu_va_range *range, D3D12_GPU_VIRTUAL_ADDRESS base, uint64_t extent)
+{
+    D3D12_GPU_VIRTUAL_ADDRESS end = range->base + range->size;
+    struct vkd3d_gpu_va_range *tail;
+
+    if (base == range->base && base + extent == end)
+    {
+        vkd3d_gpu_va_allocator_remove_free_range(allocator, range);
+        return true;
+    }
+
+    if (base > range->base && base + extent < end)
+    {
+        if (!(tail = vkd3d_malloc(sizeof(*tail))))
+            return false;
+        tail->base = base + extent;
+        tail->size = end - tail->base;
+        rb_put(&allocator->fallback_free_ranges, &tail->base, &tail->entry);
+        rb_put(&allocator->fallback_free_sizes, tail, &tail->size_entry);
+    }
+
+    /* The range stays between its neighbours, so only its size entry moves. */
+    rb_remove(&allocator->fallback_free_sizes, &range->size_entry);
+    if (base > range->base)
+    {
+        range->size = base - range->base;
+    }
+    else
+    {
+        range->base = base + extent;
+        range->size = end - range->base;
+    }
+    rb_put(&allocator->fallback_free_sizes, range, &range->size_entry);
+
+    return true;
+}
+
+/* Returns [base, base + size) to the free ranges, or lowers the floor if the
+ * range ends there. */
+static void vkd3d_gpu_va_allocator_release_range(struct vkd3d_gpu_va_allocator *allocator,
+        D3D12_GPU_VIRTUAL_ADDRESS base, uint64_t size)
+{
+    struct vkd3d_gpu_va_range *range, *prev = NULL, *next = NULL;
+    struct rb_entry *entry;
+
+    for (entry = allocator->fallback_free_ranges.root; entry;)
+    {
+        range = RB_ENTRY_VALUE(entry, struct vkd3d_gpu_va_range, entry);
+        if (range->base > base)
+        {
+            next = range;
+            entry = entry->left;
+        }
+        else
+        {
+            prev = range;
+            entry = entry->right;
+        }
+    }
+
+    if (prev && prev->base + prev->size == base)
+    {
+        rb_remove(&allocator->fallback_free_sizes, &prev->size_entry);
+        prev->size += size;
+        if (next && base + size == next->base)
+        {
+            prev->size += next->size;
+            vkd3d_gpu_va_allocator_remove_free_range(allocator, next);
+        }
+        rb_put(&allocator->fallback_free_sizes, prev, &prev->size_entry);
+    }
+    else if (next && base + size == next->base)
+    {
+        rb_remove(&allocator->fallback_free_sizes, &next->size_entry);
+        next->base = base;
+        next->size += size;
+        rb_put(&allocator->fallback_free_sizes, next, &next->size_entry);
+    }
+    else if ((range = vkd3d_malloc(sizeof(*range))))
+    {
+        range->base = base;
+        range->size = size;
+        rb_put(&allocator->fallback_free_ranges, &range->base, &range->entry);
+        rb_put(&allocator->fallback_free_sizes, range, &range->size_entry);
+    }
+    else if (base + size < allocator->fallback_floor)
+    {
+        WARN("Failed to record free range %#"PRIx64", size %"PRIu64".\n", base, size);
+        return;
+    }
+    else
+    {
+        allocator->fallback_floor = base;
+        return;
+    }
+
+    if (!(entry = allocator->fallback_free_ranges.root))
+        return;
+    while (entry->right)
+        entry = entry->right;
+    range = RB_ENTRY_VALUE(entry, struct vkd3d_gpu_va_range, entry);
+    if (range->base + range->size >= allocator->fallback_floor)
+    {
+        allocator->fallback_floor = range->base;
+        vkd3d_gpu_va_allocator_remove_free_range(allocator, range);
+    }
+}
+
 static D3D12_GPU_VIRTUAL_ADDRESS vkd3d_gpu_va_allocator_allocate_fallback(struct vkd3d_gpu_va_allocator *allocator,
         size_t alignment, uint64_t aligned_size, void *ptr)
 {
     struct vkd3d_gpu_va_allocation *allocation;
-    D3D12_GPU_VIRTUAL_ADDRESS base, ceiling;
+    D3D12_GPU_VIRTUAL_ADDRESS base, ceiling, old_floor;
+    uint64_t page_alignment, page_count, extent, i;
+    struct vkd3d_gpu_va_range *range;
 
-    base = allocator->fallback_floor;
-    ceiling = ~(D3D12_GPU_VIRTUAL_ADDRESS)0;
-    ceiling -= alignment - 1;
-    if (aligned_size > ceiling || ceiling - aligned_size < base)
+    if (aligned_size > ~(uint64_t)0 - (VKD3D_VA_FALLBACK_PAGE_SIZE - 1))
         return 0;
 
-    base = (base + (alignment - 1)) & ~((D3D12_GPU_VIRTUAL_ADDRESS)alignment - 1);
+    page_alignment = max(alignment, VKD3D_VA_FALLBACK_PAGE_SIZE);
+    page_count = (aligned_size + VKD3D_VA_FALLBACK_PAGE_SIZE - 1) >> VKD3D_VA_FALLBACK_PAGE_SHIFT;
+    extent = page_count << VKD3D_VA_FALLBACK_PAGE_SHIFT;
 
-    if (!vkd3d_array_reserve((void **)&allocator->fallback_allocations, &allocator->fallback_allocations_size,
-            allocator->fallback_allocation_count + 1, sizeof(*allocator->fallback_allocations)))
-        return 0;
+    if (!(range = vkd3d_gpu_va_allocator_find_free_range(allocator, page_alignment, extent, &base)))
+    {
+        base = allocator->fallback_floor;
+        ceiling = ~(D3D12_GPU_VIRTUAL_ADDRESS)0;
+        ceiling -= page_alignment - 1;
+        if (extent > ceiling || ceiling - extent < base)
+            return 0;
+
+        base = (base + (page_alignment - 1)) & ~(page_alignment - 1);
+    }
 
-    allocation = &allocator->fallback_allocations[allocator->fallback_allocation_count++];
-    allocation->base = base;
-    allocation->size = aligned_size;
-    allocation->ptr = ptr;
+    /* Create the tables first, so that failure leaves no partial mapping. */
+    for (i = 0; i < page_count; ++i)
+    {
+        if (!vkd3d_gpu_va_allocator_get_fallback_page(allocator, base + (i << VKD3D_VA_FALLBACK_PAGE_SHIFT), true))
+        {
+            vkd3d_gpu_va_allocator_trim_fallback_range(allocator, base, i);
+            return 0;
+        }
+    }
+
+    if (range)
+    {
+        if (!vkd3d_gpu_va_allocator_split_free_range(allocator, range, base, extent))
+        {
+            vkd3d_gpu_va_allocator_trim_fallback_range(allocator, base, page_count);
+            return 0;
+        }
+    }
+    else
+    {
+        old_floor = allocator->fallback_floor;
+        allocator->fallback_floor = base + extent;
+        if (base > old_floor)
+            vkd3d_gpu_va_allocator_release_range(allocator, old_floor, base - old_floor);
+    }
 
-    /* This pointer is bumped and never lowered on a free. However, this will
-     * only fail once we have exhausted 63 bits of address space. */
-    allocator->fallback_floor = base + aligned_size;
+    for (i = 0; i < page_count; ++i)
+    {
+        allocation = vkd3d_gpu_va_allocator_get_fallback_page(allocator,
+                base + (i << VKD3D_VA_FALLBACK_PAGE_SHIFT), false);
+        allocation->base = base;
+        allocation->size = aligned_size;
+        allocation->ptr = ptr;
+    }
 
     TRACE("Allocated address %#"PRIx64", size %"PRIu64".\n", base, aligned_size);
 
@@ -2503,51 +2940,30 @@ static void *vkd3d_gpu_va_allocator_dereference_slab(struct vkd3d_gpu_va_allocat
     return slab->ptr;
 }
 
-static int vkd3d_gpu_va_allocation_compare(const void *k, const void *e)
-{
-    const struct vkd3d_gpu_va_allocation *allocation = e;
-    const D3D12_GPU_VIRTUAL_ADDRESS *address = k;
-
-    if (*address < allocation->base)
-        return -1;
-    if (*address - allocation->base >= allocation->size)
-        return 1;
-    return 0;
-}
-
 static void *vkd3d_gpu_va_allocator_dereference_fallback(struct vkd3d_gpu_va_allocator *allocator,
         D3D12_GPU_VIRTUAL_ADDRESS address)
 {
-    struct vkd3d_gpu_va_allocation *allocation;
+    const struct vkd3d_gpu_va_allocation *allocation;
 
-    allocation = bsearch(&address, allocator->fallback_allocations, allocator->fallback_allocation_count,
-            sizeof(*allocation), vkd3d_gpu_va_allocation_compare);
+    if (!(allocation = vkd3d_gpu_va_allocator_get_fallback_page(allocator, address, false)) || !allocation->ptr)
+        return NULL;
 
-    return allocation ? allocation->ptr : NULL;
+    return address - allocation->base < allocation->size ? allocation->ptr : NULL;
 }
 
 void *vkd3d_gpu_va_allocator_dereference(struct vkd3d_gpu_va_allocator *allocator,
         D3D12_GPU_VIRTUAL_ADDRESS address)
 {
-    void *ret;
-
-    /* If we land in the non-fallback region, dereferencing VA is lock-less.
-     * The base pointer is immutable, and the only way we can have a data race
-     * is if some other thread is poking into the
-     * slab_mem_allocation[base_index] block. This can only happen if someone
-     * is trying to free the entry while we're dereferencing it, which would
-     * be a serious application bug. */
+    /* Dereferencing VA is lock-less. The slab array is never moved or freed
+     * while the allocator is alive, nor is a fallback page table which maps a
+     * live allocation, and the only way we can have a data race is if some other thread is poking into
+     * the entry for this address. This can only happen if someone is trying
+     * to free the entry while we're dereferencing it, which would be a
+     * serious application bug. */
     if (address < VKD3D_VA_FALLBACK_BASE)
         return vkd3d_gpu_va_allocator_dereference_slab(allocator, address);
 
-    /* Slow fallback. */
-    vkd3d_mutex_lock(&allocator->mutex);
-
-    ret = vkd3d_gpu_va_allocator_dereference_fallback(allocator, address);
-
-    vkd3d_mutex_unlock(&allocator->mutex);
-
-    return ret;
+    return vkd3d_gpu_va_allocator_dereference_fallback(allocator, address);
 }
 
 static void vkd3d_gpu_va_allocator_free_slab(struct vkd3d_gpu_va_allocator *allocator,
@@ -2578,22 +2994,28 @@ static void vkd3d_gpu_va_allocator_free_fallback(struct vkd3d_gpu_va_allocator *
         D3D12_GPU_VIRTUAL_ADDRESS address)
 {
     struct vkd3d_gpu_va_allocation *allocation;
-    unsigned int index;
+    uint64_t page_count, i;
 
-    allocation = bsearch(&address, allocator->fallback_allocations, allocator->fallback_allocation_count,
-            sizeof(*allocation), vkd3d_gpu_va_allocation_compare);
+    allocation = vkd3d_gpu_va_allocator_get_fallback_page(allocator, address, false);
 
-    if (!allocation || allocation->base != address)
+    if (!allocation || !allocation->ptr || allocation->base != address)
     {
         ERR("Address %#"PRIx64" does not match any allocation.\n", address);
         return;
     }
 
-    index = allocation - allocator->fallback_allocations;
-    --allocator->fallback_allocation_count;
-    if (index != allocator->fallback_allocation_count)
-        memmove(&allocator->fallback_allocations[index], &allocator->fallback_allocations[index + 1],
-                (allocator->fallback_allocation_count - index) * sizeof(*allocation));
+    TRACE("Freeing address %#"PRIx64", size %"PRIu64".\n", address, allocation->size);
+
+    page_count = (allocation->size + VKD3D_VA_FALLBACK_PAGE_SIZE - 1) >> VKD3D_VA_FALLBACK_PAGE_SHIFT;
+    for (i = 0; i < page_count; ++i)
+    {
+        allocation = vkd3d_gpu_va_allocator_get_fallback_page(allocator,
+                address + (i << VKD3D_VA_FALLBACK_PAGE_SHIFT), false);
+        memset(allocation, 0, sizeof(*allocation));
+    }
+
+    vkd3d_gpu_va_allocator_trim_fallback_range(allocator, address, page_count);
+    vkd3d_gpu_va_allocator_release_range(allocator, address, page_count << VKD3D_VA_FALLBACK_PAGE_SHIFT);
 }
 
 void vkd3d_gpu_va_allocator_free(struct vkd3d_gpu_va_allocator *allocator, D3D12_GPU_VIRTUAL_ADDRESS address)
@@ -2618,6 +3040,8 @@ static bool vkd3d_gpu_va_allocator_init(struct vkd3d_gpu_va_allocator *allocator
 
     memset(allocator, 0, sizeof(*allocator));
     allocator->fallback_floor = VKD3D_VA_FALLBACK_BASE;
+    rb_init(&allocator->fallback_free_ranges, vkd3d_gpu_va_range_compare);
+    rb_init(&allocator->fallback_free_sizes, vkd3d_gpu_va_range_size_compare);
 
     /* To remain lock-less, we cannot grow the slabs array after the fact. If
      * we commit to a maximum number of allocations here, we can dereference
@@ -2641,9 +3065,20 @@ static bool vkd3d_gpu_va_allocator_init(struct vkd3d_gpu_va_allocator *allocator
 
 static void vkd3d_gpu_va_allocator_cleanup(struct vkd3d_gpu_va_allocator *allocator)
 {
+    struct vkd3d_gpu_va_allocation **node;
+    unsigned int i, j;
+
     vkd3d_mutex_lock(&allocator->mutex);
     vkd3d_free(allocator->slabs);
-    vkd3d_free(allocator->fallback_allocations);
+    rb_destroy(&allocator->fallback_free_ranges, vkd3d_gpu_va_range_destroy, NULL);
+    for (i = 0; i < ARRAY_SIZE(allocator->fallback_pages); ++i)
+    {
+        if (!(node = allocator->fallback_pages[i]))
+            continue;
+        for (j = 0; j < VKD3D_VA_FALLBACK_NODE_SIZE; ++j)
+            vkd3d_free(node[j]);
+        vkd3d_free(node);
+    }
     vkd3d_mutex_unlock(&allocator->mutex);
     vkd3d_mutex_destroy(&allocator->mutex);
 }
@@ -3082,24 +3517,26 @@ static ULONG STDMETHODCALLTYPE d3d12_device_AddRef(ID3D12Device9 *iface)
 
 static HRESULT device_worker_stop(struct d3d12_device *device)
 {
-    HRESULT hr;
+    HRESULT hr, ret = S_OK;
+    unsigned int i;
 
     TRACE("device %p.\n", device);
 
     vkd3d_mutex_lock(&device->worker_mutex);
 
     device->worker_should_exit = true;
-    vkd3d_cond_signal(&device->worker_cond);
+    vkd3d_cond_broadcast(&device->worker_cond);
 
     vkd3d_mutex_unlock(&device->worker_mutex);
 
-    if (FAILED(hr = vkd3d_join_thread(device->vkd3d_instance, &device->worker_thread)))
-        return hr;
-
-    vkd3d_mutex_destroy(&device->worker_mutex);
-    vkd3d_cond_destroy(&device->worker_cond);
+    for (i = 0; i < device->worker_count; ++i)
+    {
+        if (FAILED(hr = vkd3d_join_thread(device->vkd3d_instance, &device->worker_threads[i])))
+            ret = hr;
+    }
+    device->worker_count = 0;
 
-    return S_OK;
+    return ret;
 }
 
 static ULONG STDMETHODCALLTYPE d3d12_device_Release(ID3D12Device9 *iface)
@@ -3113,6 +3550,9 @@ static ULONG STDMETHODCALLTYPE d3d12_device_Release(ID3D12Device9 *iface)
     {
         const struct vkd3d_vk_device_procs *vk_procs = &device->vk_procs;
 
+        device->statistics_dump_time = 0;
+        d3d12_device_dump_statistics(device);
+
         vkd3d_mutex_destroy(&device->blocked_queues_mutex);
 
         vkd3d_private_store_destroy(&device->private_store);
@@ -3122,14 +3562,19 @@ static ULONG STDMETHODCALLTYPE d3d12_device_Release(ID3D12Device9 *iface)
         vkd3d_uav_clear_state_cleanup(&device->uav_clear_state, device);
         vkd3d_destroy_null_resources(&device->null_resources, device);
         vkd3d_gpu_va_allocator_cleanup(&device->gpu_va_allocator);
+        vkd3d_residency_manager_cleanup(&device->residency_manager);
         vkd3d_render_pass_cache_cleanup(&device->render_pass_cache, device);
+        vkd3d_image_allocation_info_cache_cleanup(&device->image_allocation_info_cache);
+        vkd3d_command_allocator_cache_cleanup(&device->command_allocator_cache, device);
+        vkd3d_shared_state_cache_cleanup(&device->shared_state_cache);
         d3d12_device_destroy_pipeline_cache(device);
         d3d12_device_destroy_vkd3d_queues(device);
         vkd3d_desc_object_cache_cleanup(&device->view_desc_cache);
         vkd3d_desc_object_cache_cleanup(&device->cbuffer_desc_cache);
-        if (device->use_vk_heaps)
-            device_worker_stop(device);
-        vkd3d_free(device->heaps);
+        device_worker_stop(device);
+        vkd3d_mutex_destroy(&device->worker_mutex);
+        vkd3d_cond_destroy(&device->worker_cond);
+        vkd3d_cond_destroy(&device->worker_idle_cond);
         VK_CALL(vkDestroyDevice(device->vk_device, NULL));
         if (device->parent)
             IUnknown_Release(device->parent);
@@ -3228,7 +3673,7 @@ static HRESULT STDMETHODCALLTYPE d3d12_device_CreateGraphicsPipelineState(ID3D12
         const D3D12_GRAPHICS_PIPELINE_STATE_DESC *desc, REFIID riid, void **pipeline_state)
 {
     struct d3d12_device *device = impl_from_ID3D12Device9(iface);
-    struct d3d12_pipeline_state *object;
+    struct d3d12_pipeline_state_object *object;
     HRESULT hr;
 
     TRACE("iface %p, desc %p, riid %s, pipeline_state %p.\n",
@@ -3245,7 +3690,7 @@ static HRESULT STDMETHODCALLTYPE d3d12_device_CreateComputePipelineState(ID3D12D
         const D3D12_COMPUTE_PIPELINE_STATE_DESC *desc, REFIID riid, void **pipeline_state)
 {
     struct d3d12_device *device = impl_from_ID3D12Device9(iface);
-    struct d3d12_pipeline_state *object;
+    struct d3d12_pipeline_state_object *object;
     HRESULT hr;
 
     TRACE("iface %p, desc %p, riid %s, pipeline_state %p.\n",
@@ -3483,11 +3928,8 @@ static HRESULT STDMETHODCALLTYPE d3d12_device_CheckFeatureSupport(ID3D12Device9
 
         case D3D12_FEATURE_FORMAT_SUPPORT:
         {
-            const struct vkd3d_vk_device_procs *vk_procs = &device->vk_procs;
             D3D12_FEATURE_DATA_FORMAT_SUPPORT *data = feature_data;
-            VkFormatFeatureFlagBits image_features;
-            const struct vkd3d_format *format;
-            VkFormatProperties properties;
+            const struct vkd3d_format_table_entry *entry;
 
             if (feature_data_size != sizeof(*data))
             {
@@ -3497,64 +3939,15 @@ static HRESULT STDMETHODCALLTYPE d3d12_device_CheckFeatureSupport(ID3D12Device9
 
             data->Support1 = D3D12_FORMAT_SUPPORT1_NONE;
             data->Support2 = D3D12_FORMAT_SUPPORT2_NONE;
-            if (!(format = vkd3d_get_format(device, data->Format, false)))
-                format = vkd3d_get_format(device, data->Format, true);
-            if (!format)
+            if (!(entry = vkd3d_get_format_table_entry(device, data->Format))
+                    || (!entry->format && !entry->depth_stencil_format))
             {
                 FIXME("Unhandled format %#x.\n", data->Format);
                 return E_INVALIDARG;
             }
 
-            VK_CALL(vkGetPhysicalDeviceFormatProperties(device->vk_physical_device, format->vk_format, &properties));
-            image_features = properties.linearTilingFeatures | properties.optimalTilingFeatures;
-
-            if (properties.bufferFeatures)
-                data->Support1 |= D3D12_FORMAT_SUPPORT1_BUFFER;
-            if (properties.bufferFeatures & VK_FORMAT_FEATURE_VERTEX_BUFFER_BIT)
-                data->Support1 |= D3D12_FORMAT_SUPPORT1_IA_VERTEX_BUFFER;
-            if (data->Format == DXGI_FORMAT_R16_UINT || data->Format == DXGI_FORMAT_R32_UINT)
-                data->Support1 |= D3D12_FORMAT_SUPPORT1_IA_INDEX_BUFFER;
-            if (image_features)
-                data->Support1 |= D3D12_FORMAT_SUPPORT1_TEXTURE1D | D3D12_FORMAT_SUPPORT1_TEXTURE2D
-                        | D3D12_FORMAT_SUPPORT1_TEXTURE3D | D3D12_FORMAT_SUPPORT1_TEXTURECUBE;
-            if (image_features & VK_FORMAT_FEATURE_SAMPLED_IMAGE_BIT)
-            {
-                data->Support1 |= D3D12_FORMAT_SUPPORT1_SHADER_LOAD | D3D12_FORMAT_SUPPORT1_MULTISAMPLE_LOAD
-                        | D3D12_FORMAT_SUPPORT1_SHADER_GATHER;
-                if (image_features & VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT)
-                {
-                    data->Support1 |= D3D12_FORMAT_SUPPORT1_SHADER_SAMPLE
-                            | D3D12_FORMAT_SUPPORT1_MIP;
-                }
-                if (format->vk_aspect_mask & VK_IMAGE_ASPECT_DEPTH_BIT)
-                    data->Support1 |= D3D12_FORMAT_SUPPORT1_SHADER_SAMPLE_COMPARISON
-                            | D3D12_FORMAT_SUPPORT1_SHADER_GATHER_COMPARISON;
-            }
-            if (image_features & VK_FORMAT_FEATURE_COLOR_ATTACHMENT_BIT)
-                data->Support1 |= D3D12_FORMAT_SUPPORT1_RENDER_TARGET | D3D12_FORMAT_SUPPORT1_MULTISAMPLE_RENDERTARGET;
-            if (image_features & VK_FORMAT_FEATURE_COLOR_ATTACHMENT_BLEND_BIT)
-                data->Support1 |= D3D12_FORMAT_SUPPORT1_BLENDABLE;
-            if (image_features & VK_FORMAT_FEATURE_DEPTH_STENCIL_ATTACHMENT_BIT)
-                data->Support1 |= D3D12_FORMAT_SUPPORT1_DEPTH_STENCIL;
-            if (image_features & VK_FORMAT_FEATURE_BLIT_SRC_BIT)
-                data->Support1 |= D3D12_FORMAT_SUPPORT1_MULTISAMPLE_RESOLVE;
-            if (image_features & VK_FORMAT_FEATURE_STORAGE_IMAGE_BIT)
-            {
-                data->Support1 |= D3D12_FORMAT_SUPPORT1_TYPED_UNORDERED_ACCESS_VIEW;
-                if (device->vk_info.uav_read_without_format)
-                    data->Support2 |= D3D12_FORMAT_SUPPORT2_UAV_TYPED_LOAD;
-                /* We effectively require shaderStorageImageWriteWithoutFormat,
-                 * so we can just report UAV_TYPED_STORE unconditionally. */
-                data->Support2 |= D3D12_FORMAT_SUPPORT2_UAV_TYPED_STORE;
-            }
-
-            if (image_features & VK_FORMAT_FEATURE_STORAGE_IMAGE_ATOMIC_BIT)
-                data->Support2 |= D3D12_FORMAT_SUPPORT2_UAV_ATOMIC_ADD
-                        | D3D12_FORMAT_SUPPORT2_UAV_ATOMIC_BITWISE_OPS
-                        | D3D12_FORMAT_SUPPORT2_UAV_ATOMIC_COMPARE_STORE_OR_COMPARE_EXCHANGE
-                        | D3D12_FORMAT_SUPPORT2_UAV_ATOMIC_EXCHANGE
-                        | D3D12_FORMAT_SUPPORT2_UAV_ATOMIC_SIGNED_MIN_OR_MAX
-                        | D3D12_FORMAT_SUPPORT2_UAV_ATOMIC_UNSIGNED_MIN_OR_MAX;
+            data->Support1 = entry->support1;
+            data->Support2 = entry->support2;
 
             vkd3d_restrict_format_support_for_feature_level(data);
 
@@ -4194,7 +4587,7 @@ static HRESULT STDMETHODCALLTYPE d3d12_device_CreateRootSignature(ID3D12Device9
         REFIID riid, void **root_signature)
 {
     struct d3d12_device *device = impl_from_ID3D12Device9(iface);
-    struct d3d12_root_signature *object;
+    struct d3d12_root_signature_object *object;
     HRESULT hr;
 
     TRACE("iface %p, node_mask 0x%08x, bytecode %p, bytecode_length %"PRIuPTR", riid %s, root_signature %p.\n",
@@ -4293,7 +4686,7 @@ static void STDMETHODCALLTYPE d3d12_device_CopyDescriptors(ID3D12Device9 *iface,
 {
     struct d3d12_device *device = impl_from_ID3D12Device9(iface);
     unsigned int dst_range_idx, dst_idx, src_range_idx, src_idx;
-    unsigned int dst_range_size, src_range_size;
+    unsigned int dst_range_size, src_range_size, count;
     struct d3d12_descriptor_heap *dst_heap;
     const struct d3d12_desc *src;
     struct d3d12_desc *dst;
@@ -4327,12 +4720,18 @@ static void STDMETHODCALLTYPE d3d12_device_CopyDescriptors(ID3D12Device9 *iface,
         dst_heap = d3d12_desc_get_descriptor_heap(dst);
         src = d3d12_desc_from_cpu_handle(src_descriptor_range_offsets[src_range_idx]);
 
-        for (; dst_idx < dst_range_size && src_idx < src_range_size; ++dst_idx, ++src_idx)
+        count = min(dst_range_size - dst_idx, src_range_size - src_idx);
+        if (count == 1)
         {
-            if (dst[dst_idx].s.u.object == src[src_idx].s.u.object)
-                continue;
-            d3d12_desc_copy(&dst[dst_idx], &src[src_idx], dst_heap, device);
+            if (dst[dst_idx].s.u.object != src[src_idx].s.u.object)
+                d3d12_desc_copy(&dst[dst_idx], &src[src_idx], dst_heap, device);
+        }
+        else if (count)
+        {
+            d3d12_desc_copy_range(&dst[dst_idx], &src[src_idx], count, dst_heap, device);
         }
+        dst_idx += count;
+        src_idx += count;
 
         if (dst_idx >= dst_range_size)
         {
@@ -4664,26 +5063,22 @@ static HRESULT STDMETHODCALLTYPE d3d12_device_OpenSharedHandleByName(ID3D12Devic
 static HRESULT STDMETHODCALLTYPE d3d12_device_MakeResident(ID3D12Device9 *iface,
         UINT object_count, ID3D12Pageable * const *objects)
 {
-    ID3D12Fence *fence;
-    HRESULT hr;
+    struct d3d12_device *device = impl_from_ID3D12Device9(iface);
 
     TRACE("iface %p, object_count %u, objects %p.\n", iface, object_count, objects);
 
-    if (FAILED(hr = ID3D12Device9_CreateFence(iface, 0, 0, &IID_ID3D12Fence, (void **)&fence)))
-        return hr;
-
-    hr = ID3D12Device9_EnqueueMakeResident(iface, 0, object_count, objects, fence, 1);
-    if (SUCCEEDED(hr))
-        ID3D12Fence_SetEventOnCompletion(fence, 1, NULL);
-    ID3D12Fence_Release(fence);
-    return hr;
+    return vkd3d_residency_manager_make_resident(&device->residency_manager, device,
+            D3D12_RESIDENCY_FLAG_NONE, object_count, objects);
 }
 
 static HRESULT STDMETHODCALLTYPE d3d12_device_Evict(ID3D12Device9 *iface,
         UINT object_count, ID3D12Pageable * const *objects)
 {
-    FIXME_ONCE("iface %p, object_count %u, objects %p stub!\n",
-            iface, object_count, objects);
+    struct d3d12_device *device = impl_from_ID3D12Device9(iface);
+
+    TRACE("iface %p, object_count %u, objects %p.\n", iface, object_count, objects);
+
+    vkd3d_residency_manager_evict(&device->residency_manager, object_count, objects);
 
     return S_OK;
 }
@@ -5021,8 +5416,11 @@ static HRESULT STDMETHODCALLTYPE d3d12_device_SetEventOnMultipleFenceCompletion(
 
     if (event == &null_event)
     {
+        uint64_t trace_start = vkd3d_trace_span_begin();
+
         vkd3d_null_event_wait(&null_event);
         vkd3d_null_event_cleanup(&null_event);
+        vkd3d_trace_span_end("Fence wait", trace_start);
     }
 
     return hr;
@@ -5031,7 +5429,11 @@ static HRESULT STDMETHODCALLTYPE d3d12_device_SetEventOnMultipleFenceCompletion(
 static HRESULT STDMETHODCALLTYPE d3d12_device_SetResidencyPriority(ID3D12Device9 *iface,
         UINT object_count, ID3D12Pageable *const *objects, const D3D12_RESIDENCY_PRIORITY *priorities)
 {
-    FIXME_ONCE("iface %p, object_count %u, objects %p, priorities %p stub!\n", iface, object_count, objects, priorities);
+    struct d3d12_device *device = impl_from_ID3D12Device9(iface);
+
+    TRACE("iface %p, object_count %u, objects %p, priorities %p.\n", iface, object_count, objects, priorities);
+
+    vkd3d_residency_manager_set_priority(&device->residency_manager, object_count, objects, priorities);
 
     return S_OK;
 }
@@ -5040,7 +5442,7 @@ static HRESULT STDMETHODCALLTYPE d3d12_device_CreatePipelineState(ID3D12Device9
         const D3D12_PIPELINE_STATE_STREAM_DESC *desc, REFIID iid, void **pipeline_state)
 {
     struct d3d12_device *device = impl_from_ID3D12Device9(iface);
-    struct d3d12_pipeline_state *object;
+    struct d3d12_pipeline_state_object *object;
     HRESULT hr;
 
     TRACE("iface %p, desc %p, iid %s, pipeline_state %p.\n", iface, desc, debugstr_guid(iid), pipeline_state);
@@ -5071,11 +5473,22 @@ static HRESULT STDMETHODCALLTYPE d3d12_device_EnqueueMakeResident(ID3D12Device9
         D3D12_RESIDENCY_FLAGS flags, UINT num_objects, ID3D12Pageable *const *objects,
         ID3D12Fence *fence, UINT64 fence_value)
 {
-    FIXME_ONCE("iface %p, flags %#x, num_objects %u, objects %p, fence %p, fence_value %#"PRIx64" stub!\n",
+    struct d3d12_device *device = impl_from_ID3D12Device9(iface);
+    HRESULT hr;
+
+    TRACE("iface %p, flags %#x, num_objects %u, objects %p, fence %p, fence_value %#"PRIx64".\n",
             iface, flags, num_objects, objects, fence, fence_value);
 
-    ID3D12Fence_Signal(fence, fence_value);
-    return S_OK;
+    if (flags & ~D3D12_RESIDENCY_FLAG_DENY_OVERBUDGET)
+        FIXME("Ignoring flags %#x.\n", flags & ~D3D12_RESIDENCY_FLAG_DENY_OVERBUDGET);
+
+    if (FAILED(hr = vkd3d_residency_manager_make_resident(&device->residency_manager, device,
+            flags, num_objects, objects)))
+        return hr;
+
+    /* Memory priority changes take effect without waiting for the GPU, so
+     * the fence can be signalled from the CPU immediately. */
+    return ID3D12Fence_Signal(fence, fence_value);
 }
 
 static HRESULT STDMETHODCALLTYPE d3d12_device_CreateCommandList1(ID3D12Device9 *iface,
@@ -5537,11 +5950,56 @@ struct d3d12_device *unsafe_impl_from_ID3D12Device9(ID3D12Device9 *iface)
     return impl_from_ID3D12Device9(iface);
 }
 
+/* Copies of large subresources are split into chunks, and are processed by
+ * the workers together with the thread which requested the copy. */
+static void device_worker_copy_chunk_locked(struct d3d12_device *device, struct vkd3d_subresource_copy *copy)
+{
+    unsigned int chunk = copy->next_chunk++;
+    uint64_t row_count;
+
+    if (copy->next_chunk == copy->chunk_count)
+        list_remove(&copy->entry);
+
+    vkd3d_mutex_unlock(&device->worker_mutex);
+
+    row_count = (uint64_t)copy->row_count * copy->slice_count;
+    vkd3d_subresource_copy_rows(copy, chunk * row_count / copy->chunk_count,
+            (chunk + 1) * row_count / copy->chunk_count);
+
+    vkd3d_mutex_lock(&device->worker_mutex);
+
+    if (!--copy->pending_chunk_count)
+        vkd3d_cond_broadcast(&device->worker_idle_cond);
+}
+
+/* Command lists recorded in deferred mode are translated to Vulkan commands
+ * after Close(), by a worker or by the first thread which needs the result. */
+static void device_worker_translate_locked(struct d3d12_device *device, struct d3d12_command_list *list)
+{
+    list_remove(&list->deferred.entry);
+    list->deferred.translation_state = VKD3D_TRANSLATION_ACTIVE;
+
+    vkd3d_mutex_unlock(&device->worker_mutex);
+
+    d3d12_command_list_translate(list);
+
+    vkd3d_mutex_lock(&device->worker_mutex);
+
+    list->deferred.translation_state = VKD3D_TRANSLATION_IDLE;
+    vkd3d_cond_broadcast(&device->worker_idle_cond);
+}
+
+/* Descriptor updates are not written to Vulkan descriptor sets until a command list
+ * is submitted to a queue, while the client is free to write d3d12 descriptors earlier,
+ * from any thread. This causes a delay right before command list execution, so
+ * handling these updates in worker threads can speed up execution significantly.
+ * Heaps are queued when they become dirty, and each queued heap is flushed by a
+ * single worker, because Vulkan requires updates to a descriptor set to be
+ * externally synchronised. */
 static void *device_worker_main(void *arg)
 {
     struct d3d12_descriptor_heap *heap;
     struct d3d12_device *device = arg;
-    size_t i;
 
     vkd3d_set_thread_name("device_worker");
 
@@ -5549,21 +6007,44 @@ static void *device_worker_main(void *arg)
 
     while (!device->worker_should_exit)
     {
-        for (i = 0; i < device->heap_count; ++i)
+        if (!list_empty(&device->copy_jobs))
         {
-            /* Descriptor updates are not written to Vulkan descriptor sets until a command list
-             * is submitted to a queue, while the client is free to write d3d12 descriptors earlier,
-             * from any thread. This causes a delay right before command list execution, so
-             * handling these updates in a worker thread can speed up execution significantly. */
-            heap = device->heaps[i];
-            if (heap->dirty_list_head == UINT_MAX)
-                continue;
-            vkd3d_mutex_lock(&heap->vk_sets_mutex);
-            d3d12_desc_flush_vk_heap_updates_locked(heap, device);
-            vkd3d_mutex_unlock(&heap->vk_sets_mutex);
+            device_worker_copy_chunk_locked(device,
+                    LIST_ENTRY(list_head(&device->copy_jobs), struct vkd3d_subresource_copy, entry));
+            continue;
+        }
+
+        if (!list_empty(&device->translation_jobs))
+        {
+            device_worker_translate_locked(device,
+                    LIST_ENTRY(list_head(&device->translation_jobs), struct d3d12_command_list, deferred.entry));
+            continue;
+        }
+
+        if (list_empty(&device->dirty_heaps))
+        {
+            vkd3d_cond_wait(&device->worker_cond, &device->worker_mutex);
+            continue;
         }
 
-        vkd3d_cond_wait(&device->worker_cond, &device->worker_mutex);
+        heap = LIST_ENTRY(list_head(&device->dirty_heaps), struct d3d12_descriptor_heap, dirty_heap_entry);
+        list_remove(&heap->dirty_heap_entry);
+        list_init(&heap->dirty_heap_entry);
+        ++heap->flush_count;
+
+        vkd3d_mutex_unlock(&device->worker_mutex);
+
+        /* Writes made after this point queue the heap again. */
+        vkd3d_atomic_exchange_u32(&heap->flush_queued, 0);
+
+        vkd3d_mutex_lock(&heap->vk_sets_mutex);
+        d3d12_desc_flush_vk_heap_updates_locked(heap, device);
+        vkd3d_mutex_unlock(&heap->vk_sets_mutex);
+
+        vkd3d_mutex_lock(&device->worker_mutex);
+
+        if (!--heap->flush_count)
+            vkd3d_cond_broadcast(&device->worker_idle_cond);
     }
 
     vkd3d_mutex_unlock(&device->worker_mutex);
@@ -5571,10 +6052,67 @@ static void *device_worker_main(void *arg)
     return NULL;
 }
 
+static unsigned int vkd3d_get_cpu_count(void)
+{
+#ifdef _WIN32
+    SYSTEM_INFO info;
+
+    GetSystemInfo(&info);
+    return info.dwNumberOfProcessors;
+#elif defined(_SC_NPROCESSORS_ONLN)
+    long count = sysconf(_SC_NPROCESSORS_ONLN);
+
+    return count > 0 ? count : 1;
+#else
+    return 1;
+#endif
+}
+
+static unsigned int device_worker_get_count(void)
+{
+    unsigned int count, cpu_count;
+
+    /* Leave a CPU for the application's own threads. */
+    cpu_count = vkd3d_get_cpu_count();
+    count = vkd3d_env_var_as_uint("VKD3D_WORKER_THREADS", cpu_count > 1 ? cpu_count - 1 : 1);
+
+    /* Without workers, queued heap flushes would wait until submission. */
+    count = vkd3d_clamp(count, 1u, VKD3D_MAX_DEVICE_WORKER_COUNT);
+    TRACE("Using %u worker threads, %u CPUs.\n", count, cpu_count);
+
+    return count;
+}
+
+/* Without workers, descriptor heaps are still flushed on submission, and
+ * copies and translations are done by the thread which needs them, so failing
+ * to start some or all of them is not fatal. */
+static void device_worker_start_locked(struct d3d12_device *device)
+{
+    unsigned int count;
+    HRESULT hr;
+
+    if (device->worker_started)
+        return;
+    device->worker_started = true;
+
+    count = device_worker_get_count();
+    for (device->worker_count = 0; device->worker_count < count; ++device->worker_count)
+    {
+        if (FAILED(hr = vkd3d_create_thread(device->vkd3d_instance, device_worker_main,
+                device, &device->worker_threads[device->worker_count])))
+        {
+            WARN("Failed to create worker thread, hr %s.\n", debugstr_hresult(hr));
+            break;
+        }
+    }
+}
+
 static HRESULT d3d12_device_init(struct d3d12_device *device,
         struct vkd3d_instance *instance, const struct vkd3d_device_create_info *create_info)
 {
+    uint64_t start_time, vk_device_time, format_info_time, heap_layouts_time, end_time;
     const struct vkd3d_vk_device_procs *vk_procs;
+    size_t descriptor_data_size;
     HRESULT hr;
 
     device->ID3D12Device9_iface.lpVtbl = &d3d12_device_vtbl;
@@ -5592,16 +6130,25 @@ static HRESULT d3d12_device_init(struct d3d12_device *device,
 
     device->vk_device = VK_NULL_HANDLE;
 
-    device->heaps = NULL;
-    device->heap_capacity = 0;
-    device->heap_count = 0;
-    memset(&device->worker_thread, 0, sizeof(device->worker_thread));
+    list_init(&device->dirty_heaps);
+    list_init(&device->copy_jobs);
+    list_init(&device->translation_jobs);
+    memset(device->worker_threads, 0, sizeof(device->worker_threads));
+    device->worker_count = 0;
+    device->worker_started = false;
     device->worker_should_exit = false;
     vkd3d_mutex_init(&device->worker_mutex);
     vkd3d_cond_init(&device->worker_cond);
+    vkd3d_cond_init(&device->worker_idle_cond);
+
+    memset(&device->statistics, 0, sizeof(device->statistics));
+    device->statistics_dump_time = 0;
+
+    start_time = vkd3d_get_monotonic_time_ns();
 
     if (FAILED(hr = vkd3d_create_vk_device(device, create_info)))
         goto out_free_instance;
+    vk_device_time = vkd3d_get_monotonic_time_ns();
 
     if (FAILED(hr = d3d12_device_init_pipeline_cache(device)))
         goto out_free_vk_resources;
@@ -5611,47 +6158,49 @@ static HRESULT d3d12_device_init(struct d3d12_device *device,
 
     if (FAILED(hr = vkd3d_init_format_info(device)))
         goto out_free_private_store;
+    format_info_time = vkd3d_get_monotonic_time_ns();
 
-    if (FAILED(hr = vkd3d_init_null_resources(&device->null_resources, device)))
-        goto out_cleanup_format_info;
-
-    if (FAILED(hr = vkd3d_uav_clear_state_init(&device->uav_clear_state, device)))
-        goto out_destroy_null_resources;
+    /* NULL resources and UAV clear pipelines are created on first use. */
+    vkd3d_init_null_resources(&device->null_resources);
+    vkd3d_uav_clear_state_init(&device->uav_clear_state);
 
     if (FAILED(hr = vkd3d_vk_descriptor_heap_layouts_init(device)))
         goto out_cleanup_uav_clear_state;
-
-    if (device->use_vk_heaps && FAILED(hr = vkd3d_create_thread(device->vkd3d_instance,
-            device_worker_main, device, &device->worker_thread)))
-    {
-        WARN("Failed to create worker thread, hr %s.\n", debugstr_hresult(hr));
-        goto out_cleanup_descriptor_heap_layouts;
-    }
+    heap_layouts_time = vkd3d_get_monotonic_time_ns();
 
     vkd3d_render_pass_cache_init(&device->render_pass_cache);
+    vkd3d_image_allocation_info_cache_init(&device->image_allocation_info_cache);
+    vkd3d_command_allocator_cache_init(&device->command_allocator_cache);
+    vkd3d_shared_state_cache_init(&device->shared_state_cache);
     vkd3d_gpu_va_allocator_init(&device->gpu_va_allocator);
+    vkd3d_residency_manager_init(&device->residency_manager);
     vkd3d_time_domains_init(device);
 
     device->blocked_queue_count = 0;
     vkd3d_mutex_init(&device->blocked_queues_mutex);
 
-    vkd3d_desc_object_cache_init(&device->view_desc_cache, sizeof(struct vkd3d_view));
-    vkd3d_desc_object_cache_init(&device->cbuffer_desc_cache, sizeof(struct vkd3d_cbuffer_desc));
+    /* Views may also hold the descriptor data of a UAV counter. */
+    descriptor_data_size = device->use_descriptor_buffers ? device->descriptor_buffer.max_descriptor_size : 0;
+    vkd3d_desc_object_cache_init(&device->view_desc_cache, sizeof(struct vkd3d_view) + 2 * descriptor_data_size);
+    vkd3d_desc_object_cache_init(&device->cbuffer_desc_cache, sizeof(struct vkd3d_cbuffer_desc) + descriptor_data_size);
 
     device_init_descriptor_pool_sizes(device);
 
     if ((device->parent = create_info->parent))
         IUnknown_AddRef(device->parent);
 
+    end_time = vkd3d_get_monotonic_time_ns();
+    TRACE("Device %p initialised in %.3f ms: Vulkan device %.3f ms, formats %.3f ms, "
+            "descriptor heap layouts %.3f ms, other %.3f ms.\n", device,
+            (end_time - start_time) / 1000000.0, (vk_device_time - start_time) / 1000000.0,
+            (format_info_time - vk_device_time) / 1000000.0, (heap_layouts_time - format_info_time) / 1000000.0,
+            (end_time - heap_layouts_time) / 1000000.0);
+
     return S_OK;
 
-out_cleanup_descriptor_heap_layouts:
-    vkd3d_vk_descriptor_heap_layouts_cleanup(device);
 out_cleanup_uav_clear_state:
     vkd3d_uav_clear_state_cleanup(&device->uav_clear_state, device);
-out_destroy_null_resources:
     vkd3d_destroy_null_resources(&device->null_resources, device);
-out_cleanup_format_info:
     vkd3d_cleanup_format_info(device);
 out_free_private_store:
     vkd3d_private_store_destroy(&device->private_store);
@@ -5662,6 +6211,9 @@ out_free_vk_resources:
     VK_CALL(vkDestroyDevice(device->vk_device, NULL));
 out_free_instance:
     vkd3d_instance_decref(device->vkd3d_instance);
+    vkd3d_mutex_destroy(&device->worker_mutex);
+    vkd3d_cond_destroy(&device->worker_cond);
+    vkd3d_cond_destroy(&device->worker_idle_cond);
     return hr;
 }
 
@@ -5700,37 +6252,151 @@ void d3d12_device_mark_as_removed(struct d3d12_device *device, HRESULT reason,
     device->removed_reason = reason;
 }
 
-HRESULT d3d12_device_add_descriptor_heap(struct d3d12_device *device, struct d3d12_descriptor_heap *heap)
+void d3d12_device_queue_descriptor_heap_flush(struct d3d12_device *device, struct d3d12_descriptor_heap *heap)
 {
     vkd3d_mutex_lock(&device->worker_mutex);
 
-    if (!vkd3d_array_reserve((void **)&device->heaps, &device->heap_capacity, device->heap_count + 1,
-            sizeof(*device->heaps)))
+    device_worker_start_locked(device);
+    list_add_tail(&device->dirty_heaps, &heap->dirty_heap_entry);
+    vkd3d_cond_signal(&device->worker_cond);
+
+    vkd3d_mutex_unlock(&device->worker_mutex);
+}
+
+#define VKD3D_PARALLEL_COPY_MIN_SIZE 0x400000u
+#define VKD3D_COPY_CHUNK_MIN_SIZE 0x100000u
+
+void d3d12_device_copy_subresource(struct d3d12_device *device, struct vkd3d_subresource_copy *copy)
+{
+    uint64_t row_count = (uint64_t)copy->row_count * copy->slice_count;
+    uint64_t size = row_count * copy->row_size;
+
+    if (size < VKD3D_PARALLEL_COPY_MIN_SIZE || row_count < 2)
+    {
+        vkd3d_subresource_copy_rows(copy, 0, row_count);
+        return;
+    }
+
+    vkd3d_mutex_lock(&device->worker_mutex);
+
+    device_worker_start_locked(device);
+    if (!device->worker_count)
     {
         vkd3d_mutex_unlock(&device->worker_mutex);
-        return E_OUTOFMEMORY;
+        vkd3d_subresource_copy_rows(copy, 0, row_count);
+        return;
     }
-    device->heaps[device->heap_count++] = heap;
+
+    /* Use a few chunks per thread, to balance the load between threads. */
+    copy->chunk_count = min(row_count, (device->worker_count + 1) * 2);
+    copy->chunk_count = min(copy->chunk_count, size / VKD3D_COPY_CHUNK_MIN_SIZE);
+    copy->next_chunk = 0;
+    copy->pending_chunk_count = copy->chunk_count;
+
+    TRACE("Copying %"PRIu64" bytes in %u chunks.\n", size, copy->chunk_count);
+
+    list_add_tail(&device->copy_jobs, &copy->entry);
+    vkd3d_cond_broadcast(&device->worker_cond);
+
+    while (copy->next_chunk < copy->chunk_count)
+        device_worker_copy_chunk_locked(device, copy);
+    while (copy->pending_chunk_count)
+        vkd3d_cond_wait(&device->worker_idle_cond, &device->worker_mutex);
 
     vkd3d_mutex_unlock(&device->worker_mutex);
+}
 
-    return S_OK;
+void d3d12_device_queue_command_list_translation(struct d3d12_device *device, struct d3d12_command_list *list)
+{
+    vkd3d_mutex_lock(&device->worker_mutex);
+
+    device_worker_start_locked(device);
+    list->deferred.translation_state = VKD3D_TRANSLATION_QUEUED;
+    list_add_tail(&device->translation_jobs, &list->deferred.entry);
+    vkd3d_cond_signal(&device->worker_cond);
+
+    vkd3d_mutex_unlock(&device->worker_mutex);
 }
 
-void d3d12_device_remove_descriptor_heap(struct d3d12_device *device, struct d3d12_descriptor_heap *heap)
+void d3d12_device_wait_command_list_translation(struct d3d12_device *device, struct d3d12_command_list *list)
 {
-    size_t i;
+    vkd3d_mutex_lock(&device->worker_mutex);
+
+    /* Translate on this thread rather than wait for a worker to pick it up. */
+    if (list->deferred.translation_state == VKD3D_TRANSLATION_QUEUED)
+        device_worker_translate_locked(device, list);
+    while (list->deferred.translation_state != VKD3D_TRANSLATION_IDLE)
+        vkd3d_cond_wait(&device->worker_idle_cond, &device->worker_mutex);
+
+    vkd3d_mutex_unlock(&device->worker_mutex);
+}
+
+static void d3d12_device_get_statistics(struct d3d12_device *device, struct vkd3d_device_statistics *statistics)
+{
+#define COPY_STATISTIC(member) \
+        statistics->member = vkd3d_atomic_load_u64_relaxed(&device->statistics.member)
+    COPY_STATISTIC(pipeline_state_count);
+    COPY_STATISTIC(pipeline_state_reuse_count);
+    COPY_STATISTIC(pipeline_state_time);
+    COPY_STATISTIC(vk_pipeline_count);
+    COPY_STATISTIC(vk_pipeline_time);
+    COPY_STATISTIC(vk_render_pass_count);
+    COPY_STATISTIC(vk_framebuffer_count);
+    COPY_STATISTIC(vk_sampler_count);
+    COPY_STATISTIC(vk_image_view_count);
+    COPY_STATISTIC(vk_buffer_view_count);
+    COPY_STATISTIC(vk_descriptor_set_count);
+    COPY_STATISTIC(vk_queue_submit_count);
+    COPY_STATISTIC(descriptor_flush_count);
+    COPY_STATISTIC(descriptor_flush_time);
+    COPY_STATISTIC(deferred_command_count);
+    COPY_STATISTIC(deferred_flush_count);
+#undef COPY_STATISTIC
+}
+
+#define VKD3D_STATISTICS_DUMP_INTERVAL_NS 1000000000ull
+
+/* Called on each submission; logs the statistics at most once per interval. */
+void d3d12_device_dump_statistics(struct d3d12_device *device)
+{
+    struct vkd3d_device_statistics statistics;
+    uint64_t now, dump_time;
+
+    if (!(device->vkd3d_instance->config_flags & VKD3D_CONFIG_FLAG_STATISTICS))
+        return;
+
+    now = vkd3d_get_monotonic_time_ns();
+    dump_time = vkd3d_atomic_load_u64_relaxed(&device->statistics_dump_time);
+    if (now < dump_time || !vkd3d_atomic_compare_exchange_u64(&device->statistics_dump_time,
+            dump_time, now + VKD3D_STATISTICS_DUMP_INTERVAL_NS))
+        return;
+
+    d3d12_device_get_statistics(device, &statistics);
+
+    MESSAGE("Device %p: %"PRIu64" pipeline states (%"PRIu64" reused, %.3f ms), "
+            "%"PRIu64" Vulkan pipelines (%.3f ms).\n", device,
+            statistics.pipeline_state_count, statistics.pipeline_state_reuse_count,
+            statistics.pipeline_state_time / 1000000.0,
+            statistics.vk_pipeline_count, statistics.vk_pipeline_time / 1000000.0);
+    MESSAGE("Device %p: %"PRIu64" render passes, %"PRIu64" framebuffers, %"PRIu64" samplers, "
+            "%"PRIu64" image views, %"PRIu64" buffer views, %"PRIu64" descriptor sets.\n", device,
+            statistics.vk_render_pass_count, statistics.vk_framebuffer_count, statistics.vk_sampler_count,
+            statistics.vk_image_view_count, statistics.vk_buffer_view_count, statistics.vk_descriptor_set_count);
+    MESSAGE("Device %p: %"PRIu64" queue submissions, %"PRIu64" descriptor flushes (%.3f ms).\n", device,
+            statistics.vk_queue_submit_count, statistics.descriptor_flush_count,
+            statistics.descriptor_flush_time / 1000000.0);
+    MESSAGE("Device %p: %"PRIu64" deferred commands, %"PRIu64" deferred command flushes.\n", device,
+            statistics.deferred_command_count, statistics.deferred_flush_count);
+}
 
+void d3d12_device_remove_descriptor_heap(struct d3d12_device *device, struct d3d12_descriptor_heap *heap)
+{
     vkd3d_mutex_lock(&device->worker_mutex);
 
-    for (i = 0; i < device->heap_count; ++i)
-    {
-        if (device->heaps[i] == heap)
-        {
-            device->heaps[i] = device->heaps[--device->heap_count];
-            break;
-        }
-    }
+    while (heap->flush_count)
+        vkd3d_cond_wait(&device->worker_idle_cond, &device->worker_mutex);
+    /* The entry is self-linked when the heap is not queued. */
+    list_remove(&heap->dirty_heap_entry);
 
     vkd3d_mutex_unlock(&device->worker_mutex);
 }
@@ -5839,6 +6505,21 @@ VkDevice vkd3d_get_vk_device(ID3D12Device *device)
     return d3d12_device->vk_device;
 }
 
+void vkd3d_get_device_statistics(ID3D12Device *device, struct vkd3d_device_statistics *statistics)
+{
+    struct d3d12_device *d3d12_device = impl_from_ID3D12Device9((ID3D12Device9 *)device);
+
+    TRACE("device %p, statistics %p.\n", device, statistics);
+
+    if (statistics->type != VKD3D_STRUCTURE_TYPE_DEVICE_STATISTICS)
+    {
+        WARN("Invalid structure type %#x.\n", statistics->type);
+        return;
+    }
+
+    d3d12_device_get_statistics(d3d12_device, statistics);
+}
+
 VkPhysicalDevice vkd3d_get_vk_physical_device(ID3D12Device *device)
 {
     struct d3d12_device *d3d12_device = impl_from_ID3D12Device9((ID3D12Device9 *)device);
@@ -20,6 +20,9 @@
 #include "vkd3d_private.h"
 
 #define VKD3D_NULL_BUFFER_SIZE 16
+/* Loads through buffer device addresses are not bounds checked, so a NULL
+ * root CBV must be backed by a buffer covering a whole constant buffer. */
+#define VKD3D_NULL_CONSTANT_BUFFER_SIZE (D3D12_REQ_CONSTANT_BUFFER_ELEMENT_COUNT * 16)
 #define VKD3D_NULL_VIEW_FORMAT DXGI_FORMAT_R8G8B8A8_UNORM
 
 uint64_t object_global_serial_id;
@@ -111,6 +114,18 @@ static HRESULT vkd3d_select_memory_type(struct d3d12_device *device, uint32_t me
     return E_FAIL;
 }
 
+static VkDeviceAddress vkd3d_get_buffer_device_address(struct d3d12_device *device, VkBuffer vk_buffer)
+{
+    const struct vkd3d_vk_device_procs *vk_procs = &device->vk_procs;
+    VkBufferDeviceAddressInfoKHR address_info;
+
+    address_info.sType = VK_STRUCTURE_TYPE_BUFFER_DEVICE_ADDRESS_INFO_KHR;
+    address_info.pNext = NULL;
+    address_info.buffer = vk_buffer;
+
+    return VK_CALL(vkGetBufferDeviceAddressKHR(device->vk_device, &address_info));
+}
+
 static HRESULT vkd3d_allocate_device_memory(struct d3d12_device *device,
         const D3D12_HEAP_PROPERTIES *heap_properties, D3D12_HEAP_FLAGS heap_flags,
         const VkMemoryRequirements *memory_requirements,
@@ -118,6 +133,7 @@ static HRESULT vkd3d_allocate_device_memory(struct d3d12_device *device,
         VkDeviceMemory *vk_memory, uint32_t *vk_memory_type)
 {
     const struct vkd3d_vk_device_procs *vk_procs = &device->vk_procs;
+    VkMemoryAllocateFlagsInfo flags_info;
     VkMemoryAllocateInfo allocate_info;
     VkResult vr;
     HRESULT hr;
@@ -127,6 +143,16 @@ static HRESULT vkd3d_allocate_device_memory(struct d3d12_device *device,
 
     allocate_info.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
     allocate_info.pNext = dedicated_allocate_info;
+    /* Descriptor buffers and root buffer addresses address all buffers,
+     * which may be bound to any allocation. */
+    if (device->use_descriptor_buffers || device->use_root_buffer_addresses)
+    {
+        flags_info.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_FLAGS_INFO;
+        flags_info.pNext = dedicated_allocate_info;
+        flags_info.flags = VK_MEMORY_ALLOCATE_DEVICE_ADDRESS_BIT_KHR;
+        flags_info.deviceMask = 0;
+        allocate_info.pNext = &flags_info;
+    }
     allocate_info.allocationSize = memory_requirements->size;
     if (FAILED(hr = vkd3d_select_memory_type(device, memory_requirements->memoryTypeBits,
             heap_properties, heap_flags, &allocate_info.memoryTypeIndex)))
@@ -332,6 +358,8 @@ static void d3d12_heap_destroy(struct d3d12_heap *heap)
     if (heap->map_ptr)
         VK_CALL(vkUnmapMemory(device->vk_device, heap->vk_memory));
 
+    vkd3d_residency_manager_remove_heap(&device->residency_manager, heap);
+
     VK_CALL(vkFreeMemory(device->vk_device, heap->vk_memory, NULL));
 
     vkd3d_mutex_destroy(&heap->mutex);
@@ -559,6 +587,8 @@ static HRESULT d3d12_heap_init(struct d3d12_heap *heap,
     if (!heap->is_private)
         d3d12_device_add_ref(heap->device);
 
+    vkd3d_residency_manager_add_heap(&device->residency_manager, heap);
+
     if (d3d12_heap_get_memory_property_flags(heap) & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT)
     {
         if ((vr = VK_CALL(vkMapMemory(device->vk_device,
@@ -699,6 +729,8 @@ HRESULT vkd3d_create_buffer(struct d3d12_device *device,
         buffer_info.usage |= VK_BUFFER_USAGE_STORAGE_TEXEL_BUFFER_BIT;
     if (!(desc->Flags & D3D12_RESOURCE_FLAG_DENY_SHADER_RESOURCE))
         buffer_info.usage |= VK_BUFFER_USAGE_UNIFORM_TEXEL_BUFFER_BIT;
+    if (device->use_descriptor_buffers || device->use_root_buffer_addresses)
+        buffer_info.usage |= VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT_KHR;
 
     /* Buffers always have properties of D3D12_RESOURCE_FLAG_ALLOW_SIMULTANEOUS_ACCESS. */
     if (desc->Flags & D3D12_RESOURCE_FLAG_ALLOW_SIMULTANEOUS_ACCESS)
@@ -774,18 +806,23 @@ static bool vkd3d_is_linear_tiling_supported(const struct d3d12_device *device,
             && (image_info->samples & properties.sampleCounts);
 }
 
-static HRESULT vkd3d_create_image(struct d3d12_device *device,
+struct vkd3d_image_create_info
+{
+    VkImageFormatListCreateInfoKHR format_list;
+    VkImageCreateInfo image_info;
+};
+
+static HRESULT vkd3d_get_image_create_info(struct d3d12_device *device,
         const D3D12_HEAP_PROPERTIES *heap_properties, D3D12_HEAP_FLAGS heap_flags,
-        const D3D12_RESOURCE_DESC1 *desc, struct d3d12_resource *resource, VkImage *vk_image)
+        const D3D12_RESOURCE_DESC1 *desc, struct d3d12_resource *resource, struct vkd3d_image_create_info *create_info)
 {
+    VkImageFormatListCreateInfoKHR *format_list = &create_info->format_list;
     const struct vkd3d_vk_device_procs *vk_procs = &device->vk_procs;
+    VkImageCreateInfo *image_info = &create_info->image_info;
     const struct vkd3d_format_compatibility_list *compat_list;
     const bool sparse_resource = !heap_properties;
-    VkImageFormatListCreateInfoKHR format_list;
     const struct vkd3d_format *format;
-    VkImageCreateInfo image_info;
     uint32_t count;
-    VkResult vr;
 
     if (resource)
     {
@@ -797,61 +834,61 @@ static HRESULT vkd3d_create_image(struct d3d12_device *device,
         return E_INVALIDARG;
     }
 
-    image_info.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
-    image_info.pNext = NULL;
-    image_info.flags = 0;
+    image_info->sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+    image_info->pNext = NULL;
+    image_info->flags = 0;
     if (desc->Flags & D3D12_RESOURCE_FLAG_ALLOW_UNORDERED_ACCESS)
     {
         /* Format compatibility rules are more relaxed for UAVs. */
         if (format->type != VKD3D_FORMAT_TYPE_UINT)
-            image_info.flags |= VK_IMAGE_CREATE_MUTABLE_FORMAT_BIT;
+            image_info->flags |= VK_IMAGE_CREATE_MUTABLE_FORMAT_BIT;
     }
     else if (!(desc->Flags & D3D12_RESOURCE_FLAG_ALLOW_DEPTH_STENCIL) && format->type == VKD3D_FORMAT_TYPE_TYPELESS)
     {
-        image_info.flags |= VK_IMAGE_CREATE_MUTABLE_FORMAT_BIT;
+        image_info->flags |= VK_IMAGE_CREATE_MUTABLE_FORMAT_BIT;
 
         if ((compat_list = vkd3d_get_format_compatibility_list(device, desc->Format)))
         {
-            format_list.sType = VK_STRUCTURE_TYPE_IMAGE_FORMAT_LIST_CREATE_INFO_KHR;
-            format_list.pNext = NULL;
-            format_list.viewFormatCount = compat_list->format_count;
-            format_list.pViewFormats = compat_list->vk_formats;
+            format_list->sType = VK_STRUCTURE_TYPE_IMAGE_FORMAT_LIST_CREATE_INFO_KHR;
+            format_list->pNext = NULL;
+            format_list->viewFormatCount = compat_list->format_count;
+            format_list->pViewFormats = compat_list->vk_formats;
 
-            image_info.pNext = &format_list;
+            image_info->pNext = format_list;
         }
     }
     if (desc->Dimension == D3D12_RESOURCE_DIMENSION_TEXTURE2D
             && desc->Width == desc->Height && desc->DepthOrArraySize >= 6
             && desc->SampleDesc.Count == 1)
-        image_info.flags |= VK_IMAGE_CREATE_CUBE_COMPATIBLE_BIT;
+        image_info->flags |= VK_IMAGE_CREATE_CUBE_COMPATIBLE_BIT;
     if (desc->Dimension == D3D12_RESOURCE_DIMENSION_TEXTURE3D)
-        image_info.flags |= VK_IMAGE_CREATE_2D_ARRAY_COMPATIBLE_BIT_KHR;
+        image_info->flags |= VK_IMAGE_CREATE_2D_ARRAY_COMPATIBLE_BIT_KHR;
 
     if (sparse_resource)
     {
-        image_info.flags |= VK_IMAGE_CREATE_SPARSE_BINDING_BIT;
+        image_info->flags |= VK_IMAGE_CREATE_SPARSE_BINDING_BIT;
         if (device->vk_info.sparse_properties.residencyNonResidentStrict)
-            image_info.flags |= VK_IMAGE_CREATE_SPARSE_RESIDENCY_BIT;
+            image_info->flags |= VK_IMAGE_CREATE_SPARSE_RESIDENCY_BIT;
     }
 
-    image_info.imageType = vk_image_type_from_d3d12_resource_dimension(desc->Dimension);
-    image_info.format = format->vk_format;
-    image_info.extent.width = desc->Width;
-    image_info.extent.height = desc->Height;
+    image_info->imageType = vk_image_type_from_d3d12_resource_dimension(desc->Dimension);
+    image_info->format = format->vk_format;
+    image_info->extent.width = desc->Width;
+    image_info->extent.height = desc->Height;
 
     if (desc->Dimension == D3D12_RESOURCE_DIMENSION_TEXTURE3D)
     {
-        image_info.extent.depth = desc->DepthOrArraySize;
-        image_info.arrayLayers = 1;
+        image_info->extent.depth = desc->DepthOrArraySize;
+        image_info->arrayLayers = 1;
     }
     else
     {
-        image_info.extent.depth = 1;
-        image_info.arrayLayers = desc->DepthOrArraySize;
+        image_info->extent.depth = 1;
+        image_info->arrayLayers = desc->DepthOrArraySize;
     }
 
-    image_info.mipLevels = min(desc->MipLevels, max_miplevel_count(desc));
-    image_info.samples = vk_samples_from_dxgi_sample_desc(&desc->SampleDesc);
+    image_info->mipLevels = min(desc->MipLevels, max_miplevel_count(desc));
+    image_info->samples = vk_samples_from_dxgi_sample_desc(&desc->SampleDesc);
 
     if (sparse_resource)
     {
@@ -861,15 +898,15 @@ static HRESULT vkd3d_create_image(struct d3d12_device *device,
             return E_INVALIDARG;
         }
 
-        image_info.tiling = VK_IMAGE_TILING_OPTIMAL;
+        image_info->tiling = VK_IMAGE_TILING_OPTIMAL;
     }
     else if (desc->Layout == D3D12_TEXTURE_LAYOUT_UNKNOWN)
     {
-        image_info.tiling = VK_IMAGE_TILING_OPTIMAL;
+        image_info->tiling = VK_IMAGE_TILING_OPTIMAL;
     }
     else if (desc->Layout == D3D12_TEXTURE_LAYOUT_ROW_MAJOR)
     {
-        image_info.tiling = VK_IMAGE_TILING_LINEAR;
+        image_info->tiling = VK_IMAGE_TILING_LINEAR;
     }
     else
     {
@@ -877,103 +914,251 @@ static HRESULT vkd3d_create_image(struct d3d12_device *device,
         return E_NOTIMPL;
     }
 
-    image_info.usage = VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT;
+    image_info->usage = VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT;
     if (desc->Flags & D3D12_RESOURCE_FLAG_ALLOW_RENDER_TARGET)
-        image_info.usage |= VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT;
+        image_info->usage |= VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT;
     if (desc->Flags & D3D12_RESOURCE_FLAG_ALLOW_DEPTH_STENCIL)
-        image_info.usage |= VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT;
+        image_info->usage |= VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT;
     if (desc->Flags & D3D12_RESOURCE_FLAG_ALLOW_UNORDERED_ACCESS)
-        image_info.usage |= VK_IMAGE_USAGE_STORAGE_BIT;
+        image_info->usage |= VK_IMAGE_USAGE_STORAGE_BIT;
     if (!(desc->Flags & D3D12_RESOURCE_FLAG_DENY_SHADER_RESOURCE))
-        image_info.usage |= VK_IMAGE_USAGE_SAMPLED_BIT;
+        image_info->usage |= VK_IMAGE_USAGE_SAMPLED_BIT;
 
     if ((desc->Flags & D3D12_RESOURCE_FLAG_ALLOW_SIMULTANEOUS_ACCESS) && device->queue_family_count > 1)
     {
         TRACE("Creating image with VK_SHARING_MODE_CONCURRENT.\n");
-        image_info.sharingMode = VK_SHARING_MODE_CONCURRENT;
-        image_info.queueFamilyIndexCount = device->queue_family_count;
-        image_info.pQueueFamilyIndices = device->queue_family_indices;
+        image_info->sharingMode = VK_SHARING_MODE_CONCURRENT;
+        image_info->queueFamilyIndexCount = device->queue_family_count;
+        image_info->pQueueFamilyIndices = device->queue_family_indices;
     }
     else
     {
-        image_info.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
-        image_info.queueFamilyIndexCount = 0;
-        image_info.pQueueFamilyIndices = NULL;
+        image_info->sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+        image_info->queueFamilyIndexCount = 0;
+        image_info->pQueueFamilyIndices = NULL;
     }
 
     if (heap_properties && is_cpu_accessible_heap(heap_properties))
     {
-        image_info.initialLayout = VK_IMAGE_LAYOUT_PREINITIALIZED;
+        image_info->initialLayout = VK_IMAGE_LAYOUT_PREINITIALIZED;
 
-        if (vkd3d_is_linear_tiling_supported(device, &image_info))
+        if (vkd3d_is_linear_tiling_supported(device, image_info))
         {
             /* Required for ReadFromSubresource(). */
             WARN("Forcing VK_IMAGE_TILING_LINEAR for CPU readable texture.\n");
-            image_info.tiling = VK_IMAGE_TILING_LINEAR;
+            image_info->tiling = VK_IMAGE_TILING_LINEAR;
         }
     }
     else
     {
-        image_info.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+        image_info->initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
     }
 
-    if (resource && image_info.tiling == VK_IMAGE_TILING_LINEAR)
+    if (resource && image_info->tiling == VK_IMAGE_TILING_LINEAR)
         resource->flags |= VKD3D_RESOURCE_LINEAR_TILING;
 
     if (sparse_resource)
     {
         count = 0;
-        VK_CALL(vkGetPhysicalDeviceSparseImageFormatProperties(device->vk_physical_device, image_info.format,
-                image_info.imageType, image_info.samples, image_info.usage, image_info.tiling, &count, NULL));
+        VK_CALL(vkGetPhysicalDeviceSparseImageFormatProperties(device->vk_physical_device, image_info->format,
+                image_info->imageType, image_info->samples, image_info->usage, image_info->tiling, &count, NULL));
 
         if (!count)
         {
             FIXME("Sparse images are not supported with format %u, type %u, samples %u, usage %#x.\n",
-                    image_info.format, image_info.imageType, image_info.samples, image_info.usage);
+                    image_info->format, image_info->imageType, image_info->samples, image_info->usage);
             return E_INVALIDARG;
         }
     }
 
-    if ((vr = VK_CALL(vkCreateImage(device->vk_device, &image_info, NULL, vk_image))) < 0)
+    return S_OK;
+}
+
+static HRESULT vkd3d_create_image(struct d3d12_device *device,
+        const D3D12_HEAP_PROPERTIES *heap_properties, D3D12_HEAP_FLAGS heap_flags,
+        const D3D12_RESOURCE_DESC1 *desc, struct d3d12_resource *resource, VkImage *vk_image)
+{
+    const struct vkd3d_vk_device_procs *vk_procs = &device->vk_procs;
+    struct vkd3d_image_create_info create_info;
+    VkResult vr;
+    HRESULT hr;
+
+    if (FAILED(hr = vkd3d_get_image_create_info(device, heap_properties, heap_flags, desc, resource, &create_info)))
+        return hr;
+
+    if ((vr = VK_CALL(vkCreateImage(device->vk_device, &create_info.image_info, NULL, vk_image))) < 0)
         WARN("Failed to create Vulkan image, vr %d.\n", vr);
 
     return hresult_from_vk_result(vr);
 }
 
-HRESULT vkd3d_get_image_allocation_info(struct d3d12_device *device,
+#define VKD3D_IMAGE_ALLOCATION_INFO_CACHE_MAX_SIZE 4096
+
+struct vkd3d_image_allocation_info_entry
+{
+    struct rb_entry entry;
+    D3D12_RESOURCE_DESC1 desc;
+    struct vkd3d_resource_allocation_info info;
+};
+
+static int vkd3d_image_allocation_info_compare(const void *key, const struct rb_entry *entry)
+{
+    const struct vkd3d_image_allocation_info_entry *e
+            = RB_ENTRY_VALUE(entry, struct vkd3d_image_allocation_info_entry, entry);
+    const D3D12_RESOURCE_DESC1 *a = key, *b = &e->desc;
+    int ret;
+
+    if ((ret = vkd3d_u32_compare(a->Dimension, b->Dimension)))
+        return ret;
+    if ((ret = vkd3d_u64_compare(a->Width, b->Width)))
+        return ret;
+    if ((ret = vkd3d_u32_compare(a->Height, b->Height)))
+        return ret;
+    if ((ret = vkd3d_u32_compare(a->DepthOrArraySize, b->DepthOrArraySize)))
+        return ret;
+    if ((ret = vkd3d_u32_compare(a->MipLevels, b->MipLevels)))
+        return ret;
+    if ((ret = vkd3d_u32_compare(a->Format, b->Format)))
+        return ret;
+    if ((ret = vkd3d_u32_compare(a->SampleDesc.Count, b->SampleDesc.Count)))
+        return ret;
+    if ((ret = vkd3d_u32_compare(a->SampleDesc.Quality, b->SampleDesc.Quality)))
+        return ret;
+    if ((ret = vkd3d_u32_compare(a->Layout, b->Layout)))
+        return ret;
+    return vkd3d_u32_compare(a->Flags, b->Flags);
+}
+
+void vkd3d_image_allocation_info_cache_init(struct vkd3d_image_allocation_info_cache *cache)
+{
+    vkd3d_mutex_init(&cache->mutex);
+    rb_init(&cache->tree, vkd3d_image_allocation_info_compare);
+    cache->entry_count = 0;
+}
+
+static void vkd3d_image_allocation_info_entry_destroy(struct rb_entry *entry, void *context)
+{
+    vkd3d_free(RB_ENTRY_VALUE(entry, struct vkd3d_image_allocation_info_entry, entry));
+}
+
+void vkd3d_image_allocation_info_cache_cleanup(struct vkd3d_image_allocation_info_cache *cache)
+{
+    rb_destroy(&cache->tree, vkd3d_image_allocation_info_entry_destroy, NULL);
+    vkd3d_mutex_destroy(&cache->mutex);
+}
+
+static bool vkd3d_image_allocation_info_cache_get(struct vkd3d_image_allocation_info_cache *cache,
         const D3D12_RESOURCE_DESC1 *desc, struct vkd3d_resource_allocation_info *allocation_info)
+{
+    struct rb_entry *entry;
+
+    vkd3d_mutex_lock(&cache->mutex);
+    if ((entry = rb_get(&cache->tree, desc)))
+        *allocation_info = RB_ENTRY_VALUE(entry, struct vkd3d_image_allocation_info_entry, entry)->info;
+    vkd3d_mutex_unlock(&cache->mutex);
+
+    return !!entry;
+}
+
+static void vkd3d_image_allocation_info_cache_put(struct vkd3d_image_allocation_info_cache *cache,
+        const D3D12_RESOURCE_DESC1 *desc, const struct vkd3d_resource_allocation_info *allocation_info)
+{
+    struct vkd3d_image_allocation_info_entry *e;
+
+    if (!(e = vkd3d_malloc(sizeof(*e))))
+        return;
+    e->desc = *desc;
+    e->info = *allocation_info;
+
+    vkd3d_mutex_lock(&cache->mutex);
+    /* Another thread may have added the same description. */
+    if (cache->entry_count < VKD3D_IMAGE_ALLOCATION_INFO_CACHE_MAX_SIZE && rb_put(&cache->tree, desc, &e->entry) != -1)
+    {
+        ++cache->entry_count;
+        e = NULL;
+    }
+    vkd3d_mutex_unlock(&cache->mutex);
+
+    vkd3d_free(e);
+}
+
+static HRESULT vkd3d_get_image_memory_requirements(struct d3d12_device *device,
+        const D3D12_RESOURCE_DESC1 *desc, VkMemoryRequirements *requirements)
 {
     static const D3D12_HEAP_PROPERTIES heap_properties = {D3D12_HEAP_TYPE_DEFAULT};
     const struct vkd3d_vk_device_procs *vk_procs = &device->vk_procs;
-    D3D12_RESOURCE_DESC1 validated_desc;
-    VkMemoryRequirements requirements;
+    VkDeviceImageMemoryRequirementsKHR requirements_info;
+    struct vkd3d_image_create_info create_info;
+    VkMemoryRequirements2 requirements2;
     VkImage vk_image;
+    VkResult vr;
     bool tiled;
     HRESULT hr;
 
+    tiled = desc->Layout == D3D12_TEXTURE_LAYOUT_64KB_UNDEFINED_SWIZZLE;
+
+    if (FAILED(hr = vkd3d_get_image_create_info(device, tiled ? NULL : &heap_properties, 0, desc, NULL, &create_info)))
+        return hr;
+
+    if (device->vk_info.KHR_maintenance4)
+    {
+        requirements_info.sType = VK_STRUCTURE_TYPE_DEVICE_IMAGE_MEMORY_REQUIREMENTS_KHR;
+        requirements_info.pNext = NULL;
+        requirements_info.pCreateInfo = &create_info.image_info;
+        requirements_info.planeAspect = 0;
+
+        requirements2.sType = VK_STRUCTURE_TYPE_MEMORY_REQUIREMENTS_2;
+        requirements2.pNext = NULL;
+
+        VK_CALL(vkGetDeviceImageMemoryRequirementsKHR(device->vk_device, &requirements_info, &requirements2));
+        *requirements = requirements2.memoryRequirements;
+        return S_OK;
+    }
+
+    /* Without VK_KHR_maintenance4 we have to create an image to get its memory requirements. */
+    if ((vr = VK_CALL(vkCreateImage(device->vk_device, &create_info.image_info, NULL, &vk_image))) < 0)
+    {
+        WARN("Failed to create Vulkan image, vr %d.\n", vr);
+        return hresult_from_vk_result(vr);
+    }
+
+    VK_CALL(vkGetImageMemoryRequirements(device->vk_device, vk_image, requirements));
+    VK_CALL(vkDestroyImage(device->vk_device, vk_image, NULL));
+
+    return S_OK;
+}
+
+HRESULT vkd3d_get_image_allocation_info(struct d3d12_device *device,
+        const D3D12_RESOURCE_DESC1 *desc, struct vkd3d_resource_allocation_info *allocation_info)
+{
+    struct vkd3d_image_allocation_info_cache *cache = &device->image_allocation_info_cache;
+    D3D12_RESOURCE_DESC1 validated_desc;
+    VkMemoryRequirements requirements;
+    HRESULT hr;
+
     VKD3D_ASSERT(desc->Dimension != D3D12_RESOURCE_DIMENSION_BUFFER);
     VKD3D_ASSERT(d3d12_resource_validate_desc(desc, device, 0) == S_OK);
 
-    if (!desc->MipLevels)
-    {
-        validated_desc = *desc;
+    /* Normalise the fields which do not affect the Vulkan image. */
+    validated_desc = *desc;
+    if (!validated_desc.MipLevels)
         validated_desc.MipLevels = max_miplevel_count(desc);
-        desc = &validated_desc;
-    }
+    validated_desc.Alignment = 0;
+    memset(&validated_desc.SamplerFeedbackMipRegion, 0, sizeof(validated_desc.SamplerFeedbackMipRegion));
+    desc = &validated_desc;
 
-    tiled = desc->Layout == D3D12_TEXTURE_LAYOUT_64KB_UNDEFINED_SWIZZLE;
+    if (vkd3d_image_allocation_info_cache_get(cache, desc, allocation_info))
+        return S_OK;
 
-    /* XXX: We have to create an image to get its memory requirements. */
-    if (SUCCEEDED(hr = vkd3d_create_image(device, tiled ? NULL : &heap_properties, 0, desc, NULL, &vk_image)))
-    {
-        VK_CALL(vkGetImageMemoryRequirements(device->vk_device, vk_image, &requirements));
-        VK_CALL(vkDestroyImage(device->vk_device, vk_image, NULL));
+    if (FAILED(hr = vkd3d_get_image_memory_requirements(device, desc, &requirements)))
+        return hr;
 
-        allocation_info->size_in_bytes = requirements.size;
-        allocation_info->alignment = requirements.alignment;
-    }
+    allocation_info->size_in_bytes = requirements.size;
+    allocation_info->alignment = requirements.alignment;
 
-    return hr;
+    vkd3d_image_allocation_info_cache_put(cache, desc, allocation_info);
+
+    return S_OK;
 }
 
 static void d3d12_resource_tile_info_cleanup(struct d3d12_resource *resource)
@@ -1184,6 +1369,8 @@ static bool d3d12_resource_init_tiles(struct d3d12_resource *resource, struct d3
         resource->tiles.subresource_count = 1;
         resource->tiles.standard_mip_count = 1;
         resource->tiles.packed_mip_tile_count = 0;
+        resource->tiles.mip_tail_offset = 0;
+        resource->tiles.mip_tail_stride = 0;
     }
     else
     {
@@ -1229,6 +1416,9 @@ static bool d3d12_resource_init_tiles(struct d3d12_resource *resource, struct d3
                 ? sparse_requirements.imageMipTailFirstLod : resource->desc.MipLevels;
         resource->tiles.packed_mip_tile_count = (resource->tiles.standard_mip_count < resource->desc.MipLevels)
                 ? sparse_requirements.imageMipTailSize / requirements.alignment : 0;
+        resource->tiles.mip_tail_offset = sparse_requirements.imageMipTailOffset;
+        resource->tiles.mip_tail_stride = (sparse_requirements.formatProperties.flags
+                & VK_SPARSE_IMAGE_FORMAT_SINGLE_MIPTAIL_BIT) ? 0 : sparse_requirements.imageMipTailStride;
 
         for (i = 0, start_idx = 0; i < subresource_count; ++i)
         {
@@ -1424,6 +1614,12 @@ static void d3d12_resource_flush(struct d3d12_resource *resource, uint64_t offse
         ERR("Failed to flush memory, vr %d.\n", vr);
 }
 
+/* Uncached host memory is write-combined in practice. */
+static bool d3d12_resource_is_write_combined(const struct d3d12_resource *resource)
+{
+    return !(d3d12_heap_get_memory_property_flags(resource->heap) & VK_MEMORY_PROPERTY_HOST_CACHED_BIT);
+}
+
 static HRESULT STDMETHODCALLTYPE d3d12_resource_Map(ID3D12Resource2 *iface, UINT sub_resource,
         const D3D12_RANGE *read_range, void **data)
 {
@@ -1591,9 +1787,11 @@ static HRESULT STDMETHODCALLTYPE d3d12_resource_WriteToSubresource(ID3D12Resourc
     dst_size = vk_layout.offset + vkd3d_format_get_data_offset(format, vk_layout.rowPitch,
             vk_layout.depthPitch, dst_box->right, dst_box->bottom - 1, dst_box->back - 1) - dst_offset;
 
-    vkd3d_format_copy_data(format, src_data, src_row_pitch, src_slice_pitch,
+    /* Non-temporal stores would only evict useful lines from cached memory. */
+    vkd3d_format_copy_data(device, format, src_data, src_row_pitch, src_slice_pitch,
             dst_data + dst_offset, vk_layout.rowPitch, vk_layout.depthPitch, dst_box->right - dst_box->left,
-            dst_box->bottom - dst_box->top, dst_box->back - dst_box->front);
+            dst_box->bottom - dst_box->top, dst_box->back - dst_box->front,
+            d3d12_resource_is_write_combined(resource));
 
     d3d12_resource_flush(resource, dst_offset, dst_size);
 
@@ -1678,9 +1876,9 @@ static HRESULT STDMETHODCALLTYPE d3d12_resource_ReadFromSubresource(ID3D12Resour
 
     d3d12_resource_invalidate(resource, src_offset, src_size);
 
-    vkd3d_format_copy_data(format, src_data + src_offset, vk_layout.rowPitch, vk_layout.depthPitch,
+    vkd3d_format_copy_data(device, format, src_data + src_offset, vk_layout.rowPitch, vk_layout.depthPitch,
             dst_data, dst_row_pitch, dst_slice_pitch, src_box->right - src_box->left,
-            src_box->bottom - src_box->top, src_box->back - src_box->front);
+            src_box->bottom - src_box->top, src_box->back - src_box->front, false);
 
     return S_OK;
 }
@@ -1776,6 +1974,205 @@ struct d3d12_resource *unsafe_impl_from_ID3D12Resource(ID3D12Resource *iface)
     return impl_from_ID3D12Resource(iface);
 }
 
+void vkd3d_residency_manager_init(struct vkd3d_residency_manager *manager)
+{
+    memset(manager, 0, sizeof(*manager));
+    vkd3d_mutex_init(&manager->mutex);
+}
+
+void vkd3d_residency_manager_cleanup(struct vkd3d_residency_manager *manager)
+{
+    vkd3d_mutex_destroy(&manager->mutex);
+}
+
+static uint32_t d3d12_heap_get_vk_heap_index(const struct d3d12_heap *heap)
+{
+    return heap->device->memory_properties.memoryTypes[heap->vk_memory_type].heapIndex;
+}
+
+static float vk_memory_priority_from_d3d12(D3D12_RESIDENCY_PRIORITY priority)
+{
+    uint32_t p = priority;
+
+    p = max(p, (uint32_t)D3D12_RESIDENCY_PRIORITY_MINIMUM);
+    p = min(p, (uint32_t)D3D12_RESIDENCY_PRIORITY_MAXIMUM);
+
+    /* The low 16 bits only order allocations within a priority class. */
+    return (float)(p >> 16) / (float)((uint32_t)D3D12_RESIDENCY_PRIORITY_MAXIMUM >> 16);
+}
+
+static void d3d12_heap_update_vk_priority(struct d3d12_heap *heap)
+{
+    struct d3d12_device *device = heap->device;
+    const struct vkd3d_vk_device_procs *vk_procs = &device->vk_procs;
+    float priority;
+
+    if (!device->vk_info.EXT_pageable_device_local_memory)
+        return;
+
+    /* The lowest priority allows the driver to move the contents of evicted
+     * heaps out of device local memory. */
+    priority = heap->evicted ? 0.0f : vk_memory_priority_from_d3d12(heap->residency_priority);
+    VK_CALL(vkSetDeviceMemoryPriorityEXT(device->vk_device, heap->vk_memory, priority));
+}
+
+static struct d3d12_heap *d3d12_heap_from_pageable(ID3D12Pageable *pageable)
+{
+    struct d3d12_resource *resource;
+
+    if (!pageable)
+        return NULL;
+
+    if (pageable->lpVtbl == (ID3D12PageableVtbl *)&d3d12_heap_vtbl)
+        return impl_from_ID3D12Heap((ID3D12Heap *)pageable);
+
+    if (pageable->lpVtbl == (ID3D12PageableVtbl *)&d3d12_resource_vtbl)
+    {
+        resource = impl_from_ID3D12Resource2((ID3D12Resource2 *)pageable);
+        if (resource->flags & VKD3D_RESOURCE_DEDICATED_HEAP)
+            return resource->heap;
+        /* Placed resources are made resident through their heap, and
+         * reserved resources have no memory of their own. */
+        return NULL;
+    }
+
+    /* Descriptor heaps, query heaps and pipeline objects are always resident. */
+    return NULL;
+}
+
+void vkd3d_residency_manager_add_heap(struct vkd3d_residency_manager *manager, struct d3d12_heap *heap)
+{
+    heap->evicted = false;
+    heap->residency_priority = D3D12_RESIDENCY_PRIORITY_NORMAL;
+
+    vkd3d_mutex_lock(&manager->mutex);
+    manager->resident_size[d3d12_heap_get_vk_heap_index(heap)] += heap->desc.SizeInBytes;
+    vkd3d_mutex_unlock(&manager->mutex);
+}
+
+void vkd3d_residency_manager_remove_heap(struct vkd3d_residency_manager *manager, struct d3d12_heap *heap)
+{
+    vkd3d_mutex_lock(&manager->mutex);
+    if (!heap->evicted)
+        manager->resident_size[d3d12_heap_get_vk_heap_index(heap)] -= heap->desc.SizeInBytes;
+    vkd3d_mutex_unlock(&manager->mutex);
+}
+
+static void vkd3d_get_memory_heap_budgets(struct d3d12_device *device, VkDeviceSize *budgets)
+{
+    const struct vkd3d_vk_instance_procs *vk_procs = &device->vkd3d_instance->vk_procs;
+    VkPhysicalDeviceMemoryBudgetPropertiesEXT budget_properties;
+    VkPhysicalDeviceMemoryProperties2 memory_properties2;
+    unsigned int i;
+
+    if (device->vk_info.EXT_memory_budget)
+    {
+        memset(&budget_properties, 0, sizeof(budget_properties));
+        budget_properties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_BUDGET_PROPERTIES_EXT;
+        memory_properties2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_PROPERTIES_2;
+        memory_properties2.pNext = &budget_properties;
+        VK_CALL(vkGetPhysicalDeviceMemoryProperties2KHR(device->vk_physical_device, &memory_properties2));
+
+        for (i = 0; i < device->memory_properties.memoryHeapCount; ++i)
+            budgets[i] = budget_properties.heapBudget[i];
+        return;
+    }
+
+    for (i = 0; i < device->memory_properties.memoryHeapCount; ++i)
+        budgets[i] = device->memory_properties.memoryHeaps[i].size;
+}
+
+HRESULT vkd3d_residency_manager_make_resident(struct vkd3d_residency_manager *manager, struct d3d12_device *device,
+        D3D12_RESIDENCY_FLAGS flags, unsigned int object_count, ID3D12Pageable * const *objects)
+{
+    VkDeviceSize budgets[VK_MAX_MEMORY_HEAPS], required[VK_MAX_MEMORY_HEAPS] = {0};
+    struct d3d12_heap *heap;
+    unsigned int i, index;
+    bool over_budget;
+
+    vkd3d_get_memory_heap_budgets(device, budgets);
+
+    vkd3d_mutex_lock(&manager->mutex);
+
+    for (i = 0; i < object_count; ++i)
+    {
+        if ((heap = d3d12_heap_from_pageable(objects[i])) && heap->evicted)
+            required[d3d12_heap_get_vk_heap_index(heap)] += heap->desc.SizeInBytes;
+    }
+
+    for (i = 0, over_budget = false; i < device->memory_properties.memoryHeapCount; ++i)
+    {
+        if (!required[i] || manager->resident_size[i] + required[i] <= budgets[i])
+            continue;
+        WARN("Memory heap %u is over budget, resident %#"PRIx64", required %#"PRIx64", budget %#"PRIx64".\n",
+                i, manager->resident_size[i], required[i], budgets[i]);
+        over_budget = true;
+    }
+
+    if (over_budget && (flags & D3D12_RESIDENCY_FLAG_DENY_OVERBUDGET))
+    {
+        vkd3d_mutex_unlock(&manager->mutex);
+        return E_OUTOFMEMORY;
+    }
+
+    for (i = 0; i < object_count; ++i)
+    {
+        if (!(heap = d3d12_heap_from_pageable(objects[i])) || !heap->evicted)
+            continue;
+
+        index = d3d12_heap_get_vk_heap_index(heap);
+        manager->resident_size[index] += heap->desc.SizeInBytes;
+        heap->evicted = false;
+        d3d12_heap_update_vk_priority(heap);
+    }
+
+    vkd3d_mutex_unlock(&manager->mutex);
+
+    return S_OK;
+}
+
+void vkd3d_residency_manager_evict(struct vkd3d_residency_manager *manager,
+        unsigned int object_count, ID3D12Pageable * const *objects)
+{
+    struct d3d12_heap *heap;
+    unsigned int i;
+
+    vkd3d_mutex_lock(&manager->mutex);
+
+    for (i = 0; i < object_count; ++i)
+    {
+        if (!(heap = d3d12_heap_from_pageable(objects[i])) || heap->evicted)
+            continue;
+
+        manager->resident_size[d3d12_heap_get_vk_heap_index(heap)] -= heap->desc.SizeInBytes;
+        heap->evicted = true;
+        d3d12_heap_update_vk_priority(heap);
+    }
+
+    vkd3d_mutex_unlock(&manager->mutex);
+}
+
+void vkd3d_residency_manager_set_priority(struct vkd3d_residency_manager *manager, unsigned int object_count,
+        ID3D12Pageable * const *objects, const D3D12_RESIDENCY_PRIORITY *priorities)
+{
+    struct d3d12_heap *heap;
+    unsigned int i;
+
+    vkd3d_mutex_lock(&manager->mutex);
+
+    for (i = 0; i < object_count; ++i)
+    {
+        if (!(heap = d3d12_heap_from_pageable(objects[i])))
+            continue;
+
+        heap->residency_priority = priorities[i];
+        if (!heap->evicted)
+            d3d12_heap_update_vk_priority(heap);
+    }
+
+    vkd3d_mutex_unlock(&manager->mutex);
+}
+
 static void d3d12_validate_resource_flags(D3D12_RESOURCE_FLAGS flags)
 {
     unsigned int unknown_flags = flags & ~(D3D12_RESOURCE_FLAG_NONE
@@ -2013,6 +2410,7 @@ static HRESULT d3d12_resource_init(struct d3d12_resource *resource, struct d3d12
         WARN("Ignoring optimized clear value.\n");
 
     resource->gpu_address = 0;
+    resource->vk_device_address = 0;
     resource->flags = 0;
 
     if (FAILED(hr = d3d12_resource_validate_desc(&resource->desc, device, 0)))
@@ -2095,6 +2493,13 @@ static HRESULT d3d12_resource_create(struct d3d12_device *device,
     return hr;
 }
 
+static void d3d12_resource_init_device_address(struct d3d12_resource *resource, struct d3d12_device *device)
+{
+    /* The address of a non-sparse buffer is only valid once memory is bound. */
+    if (device->use_root_buffer_addresses && d3d12_resource_is_buffer(resource))
+        resource->vk_device_address = vkd3d_get_buffer_device_address(device, resource->u.vk_buffer);
+}
+
 static HRESULT vkd3d_allocate_resource_memory(
         struct d3d12_device *device, struct d3d12_resource *resource,
         const D3D12_HEAP_PROPERTIES *heap_properties, D3D12_HEAP_FLAGS heap_flags)
@@ -2139,6 +2544,8 @@ HRESULT d3d12_committed_resource_create(struct d3d12_device *device,
         return hr;
     }
 
+    d3d12_resource_init_device_address(object, device);
+
     TRACE("Created committed resource %p.\n", object);
 
     *resource = object;
@@ -2232,6 +2639,8 @@ HRESULT d3d12_placed_resource_create(struct d3d12_device *device, struct d3d12_h
         return hr;
     }
 
+    d3d12_resource_init_device_address(object, device);
+
     TRACE("Created placed resource %p.\n", object);
 
     *resource = object;
@@ -2256,6 +2665,8 @@ HRESULT d3d12_reserved_resource_create(struct d3d12_device *device,
         return E_OUTOFMEMORY;
     }
 
+    d3d12_resource_init_device_address(object, device);
+
     TRACE("Created reserved resource %p.\n", object);
 
     *resource = object;
@@ -2452,6 +2863,16 @@ static void vkd3d_view_destroy(struct vkd3d_view *view, struct d3d12_device *dev
     vkd3d_desc_object_cache_push(&device->view_desc_cache, view);
 }
 
+static void vkd3d_desc_object_destroy(void *object, struct d3d12_device *device)
+{
+    union d3d12_desc_object u = {object};
+
+    if (u.header->magic != VKD3D_DESCRIPTOR_MAGIC_CBV)
+        vkd3d_view_destroy(u.view, device);
+    else
+        vkd3d_desc_object_cache_push(&device->cbuffer_desc_cache, u.object);
+}
+
 void vkd3d_view_decref(void *view, struct d3d12_device *device)
 {
     union d3d12_desc_object u = {view};
@@ -2459,10 +2880,34 @@ void vkd3d_view_decref(void *view, struct d3d12_device *device)
     if (vkd3d_atomic_decrement_u32(&u.header->refcount))
         return;
 
-    if (u.header->magic != VKD3D_DESCRIPTOR_MAGIC_CBV)
-        vkd3d_view_destroy(u.view, device);
-    else
-        vkd3d_desc_object_cache_push(&device->cbuffer_desc_cache, u.object);
+    vkd3d_desc_object_destroy(view, device);
+}
+
+static void vkd3d_view_decref_n(void *view, unsigned int count, struct d3d12_device *device)
+{
+    union d3d12_desc_object u = {view};
+
+    if (vkd3d_atomic_add_fetch_u32(&u.header->refcount, 0u - count))
+        return;
+
+    vkd3d_desc_object_destroy(view, device);
+}
+
+static bool vkd3d_view_incref_n(void *view, unsigned int count)
+{
+    union d3d12_desc_object u = {view};
+    unsigned int refcount;
+
+    do
+    {
+        refcount = u.header->refcount;
+        /* Avoid incrementing a freed object, as in vkd3d_view_incref(). */
+        if (!refcount)
+            return false;
+    }
+    while (!vkd3d_atomic_compare_exchange_u32(&u.header->refcount, refcount, refcount + count));
+
+    return true;
 }
 
 static inline void d3d12_desc_replace(struct d3d12_desc *dst, void *view, struct d3d12_device *device)
@@ -2667,11 +3112,21 @@ void d3d12_desc_flush_vk_heap_updates_locked(struct d3d12_descriptor_heap *descr
     struct d3d12_desc *descriptors, *src;
     struct descriptor_writes writes;
     union d3d12_desc_object u;
-    unsigned int i, next;
+    uint64_t ranges[ARRAY_SIZE(descriptor_heap->dirty_ranges)];
+    unsigned int i, j, k, next, end;
+    bool have_ranges = false;
+    uint64_t start_time;
 
-    if ((i = vkd3d_atomic_exchange_u32(&descriptor_heap->dirty_list_head, UINT_MAX)) == UINT_MAX)
+    for (k = 0; k < ARRAY_SIZE(ranges); ++k)
+    {
+        ranges[k] = vkd3d_atomic_exchange_u64(&descriptor_heap->dirty_ranges[k], 0);
+        have_ranges |= !!ranges[k];
+    }
+    if ((i = vkd3d_atomic_exchange_u32(&descriptor_heap->dirty_list_head, UINT_MAX)) == UINT_MAX && !have_ranges)
         return;
 
+    start_time = vkd3d_get_monotonic_time_ns();
+
     writes.null_vk_cbv_info.buffer = VK_NULL_HANDLE;
     writes.null_vk_cbv_info.offset = 0;
     writes.null_vk_cbv_info.range = VK_WHOLE_SIZE;
@@ -2681,6 +3136,18 @@ void d3d12_desc_flush_vk_heap_updates_locked(struct d3d12_descriptor_heap *descr
 
     descriptors = (struct d3d12_desc *)descriptor_heap->descriptors;
 
+    for (k = 0; k < ARRAY_SIZE(ranges); ++k)
+    {
+        for (j = ranges[k] >> 32, end = (uint32_t)ranges[k]; j < end; ++j)
+        {
+            if (!(u.object = d3d12_desc_get_object_ref(&descriptors[j], device)))
+                continue;
+
+            writes.held_refs[writes.held_ref_count++] = u.object;
+            d3d12_desc_write_vk_heap(descriptor_heap, j, &writes, u.object, device);
+        }
+    }
+
     for (; i != UINT_MAX; i = next)
     {
         src = &descriptors[i];
@@ -2702,9 +3169,22 @@ void d3d12_desc_flush_vk_heap_updates_locked(struct d3d12_descriptor_heap *descr
     if (writes.count)
         VK_CALL(vkUpdateDescriptorSets(device->vk_device, writes.count, writes.vk_descriptor_writes, 0, NULL));
     descriptor_writes_free_object_refs(&writes, device);
+
+    d3d12_device_add_statistic(device, descriptor_flush_count, 1);
+    d3d12_device_add_statistic(device, descriptor_flush_time, vkd3d_get_monotonic_time_ns() - start_time);
+    if (vkd3d_trace_enabled)
+        vkd3d_trace_span_end("Flush descriptor heap", start_time);
 }
 
-static void d3d12_desc_mark_as_modified(struct d3d12_desc *dst, struct d3d12_descriptor_heap *descriptor_heap)
+static void d3d12_descriptor_heap_queue_flush(struct d3d12_descriptor_heap *descriptor_heap)
+{
+    /* Checked after marking the descriptors, so a worker which has already
+     * cleared the flag is guaranteed to see them. */
+    if (!descriptor_heap->flush_queued && vkd3d_atomic_compare_exchange_u32(&descriptor_heap->flush_queued, 0, 1))
+        d3d12_device_queue_descriptor_heap_flush(descriptor_heap->device, descriptor_heap);
+}
+
+static void d3d12_desc_mark_as_modified(struct d3d12_desc *dst, struct d3d12_descriptor_heap *descriptor_heap)
 {
     unsigned int i, head;
 
@@ -2720,6 +3200,90 @@ static void d3d12_desc_mark_as_modified(struct d3d12_desc *dst, struct d3d12_des
         head = descriptor_heap->dirty_list_head;
         vkd3d_atomic_exchange_u32(&dst->next, (head << 1) | 1);
     }
+
+    d3d12_descriptor_heap_queue_flush(descriptor_heap);
+}
+
+/* Ranges are only merged if the result is not much larger than the ranges
+ * themselves, so that scattered writes do not flush everything between them. */
+static bool vkd3d_dirty_range_merge(uint64_t range, unsigned int begin, unsigned int end, uint64_t *merged)
+{
+    unsigned int range_begin = range >> 32, range_end = (uint32_t)range;
+    unsigned int merged_begin, merged_end;
+
+    if (!range)
+    {
+        *merged = ((uint64_t)begin << 32) | end;
+        return true;
+    }
+
+    merged_begin = min(begin, range_begin);
+    merged_end = max(end, range_end);
+    if (merged_end - merged_begin > 2 * ((range_end - range_begin) + (end - begin)))
+        return false;
+
+    *merged = ((uint64_t)merged_begin << 32) | merged_end;
+    return true;
+}
+
+static void d3d12_desc_mark_range_as_modified(struct d3d12_descriptor_heap *descriptor_heap,
+        unsigned int begin, unsigned int end)
+{
+    struct d3d12_desc *descriptors;
+    uint64_t range, new_range;
+    unsigned int i;
+
+    for (i = 0; i < ARRAY_SIZE(descriptor_heap->dirty_ranges); ++i)
+    {
+        for (;;)
+        {
+            range = descriptor_heap->dirty_ranges[i];
+            if (!vkd3d_dirty_range_merge(range, begin, end, &new_range))
+                break;
+            if (new_range == range
+                    || vkd3d_atomic_compare_exchange_u64(&descriptor_heap->dirty_ranges[i], range, new_range))
+            {
+                d3d12_descriptor_heap_queue_flush(descriptor_heap);
+                return;
+            }
+        }
+    }
+
+    /* All slots hold distant ranges; fall back to the per-descriptor list. */
+    descriptors = (struct d3d12_desc *)descriptor_heap->descriptors;
+    for (i = begin; i < end; ++i)
+    {
+        if (!descriptors[i].next)
+            d3d12_desc_mark_as_modified(&descriptors[i], descriptor_heap);
+    }
+}
+
+static void d3d12_desc_write_descriptor_buffer(struct d3d12_descriptor_heap *descriptor_heap,
+        unsigned int index, void *object, struct d3d12_device *device)
+{
+    const struct vkd3d_descriptor_buffer_info *info = &device->descriptor_buffer;
+    union d3d12_desc_object u = {object};
+    enum vkd3d_vk_descriptor_set_index set;
+    VkDescriptorType type;
+    const uint8_t *data;
+    uint8_t *dst;
+
+    type = u.header->vk_descriptor_type;
+    set = (type == VK_DESCRIPTOR_TYPE_SAMPLER) ? VKD3D_SET_INDEX_SAMPLER : VKD3D_SET_INDEX_MUTABLE;
+    data = (u.header->magic == VKD3D_DESCRIPTOR_MAGIC_CBV)
+            ? vkd3d_cbuffer_desc_get_descriptor_data(u.cb_desc) : vkd3d_view_get_descriptor_data(u.view);
+
+    dst = descriptor_heap->descriptor_buffer_data + descriptor_heap->descriptor_buffer_set_offsets[set]
+            + info->binding_offsets[set] + index * info->descriptor_sizes[set];
+    memcpy(dst, data, info->type_sizes[type]);
+
+    if (u.header->magic == VKD3D_DESCRIPTOR_MAGIC_UAV && u.view->v.vk_counter_view)
+    {
+        set = VKD3D_SET_INDEX_UAV_COUNTER;
+        dst = descriptor_heap->descriptor_buffer_data + descriptor_heap->descriptor_buffer_set_offsets[set]
+                + info->binding_offsets[set] + index * info->descriptor_sizes[set];
+        memcpy(dst, data + info->max_descriptor_size, info->descriptor_sizes[set]);
+    }
 }
 
 static inline void descriptor_heap_write_atomic(struct d3d12_descriptor_heap *descriptor_heap, struct d3d12_desc *dst,
@@ -2727,6 +3291,11 @@ static inline void descriptor_heap_write_atomic(struct d3d12_descriptor_heap *de
 {
     void *object = src->s.u.object;
 
+    /* The caller holds a reference to the object, so its data remains valid
+     * even if another thread replaces it in dst. */
+    if (descriptor_heap->use_descriptor_buffer && object)
+        d3d12_desc_write_descriptor_buffer(descriptor_heap, dst->index, object, device);
+
     d3d12_desc_replace(dst, object, device);
     if (descriptor_heap->use_vk_heaps && object && !dst->next)
         d3d12_desc_mark_as_modified(dst, descriptor_heap);
@@ -2756,6 +3325,96 @@ void d3d12_desc_copy(struct d3d12_desc *dst, const struct d3d12_desc *src, struc
     descriptor_heap_write_atomic(dst_heap, dst, &tmp, device);
 }
 
+static bool d3d12_desc_object_incref_range(void *object, const volatile struct d3d12_desc *src,
+        unsigned int count, unsigned int ref_count, struct d3d12_device *device)
+{
+    unsigned int i;
+
+    if (!vkd3d_view_incref_n(object, ref_count))
+        return false;
+
+    /* As in d3d12_desc_get_object_ref(), handle the object being freed and reused. */
+    for (i = 0; i < count; ++i)
+    {
+        if (src[i].s.u.object != object)
+        {
+            vkd3d_view_decref_n(object, ref_count, device);
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/* Copies a contiguous range of descriptors. References are taken once for each
+ * run of identical source objects, and the destination is flushed as one range. */
+void d3d12_desc_copy_range(struct d3d12_desc *dst, const struct d3d12_desc *src, unsigned int count,
+        struct d3d12_descriptor_heap *dst_heap, struct d3d12_device *device)
+{
+    unsigned int i, j, k, ref_count, released_count = 0, modified_begin = UINT_MAX, modified_end = 0;
+    void *object, *old, *released = NULL;
+
+    for (i = 0; i < count; i = j)
+    {
+        object = src[i].s.u.object;
+        for (j = i + 1; j < count && src[j].s.u.object == object; ++j)
+            ;
+
+        for (k = i, ref_count = 0; k < j; ++k)
+            ref_count += dst[k].s.u.object != object;
+        if (!ref_count)
+            continue;
+
+        if (object && !d3d12_desc_object_incref_range(object, &src[i], j - i, ref_count, device))
+        {
+            /* The source was modified concurrently. */
+            for (k = i; k < j; ++k)
+            {
+                if (dst[k].s.u.object != src[k].s.u.object)
+                    d3d12_desc_copy(&dst[k], &src[k], dst_heap, device);
+            }
+            continue;
+        }
+
+        for (k = i; k < j && ref_count; ++k)
+        {
+            if (dst[k].s.u.object == object)
+                continue;
+
+            if (object)
+            {
+                if (dst_heap->use_descriptor_buffer)
+                    d3d12_desc_write_descriptor_buffer(dst_heap, dst[k].index, object, device);
+                modified_begin = min(modified_begin, dst[k].index);
+                modified_end = max(modified_end, dst[k].index + 1);
+            }
+
+            --ref_count;
+            if (!(old = vkd3d_atomic_exchange_ptr(&dst[k].s.u.object, object)))
+                continue;
+            /* Release runs of identical objects together. */
+            if (old != released)
+            {
+                if (released)
+                    vkd3d_view_decref_n(released, released_count, device);
+                released = old;
+                released_count = 0;
+            }
+            ++released_count;
+        }
+
+        /* Drop any references left over due to concurrent writes to dst. */
+        if (object && ref_count)
+            vkd3d_view_decref_n(object, ref_count, device);
+    }
+
+    if (released)
+        vkd3d_view_decref_n(released, released_count, device);
+
+    if (dst_heap->use_vk_heaps && modified_begin < modified_end)
+        d3d12_desc_mark_range_as_modified(dst_heap, modified_begin, modified_end);
+}
+
 static VkDeviceSize vkd3d_get_required_texel_buffer_alignment(const struct d3d12_device *device,
         const struct vkd3d_format *format)
 {
@@ -2783,6 +3442,41 @@ static VkDeviceSize vkd3d_get_required_texel_buffer_alignment(const struct d3d12
     return vk_info->device_limits.minTexelBufferOffsetAlignment;
 }
 
+static void vkd3d_get_descriptor_data(struct d3d12_device *device,
+        const VkDescriptorGetInfoEXT *get_info, void *data)
+{
+    const struct vkd3d_vk_device_procs *vk_procs = &device->vk_procs;
+
+    VKD3D_ASSERT(get_info->type < ARRAY_SIZE(device->descriptor_buffer.type_sizes));
+    VK_CALL(vkGetDescriptorEXT(device->vk_device, get_info, device->descriptor_buffer.type_sizes[get_info->type], data));
+}
+
+/* A null buffer results in a null descriptor. */
+static void vkd3d_get_buffer_descriptor_data(struct d3d12_device *device, VkDescriptorType vk_descriptor_type,
+        VkBuffer vk_buffer, VkFormat vk_format, VkDeviceSize offset, VkDeviceSize range, void *data)
+{
+    VkDescriptorAddressInfoEXT address_info;
+    VkDescriptorGetInfoEXT get_info;
+
+    get_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_GET_INFO_EXT;
+    get_info.pNext = NULL;
+    get_info.type = vk_descriptor_type;
+    /* The buffer members of the data union are all of the same type. */
+    get_info.data.pUniformBuffer = NULL;
+
+    if (vk_buffer)
+    {
+        address_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_ADDRESS_INFO_EXT;
+        address_info.pNext = NULL;
+        address_info.address = vkd3d_get_buffer_device_address(device, vk_buffer) + offset;
+        address_info.range = range;
+        address_info.format = vk_format;
+        get_info.data.pUniformBuffer = &address_info;
+    }
+
+    vkd3d_get_descriptor_data(device, &get_info, data);
+}
+
 static bool vkd3d_create_vk_buffer_view(struct d3d12_device *device,
         VkBuffer vk_buffer, const struct vkd3d_format *format,
         VkDeviceSize offset, VkDeviceSize range, VkBufferView *vk_view)
@@ -2811,6 +3505,8 @@ static bool vkd3d_create_vk_buffer_view(struct d3d12_device *device,
     view_desc.range = range;
     if ((vr = VK_CALL(vkCreateBufferView(device->vk_device, &view_desc, NULL, vk_view))) < 0)
         WARN("Failed to create Vulkan buffer view, vr %d.\n", vr);
+    else
+        d3d12_device_add_statistic(device, vk_buffer_view_count, 1);
     return vr == VK_SUCCESS;
 }
 
@@ -2837,6 +3533,9 @@ bool vkd3d_create_buffer_view(struct d3d12_device *device, uint32_t magic, VkBuf
     object->v.format = format;
     object->v.info.buffer.offset = offset;
     object->v.info.buffer.size = size;
+    if (device->use_descriptor_buffers)
+        vkd3d_get_buffer_descriptor_data(device, object->h.vk_descriptor_type, vk_buffer,
+                format->vk_format, offset, size, vkd3d_view_get_descriptor_data(object));
     *view = object;
     return true;
 }
@@ -3104,6 +3803,27 @@ static void vkd3d_texture_view_desc_normalise(struct vkd3d_texture_view_desc *de
     desc->layer_count = max_layer_count;
 }
 
+static void vkd3d_get_image_descriptor_data(struct d3d12_device *device, struct vkd3d_view *view)
+{
+    VkDescriptorImageInfo image_info;
+    VkDescriptorGetInfoEXT get_info;
+
+    image_info.sampler = VK_NULL_HANDLE;
+    image_info.imageView = view->v.u.vk_image_view;
+    image_info.imageLayout = (view->h.vk_descriptor_type == VK_DESCRIPTOR_TYPE_STORAGE_IMAGE)
+            ? VK_IMAGE_LAYOUT_GENERAL : VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+
+    get_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_GET_INFO_EXT;
+    get_info.pNext = NULL;
+    get_info.type = view->h.vk_descriptor_type;
+    if (get_info.type == VK_DESCRIPTOR_TYPE_STORAGE_IMAGE)
+        get_info.data.pStorageImage = &image_info;
+    else
+        get_info.data.pSampledImage = &image_info;
+
+    vkd3d_get_descriptor_data(device, &get_info, vkd3d_view_get_descriptor_data(view));
+}
+
 bool vkd3d_create_texture_view(struct d3d12_device *device, uint32_t magic, VkImage vk_image,
         const struct vkd3d_texture_view_desc *desc, struct vkd3d_view **view)
 {
@@ -3141,6 +3861,7 @@ bool vkd3d_create_texture_view(struct d3d12_device *device, uint32_t magic, VkIm
             WARN("Failed to create Vulkan image view, vr %d.\n", vr);
             return false;
         }
+        d3d12_device_add_statistic(device, vk_image_view_count, 1);
     }
 
     if (!(object = vkd3d_view_create(magic, magic == VKD3D_DESCRIPTOR_MAGIC_UAV ? VK_DESCRIPTOR_TYPE_STORAGE_IMAGE
@@ -3156,6 +3877,8 @@ bool vkd3d_create_texture_view(struct d3d12_device *device, uint32_t magic, VkIm
     object->v.info.texture.miplevel_idx = desc->miplevel_idx;
     object->v.info.texture.layer_idx = desc->layer_idx;
     object->v.info.texture.layer_count = desc->layer_count;
+    if (device->use_descriptor_buffers && (magic == VKD3D_DESCRIPTOR_MAGIC_SRV || magic == VKD3D_DESCRIPTOR_MAGIC_UAV))
+        vkd3d_get_image_descriptor_data(device, object);
     *view = object;
     return true;
 }
@@ -3163,6 +3886,7 @@ bool vkd3d_create_texture_view(struct d3d12_device *device, uint32_t magic, VkIm
 void d3d12_desc_create_cbv(struct d3d12_desc *descriptor,
         struct d3d12_device *device, const D3D12_CONSTANT_BUFFER_VIEW_DESC *desc)
 {
+    const struct vkd3d_null_resources *null_resources;
     struct VkDescriptorBufferInfo *buffer_info;
     struct vkd3d_cbuffer_desc *cb_desc;
     struct d3d12_resource *resource;
@@ -3196,11 +3920,22 @@ void d3d12_desc_create_cbv(struct d3d12_desc *descriptor,
     else
     {
         /* NULL descriptor */
-        buffer_info->buffer = device->null_resources.vk_buffer;
+        if (!(null_resources = vkd3d_get_null_resources(device)))
+        {
+            vkd3d_view_decref(cb_desc, device);
+            return;
+        }
+        buffer_info->buffer = null_resources->vk_buffer;
         buffer_info->offset = 0;
         buffer_info->range = VK_WHOLE_SIZE;
     }
 
+    /* Descriptor buffers require null descriptors, and VK_WHOLE_SIZE is not a valid range. */
+    if (device->use_descriptor_buffers)
+        vkd3d_get_buffer_descriptor_data(device, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER,
+                desc->BufferLocation ? buffer_info->buffer : VK_NULL_HANDLE, VK_FORMAT_UNDEFINED,
+                buffer_info->offset, buffer_info->range, vkd3d_cbuffer_desc_get_descriptor_data(cb_desc));
+
     descriptor->s.u.cb_desc = cb_desc;
 }
 
@@ -3216,7 +3951,7 @@ static unsigned int vkd3d_view_flags_from_d3d12_buffer_srv_flags(D3D12_BUFFER_SR
 static void vkd3d_create_null_srv(struct d3d12_desc *descriptor,
         struct d3d12_device *device, const D3D12_SHADER_RESOURCE_VIEW_DESC *desc)
 {
-    struct vkd3d_null_resources *null_resources = &device->null_resources;
+    const struct vkd3d_null_resources *null_resources;
     struct vkd3d_texture_view_desc vkd3d_desc;
     VkImage vk_image;
 
@@ -3226,6 +3961,9 @@ static void vkd3d_create_null_srv(struct d3d12_desc *descriptor,
         return;
     }
 
+    if (!(null_resources = vkd3d_get_null_resources(device)))
+        return;
+
     switch (desc->ViewDimension)
     {
         case D3D12_SRV_DIMENSION_BUFFER:
@@ -3444,7 +4182,7 @@ static unsigned int vkd3d_view_flags_from_d3d12_buffer_uav_flags(D3D12_BUFFER_UA
 static void vkd3d_create_null_uav(struct d3d12_desc *descriptor,
         struct d3d12_device *device, const D3D12_UNORDERED_ACCESS_VIEW_DESC *desc)
 {
-    struct vkd3d_null_resources *null_resources = &device->null_resources;
+    const struct vkd3d_null_resources *null_resources;
     struct vkd3d_texture_view_desc vkd3d_desc;
     VkImage vk_image;
 
@@ -3454,6 +4192,9 @@ static void vkd3d_create_null_uav(struct d3d12_desc *descriptor,
         return;
     }
 
+    if (!(null_resources = vkd3d_get_null_resources(device)))
+        return;
+
     switch (desc->ViewDimension)
     {
         case D3D12_UAV_DIMENSION_BUFFER:
@@ -3546,6 +4287,12 @@ static void vkd3d_create_buffer_uav(struct d3d12_desc *descriptor, struct d3d12_
             vkd3d_view_decref(view, device);
             return;
         }
+
+        if (device->use_descriptor_buffers)
+            vkd3d_get_buffer_descriptor_data(device, VK_DESCRIPTOR_TYPE_STORAGE_TEXEL_BUFFER,
+                    counter_resource->u.vk_buffer, format->vk_format, desc->u.Buffer.CounterOffsetInBytes,
+                    sizeof(uint32_t), vkd3d_view_get_descriptor_data(view)
+                    + device->descriptor_buffer.max_descriptor_size);
     }
 
     descriptor->s.u.view = view;
@@ -3636,6 +4383,7 @@ void d3d12_desc_create_uav(struct d3d12_desc *descriptor, struct d3d12_device *d
 bool vkd3d_create_raw_buffer_view(struct d3d12_device *device,
         D3D12_GPU_VIRTUAL_ADDRESS gpu_address, D3D12_ROOT_PARAMETER_TYPE parameter_type, VkBufferView *vk_buffer_view)
 {
+    const struct vkd3d_null_resources *null_resources;
     const struct vkd3d_format *format;
     struct d3d12_resource *resource;
 
@@ -3649,8 +4397,10 @@ bool vkd3d_create_raw_buffer_view(struct d3d12_device *device,
             return true;
         }
         WARN("Creating null buffer view.\n");
+        if (!(null_resources = vkd3d_get_null_resources(device)))
+            return false;
         return vkd3d_create_vk_buffer_view(device, parameter_type == D3D12_ROOT_PARAMETER_TYPE_UAV
-                ? device->null_resources.vk_storage_buffer : device->null_resources.vk_buffer,
+                ? null_resources->vk_storage_buffer : null_resources->vk_buffer,
                 format, 0, VK_WHOLE_SIZE, vk_buffer_view);
     }
 
@@ -3769,6 +4519,8 @@ static VkResult d3d12_create_sampler(struct d3d12_device *device, D3D12_FILTER f
 
     if ((vr = VK_CALL(vkCreateSampler(device->vk_device, &sampler_desc, NULL, vk_sampler))) < 0)
         WARN("Failed to create Vulkan sampler, vr %d.\n", vr);
+    else
+        d3d12_device_add_statistic(device, vk_sampler_count, 1);
 
     return vr;
 }
@@ -3831,6 +4583,17 @@ void d3d12_desc_create_sampler(struct d3d12_desc *sampler,
         return;
     }
 
+    if (device->use_descriptor_buffers)
+    {
+        VkDescriptorGetInfoEXT get_info;
+
+        get_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_GET_INFO_EXT;
+        get_info.pNext = NULL;
+        get_info.type = VK_DESCRIPTOR_TYPE_SAMPLER;
+        get_info.data.pSampler = &view->v.u.vk_sampler;
+        vkd3d_get_descriptor_data(device, &get_info, vkd3d_view_get_descriptor_data(view));
+    }
+
     sampler->s.u.view = view;
 }
 
@@ -4129,6 +4892,9 @@ static ULONG STDMETHODCALLTYPE d3d12_descriptor_heap_Release(ID3D12DescriptorHea
         VK_CALL(vkDestroyDescriptorPool(device->vk_device, heap->vk_descriptor_pool, NULL));
         vkd3d_mutex_destroy(&heap->vk_sets_mutex);
 
+        VK_CALL(vkDestroyBuffer(device->vk_device, heap->vk_descriptor_buffer, NULL));
+        VK_CALL(vkFreeMemory(device->vk_device, heap->vk_descriptor_memory, NULL));
+
         vkd3d_free(heap);
 
         d3d12_device_release(device);
@@ -4314,6 +5080,7 @@ static HRESULT d3d12_descriptor_heap_create_descriptor_set(struct d3d12_descript
     set_size.pDescriptorCounts = &variable_binding_size;
     if ((vr = VK_CALL(vkAllocateDescriptorSets(device->vk_device, &set_desc, &descriptor_set->vk_set))) >= 0)
     {
+        d3d12_device_add_statistic(device, vk_descriptor_set_count, 1);
         descriptor_set->vk_type = device->vk_descriptor_heap_layouts[set].type;
         return S_OK;
     }
@@ -4348,6 +5115,109 @@ static HRESULT d3d12_descriptor_heap_vk_descriptor_sets_init(struct d3d12_descri
     return S_OK;
 }
 
+static HRESULT d3d12_descriptor_heap_descriptor_buffer_init(struct d3d12_descriptor_heap *descriptor_heap,
+        struct d3d12_device *device, const D3D12_DESCRIPTOR_HEAP_DESC *desc)
+{
+    const VkPhysicalDeviceDescriptorBufferPropertiesEXT *properties = &device->vk_info.descriptor_buffer_properties;
+    const struct vkd3d_descriptor_buffer_info *info = &device->descriptor_buffer;
+    const struct vkd3d_vk_device_procs *vk_procs = &device->vk_procs;
+    D3D12_HEAP_PROPERTIES heap_properties;
+    enum vkd3d_vk_descriptor_set_index set;
+    VkBufferCreateInfo buffer_info;
+    VkDeviceSize size, max_size;
+    void *data;
+    VkResult vr;
+    HRESULT hr;
+
+    descriptor_heap->vk_descriptor_buffer = VK_NULL_HANDLE;
+    descriptor_heap->vk_descriptor_memory = VK_NULL_HANDLE;
+    descriptor_heap->vk_descriptor_buffer_usage = 0;
+    descriptor_heap->descriptor_buffer_address = 0;
+    descriptor_heap->descriptor_buffer_data = NULL;
+    memset(descriptor_heap->descriptor_buffer_set_offsets, 0, sizeof(descriptor_heap->descriptor_buffer_set_offsets));
+
+    if (!descriptor_heap->use_descriptor_buffer)
+        return S_OK;
+
+    for (set = 0, size = 0; set < ARRAY_SIZE(device->vk_descriptor_heap_layouts); ++set)
+    {
+        if (device->vk_descriptor_heap_layouts[set].applicable_heap_type != desc->Type
+                || !device->vk_descriptor_heap_layouts[set].vk_set_layout)
+            continue;
+        size = align(size, info->offset_alignment);
+        descriptor_heap->descriptor_buffer_set_offsets[set] = size;
+        size += info->binding_offsets[set] + (VkDeviceSize)desc->NumDescriptors * info->descriptor_sizes[set];
+    }
+
+    if (desc->Type == D3D12_DESCRIPTOR_HEAP_TYPE_SAMPLER)
+    {
+        descriptor_heap->vk_descriptor_buffer_usage = VK_BUFFER_USAGE_SAMPLER_DESCRIPTOR_BUFFER_BIT_EXT;
+        max_size = properties->maxSamplerDescriptorBufferRange;
+    }
+    else
+    {
+        descriptor_heap->vk_descriptor_buffer_usage = VK_BUFFER_USAGE_RESOURCE_DESCRIPTOR_BUFFER_BIT_EXT;
+        max_size = properties->maxResourceDescriptorBufferRange;
+    }
+    if (size > max_size)
+    {
+        WARN("Descriptor buffer size %#"PRIx64" exceeds the maximum %#"PRIx64".\n", size, max_size);
+        return E_OUTOFMEMORY;
+    }
+
+    buffer_info.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+    buffer_info.pNext = NULL;
+    buffer_info.flags = 0;
+    buffer_info.size = max(size, 1);
+    buffer_info.usage = descriptor_heap->vk_descriptor_buffer_usage | VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT_KHR;
+    if (device->queue_family_count > 1)
+    {
+        buffer_info.sharingMode = VK_SHARING_MODE_CONCURRENT;
+        buffer_info.queueFamilyIndexCount = device->queue_family_count;
+        buffer_info.pQueueFamilyIndices = device->queue_family_indices;
+    }
+    else
+    {
+        buffer_info.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+        buffer_info.queueFamilyIndexCount = 0;
+        buffer_info.pQueueFamilyIndices = NULL;
+    }
+    if ((vr = VK_CALL(vkCreateBuffer(device->vk_device, &buffer_info, NULL,
+            &descriptor_heap->vk_descriptor_buffer))) < 0)
+    {
+        WARN("Failed to create descriptor buffer, vr %d.\n", vr);
+        descriptor_heap->vk_descriptor_buffer = VK_NULL_HANDLE;
+        return hresult_from_vk_result(vr);
+    }
+
+    /* Descriptors are written by the CPU and read by the GPU in place. */
+    memset(&heap_properties, 0, sizeof(heap_properties));
+    heap_properties.Type = D3D12_HEAP_TYPE_UPLOAD;
+    if (FAILED(hr = vkd3d_allocate_buffer_memory(device, descriptor_heap->vk_descriptor_buffer,
+            &heap_properties, D3D12_HEAP_FLAG_NONE, &descriptor_heap->vk_descriptor_memory, NULL, NULL)))
+        goto fail;
+
+    if ((vr = VK_CALL(vkMapMemory(device->vk_device, descriptor_heap->vk_descriptor_memory,
+            0, VK_WHOLE_SIZE, 0, &data))) < 0)
+    {
+        ERR("Failed to map descriptor buffer memory, vr %d.\n", vr);
+        hr = hresult_from_vk_result(vr);
+        goto fail;
+    }
+    descriptor_heap->descriptor_buffer_data = data;
+    descriptor_heap->descriptor_buffer_address = vkd3d_get_buffer_device_address(device,
+            descriptor_heap->vk_descriptor_buffer);
+
+    return S_OK;
+
+fail:
+    VK_CALL(vkFreeMemory(device->vk_device, descriptor_heap->vk_descriptor_memory, NULL));
+    descriptor_heap->vk_descriptor_memory = VK_NULL_HANDLE;
+    VK_CALL(vkDestroyBuffer(device->vk_device, descriptor_heap->vk_descriptor_buffer, NULL));
+    descriptor_heap->vk_descriptor_buffer = VK_NULL_HANDLE;
+    return hr;
+}
+
 static HRESULT d3d12_descriptor_heap_init(struct d3d12_descriptor_heap *descriptor_heap,
         struct d3d12_device *device, const D3D12_DESCRIPTOR_HEAP_DESC *desc)
 {
@@ -4363,12 +5233,24 @@ static HRESULT d3d12_descriptor_heap_init(struct d3d12_descriptor_heap *descript
         return hr;
 
     descriptor_heap->use_vk_heaps = device->use_vk_heaps && (desc->Flags & D3D12_DESCRIPTOR_HEAP_FLAG_SHADER_VISIBLE);
+    /* Descriptor buffers replace the Vulkan descriptor sets. */
+    descriptor_heap->use_descriptor_buffer = descriptor_heap->use_vk_heaps && device->use_descriptor_buffers;
+    if (descriptor_heap->use_descriptor_buffer)
+        descriptor_heap->use_vk_heaps = false;
     if (FAILED(hr = d3d12_descriptor_heap_vk_descriptor_sets_init(descriptor_heap, device, desc)))
     {
         vkd3d_private_store_destroy(&descriptor_heap->private_store);
         return hr;
     }
+    if (FAILED(hr = d3d12_descriptor_heap_descriptor_buffer_init(descriptor_heap, device, desc)))
+    {
+        vkd3d_private_store_destroy(&descriptor_heap->private_store);
+        return hr;
+    }
     vkd3d_mutex_init(&descriptor_heap->vk_sets_mutex);
+    descriptor_heap->flush_queued = 0;
+    list_init(&descriptor_heap->dirty_heap_entry);
+    descriptor_heap->flush_count = 0;
 
     d3d12_device_add_ref(descriptor_heap->device = device);
 
@@ -4424,12 +5306,7 @@ HRESULT d3d12_descriptor_heap_create(struct d3d12_device *device,
             dst[i].next = 0;
         }
         object->dirty_list_head = UINT_MAX;
-
-        if (object->use_vk_heaps && FAILED(hr = d3d12_device_add_descriptor_heap(device, object)))
-        {
-            vkd3d_free(object);
-            return hr;
-        }
+        memset((void *)object->dirty_ranges, 0, sizeof(object->dirty_ranges));
     }
     else
     {
@@ -4669,65 +5546,14 @@ HRESULT d3d12_query_heap_create(struct d3d12_device *device, const D3D12_QUERY_H
     return S_OK;
 }
 
-static HRESULT vkd3d_init_null_resources_data(struct vkd3d_null_resources *null_resource,
-        struct d3d12_device *device)
+static void vkd3d_null_resources_init_images(struct vkd3d_null_resources *null_resource,
+        struct d3d12_device *device, VkCommandBuffer vk_command_buffer)
 {
     const bool use_sparse_resources = device->vk_info.sparse_properties.residencyNonResidentStrict;
     const struct vkd3d_vk_device_procs *vk_procs = &device->vk_procs;
     static const VkClearColorValue clear_color = {{0}};
-    VkCommandBufferAllocateInfo command_buffer_info;
-    VkCommandPool vk_command_pool = VK_NULL_HANDLE;
-    VkCommandPoolCreateInfo command_pool_info;
-    VkDevice vk_device = device->vk_device;
-    VkCommandBufferBeginInfo begin_info;
-    VkCommandBuffer vk_command_buffer;
-    VkFence vk_fence = VK_NULL_HANDLE;
     VkImageSubresourceRange range;
     VkImageMemoryBarrier barrier;
-    VkFenceCreateInfo fence_info;
-    struct vkd3d_queue *queue;
-    VkSubmitInfo submit_info;
-    VkQueue vk_queue;
-    VkResult vr;
-
-    queue = d3d12_device_get_vkd3d_queue(device, D3D12_COMMAND_LIST_TYPE_DIRECT);
-
-    command_pool_info.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
-    command_pool_info.pNext = NULL;
-    command_pool_info.flags = 0;
-    command_pool_info.queueFamilyIndex = queue->vk_family_index;
-
-    if ((vr = VK_CALL(vkCreateCommandPool(vk_device, &command_pool_info, NULL, &vk_command_pool))) < 0)
-    {
-        WARN("Failed to create Vulkan command pool, vr %d.\n", vr);
-        goto done;
-    }
-
-    command_buffer_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
-    command_buffer_info.pNext = NULL;
-    command_buffer_info.commandPool = vk_command_pool;
-    command_buffer_info.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
-    command_buffer_info.commandBufferCount = 1;
-
-    if ((vr = VK_CALL(vkAllocateCommandBuffers(vk_device, &command_buffer_info, &vk_command_buffer))) < 0)
-    {
-        WARN("Failed to allocate Vulkan command buffer, vr %d.\n", vr);
-        goto done;
-    }
-
-    begin_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
-    begin_info.pNext = NULL;
-    begin_info.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
-    begin_info.pInheritanceInfo = NULL;
-
-    if ((vr = VK_CALL(vkBeginCommandBuffer(vk_command_buffer, &begin_info))) < 0)
-    {
-        WARN("Failed to begin command buffer, vr %d.\n", vr);
-        goto done;
-    }
-
-    /* fill buffer */
-    VK_CALL(vkCmdFillBuffer(vk_command_buffer, null_resource->vk_buffer, 0, VK_WHOLE_SIZE, 0x00000000));
 
     if (use_sparse_resources)
     {
@@ -4806,6 +5632,66 @@ static HRESULT vkd3d_init_null_resources_data(struct vkd3d_null_resources *null_
     VK_CALL(vkCmdPipelineBarrier(vk_command_buffer,
             VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 0,
             0, NULL, 0, NULL, 1, &barrier));
+}
+
+static HRESULT vkd3d_init_null_resources_data(struct vkd3d_null_resources *null_resource,
+        struct d3d12_device *device)
+{
+    const struct vkd3d_vk_device_procs *vk_procs = &device->vk_procs;
+    VkCommandBufferAllocateInfo command_buffer_info;
+    VkCommandPool vk_command_pool = VK_NULL_HANDLE;
+    VkCommandPoolCreateInfo command_pool_info;
+    VkDevice vk_device = device->vk_device;
+    VkCommandBufferBeginInfo begin_info;
+    VkCommandBuffer vk_command_buffer;
+    VkFence vk_fence = VK_NULL_HANDLE;
+    VkFenceCreateInfo fence_info;
+    struct vkd3d_queue *queue;
+    VkSubmitInfo submit_info;
+    VkQueue vk_queue;
+    VkResult vr;
+
+    queue = d3d12_device_get_vkd3d_queue(device, D3D12_COMMAND_LIST_TYPE_DIRECT);
+
+    command_pool_info.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+    command_pool_info.pNext = NULL;
+    command_pool_info.flags = 0;
+    command_pool_info.queueFamilyIndex = queue->vk_family_index;
+
+    if ((vr = VK_CALL(vkCreateCommandPool(vk_device, &command_pool_info, NULL, &vk_command_pool))) < 0)
+    {
+        WARN("Failed to create Vulkan command pool, vr %d.\n", vr);
+        goto done;
+    }
+
+    command_buffer_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+    command_buffer_info.pNext = NULL;
+    command_buffer_info.commandPool = vk_command_pool;
+    command_buffer_info.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+    command_buffer_info.commandBufferCount = 1;
+
+    if ((vr = VK_CALL(vkAllocateCommandBuffers(vk_device, &command_buffer_info, &vk_command_buffer))) < 0)
+    {
+        WARN("Failed to allocate Vulkan command buffer, vr %d.\n", vr);
+        goto done;
+    }
+
+    begin_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    begin_info.pNext = NULL;
+    begin_info.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+    begin_info.pInheritanceInfo = NULL;
+
+    if ((vr = VK_CALL(vkBeginCommandBuffer(vk_command_buffer, &begin_info))) < 0)
+    {
+        WARN("Failed to begin command buffer, vr %d.\n", vr);
+        goto done;
+    }
+
+    /* fill buffer */
+    VK_CALL(vkCmdFillBuffer(vk_command_buffer, null_resource->vk_buffer, 0, VK_WHOLE_SIZE, 0x00000000));
+
+    if (!device->vk_info.EXT_robustness2)
+        vkd3d_null_resources_init_images(null_resource, device, vk_command_buffer);
 
     if ((vr = VK_CALL(vkEndCommandBuffer(vk_command_buffer))) < 0)
     {
@@ -4841,6 +5727,8 @@ static HRESULT vkd3d_init_null_resources_data(struct vkd3d_null_resources *null_
 
     if ((vr = VK_CALL(vkQueueSubmit(vk_queue, 1, &submit_info, vk_fence))) < 0)
         ERR("Failed to submit, vr %d.\n", vr);
+    else
+        d3d12_device_add_statistic(device, vk_queue_submit_count, 1);
 
     vkd3d_queue_release(queue);
 
@@ -4855,7 +5743,34 @@ done:
     return hresult_from_vk_result(vr);
 }
 
-HRESULT vkd3d_init_null_resources(struct vkd3d_null_resources *null_resources,
+static void vkd3d_null_resources_destroy_objects(struct vkd3d_null_resources *null_resources,
+        struct d3d12_device *device)
+{
+    const struct vkd3d_vk_device_procs *vk_procs = &device->vk_procs;
+
+    VK_CALL(vkDestroyBuffer(device->vk_device, null_resources->vk_buffer, NULL));
+    VK_CALL(vkFreeMemory(device->vk_device, null_resources->vk_buffer_memory, NULL));
+
+    VK_CALL(vkDestroyBuffer(device->vk_device, null_resources->vk_storage_buffer, NULL));
+    VK_CALL(vkFreeMemory(device->vk_device, null_resources->vk_storage_buffer_memory, NULL));
+
+    VK_CALL(vkDestroyImage(device->vk_device, null_resources->vk_2d_image, NULL));
+    VK_CALL(vkFreeMemory(device->vk_device, null_resources->vk_2d_image_memory, NULL));
+
+    VK_CALL(vkDestroyImage(device->vk_device, null_resources->vk_2d_storage_image, NULL));
+    VK_CALL(vkFreeMemory(device->vk_device, null_resources->vk_2d_storage_image_memory, NULL));
+
+    null_resources->vk_buffer = VK_NULL_HANDLE;
+    null_resources->vk_buffer_memory = VK_NULL_HANDLE;
+    null_resources->vk_storage_buffer = VK_NULL_HANDLE;
+    null_resources->vk_storage_buffer_memory = VK_NULL_HANDLE;
+    null_resources->vk_2d_image = VK_NULL_HANDLE;
+    null_resources->vk_2d_image_memory = VK_NULL_HANDLE;
+    null_resources->vk_2d_storage_image = VK_NULL_HANDLE;
+    null_resources->vk_2d_storage_image_memory = VK_NULL_HANDLE;
+}
+
+static HRESULT vkd3d_null_resources_create(struct vkd3d_null_resources *null_resources,
         struct d3d12_device *device)
 {
     const bool use_sparse_resources = device->vk_info.sparse_properties.residencyNonResidentStrict;
@@ -4865,9 +5780,9 @@ HRESULT vkd3d_init_null_resources(struct vkd3d_null_resources *null_resources,
 
     TRACE("Creating resources for NULL views.\n");
 
-    memset(null_resources, 0, sizeof(*null_resources));
-
-    if (device->vk_info.EXT_robustness2)
+    /* Views use null descriptors with robustness2, but root CBVs passed as
+     * buffer device addresses still need a buffer. */
+    if (device->vk_info.EXT_robustness2 && !device->use_root_buffer_addresses)
         return S_OK;
 
     memset(&heap_properties, 0, sizeof(heap_properties));
@@ -4876,7 +5791,7 @@ HRESULT vkd3d_init_null_resources(struct vkd3d_null_resources *null_resources,
     /* buffer */
     resource_desc.Dimension = D3D12_RESOURCE_DIMENSION_BUFFER;
     resource_desc.Alignment = 0;
-    resource_desc.Width = VKD3D_NULL_BUFFER_SIZE;
+    resource_desc.Width = device->use_root_buffer_addresses ? VKD3D_NULL_CONSTANT_BUFFER_SIZE : VKD3D_NULL_BUFFER_SIZE;
     resource_desc.Height = 1;
     resource_desc.DepthOrArraySize = 1;
     resource_desc.MipLevels = 1;
@@ -4893,8 +5808,20 @@ HRESULT vkd3d_init_null_resources(struct vkd3d_null_resources *null_resources,
     if (FAILED(hr = vkd3d_allocate_buffer_memory(device, null_resources->vk_buffer,
             &heap_properties, D3D12_HEAP_FLAG_NONE, &null_resources->vk_buffer_memory, NULL, NULL)))
         goto fail;
+    if (device->use_root_buffer_addresses)
+        null_resources->vk_buffer_address = vkd3d_get_buffer_device_address(device, null_resources->vk_buffer);
+
+    if (device->vk_info.EXT_robustness2)
+    {
+        vkd3d_set_vk_object_name_utf8(device, (uint64_t)null_resources->vk_buffer,
+                VK_DEBUG_REPORT_OBJECT_TYPE_BUFFER_EXT, "NULL buffer");
+        if (SUCCEEDED(hr = vkd3d_init_null_resources_data(null_resources, device)))
+            return hr;
+        goto fail;
+    }
 
     /* buffer UAV */
+    resource_desc.Width = VKD3D_NULL_BUFFER_SIZE;
     resource_desc.Flags = D3D12_RESOURCE_FLAG_ALLOW_UNORDERED_ACCESS;
 
     if (FAILED(hr = vkd3d_create_buffer(device, use_sparse_resources ? NULL : &heap_properties, D3D12_HEAP_FLAG_NONE,
@@ -4966,30 +5893,40 @@ HRESULT vkd3d_init_null_resources(struct vkd3d_null_resources *null_resources,
                 VK_DEBUG_REPORT_OBJECT_TYPE_DEVICE_MEMORY_EXT, "NULL 2D UAV memory");
     }
 
-    return vkd3d_init_null_resources_data(null_resources, device);
+    if (SUCCEEDED(hr = vkd3d_init_null_resources_data(null_resources, device)))
+        return hr;
 
 fail:
     ERR("Failed to initialise NULL resources, hr %s.\n", debugstr_hresult(hr));
-    vkd3d_destroy_null_resources(null_resources, device);
+    vkd3d_null_resources_destroy_objects(null_resources, device);
     return hr;
 }
 
-void vkd3d_destroy_null_resources(struct vkd3d_null_resources *null_resources,
-        struct d3d12_device *device)
+void vkd3d_init_null_resources(struct vkd3d_null_resources *null_resources)
 {
-    const struct vkd3d_vk_device_procs *vk_procs = &device->vk_procs;
+    memset(null_resources, 0, sizeof(*null_resources));
+    vkd3d_mutex_init(&null_resources->mutex);
+}
 
-    VK_CALL(vkDestroyBuffer(device->vk_device, null_resources->vk_buffer, NULL));
-    VK_CALL(vkFreeMemory(device->vk_device, null_resources->vk_buffer_memory, NULL));
+const struct vkd3d_null_resources *vkd3d_get_null_resources(struct d3d12_device *device)
+{
+    struct vkd3d_null_resources *null_resources = &device->null_resources;
+    HRESULT hr = S_OK;
 
-    VK_CALL(vkDestroyBuffer(device->vk_device, null_resources->vk_storage_buffer, NULL));
-    VK_CALL(vkFreeMemory(device->vk_device, null_resources->vk_storage_buffer_memory, NULL));
+    if (vkd3d_atomic_load_u32_acquire(&null_resources->initialised))
+        return null_resources;
 
-    VK_CALL(vkDestroyImage(device->vk_device, null_resources->vk_2d_image, NULL));
-    VK_CALL(vkFreeMemory(device->vk_device, null_resources->vk_2d_image_memory, NULL));
+    vkd3d_mutex_lock(&null_resources->mutex);
+    if (!null_resources->initialised && SUCCEEDED(hr = vkd3d_null_resources_create(null_resources, device)))
+        vkd3d_atomic_store_u32_release(&null_resources->initialised, 1);
+    vkd3d_mutex_unlock(&null_resources->mutex);
 
-    VK_CALL(vkDestroyImage(device->vk_device, null_resources->vk_2d_storage_image, NULL));
-    VK_CALL(vkFreeMemory(device->vk_device, null_resources->vk_2d_storage_image_memory, NULL));
+    return SUCCEEDED(hr) ? null_resources : NULL;
+}
 
-    memset(null_resources, 0, sizeof(*null_resources));
+void vkd3d_destroy_null_resources(struct vkd3d_null_resources *null_resources,
+        struct d3d12_device *device)
+{
+    vkd3d_null_resources_destroy_objects(null_resources, device);
+    vkd3d_mutex_destroy(&null_resources->mutex);
 }
@@ -22,41 +22,87 @@
 #include "vkd3d_shaders.h"
 #include "vkd3d_shader_utils.h"
 
-/* ID3D12RootSignature */
-static inline struct d3d12_root_signature *impl_from_ID3D12RootSignature(ID3D12RootSignature *iface)
+static uint64_t vkd3d_shared_state_hash(const void *data, size_t size)
 {
-    return CONTAINING_RECORD(iface, struct d3d12_root_signature, ID3D12RootSignature_iface);
+    static const uint64_t fnv_prime = 0x00000100000001b3;
+    uint64_t hash = 0xcbf29ce484222325;
+    const uint8_t *d = data;
+    size_t i;
+
+    for (i = 0; i < size; ++i)
+        hash = (hash ^ d[i]) * fnv_prime;
+
+    return hash;
 }
 
-static HRESULT STDMETHODCALLTYPE d3d12_root_signature_QueryInterface(ID3D12RootSignature *iface,
-        REFIID riid, void **object)
+struct vkd3d_shared_state_key_buffer
 {
-    TRACE("iface %p, riid %s, object %p.\n", iface, debugstr_guid(riid), object);
+    uint8_t *data;
+    size_t size;
+    size_t capacity;
+    bool failed;
+};
 
-    if (IsEqualGUID(riid, &IID_ID3D12RootSignature)
-            || IsEqualGUID(riid, &IID_ID3D12DeviceChild)
-            || IsEqualGUID(riid, &IID_ID3D12Object)
-            || IsEqualGUID(riid, &IID_IUnknown))
+static void key_buffer_put(struct vkd3d_shared_state_key_buffer *buffer, const void *data, size_t size)
+{
+    if (buffer->failed)
+        return;
+
+    if (!vkd3d_array_reserve((void **)&buffer->data, &buffer->capacity, buffer->size + size, 1))
     {
-        ID3D12RootSignature_AddRef(iface);
-        *object = iface;
-        return S_OK;
+        buffer->failed = true;
+        return;
     }
 
-    WARN("%s not implemented, returning E_NOINTERFACE.\n", debugstr_guid(riid));
+    if (size)
+        memcpy(&buffer->data[buffer->size], data, size);
+    buffer->size += size;
+}
 
-    *object = NULL;
-    return E_NOINTERFACE;
+static void key_buffer_put_u32(struct vkd3d_shared_state_key_buffer *buffer, uint32_t value)
+{
+    key_buffer_put(buffer, &value, sizeof(value));
 }
 
-static ULONG STDMETHODCALLTYPE d3d12_root_signature_AddRef(ID3D12RootSignature *iface)
+static int vkd3d_shared_state_key_compare(const struct vkd3d_shared_state_key *k,
+        const struct vkd3d_shared_state_key *e)
 {
-    struct d3d12_root_signature *root_signature = impl_from_ID3D12RootSignature(iface);
-    unsigned int refcount = vkd3d_atomic_increment_u32(&root_signature->refcount);
+    int ret;
 
-    TRACE("%p increasing refcount to %u.\n", root_signature, refcount);
+    if ((ret = vkd3d_u64_compare(k->hash, e->hash)))
+        return ret;
+    if ((ret = vkd3d_u64_compare(k->size, e->size)))
+        return ret;
+    return memcmp(k->data, e->data, k->size);
+}
 
-    return refcount;
+static int vkd3d_shared_root_signature_compare(const void *key, const struct rb_entry *entry)
+{
+    const struct d3d12_root_signature *e = RB_ENTRY_VALUE(entry, struct d3d12_root_signature, entry);
+
+    return vkd3d_shared_state_key_compare(key, &e->key);
+}
+
+static int vkd3d_shared_pipeline_state_compare(const void *key, const struct rb_entry *entry)
+{
+    const struct d3d12_pipeline_state *e = RB_ENTRY_VALUE(entry, struct d3d12_pipeline_state, entry);
+
+    return vkd3d_shared_state_key_compare(key, &e->key);
+}
+
+void vkd3d_shared_state_cache_init(struct vkd3d_shared_state_cache *cache)
+{
+    vkd3d_mutex_init(&cache->mutex);
+    rb_init(&cache->root_signatures, vkd3d_shared_root_signature_compare);
+    rb_init(&cache->pipeline_states, vkd3d_shared_pipeline_state_compare);
+}
+
+void vkd3d_shared_state_cache_cleanup(struct vkd3d_shared_state_cache *cache)
+{
+    /* Every entry holds a device reference through its COM objects. */
+    VKD3D_ASSERT(!cache->root_signatures.root);
+    VKD3D_ASSERT(!cache->pipeline_states.root);
+    vkd3d_mutex_destroy(&cache->mutex);
 }
 
 static void d3d12_descriptor_set_layout_cleanup(
@@ -97,6 +143,7 @@ static void d3d12_root_signature_cleanup(struct d3d12_root_signature *root_signa
     vkd3d_free(root_signature->uav_counter_offsets);
     if (root_signature->root_constants)
         vkd3d_free(root_signature->root_constants);
+    vkd3d_free(root_signature->root_buffer_addresses);
 
     for (i = 0; i < root_signature->static_sampler_count; ++i)
     {
@@ -105,11 +152,80 @@ static void d3d12_root_signature_cleanup(struct d3d12_root_signature *root_signa
     }
     if (root_signature->static_samplers)
         vkd3d_free(root_signature->static_samplers);
+
+    vkd3d_free((void *)root_signature->layout_key.data);
+}
+
+static void d3d12_root_signature_destroy(struct d3d12_root_signature *root_signature)
+{
+    d3d12_root_signature_cleanup(root_signature, root_signature->device);
+    vkd3d_free((void *)root_signature->key.data);
+    vkd3d_free(root_signature);
+}
+
+static void d3d12_root_signature_incref(struct d3d12_root_signature *root_signature)
+{
+    struct vkd3d_shared_state_cache *cache = &root_signature->device->shared_state_cache;
+
+    vkd3d_mutex_lock(&cache->mutex);
+    ++root_signature->refcount;
+    vkd3d_mutex_unlock(&cache->mutex);
+}
+
+static void d3d12_root_signature_decref(struct d3d12_root_signature *root_signature)
+{
+    struct vkd3d_shared_state_cache *cache = &root_signature->device->shared_state_cache;
+    unsigned int refcount;
+
+    vkd3d_mutex_lock(&cache->mutex);
+    if (!(refcount = --root_signature->refcount))
+        rb_remove(&cache->root_signatures, &root_signature->entry);
+    vkd3d_mutex_unlock(&cache->mutex);
+
+    if (!refcount)
+        d3d12_root_signature_destroy(root_signature);
+}
+
+/* ID3D12RootSignature */
+static inline struct d3d12_root_signature_object *impl_from_ID3D12RootSignature(ID3D12RootSignature *iface)
+{
+    return CONTAINING_RECORD(iface, struct d3d12_root_signature_object, ID3D12RootSignature_iface);
+}
+
+static HRESULT STDMETHODCALLTYPE d3d12_root_signature_QueryInterface(ID3D12RootSignature *iface,
+        REFIID riid, void **object)
+{
+    TRACE("iface %p, riid %s, object %p.\n", iface, debugstr_guid(riid), object);
+
+    if (IsEqualGUID(riid, &IID_ID3D12RootSignature)
+            || IsEqualGUID(riid, &IID_ID3D12DeviceChild)
+            || IsEqualGUID(riid, &IID_ID3D12Object)
+            || IsEqualGUID(riid, &IID_IUnknown))
+    {
+        ID3D12RootSignature_AddRef(iface);
+        *object = iface;
+        return S_OK;
+    }
+
+    WARN("%s not implemented, returning E_NOINTERFACE.\n", debugstr_guid(riid));
+
+    *object = NULL;
+    return E_NOINTERFACE;
+}
+
+static ULONG STDMETHODCALLTYPE d3d12_root_signature_AddRef(ID3D12RootSignature *iface)
+{
+    struct d3d12_root_signature_object *root_signature = impl_from_ID3D12RootSignature(iface);
+    unsigned int refcount = vkd3d_atomic_increment_u32(&root_signature->refcount);
+
+    TRACE("%p increasing refcount to %u.\n", root_signature, refcount);
+
+    return refcount;
 }
 
 static ULONG STDMETHODCALLTYPE d3d12_root_signature_Release(ID3D12RootSignature *iface)
 {
-    struct d3d12_root_signature *root_signature = impl_from_ID3D12RootSignature(iface);
+    struct d3d12_root_signature_object *root_signature = impl_from_ID3D12RootSignature(iface);
     unsigned int refcount = vkd3d_atomic_decrement_u32(&root_signature->refcount);
 
     TRACE("%p decreasing refcount to %u.\n", root_signature, refcount);
@@ -118,7 +234,7 @@ static ULONG STDMETHODCALLTYPE d3d12_root_signature_Release(ID3D12RootSignature
     {
         struct d3d12_device *device = root_signature->device;
         vkd3d_private_store_destroy(&root_signature->private_store);
-        d3d12_root_signature_cleanup(root_signature, device);
+        d3d12_root_signature_decref(root_signature->root_signature);
         vkd3d_free(root_signature);
         d3d12_device_release(device);
     }
@@ -129,7 +245,7 @@ static ULONG STDMETHODCALLTYPE d3d12_root_signature_Release(ID3D12RootSignature
 static HRESULT STDMETHODCALLTYPE d3d12_root_signature_GetPrivateData(ID3D12RootSignature *iface,
         REFGUID guid, UINT *data_size, void *data)
 {
-    struct d3d12_root_signature *root_signature = impl_from_ID3D12RootSignature(iface);
+    struct d3d12_root_signature_object *root_signature = impl_from_ID3D12RootSignature(iface);
 
     TRACE("iface %p, guid %s, data_size %p, data %p.\n", iface, debugstr_guid(guid), data_size, data);
 
@@ -139,7 +255,7 @@ static HRESULT STDMETHODCALLTYPE d3d12_root_signature_GetPrivateData(ID3D12RootS
 static HRESULT STDMETHODCALLTYPE d3d12_root_signature_SetPrivateData(ID3D12RootSignature *iface,
         REFGUID guid, UINT data_size, const void *data)
 {
-    struct d3d12_root_signature *root_signature = impl_from_ID3D12RootSignature(iface);
+    struct d3d12_root_signature_object *root_signature = impl_from_ID3D12RootSignature(iface);
 
     TRACE("iface %p, guid %s, data_size %u, data %p.\n", iface, debugstr_guid(guid), data_size, data);
 
@@ -149,7 +265,7 @@ static HRESULT STDMETHODCALLTYPE d3d12_root_signature_SetPrivateData(ID3D12RootS
 static HRESULT STDMETHODCALLTYPE d3d12_root_signature_SetPrivateDataInterface(ID3D12RootSignature *iface,
         REFGUID guid, const IUnknown *data)
 {
-    struct d3d12_root_signature *root_signature = impl_from_ID3D12RootSignature(iface);
+    struct d3d12_root_signature_object *root_signature = impl_from_ID3D12RootSignature(iface);
 
     TRACE("iface %p, guid %s, data %p.\n", iface, debugstr_guid(guid), data);
 
@@ -158,7 +274,7 @@ static HRESULT STDMETHODCALLTYPE d3d12_root_signature_SetPrivateDataInterface(ID
 
 static HRESULT STDMETHODCALLTYPE d3d12_root_signature_SetName(ID3D12RootSignature *iface, const WCHAR *name)
 {
-    struct d3d12_root_signature *root_signature = impl_from_ID3D12RootSignature(iface);
+    struct d3d12_root_signature_object *root_signature = impl_from_ID3D12RootSignature(iface);
 
     TRACE("iface %p, name %s.\n", iface, debugstr_w(name, root_signature->device->wchar_size));
 
@@ -168,7 +284,7 @@ static HRESULT STDMETHODCALLTYPE d3d12_root_signature_SetName(ID3D12RootSignatur
 static HRESULT STDMETHODCALLTYPE d3d12_root_signature_GetDevice(ID3D12RootSignature *iface,
         REFIID iid, void **device)
 {
-    struct d3d12_root_signature *root_signature = impl_from_ID3D12RootSignature(iface);
+    struct d3d12_root_signature_object *root_signature = impl_from_ID3D12RootSignature(iface);
 
     TRACE("iface %p, iid %s, device %p.\n", iface, debugstr_guid(iid), device);
 
@@ -195,7 +311,7 @@ struct d3d12_root_signature *unsafe_impl_from_ID3D12RootSignature(ID3D12RootSign
     if (!iface)
         return NULL;
     VKD3D_ASSERT(iface->lpVtbl == &d3d12_root_signature_vtbl);
-    return impl_from_ID3D12RootSignature(iface);
+    return impl_from_ID3D12RootSignature(iface)->root_signature;
 }
 
 static VkShaderStageFlags stage_flags_from_visibility(D3D12_SHADER_VISIBILITY visibility)
@@ -308,6 +424,7 @@ struct d3d12_root_signature_info
 
     size_t root_constant_count;
     size_t root_descriptor_count;
+    size_t root_cbv_count;
 
     unsigned int cbv_count;
     unsigned int srv_count;
@@ -518,6 +635,7 @@ static HRESULT d3d12_root_signature_info_from_desc(struct d3d12_root_signature_i
 
             case D3D12_ROOT_PARAMETER_TYPE_CBV:
                 ++info->root_descriptor_count;
+                ++info->root_cbv_count;
                 ++info->cbv_count;
                 ++info->binding_count;
                 info->cost += 2;
@@ -603,10 +721,11 @@ static HRESULT d3d12_root_signature_init_push_constants(struct d3d12_root_signat
         struct VkPushConstantRange push_constants[D3D12_SHADER_VISIBILITY_PIXEL + 1],
         uint32_t *push_constant_range_count)
 {
+    bool use_buffer_addresses = root_signature->device->use_root_buffer_addresses;
     uint32_t push_constants_offset[D3D12_SHADER_VISIBILITY_PIXEL + 1];
     bool use_vk_heaps = root_signature->device->use_vk_heaps;
     unsigned int i, j, push_constant_count;
-    uint32_t offset;
+    uint32_t offset, size;
 
     memset(push_constants, 0, (D3D12_SHADER_VISIBILITY_PIXEL + 1) * sizeof(*push_constants));
     memset(push_constants_offset, 0, sizeof(push_constants_offset));
@@ -615,15 +734,23 @@ static HRESULT d3d12_root_signature_init_push_constants(struct d3d12_root_signat
         const D3D12_ROOT_PARAMETER *p = &desc->pParameters[i];
         D3D12_SHADER_VISIBILITY visibility;
 
-        if (p->ParameterType != D3D12_ROOT_PARAMETER_TYPE_32BIT_CONSTANTS)
+        if (p->ParameterType == D3D12_ROOT_PARAMETER_TYPE_32BIT_CONSTANTS)
+            size = align(p->u.Constants.Num32BitValues, 4) * sizeof(uint32_t);
+        else if (p->ParameterType == D3D12_ROOT_PARAMETER_TYPE_CBV && use_buffer_addresses)
+            size = sizeof(VkDeviceAddress);
+        else
             continue;
 
         visibility = use_vk_heaps ? D3D12_SHADER_VISIBILITY_ALL : p->ShaderVisibility;
         VKD3D_ASSERT(visibility <= D3D12_SHADER_VISIBILITY_PIXEL);
 
         push_constants[visibility].stageFlags = stage_flags_from_visibility(visibility);
-        push_constants[visibility].size += align(p->u.Constants.Num32BitValues, 4) * sizeof(uint32_t);
+        push_constants[visibility].size += size;
     }
+    /* Buffer addresses are placed after the root constants in each range, and
+     * root constants must be 16-byte aligned. */
+    for (i = 0; i <= D3D12_SHADER_VISIBILITY_PIXEL; ++i)
+        push_constants[i].size = align(push_constants[i].size, 16);
 
     if (push_constants[D3D12_SHADER_VISIBILITY_ALL].size)
     {
@@ -689,6 +816,34 @@ static HRESULT d3d12_root_signature_init_push_constants(struct d3d12_root_signat
         ++j;
     }
 
+    for (i = 0, j = 0; use_buffer_addresses && i < desc->NumParameters; ++i)
+    {
+        struct d3d12_root_constant *address = &root_signature->parameters[i].u.constant;
+        const D3D12_ROOT_PARAMETER *p = &desc->pParameters[i];
+        unsigned int idx;
+
+        if (p->ParameterType != D3D12_ROOT_PARAMETER_TYPE_CBV)
+            continue;
+
+        idx = push_constant_count == 1 ? 0 : p->ShaderVisibility;
+        offset = push_constants_offset[idx];
+        push_constants_offset[idx] += sizeof(VkDeviceAddress);
+
+        root_signature->parameters[i].parameter_type = p->ParameterType;
+        address->stage_flags = push_constant_count == 1
+                ? push_constants[0].stageFlags : stage_flags_from_visibility(p->ShaderVisibility);
+        address->offset = offset;
+
+        root_signature->root_buffer_addresses[j].register_space = p->u.Descriptor.RegisterSpace;
+        root_signature->root_buffer_addresses[j].register_index = p->u.Descriptor.ShaderRegister;
+        root_signature->root_buffer_addresses[j].shader_visibility
+                = vkd3d_shader_visibility_from_d3d12(p->ShaderVisibility);
+        root_signature->root_buffer_addresses[j].offset = offset;
+        root_signature->root_buffer_addresses[j].size = sizeof(VkDeviceAddress);
+
+        ++j;
+    }
+
     *push_constant_range_count = push_constant_count;
 
     return S_OK;
@@ -759,6 +914,7 @@ struct vkd3d_descriptor_set_context
     bool push_descriptor;
     bool static_samplers;
     bool use_vk_heaps;
+    bool use_descriptor_buffers;
 };
 
 static void descriptor_set_context_cleanup(struct vkd3d_descriptor_set_context *context)
@@ -829,10 +985,15 @@ static struct vk_binding_array *d3d12_root_signature_vk_binding_array_for_type(
 
     if (context->push_descriptor)
     {
+        VkDescriptorSetLayoutCreateFlags flags = VK_DESCRIPTOR_SET_LAYOUT_CREATE_PUSH_DESCRIPTOR_BIT_KHR;
+
+        if (context->use_descriptor_buffers)
+            flags |= VK_DESCRIPTOR_SET_LAYOUT_CREATE_DESCRIPTOR_BUFFER_BIT_EXT;
+
         /* The descriptor type is irrelevant here, it will never be used. */
         if (!context->root_descriptor_set)
             context->root_descriptor_set = d3d12_root_signature_append_vk_binding_array(root_signature,
-                    0, VK_DESCRIPTOR_SET_LAYOUT_CREATE_PUSH_DESCRIPTOR_BIT_KHR, context);
+                    0, flags, context);
 
         return context->root_descriptor_set;
     }
@@ -843,7 +1004,12 @@ static struct vk_binding_array *d3d12_root_signature_vk_binding_array_for_type(
         {
             if (!context->static_samplers_descriptor_set)
             {
-                if (!context->push_descriptor && context->root_descriptor_set)
+                /* Descriptor buffers need a dedicated set for embedded samplers. */
+                if (context->use_descriptor_buffers)
+                    context->static_samplers_descriptor_set = d3d12_root_signature_append_vk_binding_array(
+                            root_signature, 0, VK_DESCRIPTOR_SET_LAYOUT_CREATE_DESCRIPTOR_BUFFER_BIT_EXT
+                            | VK_DESCRIPTOR_SET_LAYOUT_CREATE_EMBEDDED_IMMUTABLE_SAMPLERS_BIT_EXT, context);
+                else if (!context->push_descriptor && context->root_descriptor_set)
                     context->static_samplers_descriptor_set = context->root_descriptor_set;
                 else
                     /* The descriptor type is irrelevant here, it will never be used. */
@@ -1353,6 +1519,10 @@ static HRESULT d3d12_root_signature_init_root_descriptors(struct d3d12_root_sign
                 && p->ParameterType != D3D12_ROOT_PARAMETER_TYPE_UAV)
             continue;
 
+        /* Root CBVs are set up with the push constants. */
+        if (p->ParameterType == D3D12_ROOT_PARAMETER_TYPE_CBV && root_signature->device->use_root_buffer_addresses)
+            continue;
+
         root_signature->push_descriptor_mask |= 1u << i;
 
         descriptor_type = vkd3d_descriptor_type_from_d3d12_root_parameter_type(p->ParameterType);
@@ -1386,6 +1556,14 @@ static HRESULT d3d12_root_signature_init_static_samplers(struct d3d12_root_signa
     if (!desc->NumStaticSamplers)
         return S_OK;
 
+    if (context->use_descriptor_buffers && desc->NumStaticSamplers
+            > device->vk_info.descriptor_buffer_properties.maxEmbeddedImmutableSamplerBindings)
+    {
+        FIXME("Static sampler count %u exceeds the maximum embedded sampler count %u.\n", desc->NumStaticSamplers,
+                device->vk_info.descriptor_buffer_properties.maxEmbeddedImmutableSamplerBindings);
+        return E_NOTIMPL;
+    }
+
     if (!(array = d3d12_root_signature_vk_binding_array_for_type(root_signature,
             VKD3D_SHADER_DESCRIPTOR_TYPE_SAMPLER, context)))
         return E_OUTOFMEMORY;
@@ -1614,6 +1792,140 @@ static unsigned int d3d12_root_signature_copy_descriptor_set_layouts(const struc
     return i;
 }
 
+/* Root signatures with equal layout keys have identically defined Vulkan
+ * pipeline layouts, and interpret root arguments in the same way. Static
+ * sampler handles are unique, so root signatures with static samplers are
+ * only compatible with themselves. */
+static HRESULT d3d12_root_signature_init_layout_key(struct d3d12_root_signature *root_signature,
+        const struct vkd3d_descriptor_set_context *context)
+{
+    struct vkd3d_shared_state_key_buffer buffer = {0};
+    const struct d3d12_root_descriptor_table_range *range;
+    const struct d3d12_root_parameter *parameter;
+    const VkDescriptorSetLayoutBinding *binding;
+    const struct vk_binding_array *array;
+    unsigned int i, j;
+
+    key_buffer_put_u32(&buffer, root_signature->vk_set_count);
+    for (i = 0; i < root_signature->vk_set_count; ++i)
+    {
+        array = &context->vk_bindings[i];
+        key_buffer_put_u32(&buffer, array->flags);
+        key_buffer_put_u32(&buffer, array->descriptor_type);
+        key_buffer_put_u32(&buffer, array->unbounded_offset);
+        key_buffer_put_u32(&buffer, array->table_index);
+        key_buffer_put_u32(&buffer, array->count);
+        for (j = 0; j < array->count; ++j)
+        {
+            binding = &array->bindings[j];
+            key_buffer_put_u32(&buffer, binding->binding);
+            key_buffer_put_u32(&buffer, binding->descriptorType);
+            key_buffer_put_u32(&buffer, binding->descriptorCount);
+            key_buffer_put_u32(&buffer, binding->stageFlags);
+            key_buffer_put_u32(&buffer, !!binding->pImmutableSamplers);
+            if (binding->pImmutableSamplers)
+                key_buffer_put(&buffer, binding->pImmutableSamplers,
+                        binding->descriptorCount * sizeof(*binding->pImmutableSamplers));
+        }
+    }
+
+    key_buffer_put_u32(&buffer, root_signature->push_constant_range_count);
+    for (i = 0; i < ARRAY_SIZE(root_signature->push_constant_ranges); ++i)
+    {
+        key_buffer_put_u32(&buffer, root_signature->push_constant_ranges[i].stageFlags);
+        key_buffer_put_u32(&buffer, root_signature->push_constant_ranges[i].offset);
+        key_buffer_put_u32(&buffer, root_signature->push_constant_ranges[i].size);
+    }
+
+    key_buffer_put_u32(&buffer, root_signature->use_descriptor_arrays);
+    key_buffer_put_u32(&buffer, root_signature->main_set);
+    key_buffer_put_u32(&buffer, root_signature->static_sampler_set);
+    key_buffer_put_u32(&buffer, root_signature->descriptor_table_offset);
+    key_buffer_put_u32(&buffer, root_signature->descriptor_table_count);
+    key_buffer_put(&buffer, &root_signature->descriptor_table_mask, sizeof(root_signature->descriptor_table_mask));
+    key_buffer_put_u32(&buffer, root_signature->push_descriptor_mask);
+
+    key_buffer_put_u32(&buffer, root_signature->parameter_count);
+    for (i = 0; i < root_signature->parameter_count; ++i)
+    {
+        parameter = &root_signature->parameters[i];
+        key_buffer_put_u32(&buffer, parameter->parameter_type);
+        switch (parameter->parameter_type)
+        {
+            case D3D12_ROOT_PARAMETER_TYPE_DESCRIPTOR_TABLE:
+                key_buffer_put_u32(&buffer, parameter->u.descriptor_table.range_count);
+                for (j = 0; j < parameter->u.descriptor_table.range_count; ++j)
+                {
+                    range = &parameter->u.descriptor_table.ranges[j];
+                    key_buffer_put_u32(&buffer, range->offset);
+                    key_buffer_put_u32(&buffer, range->descriptor_count);
+                    key_buffer_put_u32(&buffer, range->vk_binding_count);
+                    key_buffer_put_u32(&buffer, range->set);
+                    key_buffer_put_u32(&buffer, range->binding);
+                    key_buffer_put_u32(&buffer, range->image_set);
+                    key_buffer_put_u32(&buffer, range->image_binding);
+                    key_buffer_put_u32(&buffer, range->type);
+                    key_buffer_put_u32(&buffer, range->descriptor_magic);
+                }
+                break;
+
+            case D3D12_ROOT_PARAMETER_TYPE_32BIT_CONSTANTS:
+                key_buffer_put_u32(&buffer, parameter->u.constant.stage_flags);
+                key_buffer_put_u32(&buffer, parameter->u.constant.offset);
+                break;
+
+            case D3D12_ROOT_PARAMETER_TYPE_CBV:
+            case D3D12_ROOT_PARAMETER_TYPE_SRV:
+            case D3D12_ROOT_PARAMETER_TYPE_UAV:
+                /* Root CBVs passed as buffer addresses use the constant member. */
+                if (parameter->parameter_type == D3D12_ROOT_PARAMETER_TYPE_CBV
+                        && root_signature->device->use_root_buffer_addresses)
+                {
+                    key_buffer_put_u32(&buffer, parameter->u.constant.stage_flags);
+                    key_buffer_put_u32(&buffer, parameter->u.constant.offset);
+                }
+                else
+                {
+                    key_buffer_put_u32(&buffer, parameter->u.descriptor.set);
+                    key_buffer_put_u32(&buffer, parameter->u.descriptor.binding);
+                }
+                break;
+
+            default:
+                break;
+        }
+    }
+
+    key_buffer_put_u32(&buffer, root_signature->uav_mapping_count);
+    for (i = 0; root_signature->uav_counter_mapping && i < root_signature->uav_mapping_count; ++i)
+    {
+        key_buffer_put_u32(&buffer, root_signature->uav_counter_mapping[i].binding.set);
+        key_buffer_put_u32(&buffer, root_signature->uav_counter_mapping[i].binding.binding);
+    }
+
+    if (buffer.failed)
+    {
+        vkd3d_free(buffer.data);
+        return E_OUTOFMEMORY;
+    }
+
+    root_signature->layout_key.hash = vkd3d_shared_state_hash(buffer.data, buffer.size);
+    root_signature->layout_key.data = buffer.data;
+    root_signature->layout_key.size = buffer.size;
+
+    return S_OK;
+}
+
+bool d3d12_root_signature_is_layout_compatible(const struct d3d12_root_signature *a,
+        const struct d3d12_root_signature *b)
+{
+    if (a == b)
+        return true;
+
+    return a->layout_key.hash == b->layout_key.hash && a->layout_key.size == b->layout_key.size
+            && !memcmp(a->layout_key.data, b->layout_key.data, a->layout_key.size);
+}
+
 static HRESULT d3d12_root_signature_init(struct d3d12_root_signature *root_signature,
         struct d3d12_device *device, const D3D12_ROOT_SIGNATURE_DESC *desc)
 {
@@ -1627,8 +1939,9 @@ static HRESULT d3d12_root_signature_init(struct d3d12_root_signature *root_signa
 
     memset(&context, 0, sizeof(context));
 
-    root_signature->ID3D12RootSignature_iface.lpVtbl = &d3d12_root_signature_vtbl;
     root_signature->refcount = 1;
+    root_signature->key.data = NULL;
+    root_signature->layout_key.data = NULL;
 
     root_signature->vk_pipeline_layout = VK_NULL_HANDLE;
     root_signature->vk_set_count = 0;
@@ -1638,8 +1951,11 @@ static HRESULT d3d12_root_signature_init(struct d3d12_root_signature *root_signa
     root_signature->descriptor_offsets = NULL;
     root_signature->uav_counter_mapping = NULL;
     root_signature->uav_counter_offsets = NULL;
+    root_signature->root_buffer_address_count = 0;
+    root_signature->root_buffer_addresses = NULL;
     root_signature->static_sampler_count = 0;
     root_signature->static_samplers = NULL;
+    root_signature->static_sampler_set = UINT_MAX;
     root_signature->device = device;
 
     if (desc->Flags & ~(D3D12_ROOT_SIGNATURE_FLAG_ALLOW_INPUT_ASSEMBLER_INPUT_LAYOUT
@@ -1683,11 +1999,16 @@ static HRESULT d3d12_root_signature_init(struct d3d12_root_signature *root_signa
     if (!(root_signature->root_constants = vkd3d_calloc(root_signature->root_constant_count,
             sizeof(*root_signature->root_constants))))
         goto fail;
+    root_signature->root_buffer_address_count = device->use_root_buffer_addresses ? info.root_cbv_count : 0;
+    if (root_signature->root_buffer_address_count && !(root_signature->root_buffer_addresses = vkd3d_calloc(
+            root_signature->root_buffer_address_count, sizeof(*root_signature->root_buffer_addresses))))
+        goto fail;
     if (!(root_signature->static_samplers = vkd3d_calloc(root_signature->static_sampler_count,
             sizeof(*root_signature->static_samplers))))
         goto fail;
 
     context.use_vk_heaps = use_vk_heaps;
+    context.use_descriptor_buffers = device->use_descriptor_buffers;
     context.push_descriptor = vk_info->KHR_push_descriptor;
     if (FAILED(hr = d3d12_root_signature_init_root_descriptors(root_signature, desc, &context)))
         goto fail;
@@ -1702,6 +2023,8 @@ static HRESULT d3d12_root_signature_init(struct d3d12_root_signature *root_signa
     if (FAILED(hr = d3d12_root_signature_init_static_samplers(root_signature, device, desc, &context)))
         goto fail;
     context.static_samplers = false;
+    if (context.use_descriptor_buffers && context.static_samplers_descriptor_set)
+        root_signature->static_sampler_set = context.static_samplers_descriptor_set->descriptor_set;
 
     context.push_constant_index = 0;
     if (FAILED(hr = d3d12_root_signature_init_root_descriptor_tables(root_signature, desc, &info, &context)))
@@ -1711,6 +2034,8 @@ static HRESULT d3d12_root_signature_init(struct d3d12_root_signature *root_signa
 
     if (FAILED(hr = d3d12_root_signature_create_descriptor_set_layouts(root_signature, &context)))
         goto fail;
+    if (FAILED(hr = d3d12_root_signature_init_layout_key(root_signature, &context)))
+        goto fail;
 
     descriptor_set_context_cleanup(&context);
 
@@ -1720,11 +2045,6 @@ static HRESULT d3d12_root_signature_init(struct d3d12_root_signature *root_signa
             root_signature->push_constant_ranges, &root_signature->vk_pipeline_layout)))
         goto fail;
 
-    if (FAILED(hr = vkd3d_private_store_init(&root_signature->private_store)))
-        goto fail;
-
-    d3d12_device_add_ref(device);
-
     return S_OK;
 
 fail:
@@ -1733,9 +2053,10 @@ fail:
     return hr;
 }
 
-HRESULT d3d12_root_signature_create(struct d3d12_device *device,
+static HRESULT d3d12_root_signature_get(struct d3d12_device *device,
         const void *bytecode, size_t bytecode_length, struct d3d12_root_signature **root_signature)
 {
+    struct vkd3d_shared_state_cache *cache = &device->shared_state_cache;
     const struct vkd3d_shader_code dxbc = {bytecode, bytecode_length};
     union
     {
@@ -1743,9 +2064,27 @@ HRESULT d3d12_root_signature_create(struct d3d12_device *device,
         struct vkd3d_shader_versioned_root_signature_desc vkd3d;
     } root_signature_desc;
     struct d3d12_root_signature *object;
+    struct vkd3d_shared_state_key key;
+    struct rb_entry *entry;
     HRESULT hr;
     int ret;
 
+    key.hash = vkd3d_shared_state_hash(bytecode, bytecode_length);
+    key.data = bytecode;
+    key.size = bytecode_length;
+
+    vkd3d_mutex_lock(&cache->mutex);
+    if ((entry = rb_get(&cache->root_signatures, &key)))
+    {
+        object = RB_ENTRY_VALUE(entry, struct d3d12_root_signature, entry);
+        ++object->refcount;
+        vkd3d_mutex_unlock(&cache->mutex);
+        TRACE("Reusing root signature %p.\n", object);
+        *root_signature = object;
+        return S_OK;
+    }
+    vkd3d_mutex_unlock(&cache->mutex);
+
     if ((ret = vkd3d_parse_root_signature_v_1_0(&dxbc, &root_signature_desc.vkd3d)) < 0)
     {
         WARN("Failed to parse root signature, vkd3d result %d.\n", ret);
@@ -1766,6 +2105,29 @@ HRESULT d3d12_root_signature_create(struct d3d12_device *device,
         return hr;
     }
 
+    if (!(object->key.data = vkd3d_memdup(bytecode, bytecode_length)))
+    {
+        d3d12_root_signature_destroy(object);
+        return E_OUTOFMEMORY;
+    }
+    object->key.hash = key.hash;
+    object->key.size = key.size;
+
+    vkd3d_mutex_lock(&cache->mutex);
+    /* Another thread may have created the same root signature meanwhile. */
+    if ((entry = rb_get(&cache->root_signatures, &key)))
+    {
+        struct d3d12_root_signature *existing = RB_ENTRY_VALUE(entry, struct d3d12_root_signature, entry);
+
+        ++existing->refcount;
+        vkd3d_mutex_unlock(&cache->mutex);
+        d3d12_root_signature_destroy(object);
+        *root_signature = existing;
+        return S_OK;
+    }
+    rb_put(&cache->root_signatures, &object->key, &object->entry);
+    vkd3d_mutex_unlock(&cache->mutex);
+
     TRACE("Created root signature %p.\n", object);
 
     *root_signature = object;
@@ -1773,6 +2135,40 @@ HRESULT d3d12_root_signature_create(struct d3d12_device *device,
     return S_OK;
 }
 
+HRESULT d3d12_root_signature_create(struct d3d12_device *device,
+        const void *bytecode, size_t bytecode_length, struct d3d12_root_signature_object **root_signature)
+{
+    struct d3d12_root_signature_object *object;
+    HRESULT hr;
+
+    if (!(object = vkd3d_malloc(sizeof(*object))))
+        return E_OUTOFMEMORY;
+
+    object->ID3D12RootSignature_iface.lpVtbl = &d3d12_root_signature_vtbl;
+    object->refcount = 1;
+
+    if (FAILED(hr = d3d12_root_signature_get(device, bytecode, bytecode_length, &object->root_signature)))
+    {
+        vkd3d_free(object);
+        return hr;
+    }
+
+    if (FAILED(hr = vkd3d_private_store_init(&object->private_store)))
+    {
+        d3d12_root_signature_decref(object->root_signature);
+        vkd3d_free(object);
+        return hr;
+    }
+
+    d3d12_device_add_ref(object->device = device);
+
+    TRACE("Created root signature object %p, root signature %p.\n", object, object->root_signature);
+
+    *root_signature = object;
+
+    return S_OK;
+}
+
 /* vkd3d_render_pass_cache */
 struct vkd3d_render_pass_entry
 {
@@ -1782,12 +2178,23 @@ struct vkd3d_render_pass_entry
 
 STATIC_ASSERT(sizeof(struct vkd3d_render_pass_key) == 48);
 
+VkResult vkd3d_create_render_pass(struct d3d12_device *device,
+        const VkRenderPassCreateInfo *create_info, VkRenderPass *vk_render_pass)
+{
+    const struct vkd3d_vk_device_procs *vk_procs = &device->vk_procs;
+    VkResult vr;
+
+    if ((vr = VK_CALL(vkCreateRenderPass(device->vk_device, create_info, NULL, vk_render_pass))) >= 0)
+        d3d12_device_add_statistic(device, vk_render_pass_count, 1);
+
+    return vr;
+}
+
 static HRESULT vkd3d_render_pass_cache_create_pass_locked(struct vkd3d_render_pass_cache *cache,
         struct d3d12_device *device, const struct vkd3d_render_pass_key *key, VkRenderPass *vk_render_pass)
 {
     VkAttachmentReference attachment_references[D3D12_SIMULTANEOUS_RENDER_TARGET_COUNT + 1];
     VkAttachmentDescription attachments[D3D12_SIMULTANEOUS_RENDER_TARGET_COUNT + 1];
-    const struct vkd3d_vk_device_procs *vk_procs = &device->vk_procs;
     struct vkd3d_render_pass_entry *entry;
     unsigned int index, attachment_index;
     VkSubpassDescription sub_pass_desc;
@@ -1898,7 +2305,7 @@ static HRESULT vkd3d_render_pass_cache_create_pass_locked(struct vkd3d_render_pa
     pass_info.pSubpasses = &sub_pass_desc;
     pass_info.dependencyCount = 0;
     pass_info.pDependencies = NULL;
-    if ((vr = VK_CALL(vkCreateRenderPass(device->vk_device, &pass_info, NULL, vk_render_pass))) >= 0)
+    if ((vr = vkd3d_create_render_pass(device, &pass_info, vk_render_pass)) >= 0)
     {
         entry->vk_render_pass = *vk_render_pass;
         ++cache->render_pass_count;
@@ -2162,80 +2569,112 @@ struct vkd3d_compiled_pipeline
     VkRenderPass vk_render_pass;
 };
 
-/* ID3D12PipelineState */
-static inline struct d3d12_pipeline_state *impl_from_ID3D12PipelineState(ID3D12PipelineState *iface)
-{
-    return CONTAINING_RECORD(iface, struct d3d12_pipeline_state, ID3D12PipelineState_iface);
-}
-
-static HRESULT STDMETHODCALLTYPE d3d12_pipeline_state_QueryInterface(ID3D12PipelineState *iface,
-        REFIID riid, void **object)
+static void d3d12_pipeline_state_destroy_graphics(struct d3d12_pipeline_state *state,
+        struct d3d12_device *device)
 {
-    TRACE("iface %p, riid %s, object %p.\n", iface, debugstr_guid(riid), object);
+    struct d3d12_graphics_pipeline_state *graphics = &state->u.graphics;
+    const struct vkd3d_vk_device_procs *vk_procs = &device->vk_procs;
+    struct vkd3d_compiled_pipeline *current, *e;
+    unsigned int i;
 
-    if (IsEqualGUID(riid, &IID_ID3D12PipelineState)
-            || IsEqualGUID(riid, &IID_ID3D12Pageable)
-            || IsEqualGUID(riid, &IID_ID3D12DeviceChild)
-            || IsEqualGUID(riid, &IID_ID3D12Object)
-            || IsEqualGUID(riid, &IID_IUnknown))
+    for (i = 0; i < graphics->stage_count; ++i)
     {
-        ID3D12PipelineState_AddRef(iface);
-        *object = iface;
-        return S_OK;
+        VK_CALL(vkDestroyShaderModule(device->vk_device, graphics->stages[i].module, NULL));
     }
 
-    WARN("%s not implemented, returning E_NOINTERFACE.\n", debugstr_guid(riid));
+    LIST_FOR_EACH_ENTRY_SAFE(current, e, &graphics->compiled_pipelines, struct vkd3d_compiled_pipeline, entry)
+    {
+        VK_CALL(vkDestroyPipeline(device->vk_device, current->vk_pipeline, NULL));
+        vkd3d_free(current);
+    }
+}
 
-    *object = NULL;
-    return E_NOINTERFACE;
+static void d3d12_pipeline_uav_counter_state_cleanup(struct d3d12_pipeline_uav_counter_state *uav_counters,
+        struct d3d12_device *device)
+{
+    const struct vkd3d_vk_device_procs *vk_procs = &device->vk_procs;
+
+    if (uav_counters->vk_set_layout)
+        VK_CALL(vkDestroyDescriptorSetLayout(device->vk_device, uav_counters->vk_set_layout, NULL));
+    if (uav_counters->vk_pipeline_layout)
+        VK_CALL(vkDestroyPipelineLayout(device->vk_device, uav_counters->vk_pipeline_layout, NULL));
+
+    vkd3d_free(uav_counters->bindings);
 }
 
-static ULONG STDMETHODCALLTYPE d3d12_pipeline_state_AddRef(ID3D12PipelineState *iface)
+static void d3d12_pipeline_state_destroy(struct d3d12_pipeline_state *state)
 {
-    struct d3d12_pipeline_state *state = impl_from_ID3D12PipelineState(iface);
-    unsigned int refcount = vkd3d_atomic_increment_u32(&state->refcount);
+    struct d3d12_device *device = state->device;
+    const struct vkd3d_vk_device_procs *vk_procs = &device->vk_procs;
 
-    TRACE("%p increasing refcount to %u.\n", state, refcount);
+    if (d3d12_pipeline_state_is_graphics(state))
+        d3d12_pipeline_state_destroy_graphics(state, device);
+    else if (d3d12_pipeline_state_is_compute(state))
+        VK_CALL(vkDestroyPipeline(device->vk_device, state->u.compute.vk_pipeline, NULL));
 
-    return refcount;
+    d3d12_pipeline_uav_counter_state_cleanup(&state->uav_counters, device);
+
+    d3d12_root_signature_decref(state->root_signature);
+
+    vkd3d_free((void *)state->key.data);
+    vkd3d_free(state);
 }
 
-static void d3d12_pipeline_state_destroy_graphics(struct d3d12_pipeline_state *state,
-        struct d3d12_device *device)
+static void d3d12_pipeline_state_decref(struct d3d12_pipeline_state *state)
 {
-    struct d3d12_graphics_pipeline_state *graphics = &state->u.graphics;
-    const struct vkd3d_vk_device_procs *vk_procs = &device->vk_procs;
-    struct vkd3d_compiled_pipeline *current, *e;
-    unsigned int i;
+    struct vkd3d_shared_state_cache *cache = &state->device->shared_state_cache;
+    unsigned int refcount;
 
-    for (i = 0; i < graphics->stage_count; ++i)
-    {
-        VK_CALL(vkDestroyShaderModule(device->vk_device, graphics->stages[i].module, NULL));
-    }
+    vkd3d_mutex_lock(&cache->mutex);
+    if (!(refcount = --state->refcount))
+        rb_remove(&cache->pipeline_states, &state->entry);
+    vkd3d_mutex_unlock(&cache->mutex);
 
-    LIST_FOR_EACH_ENTRY_SAFE(current, e, &graphics->compiled_pipelines, struct vkd3d_compiled_pipeline, entry)
+    if (!refcount)
+        d3d12_pipeline_state_destroy(state);
+}
+
+/* ID3D12PipelineState */
+static inline struct d3d12_pipeline_state_object *impl_from_ID3D12PipelineState(ID3D12PipelineState *iface)
+{
+    return CONTAINING_RECORD(iface, struct d3d12_pipeline_state_object, ID3D12PipelineState_iface);
+}
+
+static HRESULT STDMETHODCALLTYPE d3d12_pipeline_state_QueryInterface(ID3D12PipelineState *iface,
+        REFIID riid, void **object)
+{
+    TRACE("iface %p, riid %s, object %p.\n", iface, debugstr_guid(riid), object);
+
+    if (IsEqualGUID(riid, &IID_ID3D12PipelineState)
+            || IsEqualGUID(riid, &IID_ID3D12Pageable)
+            || IsEqualGUID(riid, &IID_ID3D12DeviceChild)
+            || IsEqualGUID(riid, &IID_ID3D12Object)
+            || IsEqualGUID(riid, &IID_IUnknown))
     {
-        VK_CALL(vkDestroyPipeline(device->vk_device, current->vk_pipeline, NULL));
-        vkd3d_free(current);
+        ID3D12PipelineState_AddRef(iface);
+        *object = iface;
+        return S_OK;
     }
+
+    WARN("%s not implemented, returning E_NOINTERFACE.\n", debugstr_guid(riid));
+
+    *object = NULL;
+    return E_NOINTERFACE;
 }
 
-static void d3d12_pipeline_uav_counter_state_cleanup(struct d3d12_pipeline_uav_counter_state *uav_counters,
-        struct d3d12_device *device)
+static ULONG STDMETHODCALLTYPE d3d12_pipeline_state_AddRef(ID3D12PipelineState *iface)
 {
-    const struct vkd3d_vk_device_procs *vk_procs = &device->vk_procs;
+    struct d3d12_pipeline_state_object *state = impl_from_ID3D12PipelineState(iface);
+    unsigned int refcount = vkd3d_atomic_increment_u32(&state->refcount);
 
-    if (uav_counters->vk_set_layout)
-        VK_CALL(vkDestroyDescriptorSetLayout(device->vk_device, uav_counters->vk_set_layout, NULL));
-    if (uav_counters->vk_pipeline_layout)
-        VK_CALL(vkDestroyPipelineLayout(device->vk_device, uav_counters->vk_pipeline_layout, NULL));
+    TRACE("%p increasing refcount to %u.\n", state, refcount);
 
-    vkd3d_free(uav_counters->bindings);
+    return refcount;
 }
 
 static ULONG STDMETHODCALLTYPE d3d12_pipeline_state_Release(ID3D12PipelineState *iface)
 {
-    struct d3d12_pipeline_state *state = impl_from_ID3D12PipelineState(iface);
+    struct d3d12_pipeline_state_object *state = impl_from_ID3D12PipelineState(iface);
     unsigned int refcount = vkd3d_atomic_decrement_u32(&state->refcount);
 
     TRACE("%p decreasing refcount to %u.\n", state, refcount);
@@ -2243,20 +2682,9 @@ static ULONG STDMETHODCALLTYPE d3d12_pipeline_state_Release(ID3D12PipelineState
     if (!refcount)
     {
         struct d3d12_device *device = state->device;
-        const struct vkd3d_vk_device_procs *vk_procs = &device->vk_procs;
 
         vkd3d_private_store_destroy(&state->private_store);
-
-        if (d3d12_pipeline_state_is_graphics(state))
-            d3d12_pipeline_state_destroy_graphics(state, device);
-        else if (d3d12_pipeline_state_is_compute(state))
-            VK_CALL(vkDestroyPipeline(device->vk_device, state->u.compute.vk_pipeline, NULL));
-
-        d3d12_pipeline_uav_counter_state_cleanup(&state->uav_counters, device);
-
-        if (state->implicit_root_signature)
-            d3d12_root_signature_Release(state->implicit_root_signature);
-
+        d3d12_pipeline_state_decref(state->state);
         vkd3d_free(state);
 
         d3d12_device_release(device);
@@ -2268,7 +2696,7 @@ static ULONG STDMETHODCALLTYPE d3d12_pipeline_state_Release(ID3D12PipelineState
 static HRESULT STDMETHODCALLTYPE d3d12_pipeline_state_GetPrivateData(ID3D12PipelineState *iface,
         REFGUID guid, UINT *data_size, void *data)
 {
-    struct d3d12_pipeline_state *state = impl_from_ID3D12PipelineState(iface);
+    struct d3d12_pipeline_state_object *state = impl_from_ID3D12PipelineState(iface);
 
     TRACE("iface %p, guid %s, data_size %p, data %p.\n", iface, debugstr_guid(guid), data_size, data);
 
@@ -2278,7 +2706,7 @@ static HRESULT STDMETHODCALLTYPE d3d12_pipeline_state_GetPrivateData(ID3D12Pipel
 static HRESULT STDMETHODCALLTYPE d3d12_pipeline_state_SetPrivateData(ID3D12PipelineState *iface,
         REFGUID guid, UINT data_size, const void *data)
 {
-    struct d3d12_pipeline_state *state = impl_from_ID3D12PipelineState(iface);
+    struct d3d12_pipeline_state_object *state = impl_from_ID3D12PipelineState(iface);
 
     TRACE("iface %p, guid %s, data_size %u, data %p.\n", iface, debugstr_guid(guid), data_size, data);
 
@@ -2288,7 +2716,7 @@ static HRESULT STDMETHODCALLTYPE d3d12_pipeline_state_SetPrivateData(ID3D12Pipel
 static HRESULT STDMETHODCALLTYPE d3d12_pipeline_state_SetPrivateDataInterface(ID3D12PipelineState *iface,
         REFGUID guid, const IUnknown *data)
 {
-    struct d3d12_pipeline_state *state = impl_from_ID3D12PipelineState(iface);
+    struct d3d12_pipeline_state_object *state = impl_from_ID3D12PipelineState(iface);
 
     TRACE("iface %p, guid %s, data %p.\n", iface, debugstr_guid(guid), data);
 
@@ -2297,13 +2725,14 @@ static HRESULT STDMETHODCALLTYPE d3d12_pipeline_state_SetPrivateDataInterface(ID
 
 static HRESULT STDMETHODCALLTYPE d3d12_pipeline_state_SetName(ID3D12PipelineState *iface, const WCHAR *name)
 {
-    struct d3d12_pipeline_state *state = impl_from_ID3D12PipelineState(iface);
+    struct d3d12_pipeline_state_object *state = impl_from_ID3D12PipelineState(iface);
 
     TRACE("iface %p, name %s.\n", iface, debugstr_w(name, state->device->wchar_size));
 
-    if (d3d12_pipeline_state_is_compute(state))
+    /* The Vulkan pipeline may be shared with other objects; the last name wins. */
+    if (d3d12_pipeline_state_is_compute(state->state))
     {
-        return vkd3d_set_vk_object_name(state->device, (uint64_t)state->u.compute.vk_pipeline,
+        return vkd3d_set_vk_object_name(state->device, (uint64_t)state->state->u.compute.vk_pipeline,
                 VK_DEBUG_REPORT_OBJECT_TYPE_PIPELINE_EXT, name);
     }
 
@@ -2313,7 +2742,7 @@ static HRESULT STDMETHODCALLTYPE d3d12_pipeline_state_SetName(ID3D12PipelineStat
 static HRESULT STDMETHODCALLTYPE d3d12_pipeline_state_GetDevice(ID3D12PipelineState *iface,
         REFIID iid, void **device)
 {
-    struct d3d12_pipeline_state *state = impl_from_ID3D12PipelineState(iface);
+    struct d3d12_pipeline_state_object *state = impl_from_ID3D12PipelineState(iface);
 
     TRACE("iface %p, iid %s, device %p.\n", iface, debugstr_guid(iid), device);
 
@@ -2350,7 +2779,7 @@ struct d3d12_pipeline_state *unsafe_impl_from_ID3D12PipelineState(ID3D12Pipeline
     if (!iface)
         return NULL;
     VKD3D_ASSERT(iface->lpVtbl == &d3d12_pipeline_state_vtbl);
-    return impl_from_ID3D12PipelineState(iface);
+    return impl_from_ID3D12PipelineState(iface)->state;
 }
 
 static inline unsigned int typed_uav_compile_option(const struct d3d12_device *device)
@@ -2385,6 +2814,7 @@ static HRESULT create_shader_stage(struct d3d12_device *device,
     struct VkShaderModuleCreateInfo shader_desc;
     struct vkd3d_shader_dxbc_desc dxbc_desc;
     struct vkd3d_shader_code spirv = {0};
+    uint64_t trace_start;
     char source_name[33];
     VkResult vr;
     int ret;
@@ -2428,8 +2858,11 @@ static HRESULT create_shader_stage(struct d3d12_device *device,
         compile_info.source_name = source_name;
     }
 
-    if ((ret = vkd3d_shader_parse_dxbc_source_type(&compile_info.source, &compile_info.source_type, NULL)) < 0
-            || (ret = vkd3d_shader_compile(&compile_info, &spirv, NULL)) < 0)
+    trace_start = vkd3d_trace_span_begin();
+    if ((ret = vkd3d_shader_parse_dxbc_source_type(&compile_info.source, &compile_info.source_type, NULL)) >= 0)
+        ret = vkd3d_shader_compile(&compile_info, &spirv, NULL);
+    vkd3d_trace_span_end("vkd3d_shader_compile", trace_start);
+    if (ret < 0)
     {
         WARN("Failed to compile shader, vkd3d result %d.\n", ret);
         return hresult_from_vkd3d_result(ret);
@@ -2478,16 +2911,17 @@ static int vkd3d_scan_dxbc(const struct d3d12_device *device, const D3D12_SHADER
 
 static HRESULT vkd3d_create_compute_pipeline(struct d3d12_device *device,
         const D3D12_SHADER_BYTECODE *code, const struct vkd3d_shader_interface_info *shader_interface,
-        VkPipelineLayout vk_pipeline_layout, VkPipeline *vk_pipeline)
+        VkPipelineLayout vk_pipeline_layout, VkPipelineCreateFlags flags, VkPipeline *vk_pipeline)
 {
     const struct vkd3d_vk_device_procs *vk_procs = &device->vk_procs;
     VkComputePipelineCreateInfo pipeline_info;
+    uint64_t start_time;
     VkResult vr;
     HRESULT hr;
 
     pipeline_info.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
     pipeline_info.pNext = NULL;
-    pipeline_info.flags = 0;
+    pipeline_info.flags = flags;
     if (FAILED(hr = create_shader_stage(device, &pipeline_info.stage,
             VK_SHADER_STAGE_COMPUTE_BIT, code, shader_interface)))
         return hr;
@@ -2495,14 +2929,17 @@ static HRESULT vkd3d_create_compute_pipeline(struct d3d12_device *device,
     pipeline_info.basePipelineHandle = VK_NULL_HANDLE;
     pipeline_info.basePipelineIndex = -1;
 
+    start_time = vkd3d_get_monotonic_time_ns();
     vr = VK_CALL(vkCreateComputePipelines(device->vk_device,
             VK_NULL_HANDLE, 1, &pipeline_info, NULL, vk_pipeline));
+    d3d12_device_add_statistic(device, vk_pipeline_time, vkd3d_get_monotonic_time_ns() - start_time);
     VK_CALL(vkDestroyShaderModule(device->vk_device, pipeline_info.stage.module, NULL));
     if (vr < 0)
     {
         WARN("Failed to create Vulkan compute pipeline, hr %s.\n", debugstr_hresult(hr));
         return hresult_from_vk_result(vr);
     }
+    d3d12_device_add_statistic(device, vk_pipeline_count, 1);
 
     return S_OK;
 }
@@ -2638,7 +3075,7 @@ static HRESULT d3d12_pipeline_state_find_and_init_uav_counters(struct d3d12_pipe
 static HRESULT d3d12_pipeline_state_init_compute(struct d3d12_pipeline_state *state,
         struct d3d12_device *device, const struct d3d12_pipeline_state_desc *desc)
 {
-    const struct vkd3d_vk_device_procs *vk_procs = &device->vk_procs;
+    struct vkd3d_shader_buffer_address_info buffer_address_info;
     struct vkd3d_shader_interface_info shader_interface;
     struct vkd3d_shader_descriptor_offset_info offset_info;
     struct vkd3d_shader_spirv_target_info target_info;
@@ -2646,32 +3083,28 @@ static HRESULT d3d12_pipeline_state_init_compute(struct d3d12_pipeline_state *st
     VkPipelineLayout vk_pipeline_layout;
     HRESULT hr;
 
-    state->ID3D12PipelineState_iface.lpVtbl = &d3d12_pipeline_state_vtbl;
-    state->refcount = 1;
-
     memset(&state->uav_counters, 0, sizeof(state->uav_counters));
 
-    if (!(root_signature = unsafe_impl_from_ID3D12RootSignature(desc->root_signature)))
+    if ((root_signature = unsafe_impl_from_ID3D12RootSignature(desc->root_signature)))
+    {
+        d3d12_root_signature_incref(root_signature);
+    }
+    else
     {
         TRACE("Root signature is NULL, looking for an embedded signature.\n");
-        if (FAILED(hr = d3d12_root_signature_create(device,
+        if (FAILED(hr = d3d12_root_signature_get(device,
                 desc->cs.pShaderBytecode, desc->cs.BytecodeLength, &root_signature)))
         {
             WARN("Failed to find an embedded root signature, hr %s.\n", debugstr_hresult(hr));
             return hr;
         }
-        state->implicit_root_signature = &root_signature->ID3D12RootSignature_iface;
-    }
-    else
-    {
-        state->implicit_root_signature = NULL;
     }
+    state->root_signature = root_signature;
 
     if (FAILED(hr = d3d12_pipeline_state_find_and_init_uav_counters(state, device, root_signature,
             &desc->cs, VK_SHADER_STAGE_COMPUTE_BIT)))
     {
-        if (state->implicit_root_signature)
-            d3d12_root_signature_Release(state->implicit_root_signature);
+        d3d12_root_signature_decref(root_signature);
         return hr;
     }
 
@@ -2692,6 +3125,15 @@ static HRESULT d3d12_pipeline_state_init_compute(struct d3d12_pipeline_state *st
         vkd3d_prepend_struct(&target_info, &offset_info);
     }
 
+    if (root_signature->root_buffer_address_count)
+    {
+        buffer_address_info.type = VKD3D_SHADER_STRUCTURE_TYPE_BUFFER_ADDRESS_INFO;
+        buffer_address_info.next = NULL;
+        buffer_address_info.buffers = root_signature->root_buffer_addresses;
+        buffer_address_info.buffer_count = root_signature->root_buffer_address_count;
+        vkd3d_prepend_struct(&target_info, &buffer_address_info);
+    }
+
     shader_interface.type = VKD3D_SHADER_STRUCTURE_TYPE_INTERFACE_INFO;
     shader_interface.next = &target_info;
     shader_interface.bindings = root_signature->descriptor_mapping;
@@ -2713,52 +3155,18 @@ static HRESULT d3d12_pipeline_state_init_compute(struct d3d12_pipeline_state *st
 
     vk_pipeline_layout = state->uav_counters.vk_pipeline_layout
             ? state->uav_counters.vk_pipeline_layout : root_signature->vk_pipeline_layout;
-    if (FAILED(hr = vkd3d_create_compute_pipeline(device, &desc->cs, &shader_interface,
-            vk_pipeline_layout, &state->u.compute.vk_pipeline)))
+    if (FAILED(hr = vkd3d_create_compute_pipeline(device, &desc->cs, &shader_interface, vk_pipeline_layout,
+            device->use_descriptor_buffers ? VK_PIPELINE_CREATE_DESCRIPTOR_BUFFER_BIT_EXT : 0,
+            &state->u.compute.vk_pipeline)))
     {
         WARN("Failed to create Vulkan compute pipeline, hr %s.\n", debugstr_hresult(hr));
         d3d12_pipeline_uav_counter_state_cleanup(&state->uav_counters, device);
-        if (state->implicit_root_signature)
-            d3d12_root_signature_Release(state->implicit_root_signature);
-        return hr;
-    }
-
-    if (FAILED(hr = vkd3d_private_store_init(&state->private_store)))
-    {
-        VK_CALL(vkDestroyPipeline(device->vk_device, state->u.compute.vk_pipeline, NULL));
-        d3d12_pipeline_uav_counter_state_cleanup(&state->uav_counters, device);
-        if (state->implicit_root_signature)
-            d3d12_root_signature_Release(state->implicit_root_signature);
+        d3d12_root_signature_decref(root_signature);
         return hr;
     }
 
     state->vk_bind_point = VK_PIPELINE_BIND_POINT_COMPUTE;
-    d3d12_device_add_ref(state->device = device);
-
-    return S_OK;
-}
-
-HRESULT d3d12_pipeline_state_create_compute(struct d3d12_device *device,
-        const D3D12_COMPUTE_PIPELINE_STATE_DESC *desc, struct d3d12_pipeline_state **state)
-{
-    struct d3d12_pipeline_state_desc pipeline_desc;
-    struct d3d12_pipeline_state *object;
-    HRESULT hr;
-
-    pipeline_state_desc_from_d3d12_compute_desc(&pipeline_desc, desc);
-
-    if (!(object = vkd3d_malloc(sizeof(*object))))
-        return E_OUTOFMEMORY;
-
-    if (FAILED(hr = d3d12_pipeline_state_init_compute(object, device, &pipeline_desc)))
-    {
-        vkd3d_free(object);
-        return hr;
-    }
-
-    TRACE("Created compute pipeline state %p.\n", object);
-
-    *state = object;
+    state->device = device;
 
     return S_OK;
 }
@@ -3213,6 +3621,7 @@ static HRESULT d3d12_pipeline_state_init_graphics(struct d3d12_pipeline_state *s
     uint32_t instance_divisors[D3D12_VS_INPUT_REGISTER_COUNT];
     struct vkd3d_shader_spirv_target_info *stage_target_info;
     uint32_t aligned_offsets[D3D12_VS_INPUT_REGISTER_COUNT];
+    struct vkd3d_shader_buffer_address_info buffer_address_info;
     struct vkd3d_shader_descriptor_offset_info offset_info;
     struct vkd3d_shader_scan_signature_info signature_info;
     struct vkd3d_shader_parameter ps_shader_parameters[1];
@@ -3246,9 +3655,6 @@ static HRESULT d3d12_pipeline_state_init_graphics(struct d3d12_pipeline_state *s
         {VK_SHADER_STAGE_FRAGMENT_BIT,                offsetof(struct d3d12_pipeline_state_desc, ps)},
     };
 
-    state->ID3D12PipelineState_iface.lpVtbl = &d3d12_pipeline_state_vtbl;
-    state->refcount = 1;
-
     memset(&state->uav_counters, 0, sizeof(state->uav_counters));
     graphics->stage_count = 0;
 
@@ -3264,26 +3670,30 @@ static HRESULT d3d12_pipeline_state_init_graphics(struct d3d12_pipeline_state *s
         }
     }
 
-    state->implicit_root_signature = NULL;
-    if (!(root_signature = unsafe_impl_from_ID3D12RootSignature(desc->root_signature)))
+    state->root_signature = NULL;
+    if ((root_signature = unsafe_impl_from_ID3D12RootSignature(desc->root_signature)))
+    {
+        d3d12_root_signature_incref(root_signature);
+    }
+    else
     {
         TRACE("Root signature is NULL, looking for an embedded signature in the vertex shader.\n");
-        if (FAILED(hr = d3d12_root_signature_create(device,
+        if (FAILED(hr = d3d12_root_signature_get(device,
                 desc->vs.pShaderBytecode, desc->vs.BytecodeLength, &root_signature))
-                && FAILED(hr = d3d12_root_signature_create(device,
+                && FAILED(hr = d3d12_root_signature_get(device,
                 desc->ps.pShaderBytecode, desc->ps.BytecodeLength, &root_signature))
-                && FAILED(hr = d3d12_root_signature_create(device,
+                && FAILED(hr = d3d12_root_signature_get(device,
                 desc->ds.pShaderBytecode, desc->ds.BytecodeLength, &root_signature))
-                && FAILED(hr = d3d12_root_signature_create(device,
+                && FAILED(hr = d3d12_root_signature_get(device,
                 desc->hs.pShaderBytecode, desc->hs.BytecodeLength, &root_signature))
-                && FAILED(hr = d3d12_root_signature_create(device,
+                && FAILED(hr = d3d12_root_signature_get(device,
                 desc->gs.pShaderBytecode, desc->gs.BytecodeLength, &root_signature)))
         {
             WARN("Failed to find an embedded root signature, hr %s.\n", debugstr_hresult(hr));
             goto fail;
         }
-        state->implicit_root_signature = &root_signature->ID3D12RootSignature_iface;
     }
+    state->root_signature = root_signature;
 
     sample_count = vk_samples_from_dxgi_sample_desc(&desc->sample_desc);
     if (desc->sample_desc.Count != 1 && desc->sample_desc.Quality)
@@ -3493,6 +3903,13 @@ static HRESULT d3d12_pipeline_state_init_graphics(struct d3d12_pipeline_state *s
         offset_info.uav_counter_offsets = root_signature->uav_counter_offsets;
     }
 
+    if (root_signature->root_buffer_address_count)
+    {
+        buffer_address_info.type = VKD3D_SHADER_STRUCTURE_TYPE_BUFFER_ADDRESS_INFO;
+        buffer_address_info.buffers = root_signature->root_buffer_addresses;
+        buffer_address_info.buffer_count = root_signature->root_buffer_address_count;
+    }
+
     for (i = 0; i < ARRAY_SIZE(shader_stages); ++i)
     {
         const D3D12_SHADER_BYTECODE *b = (const void *)((uintptr_t)desc + shader_stages[i].offset);
@@ -3541,12 +3958,15 @@ static HRESULT d3d12_pipeline_state_init_graphics(struct d3d12_pipeline_state *s
         ps_target_info.next = NULL;
         target_info.next = NULL;
         offset_info.next = NULL;
+        buffer_address_info.next = NULL;
         signature_info.next = NULL;
         if (shader_stages[i].stage == xfb_stage)
             vkd3d_prepend_struct(&shader_interface, &xfb_info);
         vkd3d_prepend_struct(&shader_interface, stage_target_info);
         if (root_signature->descriptor_offsets)
             vkd3d_prepend_struct(&shader_interface, &offset_info);
+        if (root_signature->root_buffer_address_count)
+            vkd3d_prepend_struct(&shader_interface, &buffer_address_info);
         if (shader_stages[i].stage == VK_SHADER_STAGE_VERTEX_BIT)
             vkd3d_prepend_struct(&shader_interface, &signature_info);
 
@@ -3723,18 +4143,15 @@ static HRESULT d3d12_pipeline_state_init_graphics(struct d3d12_pipeline_state *s
 
     list_init(&graphics->compiled_pipelines);
 
-    if (FAILED(hr = vkd3d_private_store_init(&state->private_store)))
-        goto fail;
-
     vkd3d_shader_free_scan_signature_info(&signature_info);
     state->vk_bind_point = VK_PIPELINE_BIND_POINT_GRAPHICS;
-    d3d12_device_add_ref(state->device = device);
+    state->device = device;
 
     return S_OK;
 
 fail:
-    if (state->implicit_root_signature)
-        ID3D12RootSignature_Release(state->implicit_root_signature);
+    if (state->root_signature)
+        d3d12_root_signature_decref(state->root_signature);
 
     for (i = 0; i < graphics->stage_count; ++i)
     {
@@ -3747,53 +4164,211 @@ fail:
     return hr;
 }
 
-HRESULT d3d12_pipeline_state_create_graphics(struct d3d12_device *device,
-        const D3D12_GRAPHICS_PIPELINE_STATE_DESC *desc, struct d3d12_pipeline_state **state)
+static void key_buffer_put_string(struct vkd3d_shared_state_key_buffer *buffer, const char *string)
 {
-    struct d3d12_pipeline_state_desc pipeline_desc;
-    struct d3d12_pipeline_state *object;
-    HRESULT hr;
+    key_buffer_put(buffer, string ? string : "", string ? strlen(string) + 1 : 1);
+}
 
-    pipeline_state_desc_from_d3d12_graphics_desc(&pipeline_desc, desc);
+static void key_buffer_put_bytecode(struct vkd3d_shared_state_key_buffer *buffer,
+        const D3D12_SHADER_BYTECODE *code)
+{
+    size_t size = code->pShaderBytecode ? code->BytecodeLength : 0;
 
-    if (!(object = vkd3d_malloc(sizeof(*object))))
-        return E_OUTOFMEMORY;
+    key_buffer_put(buffer, &size, sizeof(size));
+    key_buffer_put(buffer, code->pShaderBytecode, size);
+}
 
-    if (FAILED(hr = d3d12_pipeline_state_init_graphics(object, device, &pipeline_desc)))
+static void key_buffer_put_stencil_op(struct vkd3d_shared_state_key_buffer *buffer,
+        const D3D12_DEPTH_STENCILOP_DESC *desc)
+{
+    key_buffer_put_u32(buffer, desc->StencilFailOp);
+    key_buffer_put_u32(buffer, desc->StencilDepthFailOp);
+    key_buffer_put_u32(buffer, desc->StencilPassOp);
+    key_buffer_put_u32(buffer, desc->StencilFunc);
+}
+
+/* Structures are written member by member, so padding never reaches the key.
+ * The cached PSO blob is not part of the key. */
+static HRESULT d3d12_pipeline_state_key_init(struct vkd3d_shared_state_key *key,
+        const struct d3d12_pipeline_state_desc *desc, VkPipelineBindPoint bind_point)
+{
+    const D3D12_DEPTH_STENCIL_DESC1 *ds_state = &desc->depth_stencil_state;
+    const D3D12_STREAM_OUTPUT_DESC *so_desc = &desc->stream_output;
+    const D3D12_RASTERIZER_DESC *rs_state = &desc->rasterizer_state;
+    const D3D12_INPUT_LAYOUT_DESC *il_desc = &desc->input_layout;
+    const D3D12_BLEND_DESC *blend_state = &desc->blend_state;
+    struct vkd3d_shared_state_key_buffer buffer = {0};
+    const struct d3d12_root_signature *root_signature;
+    uintptr_t root_signature_id;
+    unsigned int i;
+
+    /* Root signatures are themselves shared, and pipeline states hold a
+     * reference to theirs, so the address identifies the root signature. */
+    root_signature = unsafe_impl_from_ID3D12RootSignature(desc->root_signature);
+    root_signature_id = (uintptr_t)root_signature;
+    key_buffer_put(&buffer, &root_signature_id, sizeof(root_signature_id));
+    key_buffer_put_u32(&buffer, bind_point);
+
+    key_buffer_put_bytecode(&buffer, &desc->cs);
+    if (bind_point == VK_PIPELINE_BIND_POINT_GRAPHICS)
     {
-        vkd3d_free(object);
-        return hr;
+        key_buffer_put_bytecode(&buffer, &desc->vs);
+        key_buffer_put_bytecode(&buffer, &desc->ps);
+        key_buffer_put_bytecode(&buffer, &desc->ds);
+        key_buffer_put_bytecode(&buffer, &desc->hs);
+        key_buffer_put_bytecode(&buffer, &desc->gs);
+
+        key_buffer_put_u32(&buffer, so_desc->NumEntries);
+        for (i = 0; so_desc->pSODeclaration && i < so_desc->NumEntries; ++i)
+        {
+            const D3D12_SO_DECLARATION_ENTRY *e = &so_desc->pSODeclaration[i];
+
+            key_buffer_put_u32(&buffer, e->Stream);
+            key_buffer_put_string(&buffer, e->SemanticName);
+            key_buffer_put_u32(&buffer, e->SemanticIndex);
+            key_buffer_put_u32(&buffer, e->StartComponent);
+            key_buffer_put_u32(&buffer, e->ComponentCount);
+            key_buffer_put_u32(&buffer, e->OutputSlot);
+        }
+        key_buffer_put_u32(&buffer, so_desc->NumStrides);
+        if (so_desc->pBufferStrides)
+            key_buffer_put(&buffer, so_desc->pBufferStrides, so_desc->NumStrides * sizeof(*so_desc->pBufferStrides));
+        key_buffer_put_u32(&buffer, so_desc->RasterizedStream);
+
+        key_buffer_put_u32(&buffer, blend_state->AlphaToCoverageEnable);
+        key_buffer_put_u32(&buffer, blend_state->IndependentBlendEnable);
+        for (i = 0; i < ARRAY_SIZE(blend_state->RenderTarget); ++i)
+        {
+            const D3D12_RENDER_TARGET_BLEND_DESC *rt = &blend_state->RenderTarget[i];
+
+            key_buffer_put_u32(&buffer, rt->BlendEnable);
+            key_buffer_put_u32(&buffer, rt->LogicOpEnable);
+            key_buffer_put_u32(&buffer, rt->SrcBlend);
+            key_buffer_put_u32(&buffer, rt->DestBlend);
+            key_buffer_put_u32(&buffer, rt->BlendOp);
+            key_buffer_put_u32(&buffer, rt->SrcBlendAlpha);
+            key_buffer_put_u32(&buffer, rt->DestBlendAlpha);
+            key_buffer_put_u32(&buffer, rt->BlendOpAlpha);
+            key_buffer_put_u32(&buffer, rt->LogicOp);
+            key_buffer_put_u32(&buffer, rt->RenderTargetWriteMask);
+        }
+        key_buffer_put_u32(&buffer, desc->sample_mask);
+
+        key_buffer_put_u32(&buffer, rs_state->FillMode);
+        key_buffer_put_u32(&buffer, rs_state->CullMode);
+        key_buffer_put_u32(&buffer, rs_state->FrontCounterClockwise);
+        key_buffer_put_u32(&buffer, rs_state->DepthBias);
+        key_buffer_put(&buffer, &rs_state->DepthBiasClamp, sizeof(rs_state->DepthBiasClamp));
+        key_buffer_put(&buffer, &rs_state->SlopeScaledDepthBias, sizeof(rs_state->SlopeScaledDepthBias));
+        key_buffer_put_u32(&buffer, rs_state->DepthClipEnable);
+        key_buffer_put_u32(&buffer, rs_state->MultisampleEnable);
+        key_buffer_put_u32(&buffer, rs_state->AntialiasedLineEnable);
+        key_buffer_put_u32(&buffer, rs_state->ForcedSampleCount);
+        key_buffer_put_u32(&buffer, rs_state->ConservativeRaster);
+
+        key_buffer_put_u32(&buffer, ds_state->DepthEnable);
+        key_buffer_put_u32(&buffer, ds_state->DepthWriteMask);
+        key_buffer_put_u32(&buffer, ds_state->DepthFunc);
+        key_buffer_put_u32(&buffer, ds_state->StencilEnable);
+        key_buffer_put_u32(&buffer, ds_state->StencilReadMask);
+        key_buffer_put_u32(&buffer, ds_state->StencilWriteMask);
+        key_buffer_put_stencil_op(&buffer, &ds_state->FrontFace);
+        key_buffer_put_stencil_op(&buffer, &ds_state->BackFace);
+        key_buffer_put_u32(&buffer, ds_state->DepthBoundsTestEnable);
+
+        key_buffer_put_u32(&buffer, il_desc->NumElements);
+        for (i = 0; il_desc->pInputElementDescs && i < il_desc->NumElements; ++i)
+        {
+            const D3D12_INPUT_ELEMENT_DESC *e = &il_desc->pInputElementDescs[i];
+
+            key_buffer_put_string(&buffer, e->SemanticName);
+            key_buffer_put_u32(&buffer, e->SemanticIndex);
+            key_buffer_put_u32(&buffer, e->Format);
+            key_buffer_put_u32(&buffer, e->InputSlot);
+            key_buffer_put_u32(&buffer, e->AlignedByteOffset);
+            key_buffer_put_u32(&buffer, e->InputSlotClass);
+            key_buffer_put_u32(&buffer, e->InstanceDataStepRate);
+        }
+
+        key_buffer_put_u32(&buffer, desc->strip_cut_value);
+        key_buffer_put_u32(&buffer, desc->primitive_topology_type);
+        key_buffer_put_u32(&buffer, desc->rtv_formats.NumRenderTargets);
+        for (i = 0; i < ARRAY_SIZE(desc->rtv_formats.RTFormats); ++i)
+            key_buffer_put_u32(&buffer, desc->rtv_formats.RTFormats[i]);
+        key_buffer_put_u32(&buffer, desc->dsv_format);
+        key_buffer_put_u32(&buffer, desc->sample_desc.Count);
+        key_buffer_put_u32(&buffer, desc->sample_desc.Quality);
+
+        key_buffer_put_u32(&buffer, desc->view_instancing_desc.ViewInstanceCount);
+        for (i = 0; desc->view_instancing_desc.pViewInstanceLocations
+                && i < desc->view_instancing_desc.ViewInstanceCount; ++i)
+        {
+            key_buffer_put_u32(&buffer, desc->view_instancing_desc.pViewInstanceLocations[i].ViewportArrayIndex);
+            key_buffer_put_u32(&buffer, desc->view_instancing_desc.pViewInstanceLocations[i].RenderTargetArrayIndex);
+        }
+        key_buffer_put_u32(&buffer, desc->view_instancing_desc.Flags);
     }
 
-    TRACE("Created graphics pipeline state %p.\n", object);
+    key_buffer_put_u32(&buffer, desc->node_mask);
+    key_buffer_put_u32(&buffer, desc->flags);
 
-    *state = object;
+    if (buffer.failed)
+    {
+        vkd3d_free(buffer.data);
+        return E_OUTOFMEMORY;
+    }
+
+    key->hash = vkd3d_shared_state_hash(buffer.data, buffer.size);
+    key->data = buffer.data;
+    key->size = buffer.size;
 
     return S_OK;
 }
 
-HRESULT d3d12_pipeline_state_create(struct d3d12_device *device,
-        const D3D12_PIPELINE_STATE_STREAM_DESC *desc, struct d3d12_pipeline_state **state)
+static HRESULT d3d12_pipeline_state_get(struct d3d12_device *device,
+        const struct d3d12_pipeline_state_desc *desc, VkPipelineBindPoint bind_point,
+        struct d3d12_pipeline_state **state)
 {
-    struct d3d12_pipeline_state_desc pipeline_desc;
+    struct vkd3d_shared_state_cache *cache = &device->shared_state_cache;
     struct d3d12_pipeline_state *object;
-    VkPipelineBindPoint bind_point;
+    struct vkd3d_shared_state_key key;
+    struct rb_entry *entry;
+    uint64_t start_time;
     HRESULT hr;
 
-    if (FAILED(hr = pipeline_state_desc_from_d3d12_stream_desc(&pipeline_desc, desc, &bind_point)))
+    if (FAILED(hr = d3d12_pipeline_state_key_init(&key, desc, bind_point)))
         return hr;
 
+    vkd3d_mutex_lock(&cache->mutex);
+    if ((entry = rb_get(&cache->pipeline_states, &key)))
+    {
+        object = RB_ENTRY_VALUE(entry, struct d3d12_pipeline_state, entry);
+        ++object->refcount;
+        vkd3d_mutex_unlock(&cache->mutex);
+        vkd3d_free((void *)key.data);
+        d3d12_device_add_statistic(device, pipeline_state_reuse_count, 1);
+        TRACE("Reusing pipeline state %p.\n", object);
+        *state = object;
+        return S_OK;
+    }
+    vkd3d_mutex_unlock(&cache->mutex);
+
     if (!(object = vkd3d_calloc(1, sizeof(*object))))
+    {
+        vkd3d_free((void *)key.data);
         return E_OUTOFMEMORY;
+    }
+
+    start_time = vkd3d_get_monotonic_time_ns();
 
     switch (bind_point)
     {
         case VK_PIPELINE_BIND_POINT_COMPUTE:
-            hr = d3d12_pipeline_state_init_compute(object, device, &pipeline_desc);
+            hr = d3d12_pipeline_state_init_compute(object, device, desc);
             break;
 
         case VK_PIPELINE_BIND_POINT_GRAPHICS:
-            hr = d3d12_pipeline_state_init_graphics(object, device, &pipeline_desc);
+            hr = d3d12_pipeline_state_init_graphics(object, device, desc);
             break;
 
         default:
@@ -3802,16 +4377,111 @@ HRESULT d3d12_pipeline_state_create(struct d3d12_device *device,
 
     if (FAILED(hr))
     {
+        vkd3d_free((void *)key.data);
         vkd3d_free(object);
         return hr;
     }
 
+    d3d12_device_add_statistic(device, pipeline_state_time, vkd3d_get_monotonic_time_ns() - start_time);
+    if (vkd3d_trace_enabled)
+        vkd3d_trace_span_end("Create pipeline state", start_time);
+
+    object->refcount = 1;
+    object->key = key;
+
+    vkd3d_mutex_lock(&cache->mutex);
+    /* Another thread may have created the same pipeline state meanwhile. */
+    if ((entry = rb_get(&cache->pipeline_states, &key)))
+    {
+        struct d3d12_pipeline_state *existing = RB_ENTRY_VALUE(entry, struct d3d12_pipeline_state, entry);
+
+        ++existing->refcount;
+        vkd3d_mutex_unlock(&cache->mutex);
+        d3d12_pipeline_state_destroy(object);
+        d3d12_device_add_statistic(device, pipeline_state_reuse_count, 1);
+        *state = existing;
+        return S_OK;
+    }
+    rb_put(&cache->pipeline_states, &object->key, &object->entry);
+    vkd3d_mutex_unlock(&cache->mutex);
+
+    d3d12_device_add_statistic(device, pipeline_state_count, 1);
+
     TRACE("Created pipeline state %p.\n", object);
 
     *state = object;
+
+    return S_OK;
+}
+
+static HRESULT d3d12_pipeline_state_object_create(struct d3d12_device *device,
+        const struct d3d12_pipeline_state_desc *desc, VkPipelineBindPoint bind_point,
+        struct d3d12_pipeline_state_object **state)
+{
+    struct d3d12_pipeline_state_object *object;
+    HRESULT hr;
+
+    if (!(object = vkd3d_malloc(sizeof(*object))))
+        return E_OUTOFMEMORY;
+
+    object->ID3D12PipelineState_iface.lpVtbl = &d3d12_pipeline_state_vtbl;
+    object->refcount = 1;
+
+    if (FAILED(hr = d3d12_pipeline_state_get(device, desc, bind_point, &object->state)))
+    {
+        vkd3d_free(object);
+        return hr;
+    }
+
+    if (FAILED(hr = vkd3d_private_store_init(&object->private_store)))
+    {
+        d3d12_pipeline_state_decref(object->state);
+        vkd3d_free(object);
+        return hr;
+    }
+
+    d3d12_device_add_ref(object->device = device);
+
+    TRACE("Created pipeline state object %p, pipeline state %p.\n", object, object->state);
+
+    *state = object;
+
     return S_OK;
 }
 
+HRESULT d3d12_pipeline_state_create_compute(struct d3d12_device *device,
+        const D3D12_COMPUTE_PIPELINE_STATE_DESC *desc, struct d3d12_pipeline_state_object **state)
+{
+    struct d3d12_pipeline_state_desc pipeline_desc;
+
+    pipeline_state_desc_from_d3d12_compute_desc(&pipeline_desc, desc);
+
+    return d3d12_pipeline_state_object_create(device, &pipeline_desc, VK_PIPELINE_BIND_POINT_COMPUTE, state);
+}
+
+HRESULT d3d12_pipeline_state_create_graphics(struct d3d12_device *device,
+        const D3D12_GRAPHICS_PIPELINE_STATE_DESC *desc, struct d3d12_pipeline_state_object **state)
+{
+    struct d3d12_pipeline_state_desc pipeline_desc;
+
+    pipeline_state_desc_from_d3d12_graphics_desc(&pipeline_desc, desc);
+
+    return d3d12_pipeline_state_object_create(device, &pipeline_desc, VK_PIPELINE_BIND_POINT_GRAPHICS, state);
+}
+
+HRESULT d3d12_pipeline_state_create(struct d3d12_device *device,
+        const D3D12_PIPELINE_STATE_STREAM_DESC *desc, struct d3d12_pipeline_state_object **state)
+{
+    struct d3d12_pipeline_state_desc pipeline_desc;
+    VkPipelineBindPoint bind_point;
+    HRESULT hr;
+
+    if (FAILED(hr = pipeline_state_desc_from_d3d12_stream_desc(&pipeline_desc, desc, &bind_point)))
+        return hr;
+
+    return d3d12_pipeline_state_object_create(device, &pipeline_desc, bind_point, state);
+}
+
 static enum VkPrimitiveTopology vk_topology_from_d3d12_topology(D3D12_PRIMITIVE_TOPOLOGY topology)
 {
     switch (topology)
@@ -3961,6 +4631,7 @@ VkPipeline d3d12_pipeline_state_get_or_create_pipeline(struct d3d12_pipeline_sta
     struct vkd3d_pipeline_key pipeline_key;
     size_t binding_count = 0;
     VkPipeline vk_pipeline;
+    uint64_t start_time;
     unsigned int i;
     uint32_t mask;
     VkResult vr;
@@ -4079,7 +4750,7 @@ VkPipeline d3d12_pipeline_state_get_or_create_pipeline(struct d3d12_pipeline_sta
 
     pipeline_desc.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
     pipeline_desc.pNext = NULL;
-    pipeline_desc.flags = 0;
+    pipeline_desc.flags = device->use_descriptor_buffers ? VK_PIPELINE_CREATE_DESCRIPTOR_BUFFER_BIT_EXT : 0;
     pipeline_desc.stageCount = graphics->stage_count;
     pipeline_desc.pStages = graphics->stages;
     pipeline_desc.pVertexInputState = &input_desc;
@@ -4110,12 +4781,18 @@ VkPipeline d3d12_pipeline_state_get_or_create_pipeline(struct d3d12_pipeline_sta
 
     *vk_render_pass = pipeline_desc.renderPass;
 
-    if ((vr = VK_CALL(vkCreateGraphicsPipelines(device->vk_device, device->vk_pipeline_cache,
-            1, &pipeline_desc, NULL, &vk_pipeline))) < 0)
+    start_time = vkd3d_get_monotonic_time_ns();
+    vr = VK_CALL(vkCreateGraphicsPipelines(device->vk_device, device->vk_pipeline_cache,
+            1, &pipeline_desc, NULL, &vk_pipeline));
+    d3d12_device_add_statistic(device, vk_pipeline_time, vkd3d_get_monotonic_time_ns() - start_time);
+    if (vkd3d_trace_enabled)
+        vkd3d_trace_span_end("Create pipeline variant", start_time);
+    if (vr < 0)
     {
         WARN("Failed to create Vulkan graphics pipeline, vr %d.\n", vr);
         return VK_NULL_HANDLE;
     }
+    d3d12_device_add_statistic(device, vk_pipeline_count, 1);
 
     if (d3d12_pipeline_state_put_pipeline_to_cache(state, &pipeline_key, vk_pipeline, pipeline_desc.renderPass))
         return vk_pipeline;
@@ -4162,13 +4839,10 @@ static void vkd3d_uav_clear_pipelines_cleanup(struct vkd3d_uav_clear_pipelines *
         struct d3d12_device *device)
 {
     const struct vkd3d_vk_device_procs *vk_procs = &device->vk_procs;
+    unsigned int i;
 
-    VK_CALL(vkDestroyPipeline(device->vk_device, pipelines->image_3d, NULL));
-    VK_CALL(vkDestroyPipeline(device->vk_device, pipelines->image_2d_array, NULL));
-    VK_CALL(vkDestroyPipeline(device->vk_device, pipelines->image_2d, NULL));
-    VK_CALL(vkDestroyPipeline(device->vk_device, pipelines->image_1d_array, NULL));
-    VK_CALL(vkDestroyPipeline(device->vk_device, pipelines->image_1d, NULL));
-    VK_CALL(vkDestroyPipeline(device->vk_device, pipelines->buffer, NULL));
+    for (i = 0; i < ARRAY_SIZE(pipelines->vk_pipelines); ++i)
+        VK_CALL(vkDestroyPipeline(device->vk_device, pipelines->vk_pipelines[i], NULL));
 }
 
 void vkd3d_uav_clear_state_cleanup(struct vkd3d_uav_clear_state *state, struct d3d12_device *device)
@@ -4183,13 +4857,19 @@ void vkd3d_uav_clear_state_cleanup(struct vkd3d_uav_clear_state *state, struct d
 
     VK_CALL(vkDestroyDescriptorSetLayout(device->vk_device, state->vk_set_layout_image, NULL));
     VK_CALL(vkDestroyDescriptorSetLayout(device->vk_device, state->vk_set_layout_buffer, NULL));
+
+    vkd3d_mutex_destroy(&state->mutex);
 }
 
-HRESULT vkd3d_uav_clear_state_init(struct vkd3d_uav_clear_state *state, struct d3d12_device *device)
+void vkd3d_uav_clear_state_init(struct vkd3d_uav_clear_state *state)
 {
-    struct vkd3d_shader_push_constant_buffer push_constant;
-    struct vkd3d_shader_interface_info shader_interface;
-    struct vkd3d_shader_resource_binding binding;
+    memset(state, 0, sizeof(*state));
+    vkd3d_mutex_init(&state->mutex);
+}
+
+static HRESULT vkd3d_uav_clear_state_init_layouts(struct vkd3d_uav_clear_state *state, struct d3d12_device *device)
+{
+    const struct vkd3d_vk_device_procs *vk_procs = &device->vk_procs;
     VkDescriptorSetLayoutBinding set_binding;
     VkPushConstantRange push_constant_range;
     unsigned int i;
@@ -4207,68 +4887,15 @@ HRESULT vkd3d_uav_clear_state_init(struct vkd3d_uav_clear_state *state, struct d
         {&state->vk_set_layout_image,  &state->vk_pipeline_layout_image, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE},
     };
 
-    const struct
-    {
-        VkPipeline *pipeline;
-        VkPipelineLayout *pipeline_layout;
-        struct vkd3d_shader_code code;
-    }
-    pipelines[] =
-    {
-#define SHADER_CODE(name) {name, sizeof(name)}
-        {&state->pipelines_float.buffer, &state->vk_pipeline_layout_buffer,
-                SHADER_CODE(cs_uav_clear_buffer_float_code)},
-        {&state->pipelines_float.image_1d, &state->vk_pipeline_layout_image,
-                SHADER_CODE(cs_uav_clear_1d_float_code)},
-        {&state->pipelines_float.image_1d_array, &state->vk_pipeline_layout_image,
-                SHADER_CODE(cs_uav_clear_1d_array_float_code)},
-        {&state->pipelines_float.image_2d, &state->vk_pipeline_layout_image,
-                SHADER_CODE(cs_uav_clear_2d_float_code)},
-        {&state->pipelines_float.image_2d_array, &state->vk_pipeline_layout_image,
-                SHADER_CODE(cs_uav_clear_2d_array_float_code)},
-        {&state->pipelines_float.image_3d, &state->vk_pipeline_layout_image,
-                SHADER_CODE(cs_uav_clear_3d_float_code)},
-
-        {&state->pipelines_uint.buffer, &state->vk_pipeline_layout_buffer,
-                SHADER_CODE(cs_uav_clear_buffer_uint_code)},
-        {&state->pipelines_uint.image_1d, &state->vk_pipeline_layout_image,
-                SHADER_CODE(cs_uav_clear_1d_uint_code)},
-        {&state->pipelines_uint.image_1d_array, &state->vk_pipeline_layout_image,
-                SHADER_CODE(cs_uav_clear_1d_array_uint_code)},
-        {&state->pipelines_uint.image_2d, &state->vk_pipeline_layout_image,
-                SHADER_CODE(cs_uav_clear_2d_uint_code)},
-        {&state->pipelines_uint.image_2d_array, &state->vk_pipeline_layout_image,
-                SHADER_CODE(cs_uav_clear_2d_array_uint_code)},
-        {&state->pipelines_uint.image_3d, &state->vk_pipeline_layout_image,
-                SHADER_CODE(cs_uav_clear_3d_uint_code)},
-#undef SHADER_CODE
-    };
-
-    memset(state, 0, sizeof(*state));
-
     set_binding.binding = 0;
     set_binding.descriptorCount = 1;
     set_binding.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
     set_binding.pImmutableSamplers = NULL;
 
-    binding.type = VKD3D_SHADER_DESCRIPTOR_TYPE_UAV;
-    binding.register_space = 0;
-    binding.register_index = 0;
-    binding.shader_visibility = VKD3D_SHADER_VISIBILITY_COMPUTE;
-    binding.binding.set = 0;
-    binding.binding.binding = 0;
-    binding.binding.count = 1;
-
     push_constant_range.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
     push_constant_range.offset = 0;
     push_constant_range.size = sizeof(struct vkd3d_uav_clear_args);
 
-    push_constant.register_space = 0;
-    push_constant.register_index = 0;
-    push_constant.shader_visibility = VKD3D_SHADER_VISIBILITY_COMPUTE;
-    push_constant.offset = 0;
-    push_constant.size = sizeof(struct vkd3d_uav_clear_args);
-
     for (i = 0; i < ARRAY_SIZE(set_layouts); ++i)
     {
         set_binding.descriptorType = set_layouts[i].descriptor_type;
@@ -4288,6 +4915,88 @@ HRESULT vkd3d_uav_clear_state_init(struct vkd3d_uav_clear_state *state, struct d
         }
     }
 
+    return S_OK;
+
+fail:
+    for (i = 0; i < ARRAY_SIZE(set_layouts); ++i)
+    {
+        VK_CALL(vkDestroyPipelineLayout(device->vk_device, *set_layouts[i].pipeline_layout, NULL));
+        VK_CALL(vkDestroyDescriptorSetLayout(device->vk_device, *set_layouts[i].set_layout, NULL));
+        *set_layouts[i].pipeline_layout = VK_NULL_HANDLE;
+        *set_layouts[i].set_layout = VK_NULL_HANDLE;
+    }
+    return hr;
+}
+
+static HRESULT vkd3d_uav_clear_state_create_pipeline(struct vkd3d_uav_clear_state *state,
+        struct d3d12_device *device, struct vkd3d_uav_clear_pipelines *pipelines,
+        enum vkd3d_uav_clear_pipeline_type type)
+{
+    struct vkd3d_shader_push_constant_buffer push_constant;
+    struct vkd3d_shader_interface_info shader_interface;
+    struct vkd3d_shader_resource_binding binding;
+    const struct vkd3d_shader_code *code;
+    VkPipelineLayout vk_pipeline_layout;
+    struct vkd3d_shader_code dxbc;
+    HRESULT hr;
+    int ret;
+
+#define SHADER_CODE(name) {name, sizeof(name)}
+    static const struct vkd3d_shader_code float_code[] =
+    {
+        SHADER_CODE(cs_uav_clear_buffer_float_code),
+        SHADER_CODE(cs_uav_clear_1d_float_code),
+        SHADER_CODE(cs_uav_clear_1d_array_float_code),
+        SHADER_CODE(cs_uav_clear_2d_float_code),
+        SHADER_CODE(cs_uav_clear_2d_array_float_code),
+        SHADER_CODE(cs_uav_clear_3d_float_code),
+    };
+    static const struct vkd3d_shader_code uint_code[] =
+    {
+        SHADER_CODE(cs_uav_clear_buffer_uint_code),
+        SHADER_CODE(cs_uav_clear_1d_uint_code),
+        SHADER_CODE(cs_uav_clear_1d_array_uint_code),
+        SHADER_CODE(cs_uav_clear_2d_uint_code),
+        SHADER_CODE(cs_uav_clear_2d_array_uint_code),
+        SHADER_CODE(cs_uav_clear_3d_uint_code),
+    };
+#undef SHADER_CODE
+
+    STATIC_ASSERT(ARRAY_SIZE(float_code) == VKD3D_UAV_CLEAR_PIPELINE_COUNT);
+    STATIC_ASSERT(ARRAY_SIZE(uint_code) == VKD3D_UAV_CLEAR_PIPELINE_COUNT);
+
+    if (type >= VKD3D_UAV_CLEAR_PIPELINE_COUNT)
+    {
+        ERR("Invalid UAV clear pipeline type %#x.\n", type);
+        return E_INVALIDARG;
+    }
+
+    code = pipelines == &state->pipelines_uint ? &uint_code[type] : &float_code[type];
+
+    binding.type = VKD3D_SHADER_DESCRIPTOR_TYPE_UAV;
+    binding.register_space = 0;
+    binding.register_index = 0;
+    binding.shader_visibility = VKD3D_SHADER_VISIBILITY_COMPUTE;
+    binding.binding.set = 0;
+    binding.binding.binding = 0;
+    binding.binding.count = 1;
+    if (type == VKD3D_UAV_CLEAR_PIPELINE_BUFFER)
+    {
+        binding.flags = VKD3D_SHADER_BINDING_FLAG_BUFFER;
+        vk_pipeline_layout = state->vk_pipeline_layout_buffer;
+    }
+    else
+    {
+        binding.flags = VKD3D_SHADER_BINDING_FLAG_IMAGE;
+        vk_pipeline_layout = state->vk_pipeline_layout_image;
+    }
+
+    push_constant.register_space = 0;
+    push_constant.register_index = 0;
+    push_constant.shader_visibility = VKD3D_SHADER_VISIBILITY_COMPUTE;
+    push_constant.offset = 0;
+    push_constant.size = sizeof(struct vkd3d_uav_clear_args);
+
     shader_interface.type = VKD3D_SHADER_STRUCTURE_TYPE_INTERFACE_INFO;
     shader_interface.next = NULL;
     shader_interface.bindings = &binding;
@@ -4299,36 +5008,42 @@ HRESULT vkd3d_uav_clear_state_init(struct vkd3d_uav_clear_state *state, struct d
     shader_interface.uav_counters = NULL;
     shader_interface.uav_counter_count = 0;
 
-    for (i = 0; i < ARRAY_SIZE(pipelines); ++i)
+    if ((ret = compile_hlsl_cs(code, &dxbc)))
     {
-        struct vkd3d_shader_code dxbc;
-        int ret;
+        ERR("Failed to compile HLSL compute shader %#x, ret %d.\n", type, ret);
+        return hresult_from_vk_result(ret);
+    }
 
-        if ((ret = compile_hlsl_cs(&pipelines[i].code, &dxbc)))
-        {
-            ERR("Failed to compile HLSL compute shader %u, ret %d.\n", i, ret);
-            hr = hresult_from_vk_result(ret);
-            goto fail;
-        }
+    hr = vkd3d_create_compute_pipeline(device, &(D3D12_SHADER_BYTECODE){dxbc.code, dxbc.size},
+            &shader_interface, vk_pipeline_layout, 0, &pipelines->vk_pipelines[type]);
+    vkd3d_shader_free_shader_code(&dxbc);
+    if (FAILED(hr))
+        ERR("Failed to create compute pipeline %#x, hr %s.\n", type, debugstr_hresult(hr));
 
-        if (pipelines[i].pipeline_layout == &state->vk_pipeline_layout_buffer)
-            binding.flags = VKD3D_SHADER_BINDING_FLAG_BUFFER;
-        else
-            binding.flags = VKD3D_SHADER_BINDING_FLAG_IMAGE;
+    return hr;
+}
 
-        hr = vkd3d_create_compute_pipeline(device, &(D3D12_SHADER_BYTECODE){dxbc.code, dxbc.size},
-                &shader_interface, *pipelines[i].pipeline_layout, pipelines[i].pipeline);
-        vkd3d_shader_free_shader_code(&dxbc);
-        if (FAILED(hr))
-        {
-            ERR("Failed to create compute pipeline %u, hr %s.\n", i, debugstr_hresult(hr));
-            goto fail;
-        }
-    }
+/* On success, pipelines->vk_pipelines[type] and the layouts in "state" may be
+ * used without holding the mutex. */
+HRESULT vkd3d_uav_clear_state_get_pipeline(struct vkd3d_uav_clear_state *state, struct d3d12_device *device,
+        struct vkd3d_uav_clear_pipelines *pipelines, enum vkd3d_uav_clear_pipeline_type type)
+{
+    uint32_t mask = 1u << type;
+    HRESULT hr = S_OK;
 
-    return S_OK;
+    if (vkd3d_atomic_load_u32_acquire(&pipelines->created_mask) & mask)
+        return S_OK;
+
+    vkd3d_mutex_lock(&state->mutex);
+
+    if (!state->vk_pipeline_layout_image)
+        hr = vkd3d_uav_clear_state_init_layouts(state, device);
+
+    if (SUCCEEDED(hr) && !(pipelines->created_mask & mask)
+            && SUCCEEDED(hr = vkd3d_uav_clear_state_create_pipeline(state, device, pipelines, type)))
+        vkd3d_atomic_store_u32_release(&pipelines->created_mask, pipelines->created_mask | mask);
+
+    vkd3d_mutex_unlock(&state->mutex);
 
-fail:
-    vkd3d_uav_clear_state_cleanup(state, device);
     return hr;
 }
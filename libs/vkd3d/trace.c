@@ -0,0 +1,326 @@
+/*
+ * Timeline tracing, written out in the Chrome trace event format
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301, USA
+ */
+
+#include "vkd3d_private.h"
+
+#include <errno.h>
+#include <stdio.h>
+#include <unistd.h>
+
+/* Each thread records into its own ring buffer, so recording an event takes
+ * no locks. Only the most recent events of each thread are written out. */
+#define VKD3D_TRACE_THREAD_COUNT 64u
+#define VKD3D_TRACE_EVENT_COUNT 8192u
+#define VKD3D_TRACE_LABEL_SIZE 48u
+
+struct vkd3d_trace_event
+{
+    /* Either a static name, or NULL for events with a label. */
+    const char *name;
+    char label[VKD3D_TRACE_LABEL_SIZE];
+    uint64_t timestamp;
+    uint64_t duration;
+    char phase;
+};
+
+struct vkd3d_trace_thread
+{
+    uint64_t thread_id;
+    uint32_t event_count;
+    /* Events before this one were written out by a previous flush. */
+    uint32_t flushed_count;
+    struct vkd3d_trace_event events[VKD3D_TRACE_EVENT_COUNT];
+};
+
+static struct vkd3d_trace_thread *vkd3d_trace_threads[VKD3D_TRACE_THREAD_COUNT];
+static uint32_t vkd3d_trace_initialised;
+static uint32_t vkd3d_trace_instance_count;
+static uint32_t vkd3d_trace_flush_count;
+static const char *vkd3d_trace_file;
+bool vkd3d_trace_enabled;
+
+static uint64_t vkd3d_trace_get_thread_id(void)
+{
+#ifdef _WIN32
+    return GetCurrentThreadId();
+#elif HAVE_GETTID
+    return gettid();
+#elif HAVE_PTHREAD_THREADID_NP
+    uint64_t thread_id;
+
+    pthread_threadid_np(NULL, &thread_id);
+    return thread_id;
+#else
+    return 0;
+#endif
+}
+
+/* Called for each instance created. */
+void vkd3d_trace_init(void)
+{
+    const char *file;
+
+    vkd3d_atomic_increment_u32(&vkd3d_trace_instance_count);
+
+    if (!vkd3d_atomic_compare_exchange_u32(&vkd3d_trace_initialised, 0, 1))
+        return;
+
+    if (!(file = getenv("VKD3D_TRACE_FILE")) || !*file)
+        return;
+
+    if (!vkd3d_trace_get_thread_id())
+    {
+        FIXME("Thread IDs are not available, ignoring VKD3D_TRACE_FILE.\n");
+        return;
+    }
+
+    TRACE("Recording timeline for \"%s\".\n", file);
+    vkd3d_trace_file = file;
+    vkd3d_trace_enabled = true;
+}
+
+static struct vkd3d_trace_thread *vkd3d_trace_get_thread(void)
+{
+    struct vkd3d_trace_thread *thread, *object;
+    uint64_t thread_id;
+    unsigned int i, j;
+
+    thread_id = vkd3d_trace_get_thread_id();
+
+    for (i = 0; i < VKD3D_TRACE_THREAD_COUNT; ++i)
+    {
+        j = (thread_id + i) % VKD3D_TRACE_THREAD_COUNT;
+        if ((thread = vkd3d_trace_threads[j]))
+        {
+            if (thread->thread_id == thread_id)
+                return thread;
+            continue;
+        }
+
+        if (!(object = vkd3d_malloc(sizeof(*object))))
+            return NULL;
+        object->thread_id = thread_id;
+        object->event_count = 0;
+        object->flushed_count = 0;
+
+        if (vkd3d_atomic_compare_exchange_ptr((void * volatile *)&vkd3d_trace_threads[j], NULL, object))
+            return object;
+
+        /* Another thread claimed the slot. */
+        vkd3d_free(object);
+        if (vkd3d_trace_threads[j]->thread_id == thread_id)
+            return vkd3d_trace_threads[j];
+    }
+
+    return NULL;
+}
+
+static struct vkd3d_trace_event *vkd3d_trace_add_event(char phase, uint64_t timestamp)
+{
+    struct vkd3d_trace_thread *thread;
+    struct vkd3d_trace_event *event;
+
+    if (!(thread = vkd3d_trace_get_thread()))
+        return NULL;
+
+    event = &thread->events[thread->event_count % VKD3D_TRACE_EVENT_COUNT];
+    event->name = NULL;
+    event->label[0] = '\0';
+    event->timestamp = timestamp;
+    event->duration = 0;
+    event->phase = phase;
+    vkd3d_atomic_increment_u32(&thread->event_count);
+
+    return event;
+}
+
+void vkd3d_trace_span_end(const char *name, uint64_t start_time)
+{
+    struct vkd3d_trace_event *event;
+    uint64_t end_time;
+
+    if (!start_time)
+        return;
+
+    end_time = vkd3d_get_monotonic_time_ns();
+    if ((event = vkd3d_trace_add_event('X', start_time)))
+    {
+        event->name = name;
+        event->duration = end_time - start_time;
+    }
+}
+
+static void vkd3d_trace_set_label(struct vkd3d_trace_event *event, const char *label)
+{
+    size_t length = strlen(label);
+
+    if (length >= sizeof(event->label))
+    {
+        /* Don't split a UTF-8 sequence. */
+        length = sizeof(event->label) - 1;
+        while (length && (label[length] & 0xc0) == 0x80)
+            --length;
+    }
+    memcpy(event->label, label, length);
+    event->label[length] = '\0';
+}
+
+void vkd3d_trace_marker(char phase, UINT metadata, const void *data, UINT size, size_t wchar_size)
+{
+    struct vkd3d_trace_event *event;
+    char *label;
+
+    if (!(event = vkd3d_trace_add_event(phase, vkd3d_get_monotonic_time_ns())) || phase == 'E')
+        return;
+
+    if ((label = vkd3d_strdup_marker(metadata, data, size, wchar_size)))
+    {
+        vkd3d_trace_set_label(event, label);
+        vkd3d_free(label);
+    }
+    else
+    {
+        event->name = "PIX event";
+    }
+}
+
+static void vkd3d_trace_write_string(FILE *f, const char *s)
+{
+    fputc('"', f);
+    for (; *s; ++s)
+    {
+        if (*s == '"' || *s == '\\')
+            fprintf(f, "\\%c", *s);
+        else if ((unsigned char)*s < 0x20)
+            fprintf(f, "\\u%04x", *s);
+        else
+            fputc(*s, f);
+    }
+    fputc('"', f);
+}
+
+static FILE *vkd3d_trace_open_file(void)
+{
+    unsigned int index;
+    char *name;
+    size_t size;
+    FILE *f;
+
+    /* Each instance writes its own file; the first one uses the name as
+     * given, later ones get a numeric suffix. */
+    if (!(index = vkd3d_atomic_increment_u32(&vkd3d_trace_flush_count) - 1))
+    {
+        name = NULL;
+        f = fopen(vkd3d_trace_file, "w");
+    }
+    else
+    {
+        size = strlen(vkd3d_trace_file) + 12;
+        if (!(name = vkd3d_malloc(size)))
+            return NULL;
+        snprintf(name, size, "%s.%u", vkd3d_trace_file, index);
+        f = fopen(name, "w");
+    }
+
+    if (f)
+        TRACE("Writing timeline to \"%s\".\n", name ? name : vkd3d_trace_file);
+    else
+        ERR("Failed to open \"%s\", errno %d.\n", name ? name : vkd3d_trace_file, errno);
+    vkd3d_free(name);
+
+    return f;
+}
+
+static void vkd3d_trace_cleanup(void)
+{
+    unsigned int i;
+
+    for (i = 0; i < VKD3D_TRACE_THREAD_COUNT; ++i)
+    {
+        vkd3d_free(vkd3d_trace_threads[i]);
+        vkd3d_trace_threads[i] = NULL;
+    }
+}
+
+/* Called for each instance destroyed. Writes out the events recorded since
+ * the previous flush, and frees the ring buffers once the last instance is
+ * gone.
+ *
+ * Events recorded while the trace is being written may be torn; this is only
+ * a problem for threads which are still busy at that point. */
+void vkd3d_trace_flush(void)
+{
+    const struct vkd3d_trace_event *event;
+    struct vkd3d_trace_thread *thread;
+    unsigned int i, j, count, depth;
+    bool first = true;
+    unsigned long pid;
+    FILE *f;
+
+    if (!vkd3d_trace_enabled || !(f = vkd3d_trace_open_file()))
+        goto done;
+
+#ifdef _WIN32
+    pid = GetCurrentProcessId();
+#else
+    pid = getpid();
+#endif
+
+    fputs("{\"traceEvents\":[\n", f);
+
+    for (i = 0; i < VKD3D_TRACE_THREAD_COUNT; ++i)
+    {
+        if (!(thread = vkd3d_trace_threads[i]))
+            continue;
+
+        count = thread->event_count;
+        j = count > VKD3D_TRACE_EVENT_COUNT ? count - VKD3D_TRACE_EVENT_COUNT : 0;
+        j = max(j, thread->flushed_count);
+        for (depth = 0; j < count; ++j)
+        {
+            event = &thread->events[j % VKD3D_TRACE_EVENT_COUNT];
+
+            /* The matching "B" event may have been overwritten or written
+             * out by a previous flush. */
+            if (event->phase == 'E' && !depth)
+                continue;
+            if (event->phase == 'B')
+                ++depth;
+            else if (event->phase == 'E')
+                --depth;
+
+            fputs(first ? "{\"name\":" : ",\n{\"name\":", f);
+            first = false;
+            vkd3d_trace_write_string(f, event->name ? event->name : event->label);
+            fprintf(f, ",\"cat\":\"vkd3d\",\"ph\":\"%c\",\"ts\":%.3f", event->phase, event->timestamp / 1000.0);
+            if (event->phase == 'X')
+                fprintf(f, ",\"dur\":%.3f", event->duration / 1000.0);
+            else if (event->phase == 'i')
+                fputs(",\"s\":\"t\"", f);
+            fprintf(f, ",\"pid\":%lu,\"tid\":%"PRIu64"}", pid, thread->thread_id);
+        }
+        thread->flushed_count = count;
+    }
+
+    fputs("\n]}\n", f);
+    fclose(f);
+
+done:
+    if (!vkd3d_atomic_decrement_u32(&vkd3d_trace_instance_count))
+        vkd3d_trace_cleanup();
+}
@@ -20,6 +20,11 @@
 
 #include <errno.h>
 
+#if defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64)
+# include <emmintrin.h>
+# define VKD3D_HAVE_SSE2 1
+#endif
+
 #define COLOR         (VK_IMAGE_ASPECT_COLOR_BIT)
 #define DEPTH         (VK_IMAGE_ASPECT_DEPTH_BIT)
 #define STENCIL       (VK_IMAGE_ASPECT_STENCIL_BIT)
@@ -398,25 +403,6 @@ static void vkd3d_cleanup_depth_stencil_formats(struct d3d12_device *device)
     device->depth_stencil_formats = NULL;
 }
 
-HRESULT vkd3d_init_format_info(struct d3d12_device *device)
-{
-    HRESULT hr;
-
-    if (FAILED(hr = vkd3d_init_depth_stencil_formats(device)))
-        return hr;
-
-    if (FAILED(hr = vkd3d_init_format_compatibility_lists(device)))
-        vkd3d_cleanup_depth_stencil_formats(device);
-
-    return hr;
-}
-
-void vkd3d_cleanup_format_info(struct d3d12_device *device)
-{
-    vkd3d_cleanup_depth_stencil_formats(device);
-    vkd3d_cleanup_format_compatibility_lists(device);
-}
-
 /* We use overrides for depth/stencil formats. This is required in order to
  * properly support typeless formats because depth/stencil formats are only
  * compatible with themselves in Vulkan.
@@ -439,7 +425,7 @@ static const struct vkd3d_format *vkd3d_get_depth_stencil_format(const struct d3
     return NULL;
 }
 
-const struct vkd3d_format *vkd3d_get_format(const struct d3d12_device *device,
+static const struct vkd3d_format *vkd3d_find_format(const struct d3d12_device *device,
         DXGI_FORMAT dxgi_format, bool depth_stencil)
 {
     const struct vkd3d_format *format;
@@ -462,6 +448,146 @@ const struct vkd3d_format *vkd3d_get_format(const struct d3d12_device *device,
     return NULL;
 }
 
+static void vkd3d_format_table_entry_init_support(struct vkd3d_format_table_entry *entry,
+        const struct d3d12_device *device, DXGI_FORMAT dxgi_format)
+{
+    const struct vkd3d_vk_device_procs *vk_procs = &device->vk_procs;
+    const struct vkd3d_format *format;
+    VkFormatFeatureFlags image_features;
+    VkFormatProperties properties;
+
+    entry->support1 = D3D12_FORMAT_SUPPORT1_NONE;
+    entry->support2 = D3D12_FORMAT_SUPPORT2_NONE;
+
+    if (!(format = entry->format ? entry->format : entry->depth_stencil_format))
+        return;
+
+    VK_CALL(vkGetPhysicalDeviceFormatProperties(device->vk_physical_device, format->vk_format, &properties));
+    entry->image_features = image_features = properties.linearTilingFeatures | properties.optimalTilingFeatures;
+    entry->buffer_features = properties.bufferFeatures;
+
+    if (properties.bufferFeatures)
+        entry->support1 |= D3D12_FORMAT_SUPPORT1_BUFFER;
+    if (properties.bufferFeatures & VK_FORMAT_FEATURE_VERTEX_BUFFER_BIT)
+        entry->support1 |= D3D12_FORMAT_SUPPORT1_IA_VERTEX_BUFFER;
+    if (dxgi_format == DXGI_FORMAT_R16_UINT || dxgi_format == DXGI_FORMAT_R32_UINT)
+        entry->support1 |= D3D12_FORMAT_SUPPORT1_IA_INDEX_BUFFER;
+    if (image_features)
+        entry->support1 |= D3D12_FORMAT_SUPPORT1_TEXTURE1D | D3D12_FORMAT_SUPPORT1_TEXTURE2D
+                | D3D12_FORMAT_SUPPORT1_TEXTURE3D | D3D12_FORMAT_SUPPORT1_TEXTURECUBE;
+    if (image_features & VK_FORMAT_FEATURE_SAMPLED_IMAGE_BIT)
+    {
+        entry->support1 |= D3D12_FORMAT_SUPPORT1_SHADER_LOAD | D3D12_FORMAT_SUPPORT1_MULTISAMPLE_LOAD
+                | D3D12_FORMAT_SUPPORT1_SHADER_GATHER;
+        if (image_features & VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT)
+        {
+            entry->support1 |= D3D12_FORMAT_SUPPORT1_SHADER_SAMPLE
+                    | D3D12_FORMAT_SUPPORT1_MIP;
+        }
+        if (format->vk_aspect_mask & VK_IMAGE_ASPECT_DEPTH_BIT)
+            entry->support1 |= D3D12_FORMAT_SUPPORT1_SHADER_SAMPLE_COMPARISON
+                    | D3D12_FORMAT_SUPPORT1_SHADER_GATHER_COMPARISON;
+    }
+    if (image_features & VK_FORMAT_FEATURE_COLOR_ATTACHMENT_BIT)
+        entry->support1 |= D3D12_FORMAT_SUPPORT1_RENDER_TARGET | D3D12_FORMAT_SUPPORT1_MULTISAMPLE_RENDERTARGET;
+    if (image_features & VK_FORMAT_FEATURE_COLOR_ATTACHMENT_BLEND_BIT)
+        entry->support1 |= D3D12_FORMAT_SUPPORT1_BLENDABLE;
+    if (image_features & VK_FORMAT_FEATURE_DEPTH_STENCIL_ATTACHMENT_BIT)
+        entry->support1 |= D3D12_FORMAT_SUPPORT1_DEPTH_STENCIL;
+    if (image_features & VK_FORMAT_FEATURE_BLIT_SRC_BIT)
+        entry->support1 |= D3D12_FORMAT_SUPPORT1_MULTISAMPLE_RESOLVE;
+    if (image_features & VK_FORMAT_FEATURE_STORAGE_IMAGE_BIT)
+    {
+        entry->support1 |= D3D12_FORMAT_SUPPORT1_TYPED_UNORDERED_ACCESS_VIEW;
+        if (device->vk_info.uav_read_without_format)
+            entry->support2 |= D3D12_FORMAT_SUPPORT2_UAV_TYPED_LOAD;
+        /* We effectively require shaderStorageImageWriteWithoutFormat,
+         * so we can just report UAV_TYPED_STORE unconditionally. */
+        entry->support2 |= D3D12_FORMAT_SUPPORT2_UAV_TYPED_STORE;
+    }
+
+    if (image_features & VK_FORMAT_FEATURE_STORAGE_IMAGE_ATOMIC_BIT)
+        entry->support2 |= D3D12_FORMAT_SUPPORT2_UAV_ATOMIC_ADD
+                | D3D12_FORMAT_SUPPORT2_UAV_ATOMIC_BITWISE_OPS
+                | D3D12_FORMAT_SUPPORT2_UAV_ATOMIC_COMPARE_STORE_OR_COMPARE_EXCHANGE
+                | D3D12_FORMAT_SUPPORT2_UAV_ATOMIC_EXCHANGE
+                | D3D12_FORMAT_SUPPORT2_UAV_ATOMIC_SIGNED_MIN_OR_MAX
+                | D3D12_FORMAT_SUPPORT2_UAV_ATOMIC_UNSIGNED_MIN_OR_MAX;
+}
+
+static HRESULT vkd3d_init_format_table(struct d3d12_device *device)
+{
+    struct vkd3d_format_table_entry *table, *entry;
+    DXGI_FORMAT dxgi_format;
+
+    if (!(table = vkd3d_calloc(VKD3D_FORMAT_TABLE_SIZE, sizeof(*table))))
+        return E_OUTOFMEMORY;
+
+    for (dxgi_format = 0; dxgi_format < VKD3D_FORMAT_TABLE_SIZE; ++dxgi_format)
+    {
+        entry = &table[dxgi_format];
+        entry->format = vkd3d_find_format(device, dxgi_format, false);
+        entry->depth_stencil_format = vkd3d_get_depth_stencil_format(device, dxgi_format);
+        vkd3d_format_table_entry_init_support(entry, device, dxgi_format);
+    }
+
+    device->format_table = table;
+    return S_OK;
+}
+
+HRESULT vkd3d_init_format_info(struct d3d12_device *device)
+{
+    HRESULT hr;
+
+    device->format_table = NULL;
+
+    if (FAILED(hr = vkd3d_init_depth_stencil_formats(device)))
+        return hr;
+
+    if (FAILED(hr = vkd3d_init_format_compatibility_lists(device)))
+        goto fail;
+
+    if (FAILED(hr = vkd3d_init_format_table(device)))
+    {
+        vkd3d_cleanup_format_compatibility_lists(device);
+        goto fail;
+    }
+
+    return S_OK;
+
+fail:
+    vkd3d_cleanup_depth_stencil_formats(device);
+    return hr;
+}
+
+void vkd3d_cleanup_format_info(struct d3d12_device *device)
+{
+    vkd3d_free(device->format_table);
+    device->format_table = NULL;
+    vkd3d_cleanup_depth_stencil_formats(device);
+    vkd3d_cleanup_format_compatibility_lists(device);
+}
+
+const struct vkd3d_format_table_entry *vkd3d_get_format_table_entry(const struct d3d12_device *device,
+        DXGI_FORMAT dxgi_format)
+{
+    if (!device || !device->format_table || (unsigned int)dxgi_format >= VKD3D_FORMAT_TABLE_SIZE)
+        return NULL;
+
+    return &device->format_table[dxgi_format];
+}
+
+const struct vkd3d_format *vkd3d_get_format(const struct d3d12_device *device,
+        DXGI_FORMAT dxgi_format, bool depth_stencil)
+{
+    const struct vkd3d_format_table_entry *entry;
+
+    if ((entry = vkd3d_get_format_table_entry(device, dxgi_format)))
+        return (depth_stencil && entry->depth_stencil_format) ? entry->depth_stencil_format : entry->format;
+
+    return vkd3d_find_format(device, dxgi_format, depth_stencil);
+}
+
 const struct vkd3d_format *vkd3d_find_uint_format(const struct d3d12_device *device, DXGI_FORMAT dxgi_format)
 {
     DXGI_FORMAT typeless_format = DXGI_FORMAT_UNKNOWN;
@@ -493,28 +619,87 @@ const struct vkd3d_format *vkd3d_find_uint_format(const struct d3d12_device *dev
     return NULL;
 }
 
-void vkd3d_format_copy_data(const struct vkd3d_format *format, const uint8_t *src,
-        unsigned int src_row_pitch, unsigned int src_slice_pitch, uint8_t *dst, unsigned int dst_row_pitch,
-        unsigned int dst_slice_pitch, unsigned int w, unsigned int h, unsigned int d)
+/* Non-temporal stores bypass the cache, and write whole lines of
+ * write-combined memory at once. */
+static void vkd3d_copy_row_non_temporal(uint8_t *dst, const uint8_t *src, size_t size)
+{
+#ifdef VKD3D_HAVE_SSE2
+    __m128i v0, v1, v2, v3;
+    size_t head;
+
+    head = min(size, (16 - ((uintptr_t)dst & 15)) & 15);
+    memcpy(dst, src, head);
+    dst += head;
+    src += head;
+    size -= head;
+
+    for (; size >= 64; size -= 64, src += 64, dst += 64)
+    {
+        v0 = _mm_loadu_si128((const __m128i *)src);
+        v1 = _mm_loadu_si128((const __m128i *)(src + 16));
+        v2 = _mm_loadu_si128((const __m128i *)(src + 32));
+        v3 = _mm_loadu_si128((const __m128i *)(src + 48));
+        _mm_stream_si128((__m128i *)dst, v0);
+        _mm_stream_si128((__m128i *)(dst + 16), v1);
+        _mm_stream_si128((__m128i *)(dst + 32), v2);
+        _mm_stream_si128((__m128i *)(dst + 48), v3);
+    }
+    for (; size >= 16; size -= 16, src += 16, dst += 16)
+        _mm_stream_si128((__m128i *)dst, _mm_loadu_si128((const __m128i *)src));
+#endif
+    memcpy(dst, src, size);
+}
+
+/* Rows are counted across slices, i.e. row "i" is row "i % row_count" of
+ * slice "i / row_count". */
+void vkd3d_subresource_copy_rows(const struct vkd3d_subresource_copy *copy,
+        unsigned int start_row, unsigned int end_row)
 {
-    unsigned int row_block_count, row_count, row_size, slice, row;
-    unsigned int slice_count = d;
+    unsigned int slice, row, i;
     const uint8_t *src_row;
     uint8_t *dst_row;
 
-    row_block_count = (w + format->block_width - 1) / format->block_width;
-    row_count = (h + format->block_height - 1) / format->block_height;
-    row_size = row_block_count * format->byte_count * format->block_byte_count;
-
-    for (slice = 0; slice < slice_count; ++slice)
+    for (i = start_row; i < end_row; ++i)
     {
-        for (row = 0; row < row_count; ++row)
-        {
-            src_row = &src[slice * src_slice_pitch + row * src_row_pitch];
-            dst_row = &dst[slice * dst_slice_pitch + row * dst_row_pitch];
-            memcpy(dst_row, src_row, row_size);
-        }
+        slice = i / copy->row_count;
+        row = i % copy->row_count;
+        src_row = &copy->src[slice * copy->src_slice_pitch + row * copy->src_row_pitch];
+        dst_row = &copy->dst[slice * copy->dst_slice_pitch + row * copy->dst_row_pitch];
+        if (copy->non_temporal)
+            vkd3d_copy_row_non_temporal(dst_row, src_row, copy->row_size);
+        else
+            memcpy(dst_row, src_row, copy->row_size);
     }
+
+#ifdef VKD3D_HAVE_SSE2
+    /* Make the non-temporal stores visible before the copy is reported complete. */
+    if (copy->non_temporal)
+        _mm_sfence();
+#endif
+}
+
+void vkd3d_format_copy_data(struct d3d12_device *device, const struct vkd3d_format *format, const uint8_t *src,
+        unsigned int src_row_pitch, unsigned int src_slice_pitch, uint8_t *dst, unsigned int dst_row_pitch,
+        unsigned int dst_slice_pitch, unsigned int w, unsigned int h, unsigned int d, bool non_temporal)
+{
+    struct vkd3d_subresource_copy copy;
+    unsigned int row_block_count;
+
+    /* Block-compressed formats are copied a row of blocks at a time. */
+    row_block_count = (w + format->block_width - 1) / format->block_width;
+
+    copy.src = src;
+    copy.src_row_pitch = src_row_pitch;
+    copy.src_slice_pitch = src_slice_pitch;
+    copy.dst = dst;
+    copy.dst_row_pitch = dst_row_pitch;
+    copy.dst_slice_pitch = dst_slice_pitch;
+    copy.row_size = row_block_count * format->byte_count * format->block_byte_count;
+    copy.row_count = (h + format->block_height - 1) / format->block_height;
+    copy.slice_count = d;
+    copy.non_temporal = non_temporal;
+
+    d3d12_device_copy_subresource(device, &copy);
 }
 
 VkFormat vkd3d_get_vk_format(DXGI_FORMAT format)
@@ -936,13 +1121,50 @@ bool vkd3d_get_program_name(char program_name[PATH_MAX])
 
 #endif  /* HAVE_DECL_PROGRAM_INVOCATION_NAME */
 
-static struct vkd3d_private_data *vkd3d_private_store_get_private_data(
-        const struct vkd3d_private_store *store, const GUID *tag)
+static size_t vkd3d_private_data_hash(const GUID *tag)
+{
+    uint64_t a, b;
+
+    memcpy(&a, tag, sizeof(a));
+    memcpy(&b, (const BYTE *)tag + sizeof(a), sizeof(b));
+    a ^= b * 0x9e3779b97f4a7c15;
+
+    return a ^ (a >> 32);
+}
+
+static const void *vkd3d_private_data_get_data(const struct vkd3d_private_data *data)
+{
+    if (data->is_object)
+        return &data->u.object;
+    return data->size > sizeof(data->u.data) ? data->u.external : data->u.data;
+}
+
+static void vkd3d_private_data_cleanup(struct vkd3d_private_data *data)
+{
+    if (data->is_object)
+        IUnknown_Release(data->u.object);
+    else if (data->size > sizeof(data->u.data))
+        vkd3d_free(data->u.external);
+}
+
+/* This may be called without holding the store mutex, in which case the
+ * entries may change underneath us; the number of probes is bounded so that
+ * this always terminates. */
+static struct vkd3d_private_data *vkd3d_private_data_table_find(
+        struct vkd3d_private_data_table *table, const GUID *tag)
 {
     struct vkd3d_private_data *data;
+    size_t i, j, mask;
+
+    if (!table)
+        return NULL;
 
-    LIST_FOR_EACH_ENTRY(data, &store->content, struct vkd3d_private_data, entry)
+    mask = table->capacity - 1;
+    for (i = 0, j = vkd3d_private_data_hash(tag) & mask; i < table->capacity; ++i, j = (j + 1) & mask)
     {
+        data = &table->entries[j];
+        if (!data->is_used)
+            return NULL;
         if (IsEqualGUID(&data->tag, tag))
             return data;
     }
@@ -950,17 +1172,84 @@ static struct vkd3d_private_data *vkd3d_private_store_get_private_data(
     return NULL;
 }
 
+static struct vkd3d_private_data *vkd3d_private_data_table_insert(
+        struct vkd3d_private_data_table *table, const GUID *tag)
+{
+    struct vkd3d_private_data *data;
+    size_t i, mask;
+
+    mask = table->capacity - 1;
+    for (i = vkd3d_private_data_hash(tag) & mask; table->entries[i].is_used; i = (i + 1) & mask)
+        ;
+
+    data = &table->entries[i];
+    data->tag = *tag;
+    data->is_used = true;
+    ++table->count;
+
+    return data;
+}
+
+/* Backward shift deletion, so that probe sequences need no tombstones. */
+static void vkd3d_private_data_table_remove(struct vkd3d_private_data_table *table,
+        struct vkd3d_private_data *data)
+{
+    size_t i, j, home, mask;
+
+    mask = table->capacity - 1;
+    i = data - table->entries;
+    for (j = (i + 1) & mask; table->entries[j].is_used; j = (j + 1) & mask)
+    {
+        home = vkd3d_private_data_hash(&table->entries[j].tag) & mask;
+        /* Entries whose home slot lies cyclically in (i, j] stay in place. */
+        if (i <= j ? (i < home && home <= j) : (i < home || home <= j))
+            continue;
+        table->entries[i] = table->entries[j];
+        i = j;
+    }
+
+    table->entries[i].is_used = false;
+    --table->count;
+}
+
+static bool vkd3d_private_store_reserve(struct vkd3d_private_store *store)
+{
+    struct vkd3d_private_data_table *table = store->table, *object;
+    size_t capacity, i;
+
+    /* Keep the load factor at or below one half. */
+    if (table && (table->count + 1) * 2 <= table->capacity)
+        return true;
+
+    capacity = table ? table->capacity * 2 : 8;
+    if (!(object = vkd3d_calloc(1, offsetof(struct vkd3d_private_data_table, entries[capacity]))))
+        return false;
+    object->previous = table;
+    object->capacity = capacity;
+
+    for (i = 0; table && i < table->capacity; ++i)
+    {
+        if (table->entries[i].is_used)
+            *vkd3d_private_data_table_insert(object, &table->entries[i].tag) = table->entries[i];
+    }
+
+    store->table = object;
+    return true;
+}
+
 static HRESULT vkd3d_private_store_set_private_data(struct vkd3d_private_store *store,
         const GUID *tag, const void *data, unsigned int data_size, bool is_object)
 {
-    struct vkd3d_private_data *d, *old_data;
+    struct vkd3d_private_data *d;
+    BYTE *external = NULL;
     const void *ptr = data;
 
     if (!data)
     {
-        if ((d = vkd3d_private_store_get_private_data(store, tag)))
+        if ((d = vkd3d_private_data_table_find(store->table, tag)))
         {
-            vkd3d_private_data_destroy(d);
+            vkd3d_private_data_cleanup(d);
+            vkd3d_private_data_table_remove(store->table, d);
             return S_OK;
         }
 
@@ -973,88 +1262,182 @@ static HRESULT vkd3d_private_store_set_private_data(struct vkd3d_private_store *
             return E_INVALIDARG;
         ptr = &data;
     }
+    else if (data_size > VKD3D_PRIVATE_DATA_INLINE_SIZE && !(external = vkd3d_memdup(data, data_size)))
+    {
+        return E_OUTOFMEMORY;
+    }
+
+    /* Take the new reference first, in case the old data holds the same object. */
+    if (is_object)
+        IUnknown_AddRef((IUnknown *)data);
 
-    if (!(d = vkd3d_malloc(offsetof(struct vkd3d_private_data, u.data[data_size]))))
+    if ((d = vkd3d_private_data_table_find(store->table, tag)))
+    {
+        vkd3d_private_data_cleanup(d);
+    }
+    else if (vkd3d_private_store_reserve(store))
+    {
+        d = vkd3d_private_data_table_insert(store->table, tag);
+    }
+    else
+    {
+        if (is_object)
+            IUnknown_Release((IUnknown *)data);
+        vkd3d_free(external);
         return E_OUTOFMEMORY;
+    }
 
-    d->tag = *tag;
     d->size = data_size;
     d->is_object = is_object;
-    memcpy(d->u.data, ptr, data_size);
-    if (is_object)
-        IUnknown_AddRef(d->u.object);
+    if (external)
+        d->u.external = external;
+    else
+        memcpy(d->u.data, ptr, data_size);
+
+    return S_OK;
+}
 
-    if ((old_data = vkd3d_private_store_get_private_data(store, tag)))
-        vkd3d_private_data_destroy(old_data);
-    list_add_tail(&store->content, &d->entry);
+static HRESULT vkd3d_private_data_copy(const void *data, unsigned int data_size, bool is_object,
+        unsigned int *out_size, void *out)
+{
+    unsigned int size = *out_size;
+
+    *out_size = data_size;
+    if (!out)
+        return S_OK;
+
+    if (size < data_size)
+        return DXGI_ERROR_MORE_DATA;
+
+    if (is_object)
+        IUnknown_AddRef(*(IUnknown * const *)data);
+    memcpy(out, data, data_size);
 
     return S_OK;
 }
 
+/* Inline data is read without the store mutex, seqlock style. Objects and
+ * external data may be released by a concurrent writer, so those are read
+ * with the mutex held. Returns false if the caller needs to take the mutex. */
+static bool vkd3d_private_store_get_private_data(struct vkd3d_private_store *store,
+        const GUID *tag, unsigned int *out_size, void *out, HRESULT *hr)
+{
+    BYTE data[VKD3D_PRIVATE_DATA_INLINE_SIZE];
+    const struct vkd3d_private_data *d;
+    unsigned int attempt, size;
+    uint32_t version;
+
+    for (attempt = 0; attempt < 4; ++attempt)
+    {
+        if ((version = vkd3d_atomic_load_u32_acquire(&store->version)) & 1)
+            continue;
+
+        size = 0;
+        if ((d = vkd3d_private_data_table_find(store->table, tag)))
+        {
+            size = d->size;
+            if (d->is_object || size > sizeof(data))
+                return false;
+            memcpy(data, d->u.data, size);
+        }
+
+        vkd3d_atomic_fence_acquire();
+        if (vkd3d_atomic_load_u32_acquire(&store->version) != version)
+            continue;
+
+        if (!d)
+        {
+            *out_size = 0;
+            *hr = DXGI_ERROR_NOT_FOUND;
+            return true;
+        }
+
+        *hr = vkd3d_private_data_copy(data, size, false, out_size, out);
+        return true;
+    }
+
+    return false;
+}
+
 HRESULT vkd3d_get_private_data(struct vkd3d_private_store *store,
         const GUID *tag, unsigned int *out_size, void *out)
 {
     const struct vkd3d_private_data *data;
-    HRESULT hr = S_OK;
-    unsigned int size;
+    HRESULT hr;
 
     if (!out_size)
         return E_INVALIDARG;
 
+    if (vkd3d_private_store_get_private_data(store, tag, out_size, out, &hr))
+        return hr;
+
     vkd3d_mutex_lock(&store->mutex);
 
-    if (!(data = vkd3d_private_store_get_private_data(store, tag)))
+    if ((data = vkd3d_private_data_table_find(store->table, tag)))
     {
-        *out_size = 0;
-        hr = DXGI_ERROR_NOT_FOUND;
-        goto done;
+        hr = vkd3d_private_data_copy(vkd3d_private_data_get_data(data),
+                data->size, data->is_object, out_size, out);
     }
-
-    size = *out_size;
-    *out_size = data->size;
-    if (!out)
-        goto done;
-
-    if (size < data->size)
+    else
     {
-        hr = DXGI_ERROR_MORE_DATA;
-        goto done;
+        *out_size = 0;
+        hr = DXGI_ERROR_NOT_FOUND;
     }
 
-    if (data->is_object)
-        IUnknown_AddRef(data->u.object);
-    memcpy(out, data->u.data, data->size);
-
-done:
     vkd3d_mutex_unlock(&store->mutex);
     return hr;
 }
 
-HRESULT vkd3d_set_private_data(struct vkd3d_private_store *store,
-        const GUID *tag, unsigned int data_size, const void *data)
+static HRESULT vkd3d_private_store_set(struct vkd3d_private_store *store,
+        const GUID *tag, const void *data, unsigned int data_size, bool is_object)
 {
     HRESULT hr;
 
     vkd3d_mutex_lock(&store->mutex);
+    vkd3d_atomic_increment_u32(&store->version);
 
-    hr = vkd3d_private_store_set_private_data(store, tag, data, data_size, false);
+    hr = vkd3d_private_store_set_private_data(store, tag, data, data_size, is_object);
 
+    vkd3d_atomic_increment_u32(&store->version);
     vkd3d_mutex_unlock(&store->mutex);
     return hr;
 }
 
+HRESULT vkd3d_set_private_data(struct vkd3d_private_store *store,
+        const GUID *tag, unsigned int data_size, const void *data)
+{
+    return vkd3d_private_store_set(store, tag, data, data_size, false);
+}
+
 HRESULT vkd3d_set_private_data_interface(struct vkd3d_private_store *store,
         const GUID *tag, const IUnknown *object)
 {
     const void *data = object ? object : (void *)&object;
-    HRESULT hr;
 
-    vkd3d_mutex_lock(&store->mutex);
+    return vkd3d_private_store_set(store, tag, data, sizeof(object), !!object);
+}
 
-    hr = vkd3d_private_store_set_private_data(store, tag, data, sizeof(object), !!object);
+void vkd3d_private_store_destroy(struct vkd3d_private_store *store)
+{
+    struct vkd3d_private_data_table *table, *previous;
+    size_t i;
 
-    vkd3d_mutex_unlock(&store->mutex);
-    return hr;
+    if ((table = store->table))
+    {
+        for (i = 0; i < table->capacity; ++i)
+        {
+            if (table->entries[i].is_used)
+                vkd3d_private_data_cleanup(&table->entries[i]);
+        }
+    }
+
+    for (; table; table = previous)
+    {
+        previous = table->previous;
+        vkd3d_free(table);
+    }
+
+    vkd3d_mutex_destroy(&store->mutex);
 }
 
 VkResult vkd3d_set_vk_object_name_utf8(struct d3d12_device *device, uint64_t vk_object,
@@ -1095,3 +1478,85 @@ HRESULT vkd3d_set_vk_object_name(struct d3d12_device *device, uint64_t vk_object
 
     return hresult_from_vk_result(vr);
 }
+
+/* The "metadata" values used by WinPixEventRuntime. */
+#define VKD3D_PIX_EVENT_UNICODE_VERSION 0
+#define VKD3D_PIX_EVENT_ANSI_VERSION 1
+#define VKD3D_PIX_EVENT_PIX3BLOB_VERSION 2
+
+#define VKD3D_PIX_EVENTS_STRING_IS_ANSI 0x0040000000000000ull
+#define VKD3D_PIX_EVENTS_STRING_IS_SHORTCUT 0x0020000000000000ull
+
+static char *vkd3d_strndup_utf8(const char *str, size_t max_size)
+{
+    size_t length;
+    char *s;
+
+    for (length = 0; length < max_size && str[length]; ++length)
+        ;
+    if (length == max_size)
+        return NULL;
+
+    if ((s = vkd3d_malloc(length + 1)))
+        memcpy(s, str, length + 1);
+    return s;
+}
+
+static char *vkd3d_strndup_w_utf8(const void *wstr, size_t max_size, size_t wchar_size)
+{
+    static const uint8_t zero[4];
+    const uint8_t *p = wstr;
+    size_t i;
+
+    for (i = 0; i + wchar_size <= max_size; i += wchar_size)
+    {
+        if (!memcmp(&p[i], zero, wchar_size))
+            return vkd3d_strdup_w_utf8(wstr, wchar_size);
+    }
+
+    return NULL;
+}
+
+/* PIX3 blobs consist of 64-bit words: an event header, the colour, and the
+ * format string, followed by the format arguments. The arguments are
+ * ignored; the format string is used as the label. */
+static char *vkd3d_strdup_pix3_blob(const void *data, UINT size, size_t wchar_size)
+{
+    const uint8_t *words = data;
+    uint64_t string_header;
+
+    if (size < 4 * sizeof(uint64_t))
+        return NULL;
+
+    memcpy(&string_header, &words[2 * sizeof(uint64_t)], sizeof(string_header));
+    if (string_header & VKD3D_PIX_EVENTS_STRING_IS_SHORTCUT)
+        return NULL;
+
+    words += 3 * sizeof(uint64_t);
+    size -= 3 * sizeof(uint64_t);
+    if (string_header & VKD3D_PIX_EVENTS_STRING_IS_ANSI)
+        return vkd3d_strndup_utf8((const char *)words, size);
+    return vkd3d_strndup_w_utf8(words, size, wchar_size);
+}
+
+/* Returns the UTF-8 label of a PIX event, or NULL if it can't be decoded. */
+char *vkd3d_strdup_marker(UINT metadata, const void *data, UINT size, size_t wchar_size)
+{
+    if (!data || !size)
+        return NULL;
+
+    switch (metadata)
+    {
+        case VKD3D_PIX_EVENT_UNICODE_VERSION:
+            return vkd3d_strndup_w_utf8(data, size, wchar_size);
+
+        case VKD3D_PIX_EVENT_ANSI_VERSION:
+            return vkd3d_strndup_utf8(data, size);
+
+        case VKD3D_PIX_EVENT_PIX3BLOB_VERSION:
+            return vkd3d_strdup_pix3_blob(data, size, wchar_size);
+
+        default:
+            return NULL;
+    }
+}
@@ -57,6 +57,9 @@
 #define VKD3D_MAX_SHADER_STAGES           5u
 #define VKD3D_MAX_VK_SYNC_OBJECTS         4u
 #define VKD3D_MAX_DEVICE_BLOCKED_QUEUES  16u
+#define VKD3D_MAX_DEVICE_WORKER_COUNT    16u
+#define VKD3D_MAX_RECYCLED_COMMAND_POOLS 16u
+#define VKD3D_MAX_RECYCLED_DESCRIPTOR_POOLS 64u
 #define VKD3D_MAX_DESCRIPTOR_SETS        64u
 /* Direct3D 12 binding tier 3 has a limit of "1,000,000+" CBVs, SRVs and UAVs.
  * I am not sure what the "+" is supposed to mean: it probably hints that
@@ -121,16 +124,20 @@ struct vkd3d_vulkan_info
     bool KHR_get_physical_device_properties2;
     /* EXT instance extensions */
     bool EXT_debug_report;
+    bool EXT_debug_utils;
 
     /* KHR device extensions */
+    bool KHR_buffer_device_address;
     bool KHR_dedicated_allocation;
     bool KHR_draw_indirect_count;
     bool KHR_get_memory_requirements2;
     bool KHR_image_format_list;
     bool KHR_maintenance3;
+    bool KHR_maintenance4;
     bool KHR_portability_subset;
     bool KHR_push_descriptor;
     bool KHR_sampler_mirror_clamp_to_edge;
+    bool KHR_synchronization2;
     bool KHR_timeline_semaphore;
     bool KHR_zero_initialize_workgroup_memory;
     /* EXT device extensions */
@@ -140,9 +147,13 @@ struct vkd3d_vulkan_info
     bool EXT_debug_marker;
     bool EXT_depth_range_unrestricted;
     bool EXT_depth_clip_enable;
+    bool EXT_descriptor_buffer;
     bool EXT_descriptor_indexing;
     bool EXT_fragment_shader_interlock;
+    bool EXT_memory_budget;
+    bool EXT_memory_priority;
     bool EXT_mutable_descriptor_type;
+    bool EXT_pageable_device_local_memory;
     bool EXT_robustness2;
     bool EXT_shader_demote_to_helper_invocation;
     bool EXT_shader_stencil_export;
@@ -169,6 +180,7 @@ struct vkd3d_vulkan_info
     bool sparse_residency_3d;
 
     VkPhysicalDeviceTexelBufferAlignmentPropertiesEXT texel_buffer_alignment_properties;
+    VkPhysicalDeviceDescriptorBufferPropertiesEXT descriptor_buffer_properties;
 
     unsigned int shader_extension_count;
     enum vkd3d_shader_spirv_extension shader_extensions[VKD3D_MAX_SHADER_EXTENSIONS];
@@ -180,6 +192,10 @@ enum vkd3d_config_flags
 {
     VKD3D_CONFIG_FLAG_VULKAN_DEBUG = 0x00000001,
     VKD3D_CONFIG_FLAG_VIRTUAL_HEAPS = 0x00000002,
+    VKD3D_CONFIG_FLAG_DESCRIPTOR_BUFFER = 0x00000004,
+    VKD3D_CONFIG_FLAG_ROOT_BUFFER_ADDRESS = 0x00000008,
+    VKD3D_CONFIG_FLAG_DEFERRED_RECORDING = 0x00000010,
+    VKD3D_CONFIG_FLAG_STATISTICS = 0x00000020,
 };
 
 struct vkd3d_instance
@@ -259,14 +275,27 @@ struct vkd3d_gpu_va_slab
     void *ptr;
 };
 
+struct vkd3d_gpu_va_range
+{
+    struct rb_entry entry;
+    struct rb_entry size_entry;
+    D3D12_GPU_VIRTUAL_ADDRESS base;
+    uint64_t size;
+};
+
+#define VKD3D_VA_FALLBACK_ROOT_SIZE 1024
+
 struct vkd3d_gpu_va_allocator
 {
     struct vkd3d_mutex mutex;
 
     D3D12_GPU_VIRTUAL_ADDRESS fallback_floor;
-    struct vkd3d_gpu_va_allocation *fallback_allocations;
-    size_t fallback_allocations_size;
-    size_t fallback_allocation_count;
+    /* Coalesced freed ranges below fallback_floor, indexed by address and by size. */
+    struct rb_tree fallback_free_ranges;
+    struct rb_tree fallback_free_sizes;
+    /* A three-level page table which maps each page of the fallback range to
+     * its allocation. It can be read without taking the mutex. */
+    struct vkd3d_gpu_va_allocation **fallback_pages[VKD3D_VA_FALLBACK_ROOT_SIZE];
 
     struct vkd3d_gpu_va_slab *slabs;
     struct vkd3d_gpu_va_slab *free_slab;
@@ -301,57 +330,58 @@ void vkd3d_render_pass_cache_cleanup(struct vkd3d_render_pass_cache *cache, stru
 HRESULT vkd3d_render_pass_cache_find(struct vkd3d_render_pass_cache *cache, struct d3d12_device *device,
         const struct vkd3d_render_pass_key *key, VkRenderPass *vk_render_pass);
 void vkd3d_render_pass_cache_init(struct vkd3d_render_pass_cache *cache);
+VkResult vkd3d_create_render_pass(struct d3d12_device *device,
+        const VkRenderPassCreateInfo *create_info, VkRenderPass *vk_render_pass);
 
-struct vkd3d_private_store
-{
-    struct vkd3d_mutex mutex;
-
-    struct list content;
-};
+/* Data of up to this size is stored in the table itself, and can be read
+ * without taking the store mutex. */
+#define VKD3D_PRIVATE_DATA_INLINE_SIZE 32
 
 struct vkd3d_private_data
 {
-    struct list entry;
-
     GUID tag;
     unsigned int size;
+    bool is_used;
     bool is_object;
     union
     {
-        BYTE data[1];
+        BYTE data[VKD3D_PRIVATE_DATA_INLINE_SIZE];
+        BYTE *external;
         IUnknown *object;
     } u;
 };
 
-static inline void vkd3d_private_data_destroy(struct vkd3d_private_data *data)
+/* Open-addressed with linear probing. Replaced tables are kept until the
+ * store is destroyed, since lock-free readers may still access them. */
+struct vkd3d_private_data_table
 {
-    if (data->is_object)
-        IUnknown_Release(data->u.object);
-    list_remove(&data->entry);
-    vkd3d_free(data);
-}
+    struct vkd3d_private_data_table *previous;
+    size_t capacity;
+    size_t count;
+    struct vkd3d_private_data entries[];
+};
 
-static inline HRESULT vkd3d_private_store_init(struct vkd3d_private_store *store)
+struct vkd3d_private_store
 {
-    list_init(&store->content);
-
-    vkd3d_mutex_init(&store->mutex);
+    struct vkd3d_mutex mutex;
 
-    return S_OK;
-}
+    /* Incremented before and after each change; odd while the table is
+     * being modified. */
+    uint32_t version;
+    struct vkd3d_private_data_table *table;
+};
 
-static inline void vkd3d_private_store_destroy(struct vkd3d_private_store *store)
+static inline HRESULT vkd3d_private_store_init(struct vkd3d_private_store *store)
 {
-    struct vkd3d_private_data *data, *cursor;
+    store->version = 0;
+    store->table = NULL;
 
-    LIST_FOR_EACH_ENTRY_SAFE(data, cursor, &store->content, struct vkd3d_private_data, entry)
-    {
-        vkd3d_private_data_destroy(data);
-    }
+    vkd3d_mutex_init(&store->mutex);
 
-    vkd3d_mutex_destroy(&store->mutex);
+    return S_OK;
 }
 
+void vkd3d_private_store_destroy(struct vkd3d_private_store *store);
 HRESULT vkd3d_get_private_data(struct vkd3d_private_store *store, const GUID *tag, unsigned int *out_size, void *out);
 HRESULT vkd3d_set_private_data(struct vkd3d_private_store *store,
         const GUID *tag, unsigned int data_size, const void *data);
@@ -448,6 +478,10 @@ struct d3d12_heap
     unsigned int map_count;
     uint32_t vk_memory_type;
 
+    /* Protected by the device residency manager mutex. */
+    bool evicted;
+    D3D12_RESIDENCY_PRIORITY residency_priority;
+
     struct d3d12_device *device;
 
     struct vkd3d_private_store private_store;
@@ -457,6 +491,24 @@ HRESULT d3d12_heap_create(struct d3d12_device *device, const D3D12_HEAP_DESC *de
         const struct d3d12_resource *resource, ID3D12ProtectedResourceSession *protected_session, struct d3d12_heap **heap);
 struct d3d12_heap *unsafe_impl_from_ID3D12Heap(ID3D12Heap *iface);
 
+struct vkd3d_residency_manager
+{
+    struct vkd3d_mutex mutex;
+    /* Size of resident heaps, per Vulkan memory heap. */
+    VkDeviceSize resident_size[VK_MAX_MEMORY_HEAPS];
+};
+
+void vkd3d_residency_manager_init(struct vkd3d_residency_manager *manager);
+void vkd3d_residency_manager_cleanup(struct vkd3d_residency_manager *manager);
+void vkd3d_residency_manager_add_heap(struct vkd3d_residency_manager *manager, struct d3d12_heap *heap);
+void vkd3d_residency_manager_remove_heap(struct vkd3d_residency_manager *manager, struct d3d12_heap *heap);
+HRESULT vkd3d_residency_manager_make_resident(struct vkd3d_residency_manager *manager, struct d3d12_device *device,
+        D3D12_RESIDENCY_FLAGS flags, unsigned int object_count, ID3D12Pageable * const *objects);
+void vkd3d_residency_manager_evict(struct vkd3d_residency_manager *manager,
+        unsigned int object_count, ID3D12Pageable * const *objects);
+void vkd3d_residency_manager_set_priority(struct vkd3d_residency_manager *manager, unsigned int object_count,
+        ID3D12Pageable * const *objects, const D3D12_RESIDENCY_PRIORITY *priorities);
+
 #define VKD3D_RESOURCE_PUBLIC_FLAGS \
         (VKD3D_RESOURCE_INITIAL_STATE_TRANSITION | VKD3D_RESOURCE_PRESENT_STATE_TRANSITION)
 #define VKD3D_RESOURCE_EXTERNAL       0x00000004
@@ -483,6 +535,8 @@ struct d3d12_resource_tile_info
     unsigned int total_count;
     unsigned int standard_mip_count;
     unsigned int packed_mip_tile_count;
+    VkDeviceSize mip_tail_offset;
+    VkDeviceSize mip_tail_stride;
     unsigned int subresource_count;
     struct vkd3d_subresource_tile_info *subresources;
 };
@@ -498,6 +552,8 @@ struct d3d12_resource
     const struct vkd3d_format *format;
 
     D3D12_GPU_VIRTUAL_ADDRESS gpu_address;
+    /* Vulkan device address of buffers when root buffer addresses are used. */
+    VkDeviceAddress vk_device_address;
     union
     {
         VkBuffer vk_buffer;
@@ -584,6 +640,16 @@ HRESULT vkd3d_create_buffer(struct d3d12_device *device,
 HRESULT vkd3d_get_image_allocation_info(struct d3d12_device *device,
         const D3D12_RESOURCE_DESC1 *desc, struct vkd3d_resource_allocation_info *allocation_info);
 
+struct vkd3d_image_allocation_info_cache
+{
+    struct vkd3d_mutex mutex;
+    struct rb_tree tree;
+    unsigned int entry_count;
+};
+
+void vkd3d_image_allocation_info_cache_cleanup(struct vkd3d_image_allocation_info_cache *cache);
+void vkd3d_image_allocation_info_cache_init(struct vkd3d_image_allocation_info_cache *cache);
+
 enum vkd3d_view_type
 {
     VKD3D_VIEW_TYPE_BUFFER,
@@ -658,6 +724,18 @@ struct vkd3d_cbuffer_desc
     VkDescriptorBufferInfo vk_cbv_info;
 };
 
+/* When descriptor buffers are used, descriptor objects are followed by the
+ * descriptor data written to heaps, and for UAVs, the counter descriptor data. */
+static inline uint8_t *vkd3d_view_get_descriptor_data(struct vkd3d_view *view)
+{
+    return (uint8_t *)(view + 1);
+}
+
+static inline uint8_t *vkd3d_cbuffer_desc_get_descriptor_data(struct vkd3d_cbuffer_desc *desc)
+{
+    return (uint8_t *)(desc + 1);
+}
+
 struct d3d12_desc
 {
     struct
@@ -735,6 +813,8 @@ struct d3d12_descriptor_heap;
 
 void d3d12_desc_copy(struct d3d12_desc *dst, const struct d3d12_desc *src, struct d3d12_descriptor_heap *dst_heap,
         struct d3d12_device *device);
+void d3d12_desc_copy_range(struct d3d12_desc *dst, const struct d3d12_desc *src, unsigned int count,
+        struct d3d12_descriptor_heap *dst_heap, struct d3d12_device *device);
 void d3d12_desc_create_cbv(struct d3d12_desc *descriptor,
         struct d3d12_device *device, const D3D12_CONSTANT_BUFFER_VIEW_DESC *desc);
 void d3d12_desc_create_srv(struct d3d12_desc *descriptor,
@@ -842,6 +922,8 @@ struct d3d12_descriptor_heap_vk_set
     VkDescriptorType vk_type;
 };
 
+#define VKD3D_DESCRIPTOR_HEAP_DIRTY_RANGE_COUNT 4
+
 /* ID3D12DescriptorHeap */
 struct d3d12_descriptor_heap
 {
@@ -860,7 +942,28 @@ struct d3d12_descriptor_heap
     struct d3d12_descriptor_heap_vk_set vk_descriptor_sets[VKD3D_SET_INDEX_COUNT];
     struct vkd3d_mutex vk_sets_mutex;
 
+    /* Replaces the Vulkan descriptor sets if the device uses descriptor buffers. */
+    bool use_descriptor_buffer;
+    VkBuffer vk_descriptor_buffer;
+    VkDeviceMemory vk_descriptor_memory;
+    VkBufferUsageFlags vk_descriptor_buffer_usage;
+    VkDeviceAddress descriptor_buffer_address;
+    uint8_t *descriptor_buffer_data;
+    VkDeviceSize descriptor_buffer_set_offsets[VKD3D_SET_INDEX_COUNT];
+
     unsigned int volatile dirty_list_head;
+    /* Disjoint ranges of modified descriptors, packed as (begin << 32) | end.
+     * Zero marks an unused slot. */
+    uint64_t volatile dirty_ranges[VKD3D_DESCRIPTOR_HEAP_DIRTY_RANGE_COUNT];
+
+    /* Set when the heap is added to the device's queue of dirty heaps, and
+     * cleared by the device worker which removes it from the queue. */
+    unsigned int volatile flush_queued;
+    /* These fields are protected by the device's worker_mutex. The heap may
+     * be queued again while a worker is flushing it, so more than one worker
+     * can hold a reference to it; flush_count counts them. */
+    struct list dirty_heap_entry;
+    unsigned int flush_count;
 
     uint8_t DECLSPEC_ALIGN(sizeof(void *)) descriptors[];
 };
@@ -958,6 +1061,7 @@ struct d3d12_root_parameter
     D3D12_ROOT_PARAMETER_TYPE parameter_type;
     union
     {
+        /* Also used for root CBVs passed as buffer addresses. */
         struct d3d12_root_constant constant;
         struct d3d12_root_descriptor descriptor;
         struct d3d12_root_descriptor_table descriptor_table;
@@ -973,11 +1077,24 @@ struct d3d12_descriptor_set_layout
     unsigned int table_index;
 };
 
-/* ID3D12RootSignature */
+/* Lookup key for root signatures and pipeline states shared between COM objects. */
+struct vkd3d_shared_state_key
+{
+    uint64_t hash;
+    const void *data;
+    size_t size;
+};
+
+/* Root signature state, shared by all ID3D12RootSignature objects created
+ * from identical bytecode. */
 struct d3d12_root_signature
 {
-    ID3D12RootSignature ID3D12RootSignature_iface;
+    /* Protected by the device shared state cache mutex. */
     unsigned int refcount;
+    struct rb_entry entry;
+    struct vkd3d_shared_state_key key;
+    /* Equal for root signatures with compatible layouts. */
+    struct vkd3d_shared_state_key layout_key;
 
     VkPipelineLayout vk_pipeline_layout;
     struct d3d12_descriptor_set_layout descriptor_set_layouts[VKD3D_MAX_DESCRIPTOR_SETS];
@@ -1004,6 +1121,9 @@ struct d3d12_root_signature
 
     unsigned int root_constant_count;
     struct vkd3d_shader_push_constant_buffer *root_constants;
+    /* Root CBVs passed as buffer device addresses in push constants. */
+    unsigned int root_buffer_address_count;
+    struct vkd3d_shader_push_constant_buffer *root_buffer_addresses;
 
     unsigned int root_descriptor_count;
 
@@ -1013,15 +1133,29 @@ struct d3d12_root_signature
 
     unsigned int static_sampler_count;
     VkSampler *static_samplers;
+    /* The set holding embedded static samplers when descriptor buffers are used, or UINT_MAX. */
+    uint32_t static_sampler_set;
+
+    struct d3d12_device *device;
+};
+
+/* ID3D12RootSignature */
+struct d3d12_root_signature_object
+{
+    ID3D12RootSignature ID3D12RootSignature_iface;
+    unsigned int refcount;
 
+    struct d3d12_root_signature *root_signature;
     struct d3d12_device *device;
 
     struct vkd3d_private_store private_store;
 };
 
 HRESULT d3d12_root_signature_create(struct d3d12_device *device, const void *bytecode,
-        size_t bytecode_length, struct d3d12_root_signature **root_signature);
+        size_t bytecode_length, struct d3d12_root_signature_object **root_signature);
 struct d3d12_root_signature *unsafe_impl_from_ID3D12RootSignature(ID3D12RootSignature *iface);
+bool d3d12_root_signature_is_layout_compatible(const struct d3d12_root_signature *a,
+        const struct d3d12_root_signature *b);
 
 int vkd3d_parse_root_signature_v_1_0(const struct vkd3d_shader_code *dxbc,
         struct vkd3d_shader_versioned_root_signature_desc *desc);
@@ -1082,11 +1216,14 @@ struct d3d12_pipeline_uav_counter_state
     unsigned int binding_count;
 };
 
-/* ID3D12PipelineState */
+/* Pipeline state, shared by all ID3D12PipelineState objects created from
+ * identical descriptions. */
 struct d3d12_pipeline_state
 {
-    ID3D12PipelineState ID3D12PipelineState_iface;
+    /* Protected by the device shared state cache mutex. */
     unsigned int refcount;
+    struct rb_entry entry;
+    struct vkd3d_shared_state_key key;
 
     union
     {
@@ -1097,7 +1234,17 @@ struct d3d12_pipeline_state
 
     struct d3d12_pipeline_uav_counter_state uav_counters;
 
-    ID3D12RootSignature *implicit_root_signature;
+    struct d3d12_root_signature *root_signature;
+    struct d3d12_device *device;
+};
+
+/* ID3D12PipelineState */
+struct d3d12_pipeline_state_object
+{
+    ID3D12PipelineState ID3D12PipelineState_iface;
+    unsigned int refcount;
+
+    struct d3d12_pipeline_state *state;
     struct d3d12_device *device;
 
     struct vkd3d_private_store private_store;
@@ -1152,15 +1299,27 @@ struct d3d12_pipeline_state_desc
 };
 
 HRESULT d3d12_pipeline_state_create_compute(struct d3d12_device *device,
-        const D3D12_COMPUTE_PIPELINE_STATE_DESC *desc, struct d3d12_pipeline_state **state);
+        const D3D12_COMPUTE_PIPELINE_STATE_DESC *desc, struct d3d12_pipeline_state_object **state);
 HRESULT d3d12_pipeline_state_create_graphics(struct d3d12_device *device,
-        const D3D12_GRAPHICS_PIPELINE_STATE_DESC *desc, struct d3d12_pipeline_state **state);
+        const D3D12_GRAPHICS_PIPELINE_STATE_DESC *desc, struct d3d12_pipeline_state_object **state);
 HRESULT d3d12_pipeline_state_create(struct d3d12_device *device,
-        const D3D12_PIPELINE_STATE_STREAM_DESC *desc, struct d3d12_pipeline_state **state);
+        const D3D12_PIPELINE_STATE_STREAM_DESC *desc, struct d3d12_pipeline_state_object **state);
 VkPipeline d3d12_pipeline_state_get_or_create_pipeline(struct d3d12_pipeline_state *state,
         D3D12_PRIMITIVE_TOPOLOGY topology, const uint32_t *strides, VkFormat dsv_format, VkRenderPass *vk_render_pass);
 struct d3d12_pipeline_state *unsafe_impl_from_ID3D12PipelineState(ID3D12PipelineState *iface);
 
+/* Interns root signatures and pipeline states, keyed on their bytecode and
+ * description respectively. */
+struct vkd3d_shared_state_cache
+{
+    struct vkd3d_mutex mutex;
+    struct rb_tree root_signatures;
+    struct rb_tree pipeline_states;
+};
+
+void vkd3d_shared_state_cache_cleanup(struct vkd3d_shared_state_cache *cache);
+void vkd3d_shared_state_cache_init(struct vkd3d_shared_state_cache *cache);
+
 struct vkd3d_buffer
 {
     VkBuffer vk_buffer;
@@ -1179,6 +1338,35 @@ struct vkd3d_vk_descriptor_pool_array
     size_t capacity, count;
 };
 
+struct vkd3d_recycled_command_pool
+{
+    VkCommandPool vk_pool;
+    uint32_t vk_family_index;
+    /* Command buffers allocated from the pool, in the initial state. */
+    VkCommandBuffer *command_buffers;
+    size_t command_buffers_size;
+    size_t command_buffer_count;
+    uint64_t generation;
+};
+
+/* Command and descriptor pools of destroyed command allocators, for reuse by
+ * new allocators. */
+struct vkd3d_command_allocator_cache
+{
+    struct vkd3d_mutex mutex;
+    /* Incremented each time a command pool is recycled. The pool with the
+     * oldest generation is destroyed when the cache is full. */
+    uint64_t generation;
+
+    struct vkd3d_recycled_command_pool command_pools[VKD3D_MAX_RECYCLED_COMMAND_POOLS];
+    unsigned int command_pool_count;
+
+    struct vkd3d_vk_descriptor_pool_array descriptor_pools[VKD3D_SHADER_DESCRIPTOR_TYPE_COUNT];
+};
+
+void vkd3d_command_allocator_cache_init(struct vkd3d_command_allocator_cache *cache);
+void vkd3d_command_allocator_cache_cleanup(struct vkd3d_command_allocator_cache *cache, struct d3d12_device *device);
+
 /* ID3D12CommandAllocator */
 struct d3d12_command_allocator
 {
@@ -1189,11 +1377,10 @@ struct d3d12_command_allocator
     VkQueueFlags vk_queue_flags;
 
     VkCommandPool vk_command_pool;
+    uint32_t vk_family_index;
 
     VkDescriptorPool vk_descriptor_pools[VKD3D_SHADER_DESCRIPTOR_TYPE_COUNT];
 
-    struct vkd3d_vk_descriptor_pool_array free_descriptor_pools[VKD3D_SHADER_DESCRIPTOR_TYPE_COUNT];
-
     VkRenderPass *passes;
     size_t passes_size;
     size_t pass_count;
@@ -1203,6 +1390,7 @@ struct d3d12_command_allocator
     size_t framebuffer_count;
 
     struct vkd3d_vk_descriptor_pool_array descriptor_pools[VKD3D_SHADER_DESCRIPTOR_TYPE_COUNT];
+    size_t used_descriptor_pool_counts[VKD3D_SHADER_DESCRIPTOR_TYPE_COUNT];
     unsigned int vk_pool_sizes[VKD3D_SHADER_DESCRIPTOR_TYPE_COUNT];
 
     struct vkd3d_view **views;
@@ -1217,9 +1405,11 @@ struct d3d12_command_allocator
     size_t transfer_buffers_size;
     size_t transfer_buffer_count;
 
+    /* Command buffers are kept across resets, and are reused in order. */
     VkCommandBuffer *command_buffers;
     size_t command_buffers_size;
     size_t command_buffer_count;
+    size_t next_command_buffer;
 
     struct d3d12_command_list *current_command_list;
     struct d3d12_device *device;
@@ -1264,6 +1454,8 @@ struct vkd3d_pipeline_bindings
     size_t vk_uav_counter_views_size;
     bool uav_counters_dirty;
 
+    bool static_samplers_dirty;
+
     /* Needed when VK_KHR_push_descriptor is not available. */
     struct vkd3d_push_descriptor push_descriptors[D3D12_MAX_ROOT_COST / 2];
     uint32_t push_descriptor_dirty_mask;
@@ -1278,6 +1470,64 @@ enum vkd3d_pipeline_bind_point
 };
 
 /* ID3D12CommandList */
+enum vkd3d_translation_state
+{
+    VKD3D_TRANSLATION_IDLE,
+    VKD3D_TRANSLATION_QUEUED,
+    VKD3D_TRANSLATION_ACTIVE,
+};
+
+/* Commands recorded in a compact stream, and translated to Vulkan commands
+ * by the device workers after Close(). */
+struct d3d12_deferred_commands
+{
+    bool enabled;
+    bool replaying;
+
+    uint8_t *data;
+    size_t size;
+    size_t capacity;
+
+    /* Last recorded state, used to drop redundant calls. */
+    ID3D12PipelineState *pipeline_state;
+    ID3D12RootSignature *root_signatures[VKD3D_PIPELINE_BIND_POINT_COUNT];
+    D3D12_PRIMITIVE_TOPOLOGY primitive_topology;
+
+    /* Protected by the device worker mutex. */
+    enum vkd3d_translation_state translation_state;
+    struct list entry;
+};
+
+enum vkd3d_dynamic_state_flags
+{
+    VKD3D_DYNAMIC_STATE_VIEWPORTS = 0x00000001,
+    VKD3D_DYNAMIC_STATE_SCISSORS = 0x00000002,
+    VKD3D_DYNAMIC_STATE_BLEND_FACTOR = 0x00000004,
+    VKD3D_DYNAMIC_STATE_STENCIL_REF = 0x00000008,
+    VKD3D_DYNAMIC_STATE_INDEX_BUFFER = 0x00000010,
+};
+
+/* State last recorded into the Vulkan command buffer, used to drop redundant
+ * calls. Vulkan leaves dynamic state undefined at the start of a command
+ * buffer, so nothing is valid until it has been set once. */
+struct vkd3d_dynamic_state
+{
+    uint32_t valid_flags;
+
+    VkViewport viewports[D3D12_VIEWPORT_AND_SCISSORRECT_OBJECT_COUNT_PER_PIPELINE];
+    VkRect2D scissors[D3D12_VIEWPORT_AND_SCISSORRECT_OBJECT_COUNT_PER_PIPELINE];
+    float blend_factor[4];
+    uint32_t stencil_ref;
+
+    VkBuffer index_buffer;
+    VkDeviceSize index_buffer_offset;
+    VkIndexType index_type;
+
+    uint32_t vertex_buffer_mask;
+    VkBuffer vertex_buffers[D3D12_IA_VERTEX_INPUT_RESOURCE_SLOT_COUNT];
+    VkDeviceSize vertex_buffer_offsets[D3D12_IA_VERTEX_INPUT_RESOURCE_SLOT_COUNT];
+};
+
 struct d3d12_command_list
 {
     ID3D12GraphicsCommandList6 ID3D12GraphicsCommandList6_iface;
@@ -1314,6 +1564,8 @@ struct d3d12_command_list
 
     struct d3d12_pipeline_state *state;
 
+    struct vkd3d_dynamic_state dynamic_state;
+
     struct d3d12_command_allocator *allocator;
     struct d3d12_device *device;
 
@@ -1323,12 +1575,20 @@ struct d3d12_command_list
     struct d3d12_descriptor_heap *descriptor_heaps[64];
     unsigned int descriptor_heap_count;
 
+    /* Heaps bound with vkCmdBindDescriptorBuffersEXT(), indexed by
+     * D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV and D3D12_DESCRIPTOR_HEAP_TYPE_SAMPLER. */
+    struct d3d12_descriptor_heap *descriptor_buffer_heaps[2];
+    uint32_t descriptor_buffer_indices[2];
+
+    struct d3d12_deferred_commands deferred;
+
     struct vkd3d_private_store private_store;
 };
 
 HRESULT d3d12_command_list_create(struct d3d12_device *device,
         UINT node_mask, D3D12_COMMAND_LIST_TYPE type, ID3D12CommandAllocator *allocator_iface,
         ID3D12PipelineState *initial_pipeline_state, struct d3d12_command_list **list);
+void d3d12_command_list_translate(struct d3d12_command_list *list);
 
 struct vkd3d_queue
 {
@@ -1369,6 +1629,9 @@ enum vkd3d_cs_op
     VKD3D_CS_OP_EXECUTE,
     VKD3D_CS_OP_UPDATE_MAPPINGS,
     VKD3D_CS_OP_COPY_MAPPINGS,
+    VKD3D_CS_OP_BEGIN_LABEL,
+    VKD3D_CS_OP_END_LABEL,
+    VKD3D_CS_OP_INSERT_LABEL,
 };
 
 struct vkd3d_cs_wait
@@ -1413,6 +1676,12 @@ struct vkd3d_cs_copy_mappings
     D3D12_TILE_MAPPING_FLAGS flags;
 };
 
+struct vkd3d_cs_label
+{
+    /* NULL if the PIX event could not be decoded. */
+    char *name;
+};
+
 struct vkd3d_cs_op_data
 {
     enum vkd3d_cs_op opcode;
@@ -1423,14 +1692,51 @@ struct vkd3d_cs_op_data
         struct vkd3d_cs_execute execute;
         struct vkd3d_cs_update_mappings update_mappings;
         struct vkd3d_cs_copy_mappings copy_mappings;
+        struct vkd3d_cs_label label;
     } u;
 };
 
+struct vkd3d_cs_arena_block;
+
+/* Storage for op parameters. It is released once the ops have been executed. */
+struct vkd3d_cs_arena
+{
+    struct vkd3d_cs_arena_block *blocks;
+    struct vkd3d_cs_arena_block *free_blocks;
+};
+
 struct d3d12_command_queue_op_array
 {
     struct vkd3d_cs_op_data *ops;
     size_t count;
     size_t size;
+    struct vkd3d_cs_arena arena;
+};
+
+struct vkd3d_sparse_bind_arrays
+{
+    VkSparseMemoryBind *memory_binds;
+    size_t memory_binds_size;
+    size_t memory_bind_count;
+
+    VkSparseImageMemoryBind *image_binds;
+    size_t image_binds_size;
+    size_t image_bind_count;
+
+    VkSparseBufferMemoryBindInfo *buffer_infos;
+    size_t buffer_infos_size;
+    VkSparseImageOpaqueMemoryBindInfo *opaque_infos;
+    size_t opaque_infos_size;
+    VkSparseImageMemoryBindInfo *image_infos;
+    size_t image_infos_size;
+    VkBindSparseInfo *bind_infos;
+    size_t bind_infos_size;
+    size_t bind_info_count;
+
+    VkTimelineSemaphoreSubmitInfoKHR *timeline_infos;
+    size_t timeline_infos_size;
+    uint64_t *semaphore_values;
+    size_t semaphore_values_size;
 };
 
 /* ID3D12CommandQueue */
@@ -1459,6 +1765,16 @@ struct d3d12_command_queue
      * by the thread that set is_flushing; when is_flushing is not
      * set, aux_op_queue.count must be zero. */
     struct d3d12_command_queue_op_array aux_op_queue;
+    /* Like aux_op_queue, only used by the thread that set is_flushing. */
+    struct vkd3d_sparse_bind_arrays sparse_binds;
+    /* Orders sparse binds against the other submissions to the queue. A
+     * single timeline semaphore if supported, else a pair of binary ones,
+     * alternating by value. If sparse_wait_pending is set, value
+     * sparse_semaphore_value is signalled and the next submission or bind
+     * must wait for it. Only accessed with vkd3d_queue acquired. */
+    VkSemaphore vk_sparse_semaphores[2];
+    uint64_t sparse_semaphore_value;
+    bool sparse_wait_pending;
 
     bool supports_sparse_binding;
 
@@ -1486,11 +1802,15 @@ HRESULT d3d12_command_signature_create(struct d3d12_device *device,
         const D3D12_COMMAND_SIGNATURE_DESC *desc, struct d3d12_command_signature **signature);
 struct d3d12_command_signature *unsafe_impl_from_ID3D12CommandSignature(ID3D12CommandSignature *iface);
 
-/* NULL resources */
+/* NULL resources. These are created on first use. */
 struct vkd3d_null_resources
 {
+    struct vkd3d_mutex mutex;
+    uint32_t volatile initialised;
+
     VkBuffer vk_buffer;
     VkDeviceMemory vk_buffer_memory;
+    VkDeviceAddress vk_buffer_address;
 
     VkBuffer vk_storage_buffer;
     VkDeviceMemory vk_storage_buffer_memory;
@@ -1502,8 +1822,9 @@ struct vkd3d_null_resources
     VkDeviceMemory vk_2d_storage_image_memory;
 };
 
-HRESULT vkd3d_init_null_resources(struct vkd3d_null_resources *null_resources, struct d3d12_device *device);
+void vkd3d_init_null_resources(struct vkd3d_null_resources *null_resources);
 void vkd3d_destroy_null_resources(struct vkd3d_null_resources *null_resources, struct d3d12_device *device);
+const struct vkd3d_null_resources *vkd3d_get_null_resources(struct d3d12_device *device);
 
 struct vkd3d_format_compatibility_list
 {
@@ -1519,18 +1840,29 @@ struct vkd3d_uav_clear_args
     VkExtent2D extent;
 };
 
+enum vkd3d_uav_clear_pipeline_type
+{
+    VKD3D_UAV_CLEAR_PIPELINE_BUFFER,
+    VKD3D_UAV_CLEAR_PIPELINE_IMAGE_1D,
+    VKD3D_UAV_CLEAR_PIPELINE_IMAGE_1D_ARRAY,
+    VKD3D_UAV_CLEAR_PIPELINE_IMAGE_2D,
+    VKD3D_UAV_CLEAR_PIPELINE_IMAGE_2D_ARRAY,
+    VKD3D_UAV_CLEAR_PIPELINE_IMAGE_3D,
+    VKD3D_UAV_CLEAR_PIPELINE_COUNT,
+};
+
 struct vkd3d_uav_clear_pipelines
 {
-    VkPipeline buffer;
-    VkPipeline image_1d;
-    VkPipeline image_1d_array;
-    VkPipeline image_2d;
-    VkPipeline image_2d_array;
-    VkPipeline image_3d;
+    VkPipeline vk_pipelines[VKD3D_UAV_CLEAR_PIPELINE_COUNT];
+    /* A bit is set, with release semantics, once the pipeline is created. */
+    uint32_t volatile created_mask;
 };
 
+/* Pipelines are created on first use; "mutex" protects their creation. */
 struct vkd3d_uav_clear_state
 {
+    struct vkd3d_mutex mutex;
+
     VkDescriptorSetLayout vk_set_layout_buffer;
     VkDescriptorSetLayout vk_set_layout_image;
 
@@ -1541,8 +1873,10 @@ struct vkd3d_uav_clear_state
     struct vkd3d_uav_clear_pipelines pipelines_uint;
 };
 
-HRESULT vkd3d_uav_clear_state_init(struct vkd3d_uav_clear_state *state, struct d3d12_device *device);
+void vkd3d_uav_clear_state_init(struct vkd3d_uav_clear_state *state);
 void vkd3d_uav_clear_state_cleanup(struct vkd3d_uav_clear_state *state, struct d3d12_device *device);
+HRESULT vkd3d_uav_clear_state_get_pipeline(struct vkd3d_uav_clear_state *state, struct d3d12_device *device,
+        struct vkd3d_uav_clear_pipelines *pipelines, enum vkd3d_uav_clear_pipeline_type type);
 
 struct desc_object_cache_head
 {
@@ -1550,6 +1884,17 @@ struct desc_object_cache_head
     unsigned int spinlock;
 };
 
+struct vkd3d_descriptor_buffer_info
+{
+    /* Indexed by enum vkd3d_vk_descriptor_set_index. */
+    VkDeviceSize binding_offsets[VKD3D_SET_INDEX_COUNT];
+    VkDeviceSize descriptor_sizes[VKD3D_SET_INDEX_COUNT];
+    /* Indexed by VkDescriptorType. */
+    size_t type_sizes[VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER + 1];
+    VkDeviceSize offset_alignment;
+    size_t max_descriptor_size;
+};
+
 struct vkd3d_desc_object_cache
 {
     struct desc_object_cache_head heads[16];
@@ -1572,6 +1917,7 @@ struct d3d12_device
     enum vkd3d_shader_spirv_environment environment;
 
     struct vkd3d_gpu_va_allocator gpu_va_allocator;
+    struct vkd3d_residency_manager residency_manager;
 
     struct vkd3d_desc_object_cache view_desc_cache;
     struct vkd3d_desc_object_cache cbuffer_desc_cache;
@@ -1579,19 +1925,33 @@ struct d3d12_device
     unsigned int vk_pool_limits[VKD3D_SHADER_DESCRIPTOR_TYPE_COUNT];
     struct vkd3d_vk_descriptor_heap_layout vk_descriptor_heap_layouts[VKD3D_SET_INDEX_COUNT];
     bool use_vk_heaps;
-
-    struct d3d12_descriptor_heap **heaps;
-    size_t heap_capacity;
-    size_t heap_count;
-    union vkd3d_thread_handle worker_thread;
+    bool use_descriptor_buffers;
+    bool use_root_buffer_addresses;
+    struct vkd3d_descriptor_buffer_info descriptor_buffer;
+
+    struct list dirty_heaps;
+    struct list copy_jobs;
+    struct list translation_jobs;
+    /* The workers are started when the first job is queued. */
+    union vkd3d_thread_handle worker_threads[VKD3D_MAX_DEVICE_WORKER_COUNT];
+    unsigned int worker_count;
     struct vkd3d_mutex worker_mutex;
     struct vkd3d_cond worker_cond;
+    struct vkd3d_cond worker_idle_cond;
+    bool worker_started;
     bool worker_should_exit;
 
     struct vkd3d_mutex pipeline_cache_mutex;
     struct vkd3d_render_pass_cache render_pass_cache;
     VkPipelineCache vk_pipeline_cache;
 
+    struct vkd3d_image_allocation_info_cache image_allocation_info_cache;
+    struct vkd3d_command_allocator_cache command_allocator_cache;
+    struct vkd3d_shared_state_cache shared_state_cache;
+
+    struct vkd3d_device_statistics statistics;
+    uint64_t statistics_dump_time;
+
     VkPhysicalDeviceMemoryProperties memory_properties;
 
     D3D12_FEATURE_DATA_D3D12_OPTIONS feature_options;
@@ -1624,6 +1984,7 @@ struct d3d12_device
     HRESULT removed_reason;
 
     const struct vkd3d_format *depth_stencil_formats;
+    struct vkd3d_format_table_entry *format_table;
     unsigned int format_compatibility_list_count;
     const struct vkd3d_format_compatibility_list *format_compatibility_lists;
     struct vkd3d_null_resources null_resources;
@@ -1637,8 +1998,16 @@ bool d3d12_device_is_uma(struct d3d12_device *device, bool *coherent);
 void d3d12_device_mark_as_removed(struct d3d12_device *device, HRESULT reason,
         const char *message, ...) VKD3D_PRINTF_FUNC(3, 4);
 struct d3d12_device *unsafe_impl_from_ID3D12Device9(ID3D12Device9 *iface);
-HRESULT d3d12_device_add_descriptor_heap(struct d3d12_device *device, struct d3d12_descriptor_heap *heap);
+void d3d12_device_queue_descriptor_heap_flush(struct d3d12_device *device, struct d3d12_descriptor_heap *heap);
 void d3d12_device_remove_descriptor_heap(struct d3d12_device *device, struct d3d12_descriptor_heap *heap);
+struct vkd3d_subresource_copy;
+void d3d12_device_copy_subresource(struct d3d12_device *device, struct vkd3d_subresource_copy *copy);
+void d3d12_device_queue_command_list_translation(struct d3d12_device *device, struct d3d12_command_list *list);
+void d3d12_device_wait_command_list_translation(struct d3d12_device *device, struct d3d12_command_list *list);
+void d3d12_device_dump_statistics(struct d3d12_device *device);
+
+#define d3d12_device_add_statistic(device, member, value) \
+        vkd3d_atomic_add_u64_relaxed(&(device)->statistics.member, value)
 
 static inline HRESULT d3d12_device_query_interface(struct d3d12_device *device, REFIID iid, void **object)
 {
@@ -1684,6 +2053,22 @@ struct vkd3d_format
     bool is_emulated;
 };
 
+#define VKD3D_FORMAT_TABLE_SIZE (DXGI_FORMAT_B4G4R4A4_UNORM + 1)
+
+/* Resolved formats and their support on the device, indexed by DXGI format. */
+struct vkd3d_format_table_entry
+{
+    const struct vkd3d_format *format;
+    const struct vkd3d_format *depth_stencil_format;
+    VkFormatFeatureFlags image_features;
+    VkFormatFeatureFlags buffer_features;
+    D3D12_FORMAT_SUPPORT1 support1;
+    D3D12_FORMAT_SUPPORT2 support2;
+};
+
+const struct vkd3d_format_table_entry *vkd3d_get_format_table_entry(const struct d3d12_device *device,
+        DXGI_FORMAT dxgi_format);
+
 static inline size_t vkd3d_format_get_data_offset(const struct vkd3d_format *format,
         unsigned int row_pitch, unsigned int slice_pitch,
         unsigned int x, unsigned int y, unsigned int z)
@@ -1698,9 +2083,32 @@ static inline bool vkd3d_format_is_compressed(const struct vkd3d_format *format)
     return format->block_byte_count != 1;
 }
 
-void vkd3d_format_copy_data(const struct vkd3d_format *format, const uint8_t *src,
+struct vkd3d_subresource_copy
+{
+    const uint8_t *src;
+    size_t src_row_pitch;
+    size_t src_slice_pitch;
+    uint8_t *dst;
+    size_t dst_row_pitch;
+    size_t dst_slice_pitch;
+    size_t row_size;
+    unsigned int row_count;
+    unsigned int slice_count;
+    /* Use non-temporal stores, e.g. for write-combined memory. */
+    bool non_temporal;
+
+    /* Protected by the device worker mutex. */
+    struct list entry;
+    unsigned int chunk_count;
+    unsigned int next_chunk;
+    unsigned int pending_chunk_count;
+};
+
+void vkd3d_subresource_copy_rows(const struct vkd3d_subresource_copy *copy,
+        unsigned int start_row, unsigned int end_row);
+void vkd3d_format_copy_data(struct d3d12_device *device, const struct vkd3d_format *format, const uint8_t *src,
         unsigned int src_row_pitch, unsigned int src_slice_pitch, uint8_t *dst, unsigned int dst_row_pitch,
-        unsigned int dst_slice_pitch, unsigned int w, unsigned int h, unsigned int d);
+        unsigned int dst_slice_pitch, unsigned int w, unsigned int h, unsigned int d, bool non_temporal);
 
 const struct vkd3d_format *vkd3d_get_format(const struct d3d12_device *device,
         DXGI_FORMAT dxgi_format, bool depth_stencil);
@@ -1796,6 +2204,28 @@ VkResult vkd3d_set_vk_object_name_utf8(struct d3d12_device *device, uint64_t vk_
         VkDebugReportObjectTypeEXT vk_object_type, const char *name);
 HRESULT vkd3d_set_vk_object_name(struct d3d12_device *device, uint64_t vk_object,
         VkDebugReportObjectTypeEXT vk_object_type, const WCHAR *name);
+char *vkd3d_strdup_marker(UINT metadata, const void *data, UINT size, size_t wchar_size);
+
+extern bool vkd3d_trace_enabled;
+
+void vkd3d_trace_init(void);
+void vkd3d_trace_flush(void);
+void vkd3d_trace_span_end(const char *name, uint64_t start_time);
+void vkd3d_trace_marker(char phase, UINT metadata, const void *data, UINT size, size_t wchar_size);
+
+/* Returns 0 if tracing is disabled, in which case vkd3d_trace_span_end() does nothing. */
+static inline uint64_t vkd3d_trace_span_begin(void)
+{
+    return vkd3d_trace_enabled ? vkd3d_get_monotonic_time_ns() : 0;
+}
+
+static inline void vk_debug_utils_label_init(VkDebugUtilsLabelEXT *label, const char *name)
+{
+    label->sType = VK_STRUCTURE_TYPE_DEBUG_UTILS_LABEL_EXT;
+    label->pNext = NULL;
+    label->pLabelName = name ? name : "PIX event";
+    memset(label->color, 0, sizeof(label->color));
+}
 
 static inline void vk_prepend_struct(void *header, void *structure)
 {
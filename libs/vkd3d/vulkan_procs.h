@@ -49,6 +49,7 @@ VK_INSTANCE_PFN(vkGetPhysicalDeviceSparseImageFormatProperties)
 
 /* VK_KHR_get_physical_device_properties2 */
 VK_INSTANCE_EXT_PFN(vkGetPhysicalDeviceFeatures2KHR)
+VK_INSTANCE_EXT_PFN(vkGetPhysicalDeviceMemoryProperties2KHR)
 VK_INSTANCE_EXT_PFN(vkGetPhysicalDeviceProperties2KHR)
 
 /* VK_EXT_debug_report */
@@ -180,6 +181,9 @@ VK_DEVICE_PFN(vkUnmapMemory)
 VK_DEVICE_PFN(vkUpdateDescriptorSets)
 VK_DEVICE_PFN(vkWaitForFences)
 
+/* VK_KHR_buffer_device_address */
+VK_DEVICE_EXT_PFN(vkGetBufferDeviceAddressKHR)
+
 /* VK_KHR_draw_indirect_count */
 VK_DEVICE_EXT_PFN(vkCmdDrawIndirectCountKHR)
 VK_DEVICE_EXT_PFN(vkCmdDrawIndexedIndirectCountKHR)
@@ -192,6 +196,9 @@ VK_DEVICE_EXT_PFN(vkGetImageSparseMemoryRequirements2KHR)
 /* VK_KHR_maintenance3 */
 VK_DEVICE_EXT_PFN(vkGetDescriptorSetLayoutSupportKHR)
 
+/* VK_KHR_maintenance4 */
+VK_DEVICE_EXT_PFN(vkGetDeviceImageMemoryRequirementsKHR)
+
 /* VK_KHR_push_descriptor */
 VK_DEVICE_EXT_PFN(vkCmdPushDescriptorSetKHR)
 
@@ -210,6 +217,24 @@ VK_DEVICE_EXT_PFN(vkCmdEndConditionalRenderingEXT)
 /* VK_EXT_debug_marker */
 VK_DEVICE_EXT_PFN(vkDebugMarkerSetObjectNameEXT)
 
+/* VK_EXT_debug_utils */
+VK_DEVICE_EXT_PFN(vkCmdBeginDebugUtilsLabelEXT)
+VK_DEVICE_EXT_PFN(vkCmdEndDebugUtilsLabelEXT)
+VK_DEVICE_EXT_PFN(vkCmdInsertDebugUtilsLabelEXT)
+VK_DEVICE_EXT_PFN(vkQueueBeginDebugUtilsLabelEXT)
+VK_DEVICE_EXT_PFN(vkQueueEndDebugUtilsLabelEXT)
+VK_DEVICE_EXT_PFN(vkQueueInsertDebugUtilsLabelEXT)
+
+/* VK_EXT_descriptor_buffer */
+VK_DEVICE_EXT_PFN(vkCmdBindDescriptorBufferEmbeddedSamplersEXT)
+VK_DEVICE_EXT_PFN(vkCmdBindDescriptorBuffersEXT)
+VK_DEVICE_EXT_PFN(vkCmdSetDescriptorBufferOffsetsEXT)
+VK_DEVICE_EXT_PFN(vkGetDescriptorEXT)
+VK_DEVICE_EXT_PFN(vkGetDescriptorSetLayoutBindingOffsetEXT)
+
+/* VK_EXT_pageable_device_local_memory */
+VK_DEVICE_EXT_PFN(vkSetDeviceMemoryPriorityEXT)
+
 /* VK_EXT_transform_feedback */
 VK_DEVICE_EXT_PFN(vkCmdBeginQueryIndexedEXT)
 VK_DEVICE_EXT_PFN(vkCmdBeginTransformFeedbackEXT)
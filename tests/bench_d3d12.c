@@ -0,0 +1,346 @@
+/*
+ * Direct3D 12 micro-benchmarks
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301, USA
+ */
+
+/* CPU-side micro-benchmarks for the Direct3D 12 API. These don't depend on
+ * GPU throughput, and are meant to be run on a software driver like
+ * lavapipe. Each result is written to stdout as a single line of JSON:
+ *
+ *     {"benchmark":"<name>","iterations":<count>,"ns_per_iteration":<time>}
+ *
+ * The iteration counts can be scaled with the VKD3D_BENCH_SCALE environment
+ * variable. */
+
+#include "d3d12_crosstest.h"
+
+VKD3D_AGILITY_SDK_EXPORTS
+
+struct test_options test_options = {0};
+
+static unsigned int bench_scale = 1;
+
+struct bench_timer
+{
+    const char *name;
+    unsigned int iterations;
+    uint64_t start;
+};
+
+static unsigned int bench_iterations(unsigned int count)
+{
+    return count * bench_scale;
+}
+
+static void bench_start(struct bench_timer *timer, const char *name, unsigned int iterations)
+{
+    timer->name = name;
+    timer->iterations = iterations;
+    timer->start = vkd3d_get_monotonic_time_ns();
+}
+
+static void bench_end(struct bench_timer *timer)
+{
+    uint64_t elapsed = vkd3d_get_monotonic_time_ns() - timer->start;
+
+    printf("{\"benchmark\":\"%s\",\"iterations\":%u,\"ns_per_iteration\":%.1f}\n",
+            timer->name, timer->iterations, (double)elapsed / timer->iterations);
+    fflush(stdout);
+}
+
+static void bench_descriptors(void)
+{
+    unsigned int descriptor_size, iteration_count, i, j;
+    D3D12_CONSTANT_BUFFER_VIEW_DESC cbv_desc;
+    D3D12_SHADER_RESOURCE_VIEW_DESC srv_desc;
+    D3D12_CPU_DESCRIPTOR_HANDLE cpu_handle;
+    ID3D12DescriptorHeap *cpu_heap, *heap;
+    D3D12_SAMPLER_DESC sampler_desc;
+    ID3D12DescriptorHeap *sampler_heap;
+    struct bench_timer timer;
+    ID3D12Resource *buffer;
+    ID3D12Device *device;
+    ULONG refcount;
+
+    static const unsigned int descriptor_count = 1024;
+
+    if (!(device = create_device()))
+    {
+        skip("Failed to create device.\n");
+        return;
+    }
+
+    cpu_heap = create_cpu_descriptor_heap(device, D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV, descriptor_count);
+    heap = create_gpu_descriptor_heap(device, D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV, descriptor_count);
+    sampler_heap = create_cpu_descriptor_heap(device, D3D12_DESCRIPTOR_HEAP_TYPE_SAMPLER, descriptor_count);
+    descriptor_size = ID3D12Device_GetDescriptorHandleIncrementSize(device, D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV);
+    buffer = create_upload_buffer(device, descriptor_count * 256, NULL);
+
+    iteration_count = bench_iterations(64);
+
+    cbv_desc.SizeInBytes = 256;
+    bench_start(&timer, "create_cbv", iteration_count * descriptor_count);
+    for (i = 0; i < iteration_count; ++i)
+    {
+        cpu_handle = ID3D12DescriptorHeap_GetCPUDescriptorHandleForHeapStart(cpu_heap);
+        for (j = 0; j < descriptor_count; ++j, cpu_handle.ptr += descriptor_size)
+        {
+            cbv_desc.BufferLocation = ID3D12Resource_GetGPUVirtualAddress(buffer) + j * 256;
+            ID3D12Device_CreateConstantBufferView(device, &cbv_desc, cpu_handle);
+        }
+    }
+    bench_end(&timer);
+
+    memset(&srv_desc, 0, sizeof(srv_desc));
+    srv_desc.Format = DXGI_FORMAT_R32_UINT;
+    srv_desc.ViewDimension = D3D12_SRV_DIMENSION_BUFFER;
+    srv_desc.Shader4ComponentMapping = D3D12_DEFAULT_SHADER_4_COMPONENT_MAPPING;
+    srv_desc.Buffer.NumElements = 64;
+    bench_start(&timer, "create_buffer_srv", iteration_count * descriptor_count);
+    for (i = 0; i < iteration_count; ++i)
+    {
+        cpu_handle = ID3D12DescriptorHeap_GetCPUDescriptorHandleForHeapStart(cpu_heap);
+        for (j = 0; j < descriptor_count; ++j, cpu_handle.ptr += descriptor_size)
+        {
+            srv_desc.Buffer.FirstElement = j * 64;
+            ID3D12Device_CreateShaderResourceView(device, buffer, &srv_desc, cpu_handle);
+        }
+    }
+    bench_end(&timer);
+
+    memset(&sampler_desc, 0, sizeof(sampler_desc));
+    sampler_desc.AddressU = D3D12_TEXTURE_ADDRESS_MODE_WRAP;
+    sampler_desc.AddressV = D3D12_TEXTURE_ADDRESS_MODE_WRAP;
+    sampler_desc.AddressW = D3D12_TEXTURE_ADDRESS_MODE_WRAP;
+    bench_start(&timer, "create_sampler", iteration_count * descriptor_count);
+    for (i = 0; i < iteration_count; ++i)
+    {
+        for (j = 0; j < descriptor_count; ++j)
+        {
+            /* Cycle through a few distinct samplers. */
+            sampler_desc.Filter = (j & 1) ? D3D12_FILTER_MIN_MAG_MIP_LINEAR : D3D12_FILTER_MIN_MAG_MIP_POINT;
+            sampler_desc.MaxLOD = (float)(j & 7);
+            ID3D12Device_CreateSampler(device, &sampler_desc,
+                    get_cpu_handle(device, sampler_heap, D3D12_DESCRIPTOR_HEAP_TYPE_SAMPLER, j));
+        }
+    }
+    bench_end(&timer);
+
+    bench_start(&timer, "copy_descriptors_simple", iteration_count * descriptor_count);
+    for (i = 0; i < iteration_count; ++i)
+    {
+        for (j = 0; j < descriptor_count; ++j)
+            ID3D12Device_CopyDescriptorsSimple(device, 1,
+                    get_cpu_handle(device, heap, D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV, j),
+                    get_cpu_handle(device, cpu_heap, D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV, j),
+                    D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV);
+    }
+    bench_end(&timer);
+
+    bench_start(&timer, "copy_descriptors_range", iteration_count * descriptor_count);
+    for (i = 0; i < iteration_count; ++i)
+    {
+        ID3D12Device_CopyDescriptorsSimple(device, descriptor_count,
+                ID3D12DescriptorHeap_GetCPUDescriptorHandleForHeapStart(heap),
+                ID3D12DescriptorHeap_GetCPUDescriptorHandleForHeapStart(cpu_heap),
+                D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV);
+    }
+    bench_end(&timer);
+
+    ID3D12Resource_Release(buffer);
+    ID3D12DescriptorHeap_Release(sampler_heap);
+    ID3D12DescriptorHeap_Release(heap);
+    ID3D12DescriptorHeap_Release(cpu_heap);
+    refcount = ID3D12Device_Release(device);
+    ok(!refcount, "ID3D12Device has %u references left.\n", (unsigned int)refcount);
+}
+
+static void record_draws(struct test_context *context, unsigned int draw_count, bool switch_topology)
+{
+    ID3D12GraphicsCommandList *command_list = context->list;
+    unsigned int i;
+
+    ID3D12GraphicsCommandList_OMSetRenderTargets(command_list, 1, &context->rtv, false, NULL);
+    ID3D12GraphicsCommandList_SetGraphicsRootSignature(command_list, context->root_signature);
+    ID3D12GraphicsCommandList_SetPipelineState(command_list, context->pipeline_state);
+    ID3D12GraphicsCommandList_IASetPrimitiveTopology(command_list, D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+    ID3D12GraphicsCommandList_RSSetViewports(command_list, 1, &context->viewport);
+    ID3D12GraphicsCommandList_RSSetScissorRects(command_list, 1, &context->scissor_rect);
+
+    for (i = 0; i < draw_count; ++i)
+    {
+        /* Each topology change requires a different Vulkan pipeline. */
+        if (switch_topology)
+            ID3D12GraphicsCommandList_IASetPrimitiveTopology(command_list,
+                    (i & 1) ? D3D_PRIMITIVE_TOPOLOGY_TRIANGLESTRIP : D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+        ID3D12GraphicsCommandList_DrawInstanced(command_list, 3, 1, 0, 0);
+    }
+}
+
+static void bench_command_list_recording(void)
+{
+    unsigned int iteration_count, i;
+    struct test_context context;
+    struct bench_timer timer;
+    HRESULT hr;
+
+    static const unsigned int draw_count = 1024;
+
+    if (!init_test_context(&context, NULL))
+        return;
+
+    /* Create the pipeline variants up front. */
+    record_draws(&context, 2, true);
+    hr = ID3D12GraphicsCommandList_Close(context.list);
+    ok(hr == S_OK, "Failed to close command list, hr %#x.\n", hr);
+    exec_command_list(context.queue, context.list);
+    wait_queue_idle(context.device, context.queue);
+
+    iteration_count = bench_iterations(32);
+
+    bench_start(&timer, "record_draw", iteration_count * draw_count);
+    for (i = 0; i < iteration_count; ++i)
+    {
+        reset_command_list(context.list, context.allocator);
+        record_draws(&context, draw_count, false);
+        hr = ID3D12GraphicsCommandList_Close(context.list);
+        ok(hr == S_OK, "Failed to close command list, hr %#x.\n", hr);
+    }
+    bench_end(&timer);
+
+    bench_start(&timer, "record_draw_pipeline_variant", iteration_count * draw_count);
+    for (i = 0; i < iteration_count; ++i)
+    {
+        reset_command_list(context.list, context.allocator);
+        record_draws(&context, draw_count, true);
+        hr = ID3D12GraphicsCommandList_Close(context.list);
+        ok(hr == S_OK, "Failed to close command list, hr %#x.\n", hr);
+    }
+    bench_end(&timer);
+
+    destroy_test_context(&context);
+}
+
+static void bench_submission(void)
+{
+    ID3D12GraphicsCommandList *command_list;
+    unsigned int iteration_count, i;
+    struct test_context_desc desc;
+    struct test_context context;
+    struct bench_timer timer;
+    ID3D12Fence *fence;
+    uint64_t value = 0;
+    HRESULT hr;
+
+    memset(&desc, 0, sizeof(desc));
+    desc.no_render_target = true;
+    if (!init_test_context(&context, &desc))
+        return;
+    command_list = context.list;
+
+    hr = ID3D12Device_CreateFence(context.device, 0, D3D12_FENCE_FLAG_NONE,
+            &IID_ID3D12Fence, (void **)&fence);
+    ok(hr == S_OK, "Failed to create fence, hr %#x.\n", hr);
+
+    hr = ID3D12GraphicsCommandList_Close(command_list);
+    ok(hr == S_OK, "Failed to close command list, hr %#x.\n", hr);
+
+    iteration_count = bench_iterations(1024);
+
+    bench_start(&timer, "signal_wait", iteration_count);
+    for (i = 0; i < iteration_count; ++i)
+    {
+        queue_signal(context.queue, fence, ++value);
+        hr = wait_for_fence(fence, value);
+        ok(hr == S_OK, "Failed to wait for fence, hr %#x.\n", hr);
+    }
+    bench_end(&timer);
+
+    bench_start(&timer, "execute_signal_wait", iteration_count);
+    for (i = 0; i < iteration_count; ++i)
+    {
+        exec_command_list(context.queue, command_list);
+        queue_signal(context.queue, fence, ++value);
+        hr = wait_for_fence(fence, value);
+        ok(hr == S_OK, "Failed to wait for fence, hr %#x.\n", hr);
+    }
+    bench_end(&timer);
+
+    ID3D12Fence_Release(fence);
+    destroy_test_context(&context);
+}
+
+static void bench_resource_creation(void)
+{
+    unsigned int iteration_count, i;
+    struct bench_timer timer;
+    ID3D12Resource *resource;
+    ID3D12Device *device;
+    ULONG refcount;
+
+    if (!(device = create_device()))
+    {
+        skip("Failed to create device.\n");
+        return;
+    }
+
+    iteration_count = bench_iterations(256);
+
+    bench_start(&timer, "create_committed_buffer", iteration_count);
+    for (i = 0; i < iteration_count; ++i)
+    {
+        resource = create_default_buffer(device, 65536, 0, D3D12_RESOURCE_STATE_COMMON);
+        ID3D12Resource_Release(resource);
+    }
+    bench_end(&timer);
+
+    bench_start(&timer, "create_upload_buffer", iteration_count);
+    for (i = 0; i < iteration_count; ++i)
+    {
+        resource = create_upload_buffer(device, 65536, NULL);
+        ID3D12Resource_Release(resource);
+    }
+    bench_end(&timer);
+
+    bench_start(&timer, "create_committed_texture_2d", iteration_count);
+    for (i = 0; i < iteration_count; ++i)
+    {
+        resource = create_default_texture2d(device, 256, 256, 1, 1, DXGI_FORMAT_R8G8B8A8_UNORM,
+                D3D12_RESOURCE_FLAG_NONE, D3D12_RESOURCE_STATE_COPY_DEST);
+        ID3D12Resource_Release(resource);
+    }
+    bench_end(&timer);
+
+    refcount = ID3D12Device_Release(device);
+    ok(!refcount, "ID3D12Device has %u references left.\n", (unsigned int)refcount);
+}
+
+START_TEST(bench_d3d12)
+{
+    const char *scale;
+
+    parse_args(argc, argv);
+    enable_d3d12_debug_layer();
+    init_adapter_info();
+
+    if ((scale = getenv("VKD3D_BENCH_SCALE")) && atoi(scale) > 0)
+        bench_scale = atoi(scale);
+
+    run_test(bench_descriptors);
+    run_test(bench_command_list_recording);
+    run_test(bench_submission);
+    run_test(bench_resource_creation);
+}
@@ -2407,6 +2407,135 @@ static void test_create_placed_resource(void)
     ok(!refcount, "ID3D12Device has %u references left.\n", (unsigned int)refcount);
 }
 
+static void test_residency(void)
+{
+    D3D12_DESCRIPTOR_HEAP_DESC descriptor_heap_desc;
+    ID3D12Resource *buffer, *committed_buffer;
+    ID3D12GraphicsCommandList *command_list;
+    ID3D12DescriptorHeap *descriptor_heap;
+    D3D12_RESOURCE_DESC resource_desc;
+    struct test_context_desc desc;
+    ID3D12Pageable *objects[4];
+    struct test_context context;
+    D3D12_HEAP_DESC heap_desc;
+    ID3D12CommandQueue *queue;
+    ID3D12Device3 *device3;
+    unsigned int i, j;
+    ID3D12Fence *fence;
+    uint32_t *data;
+    ID3D12Heap *heap;
+    UINT64 value;
+    HRESULT hr;
+
+    memset(&desc, 0, sizeof(desc));
+    desc.no_render_target = true;
+    if (!init_test_context(&context, &desc))
+        return;
+    command_list = context.list;
+    queue = context.queue;
+
+    heap_desc.SizeInBytes = 16 * 1024 * 1024;
+    memset(&heap_desc.Properties, 0, sizeof(heap_desc.Properties));
+    heap_desc.Properties.Type = D3D12_HEAP_TYPE_DEFAULT;
+    heap_desc.Alignment = 0;
+    heap_desc.Flags = D3D12_HEAP_FLAG_ALLOW_ONLY_BUFFERS;
+    hr = ID3D12Device_CreateHeap(context.device, &heap_desc, &IID_ID3D12Heap, (void **)&heap);
+    ok(hr == S_OK, "Failed to create heap, hr %#x.\n", hr);
+
+    resource_desc.Dimension = D3D12_RESOURCE_DIMENSION_BUFFER;
+    resource_desc.Alignment = 0;
+    resource_desc.Width = 4096;
+    resource_desc.Height = 1;
+    resource_desc.DepthOrArraySize = 1;
+    resource_desc.MipLevels = 1;
+    resource_desc.Format = DXGI_FORMAT_UNKNOWN;
+    resource_desc.SampleDesc.Count = 1;
+    resource_desc.SampleDesc.Quality = 0;
+    resource_desc.Layout = D3D12_TEXTURE_LAYOUT_ROW_MAJOR;
+    resource_desc.Flags = 0;
+    hr = ID3D12Device_CreatePlacedResource(context.device, heap, 0, &resource_desc,
+            D3D12_RESOURCE_STATE_COPY_DEST, NULL, &IID_ID3D12Resource, (void **)&buffer);
+    ok(hr == S_OK, "Failed to create placed resource, hr %#x.\n", hr);
+
+    committed_buffer = create_default_buffer(context.device, 4096, D3D12_RESOURCE_FLAG_NONE,
+            D3D12_RESOURCE_STATE_COPY_DEST);
+
+    descriptor_heap_desc.Type = D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV;
+    descriptor_heap_desc.NumDescriptors = 16;
+    descriptor_heap_desc.Flags = D3D12_DESCRIPTOR_HEAP_FLAG_SHADER_VISIBLE;
+    descriptor_heap_desc.NodeMask = 0;
+    hr = ID3D12Device_CreateDescriptorHeap(context.device, &descriptor_heap_desc,
+            &IID_ID3D12DescriptorHeap, (void **)&descriptor_heap);
+    ok(hr == S_OK, "Failed to create descriptor heap, hr %#x.\n", hr);
+
+    data = malloc(resource_desc.Width);
+    ok(data, "Failed to allocate memory.\n");
+    for (i = 0; i < resource_desc.Width / sizeof(*data); ++i)
+        data[i] = 0xcafef00d;
+    upload_buffer_data(buffer, 0, resource_desc.Width, data, queue, command_list);
+    reset_command_list(command_list, context.allocator);
+    free(data);
+
+    objects[0] = (ID3D12Pageable *)heap;
+    objects[1] = (ID3D12Pageable *)buffer;
+    objects[2] = (ID3D12Pageable *)committed_buffer;
+    objects[3] = (ID3D12Pageable *)descriptor_heap;
+
+    /* Residency is tracked per object, so evicting or making an object
+     * resident twice is harmless. */
+    hr = ID3D12Device_MakeResident(context.device, ARRAY_SIZE(objects), objects);
+    ok(hr == S_OK, "Got unexpected hr %#x.\n", hr);
+    hr = ID3D12Device_Evict(context.device, ARRAY_SIZE(objects), objects);
+    ok(hr == S_OK, "Got unexpected hr %#x.\n", hr);
+    hr = ID3D12Device_Evict(context.device, ARRAY_SIZE(objects), objects);
+    ok(hr == S_OK, "Got unexpected hr %#x.\n", hr);
+    hr = ID3D12Device_MakeResident(context.device, ARRAY_SIZE(objects), objects);
+    ok(hr == S_OK, "Got unexpected hr %#x.\n", hr);
+    hr = ID3D12Device_MakeResident(context.device, ARRAY_SIZE(objects), objects);
+    ok(hr == S_OK, "Got unexpected hr %#x.\n", hr);
+
+    /* The contents of evicted heaps are preserved. */
+    transition_resource_state(command_list, buffer,
+            D3D12_RESOURCE_STATE_COPY_DEST, D3D12_RESOURCE_STATE_COPY_SOURCE);
+    check_buffer_uint(buffer, queue, command_list, 0xcafef00d, 0);
+    reset_command_list(command_list, context.allocator);
+
+    if (FAILED(hr = ID3D12Device_QueryInterface(context.device, &IID_ID3D12Device3, (void **)&device3)))
+    {
+        skip("ID3D12Device3 is not available.\n");
+        goto done;
+    }
+
+    hr = ID3D12Device_CreateFence(context.device, 0, D3D12_FENCE_FLAG_NONE, &IID_ID3D12Fence, (void **)&fence);
+    ok(hr == S_OK, "Failed to create fence, hr %#x.\n", hr);
+
+    /* Evicted heaps no longer count against the budget. If they did, these
+     * iterations would make far more than any budget resident. */
+    for (i = 0, j = 0; i < 4096; ++i)
+    {
+        hr = ID3D12Device_Evict(context.device, 1, objects);
+        ok(hr == S_OK, "Got unexpected hr %#x.\n", hr);
+        hr = ID3D12Device3_EnqueueMakeResident(device3, D3D12_RESIDENCY_FLAG_DENY_OVERBUDGET, 1, objects, fence, i + 1);
+        if (hr != S_OK)
+            ++j;
+    }
+    ok(!j, "EnqueueMakeResident() failed %u times.\n", j);
+    hr = wait_for_fence(fence, i);
+    ok(hr == S_OK, "Failed to wait for fence, hr %#x.\n", hr);
+    value = ID3D12Fence_GetCompletedValue(fence);
+    ok(value == i, "Got unexpected value %"PRIu64".\n", value);
+
+    ID3D12Fence_Release(fence);
+    ID3D12Device3_Release(device3);
+
+done:
+    ID3D12DescriptorHeap_Release(descriptor_heap);
+    ID3D12Resource_Release(committed_buffer);
+    ID3D12Resource_Release(buffer);
+    ID3D12Heap_Release(heap);
+    destroy_test_context(&context);
+}
+
 static void test_create_reserved_resource(void)
 {
     D3D12_GPU_VIRTUAL_ADDRESS gpu_address;
@@ -4253,7 +4382,7 @@ struct private_data
 static void private_data_thread_main(void *untyped_data)
 {
     struct private_data *data = untyped_data;
-    unsigned int i;
+    unsigned int i, size, value;
     HRESULT hr;
 
     hr = ID3D12Object_SetPrivateData(data->object, &data->guid, sizeof(data->value), &data->value);
@@ -4265,6 +4394,13 @@ static void private_data_thread_main(void *untyped_data)
         ok(hr == S_OK, "Got unexpected hr %#x.\n", hr);
         hr = ID3D12Object_SetPrivateData(data->object, &data->guid, sizeof(data->value), &data->value);
         ok(hr == S_OK, "Got unexpected hr %#x.\n", hr);
+
+        size = sizeof(value);
+        value = 0;
+        hr = ID3D12Object_GetPrivateData(data->object, &data->guid, &size, &value);
+        ok(hr == S_OK, "Got unexpected hr %#x.\n", hr);
+        ok(size == sizeof(value), "Got unexpected size %u.\n", size);
+        ok(value == data->value, "Got unexpected value %u, expected %u.\n", value, data->value);
     }
 }
 
@@ -4396,6 +4532,108 @@ static void test_multithread_private_data(void)
     ok(!refcount, "ID3D12Device has %u references left.\n", (unsigned int)refcount);
 }
 
+static void test_shared_state_private_data(void)
+{
+    ID3D12PipelineState *pipeline_state, *pipeline_state2;
+    ID3D12RootSignature *root_signature;
+    ULONG refcount, expected_refcount;
+    ID3D12Fence *test_object;
+    ID3D12Device *device;
+    unsigned int size;
+    unsigned int value;
+    IUnknown *ptr;
+    HRESULT hr;
+
+    static const GUID test_guid
+            = {0xfdb37466, 0x428f, 0x4edf, {0xa3, 0x7f, 0x9b, 0x1d, 0xf4, 0x88, 0xc5, 0xfc}};
+    static const GUID test_guid2
+            = {0x2e5afac2, 0x87b5, 0x4c10, {0x9b, 0x4b, 0x89, 0xd7, 0xd1, 0x12, 0xe7, 0x2b}};
+    static const unsigned int values[] = {0xdeadbeef, 0xcafef00d};
+
+    if (!(device = create_device()))
+    {
+        skip("Failed to create device.\n");
+        return;
+    }
+
+    /* Identical pipeline states are distinct objects, even when they share
+     * their Vulkan state, and each keeps its own private data. */
+    root_signature = create_empty_root_signature(device, 0);
+    pipeline_state = create_pipeline_state(device, root_signature, DXGI_FORMAT_R8G8B8A8_UNORM, NULL, NULL, NULL);
+    pipeline_state2 = create_pipeline_state(device, root_signature, DXGI_FORMAT_R8G8B8A8_UNORM, NULL, NULL, NULL);
+    ok(pipeline_state != pipeline_state2, "Got the same pipeline state pointer.\n");
+
+    hr = ID3D12PipelineState_SetPrivateData(pipeline_state, &test_guid, sizeof(values[0]), &values[0]);
+    ok(hr == S_OK, "Failed to set private data, hr %#x.\n", hr);
+    size = sizeof(value);
+    hr = ID3D12PipelineState_GetPrivateData(pipeline_state2, &test_guid, &size, &value);
+    ok(hr == DXGI_ERROR_NOT_FOUND, "Got unexpected hr %#x.\n", hr);
+
+    hr = ID3D12PipelineState_SetPrivateData(pipeline_state2, &test_guid, sizeof(values[1]), &values[1]);
+    ok(hr == S_OK, "Failed to set private data, hr %#x.\n", hr);
+    size = sizeof(value);
+    hr = ID3D12PipelineState_GetPrivateData(pipeline_state, &test_guid, &size, &value);
+    ok(hr == S_OK, "Got unexpected hr %#x.\n", hr);
+    ok(value == values[0], "Got unexpected value %#x.\n", value);
+    size = sizeof(value);
+    hr = ID3D12PipelineState_GetPrivateData(pipeline_state2, &test_guid, &size, &value);
+    ok(hr == S_OK, "Got unexpected hr %#x.\n", hr);
+    ok(value == values[1], "Got unexpected value %#x.\n", value);
+
+    /* Each object holds its own reference on a private data interface. */
+    hr = ID3D12Device_CreateFence(device, 0, D3D12_FENCE_FLAG_NONE, &IID_ID3D12Fence, (void **)&test_object);
+    ok(hr == S_OK, "Failed to create fence, hr %#x.\n", hr);
+    expected_refcount = get_refcount(test_object);
+
+    hr = ID3D12PipelineState_SetPrivateDataInterface(pipeline_state, &test_guid2, (IUnknown *)test_object);
+    ok(hr == S_OK, "Got unexpected hr %#x.\n", hr);
+    hr = ID3D12PipelineState_SetPrivateDataInterface(pipeline_state2, &test_guid2, (IUnknown *)test_object);
+    ok(hr == S_OK, "Got unexpected hr %#x.\n", hr);
+    expected_refcount += 2;
+    refcount = get_refcount(test_object);
+    ok(refcount == expected_refcount, "Got unexpected refcount %u, expected %u.\n",
+            (unsigned int)refcount, (unsigned int)expected_refcount);
+
+    hr = ID3D12PipelineState_SetPrivateDataInterface(pipeline_state2, &test_guid2, NULL);
+    ok(hr == S_OK, "Got unexpected hr %#x.\n", hr);
+    --expected_refcount;
+    refcount = get_refcount(test_object);
+    ok(refcount == expected_refcount, "Got unexpected refcount %u, expected %u.\n",
+            (unsigned int)refcount, (unsigned int)expected_refcount);
+
+    ptr = NULL;
+    size = sizeof(ptr);
+    hr = ID3D12PipelineState_GetPrivateData(pipeline_state, &test_guid2, &size, &ptr);
+    ok(hr == S_OK, "Got unexpected hr %#x.\n", hr);
+    ok(ptr == (IUnknown *)test_object, "Got unexpected pointer %p.\n", ptr);
+    IUnknown_Release(ptr);
+
+    hr = ID3D12PipelineState_SetPrivateDataInterface(pipeline_state2, &test_guid2, (IUnknown *)test_object);
+    ok(hr == S_OK, "Got unexpected hr %#x.\n", hr);
+    ++expected_refcount;
+
+    refcount = ID3D12PipelineState_Release(pipeline_state);
+    ok(!refcount, "ID3D12PipelineState has %u references left.\n", (unsigned int)refcount);
+    --expected_refcount;
+    refcount = get_refcount(test_object);
+    ok(refcount == expected_refcount, "Got unexpected refcount %u, expected %u.\n",
+            (unsigned int)refcount, (unsigned int)expected_refcount);
+
+    size = sizeof(value);
+    hr = ID3D12PipelineState_GetPrivateData(pipeline_state2, &test_guid, &size, &value);
+    ok(hr == S_OK, "Got unexpected hr %#x.\n", hr);
+    ok(value == values[1], "Got unexpected value %#x.\n", value);
+
+    refcount = ID3D12PipelineState_Release(pipeline_state2);
+    ok(!refcount, "ID3D12PipelineState has %u references left.\n", (unsigned int)refcount);
+    refcount = ID3D12Fence_Release(test_object);
+    ok(!refcount, "ID3D12Fence has %u references left.\n", (unsigned int)refcount);
+
+    ID3D12RootSignature_Release(root_signature);
+    refcount = ID3D12Device_Release(device);
+    ok(!refcount, "ID3D12Device has %u references left.\n", (unsigned int)refcount);
+}
+
 static void test_reset_command_allocator(void)
 {
     ID3D12CommandAllocator *command_allocator, *command_allocator2;
@@ -4527,6 +4765,119 @@ static void test_reset_command_allocator(void)
     ok(!refcount, "ID3D12Device has %u references left.\n", (unsigned int)refcount);
 }
 
+static void test_command_allocator_reuse(void)
+{
+    D3D12_ROOT_SIGNATURE_DESC root_signature_desc;
+    D3D12_CONSTANT_BUFFER_VIEW_DESC cbv_desc;
+    D3D12_DESCRIPTOR_RANGE descriptor_range;
+    ID3D12GraphicsCommandList *command_list;
+    D3D12_ROOT_PARAMETER root_parameter;
+    ID3D12DescriptorHeap *heap;
+    struct test_context_desc desc;
+    struct test_context context;
+    ID3D12CommandQueue *queue;
+    unsigned int i, j, index;
+    D3D12_SHADER_BYTECODE ps;
+    ID3D12Resource *cb;
+    ID3D10Blob *ps_blob;
+    HRESULT hr;
+
+    static const char ps_code[] =
+        "cbuffer cb0 : register(b0)\n"
+        "{\n"
+        "    float4 colour;\n"
+        "};\n"
+        "\n"
+        "float4 main() : SV_Target\n"
+        "{\n"
+        "    return colour;\n"
+        "}\n";
+    static const float colours[][4] =
+    {
+        {1.0f, 0.0f, 0.0f, 1.0f},
+        {0.0f, 1.0f, 0.0f, 1.0f},
+    };
+    static const float white[] = {1.0f, 1.0f, 1.0f, 1.0f};
+
+    memset(&desc, 0, sizeof(desc));
+    desc.no_root_signature = true;
+    if (!init_test_context(&context, &desc))
+        return;
+    command_list = context.list;
+    queue = context.queue;
+
+    descriptor_range.RangeType = D3D12_DESCRIPTOR_RANGE_TYPE_CBV;
+    descriptor_range.NumDescriptors = 1;
+    descriptor_range.BaseShaderRegister = 0;
+    descriptor_range.RegisterSpace = 0;
+    descriptor_range.OffsetInDescriptorsFromTableStart = 0;
+    root_parameter.ParameterType = D3D12_ROOT_PARAMETER_TYPE_DESCRIPTOR_TABLE;
+    root_parameter.DescriptorTable.NumDescriptorRanges = 1;
+    root_parameter.DescriptorTable.pDescriptorRanges = &descriptor_range;
+    root_parameter.ShaderVisibility = D3D12_SHADER_VISIBILITY_PIXEL;
+    memset(&root_signature_desc, 0, sizeof(root_signature_desc));
+    root_signature_desc.NumParameters = 1;
+    root_signature_desc.pParameters = &root_parameter;
+    hr = create_root_signature(context.device, &root_signature_desc, &context.root_signature);
+    ok(hr == S_OK, "Failed to create root signature, hr %#x.\n", hr);
+
+    ps_blob = compile_shader(ps_code, sizeof(ps_code) - 1, "ps_4_0");
+    ps = shader_bytecode_from_blob(ps_blob);
+    context.pipeline_state = create_pipeline_state(context.device, context.root_signature,
+            context.render_target_desc.Format, NULL, &ps, NULL);
+    ID3D10Blob_Release(ps_blob);
+
+    cb = create_upload_buffer(context.device, 2 * D3D12_CONSTANT_BUFFER_DATA_PLACEMENT_ALIGNMENT, NULL);
+    heap = create_gpu_descriptor_heap(context.device, D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV, ARRAY_SIZE(colours));
+    for (i = 0; i < ARRAY_SIZE(colours); ++i)
+    {
+        update_buffer_data(cb, i * D3D12_CONSTANT_BUFFER_DATA_PLACEMENT_ALIGNMENT,
+                sizeof(colours[i]), colours[i]);
+        cbv_desc.BufferLocation = ID3D12Resource_GetGPUVirtualAddress(cb)
+                + i * D3D12_CONSTANT_BUFFER_DATA_PLACEMENT_ALIGNMENT;
+        cbv_desc.SizeInBytes = D3D12_CONSTANT_BUFFER_DATA_PLACEMENT_ALIGNMENT;
+        ID3D12Device_CreateConstantBufferView(context.device, &cbv_desc,
+                get_cpu_descriptor_handle(&context, heap, i));
+    }
+
+    /* Each table change needs a new descriptor set, so every pass uses
+     * several descriptor pools, which are reused after Reset(). */
+    for (i = 0; i < 4; ++i)
+    {
+        vkd3d_test_push_context("Pass %u", i);
+
+        ID3D12GraphicsCommandList_ClearRenderTargetView(command_list, context.rtv, white, 0, NULL);
+        ID3D12GraphicsCommandList_OMSetRenderTargets(command_list, 1, &context.rtv, false, NULL);
+        ID3D12GraphicsCommandList_SetGraphicsRootSignature(command_list, context.root_signature);
+        ID3D12GraphicsCommandList_SetPipelineState(command_list, context.pipeline_state);
+        ID3D12GraphicsCommandList_SetDescriptorHeaps(command_list, 1, &heap);
+        ID3D12GraphicsCommandList_IASetPrimitiveTopology(command_list, D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+        ID3D12GraphicsCommandList_RSSetViewports(command_list, 1, &context.viewport);
+        ID3D12GraphicsCommandList_RSSetScissorRects(command_list, 1, &context.scissor_rect);
+        for (j = 0; j < 1024; ++j)
+        {
+            index = (i + j) % ARRAY_SIZE(colours);
+            ID3D12GraphicsCommandList_SetGraphicsRootDescriptorTable(command_list, 0,
+                    get_gpu_descriptor_handle(&context, heap, index));
+            ID3D12GraphicsCommandList_DrawInstanced(command_list, 3, 1, 0, 0);
+        }
+
+        transition_resource_state(command_list, context.render_target,
+                D3D12_RESOURCE_STATE_RENDER_TARGET, D3D12_RESOURCE_STATE_COPY_SOURCE);
+        check_sub_resource_uint(context.render_target, 0, queue, command_list,
+                index ? 0xff00ff00 : 0xff0000ff, 0);
+        reset_command_list(command_list, context.allocator);
+        transition_resource_state(command_list, context.render_target,
+                D3D12_RESOURCE_STATE_COPY_SOURCE, D3D12_RESOURCE_STATE_RENDER_TARGET);
+
+        vkd3d_test_pop_context();
+    }
+
+    ID3D12DescriptorHeap_Release(heap);
+    ID3D12Resource_Release(cb);
+    destroy_test_context(&context);
+}
+
 static void test_cpu_signal_fence(void)
 {
     HANDLE event1, event2;
@@ -6232,6 +6583,56 @@ static void test_draw_instanced(void)
     destroy_test_context(&context);
 }
 
+static void test_debug_markers(void)
+{
+    static const uint64_t pix3_event[] =
+    {
+        0x0000000000000400, 0xff00ff00,
+        /* ANSI string header, followed by "Draw". */
+        0x0440000000000000, 0x0000000077617244, 0x00000000000fff80,
+    };
+    static const WCHAR unicode_name[] = {'C','l','e','a','r',0};
+    static const float white[] = {1.0f, 1.0f, 1.0f, 1.0f};
+    static const char ansi_name[] = "Frame";
+    ID3D12GraphicsCommandList *command_list;
+    struct test_context context;
+    ID3D12CommandQueue *queue;
+
+    if (!init_test_context(&context, NULL))
+        return;
+    command_list = context.list;
+    queue = context.queue;
+
+    ID3D12CommandQueue_BeginEvent(queue, 1, ansi_name, sizeof(ansi_name));
+
+    ID3D12GraphicsCommandList_BeginEvent(command_list, 0, unicode_name, sizeof(unicode_name));
+    ID3D12GraphicsCommandList_ClearRenderTargetView(command_list, context.rtv, white, 0, NULL);
+    ID3D12GraphicsCommandList_EndEvent(command_list);
+
+    ID3D12GraphicsCommandList_BeginEvent(command_list, 2, pix3_event, sizeof(pix3_event));
+    ID3D12GraphicsCommandList_OMSetRenderTargets(command_list, 1, &context.rtv, false, NULL);
+    ID3D12GraphicsCommandList_SetGraphicsRootSignature(command_list, context.root_signature);
+    ID3D12GraphicsCommandList_SetPipelineState(command_list, context.pipeline_state);
+    ID3D12GraphicsCommandList_IASetPrimitiveTopology(command_list, D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+    ID3D12GraphicsCommandList_RSSetViewports(command_list, 1, &context.viewport);
+    ID3D12GraphicsCommandList_RSSetScissorRects(command_list, 1, &context.scissor_rect);
+    /* Unknown metadata and missing data are allowed. */
+    ID3D12GraphicsCommandList_SetMarker(command_list, 0xdeadbeef, NULL, 0);
+    ID3D12GraphicsCommandList_SetMarker(command_list, 1, ansi_name, sizeof(ansi_name));
+    ID3D12GraphicsCommandList_DrawInstanced(command_list, 3, 1, 0, 0);
+    ID3D12GraphicsCommandList_EndEvent(command_list);
+
+    transition_resource_state(command_list, context.render_target,
+            D3D12_RESOURCE_STATE_RENDER_TARGET, D3D12_RESOURCE_STATE_COPY_SOURCE);
+
+    check_sub_resource_uint(context.render_target, 0, queue, command_list, 0xff00ff00, 0);
+
+    ID3D12CommandQueue_SetMarker(queue, 0, unicode_name, sizeof(unicode_name));
+    ID3D12CommandQueue_EndEvent(queue);
+
+    destroy_test_context(&context);
+}
+
 static void test_draw_indexed_instanced(void)
 {
     static const float white[] = {1.0f, 1.0f, 1.0f, 1.0f};
@@ -17511,6 +17912,125 @@ static void test_update_root_descriptors(void)
     destroy_test_context(&context);
 }
 
+static void test_root_constant_buffer_address(void)
+{
+    ID3D12Resource *cb, *cb_values;
+    D3D12_ROOT_SIGNATURE_DESC root_signature_desc;
+    D3D12_ROOT_PARAMETER root_parameters[2];
+    ID3D12GraphicsCommandList *command_list;
+    struct test_context_desc desc;
+    struct test_context context;
+    ID3D12CommandQueue *queue;
+    D3D12_SHADER_BYTECODE ps;
+    ID3D10Blob *ps_blob;
+    float *values;
+    char *previous;
+    unsigned int i;
+    HRESULT hr;
+
+    static const char ps_code[] =
+        "cbuffer cb0 : register(b0)\n"
+        "{\n"
+        "    float4 unused;\n"
+        "    float4 colour;\n"
+        "};\n"
+        "\n"
+        "cbuffer cb1 : register(b1)\n"
+        "{\n"
+        "    float4 values[4096];\n"
+        "};\n"
+        "\n"
+        "float4 main() : SV_Target\n"
+        "{\n"
+        "    return colour + values[4095];\n"
+        "}\n";
+    static const float white[] = {1.0f, 1.0f, 1.0f, 1.0f};
+    static const float red[] = {1.0f, 0.0f, 0.0f, 1.0f};
+
+    /* Root CBVs are passed as buffer device addresses. The buffer which
+     * backs NULL root CBVs must cover a whole constant buffer. */
+    previous = set_vkd3d_config("root_buffer_address");
+
+    memset(&desc, 0, sizeof(desc));
+    desc.no_root_signature = true;
+    if (!init_test_context(&context, &desc))
+    {
+        restore_vkd3d_config(previous);
+        return;
+    }
+    command_list = context.list;
+    queue = context.queue;
+
+    for (i = 0; i < ARRAY_SIZE(root_parameters); ++i)
+    {
+        root_parameters[i].ParameterType = D3D12_ROOT_PARAMETER_TYPE_CBV;
+        root_parameters[i].Descriptor.ShaderRegister = i;
+        root_parameters[i].Descriptor.RegisterSpace = 0;
+        root_parameters[i].ShaderVisibility = D3D12_SHADER_VISIBILITY_PIXEL;
+    }
+    memset(&root_signature_desc, 0, sizeof(root_signature_desc));
+    root_signature_desc.NumParameters = ARRAY_SIZE(root_parameters);
+    root_signature_desc.pParameters = root_parameters;
+    hr = create_root_signature(context.device, &root_signature_desc, &context.root_signature);
+    ok(hr == S_OK, "Failed to create root signature, hr %#x.\n", hr);
+
+    ps_blob = compile_shader(ps_code, sizeof(ps_code) - 1, "ps_4_0");
+    ps = shader_bytecode_from_blob(ps_blob);
+    context.pipeline_state = create_pipeline_state(context.device, context.root_signature,
+            context.render_target_desc.Format, NULL, &ps, NULL);
+    ID3D10Blob_Release(ps_blob);
+
+    /* Place the first constant buffer at a non-zero offset. */
+    cb = create_upload_buffer(context.device, 512, NULL);
+    update_buffer_data(cb, 256 + sizeof(red), sizeof(red), red);
+
+    values = calloc(4096, 4 * sizeof(*values));
+    ok(values, "Failed to allocate memory.\n");
+    values[4095 * 4 + 1] = 1.0f;
+    cb_values = create_upload_buffer(context.device, 4096 * 4 * sizeof(*values), values);
+    free(values);
+
+    for (i = 0; i < 2; ++i)
+    {
+        vkd3d_test_push_context("Test %u", i);
+
+        /* NULL root CBVs read as zero in vkd3d, but are undefined on Windows. */
+        if (i && vkd3d_test_platform_is_windows())
+        {
+            skip("Reading a NULL root CBV is undefined.\n");
+            vkd3d_test_pop_context();
+            break;
+        }
+
+        ID3D12GraphicsCommandList_ClearRenderTargetView(command_list, context.rtv, white, 0, NULL);
+        ID3D12GraphicsCommandList_OMSetRenderTargets(command_list, 1, &context.rtv, false, NULL);
+        ID3D12GraphicsCommandList_SetGraphicsRootSignature(command_list, context.root_signature);
+        ID3D12GraphicsCommandList_SetPipelineState(command_list, context.pipeline_state);
+        ID3D12GraphicsCommandList_IASetPrimitiveTopology(command_list, D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+        ID3D12GraphicsCommandList_RSSetViewports(command_list, 1, &context.viewport);
+        ID3D12GraphicsCommandList_RSSetScissorRects(command_list, 1, &context.scissor_rect);
+        ID3D12GraphicsCommandList_SetGraphicsRootConstantBufferView(command_list, 0,
+                ID3D12Resource_GetGPUVirtualAddress(cb) + 256);
+        ID3D12GraphicsCommandList_SetGraphicsRootConstantBufferView(command_list, 1,
+                i ? 0 : ID3D12Resource_GetGPUVirtualAddress(cb_values));
+        ID3D12GraphicsCommandList_DrawInstanced(command_list, 3, 1, 0, 0);
+
+        transition_resource_state(command_list, context.render_target,
+                D3D12_RESOURCE_STATE_RENDER_TARGET, D3D12_RESOURCE_STATE_COPY_SOURCE);
+        check_sub_resource_uint(context.render_target, 0, queue, command_list, i ? 0xff0000ff : 0xff00ffff, 0);
+        reset_command_list(command_list, context.allocator);
+        transition_resource_state(command_list, context.render_target,
+                D3D12_RESOURCE_STATE_COPY_SOURCE, D3D12_RESOURCE_STATE_RENDER_TARGET);
+
+        vkd3d_test_pop_context();
+    }
+
+    ID3D12Resource_Release(cb_values);
+    ID3D12Resource_Release(cb);
+    destroy_test_context(&context);
+    restore_vkd3d_config(previous);
+}
+
 static void test_update_descriptor_tables(void)
 {
     D3D12_ROOT_SIGNATURE_DESC root_signature_desc;
@@ -18356,8 +18876,8 @@ static void test_update_compute_descriptor_tables(void)
 
 static void test_update_descriptor_tables_after_root_signature_change(void)
 {
-    ID3D12RootSignature *root_signature, *root_signature2;
-    ID3D12PipelineState *pipeline_state, *pipeline_state2;
+    ID3D12PipelineState *pipeline_state, *pipeline_state2, *pipeline_state3;
+    ID3D12RootSignature *root_signature, *root_signature2, *root_signature3;
     ID3D12DescriptorHeap *heap, *sampler_heap, *heaps[2];
     D3D12_ROOT_SIGNATURE_DESC root_signature_desc;
     D3D12_DESCRIPTOR_RANGE descriptor_range[4];
@@ -18453,11 +18973,17 @@ static void test_update_descriptor_tables_after_root_signature_change(void)
     root_signature_desc.NumParameters = ARRAY_SIZE(root_parameters) - 1;
     hr = create_root_signature(context.device, &root_signature_desc, &root_signature2);
     ok(hr == S_OK, "Failed to create root signature, hr %#x.\n", hr);
+    /* Differently serialised, but with the same layout as root_signature2. */
+    root_signature_desc.Flags = D3D12_ROOT_SIGNATURE_FLAG_ALLOW_STREAM_OUTPUT;
+    hr = create_root_signature(context.device, &root_signature_desc, &root_signature3);
+    ok(hr == S_OK, "Failed to create root signature, hr %#x.\n", hr);
 
     pipeline_state = create_pipeline_state(context.device,
             root_signature, context.render_target_desc.Format, NULL, &ps, NULL);
     pipeline_state2 = create_pipeline_state(context.device,
             root_signature2, context.render_target_desc.Format, NULL, &ps, NULL);
+    pipeline_state3 = create_pipeline_state(context.device,
+            root_signature3, context.render_target_desc.Format, NULL, &ps, NULL);
 
     heap = create_gpu_descriptor_heap(context.device, D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV, 6);
     sampler_heap = create_gpu_descriptor_heap(context.device, D3D12_DESCRIPTOR_HEAP_TYPE_SAMPLER, 1);
@@ -18561,10 +19087,92 @@ static void test_update_descriptor_tables_after_root_signature_change(void)
             D3D12_RESOURCE_STATE_RENDER_TARGET, D3D12_RESOURCE_STATE_COPY_SOURCE);
     check_sub_resource_uint(context.render_target, 0, queue, command_list, 0xff00ff00, 0);
 
+    /* Switch between compatible root signatures. */
+    for (i = 0; i < ARRAY_SIZE(textures); ++i)
+    {
+        reset_command_list(command_list, context.allocator);
+        transition_resource_state(command_list, context.render_target,
+                D3D12_RESOURCE_STATE_COPY_SOURCE, D3D12_RESOURCE_STATE_RENDER_TARGET);
+
+        ID3D12GraphicsCommandList_SetDescriptorHeaps(command_list, ARRAY_SIZE(heaps), heaps);
+
+        ID3D12GraphicsCommandList_ClearRenderTargetView(command_list, context.rtv, white, 0, NULL);
+
+        ID3D12GraphicsCommandList_OMSetRenderTargets(command_list, 1, &context.rtv, false, NULL);
+        ID3D12GraphicsCommandList_SetPipelineState(command_list, pipeline_state2);
+        ID3D12GraphicsCommandList_SetGraphicsRootSignature(command_list, root_signature2);
+
+        ID3D12GraphicsCommandList_IASetPrimitiveTopology(command_list, D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+        ID3D12GraphicsCommandList_RSSetViewports(command_list, 1, &context.viewport);
+        ID3D12GraphicsCommandList_RSSetScissorRects(command_list, 1, &context.scissor_rect);
+
+        ID3D12GraphicsCommandList_SetGraphicsRootDescriptorTable(command_list, 0,
+                get_gpu_descriptor_handle(&context, heap, 1));
+        ID3D12GraphicsCommandList_SetGraphicsRootDescriptorTable(command_list, 1,
+                ID3D12DescriptorHeap_GetGPUDescriptorHandleForHeapStart(sampler_heap));
+        ID3D12GraphicsCommandList_DrawInstanced(command_list, 3, 1, 0, 0);
+
+        ID3D12GraphicsCommandList_SetPipelineState(command_list, pipeline_state3);
+        ID3D12GraphicsCommandList_SetGraphicsRootSignature(command_list, root_signature3);
+
+        ID3D12GraphicsCommandList_SetGraphicsRootDescriptorTable(command_list, 0,
+                get_gpu_descriptor_handle(&context, heap, i));
+        ID3D12GraphicsCommandList_SetGraphicsRootDescriptorTable(command_list, 1,
+                ID3D12DescriptorHeap_GetGPUDescriptorHandleForHeapStart(sampler_heap));
+        ID3D12GraphicsCommandList_DrawInstanced(command_list, 3, 1, 0, 0);
+
+        transition_resource_state(command_list, context.render_target,
+                D3D12_RESOURCE_STATE_RENDER_TARGET, D3D12_RESOURCE_STATE_COPY_SOURCE);
+        check_sub_resource_uint(context.render_target, 0, queue, command_list, texture_data[i], 0);
+    }
+
+    /* Root arguments are undefined after a root signature change on Windows,
+     * but vkd3d keeps them across compatible root signatures. */
+    for (i = 0; i < ARRAY_SIZE(textures); ++i)
+    {
+        if (vkd3d_test_platform_is_windows())
+        {
+            skip("Root arguments are undefined after a root signature change.\n");
+            break;
+        }
+
+        reset_command_list(command_list, context.allocator);
+        transition_resource_state(command_list, context.render_target,
+                D3D12_RESOURCE_STATE_COPY_SOURCE, D3D12_RESOURCE_STATE_RENDER_TARGET);
+
+        ID3D12GraphicsCommandList_SetDescriptorHeaps(command_list, ARRAY_SIZE(heaps), heaps);
+
+        ID3D12GraphicsCommandList_OMSetRenderTargets(command_list, 1, &context.rtv, false, NULL);
+        ID3D12GraphicsCommandList_SetPipelineState(command_list, pipeline_state2);
+        ID3D12GraphicsCommandList_SetGraphicsRootSignature(command_list, root_signature2);
+
+        ID3D12GraphicsCommandList_IASetPrimitiveTopology(command_list, D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+        ID3D12GraphicsCommandList_RSSetViewports(command_list, 1, &context.viewport);
+        ID3D12GraphicsCommandList_RSSetScissorRects(command_list, 1, &context.scissor_rect);
+
+        ID3D12GraphicsCommandList_SetGraphicsRootDescriptorTable(command_list, 0,
+                get_gpu_descriptor_handle(&context, heap, i));
+        ID3D12GraphicsCommandList_SetGraphicsRootDescriptorTable(command_list, 1,
+                ID3D12DescriptorHeap_GetGPUDescriptorHandleForHeapStart(sampler_heap));
+        ID3D12GraphicsCommandList_DrawInstanced(command_list, 3, 1, 0, 0);
+
+        ID3D12GraphicsCommandList_ClearRenderTargetView(command_list, context.rtv, white, 0, NULL);
+
+        ID3D12GraphicsCommandList_SetPipelineState(command_list, pipeline_state3);
+        ID3D12GraphicsCommandList_SetGraphicsRootSignature(command_list, root_signature3);
+        ID3D12GraphicsCommandList_DrawInstanced(command_list, 3, 1, 0, 0);
+
+        transition_resource_state(command_list, context.render_target,
+                D3D12_RESOURCE_STATE_RENDER_TARGET, D3D12_RESOURCE_STATE_COPY_SOURCE);
+        check_sub_resource_uint(context.render_target, 0, queue, command_list, texture_data[i], 0);
+    }
+
     ID3D12PipelineState_Release(pipeline_state);
     ID3D12PipelineState_Release(pipeline_state2);
+    ID3D12PipelineState_Release(pipeline_state3);
     ID3D12RootSignature_Release(root_signature);
     ID3D12RootSignature_Release(root_signature2);
+    ID3D12RootSignature_Release(root_signature3);
     for (i = 0; i < ARRAY_SIZE(textures); ++i)
         ID3D12Resource_Release(textures[i]);
     ID3D12DescriptorHeap_Release(heap);
@@ -20341,6 +20949,35 @@ static void test_null_vbv(void)
     transition_resource_state(command_list, context.render_target,
             D3D12_RESOURCE_STATE_RENDER_TARGET, D3D12_RESOURCE_STATE_COPY_SOURCE);
     check_sub_resource_uint(context.render_target, 0, queue, command_list, 0xffffffff, 0);
+    reset_command_list(command_list, context.allocator);
+
+    transition_resource_state(command_list, context.render_target,
+            D3D12_RESOURCE_STATE_COPY_SOURCE, D3D12_RESOURCE_STATE_RENDER_TARGET);
+
+    ID3D12GraphicsCommandList_ClearRenderTargetView(command_list, context.rtv, white, 0, NULL);
+
+    ID3D12GraphicsCommandList_OMSetRenderTargets(command_list, 1, &context.rtv, false, NULL);
+    ID3D12GraphicsCommandList_SetGraphicsRootSignature(command_list, context.root_signature);
+    ID3D12GraphicsCommandList_SetPipelineState(command_list, context.pipeline_state);
+    ID3D12GraphicsCommandList_IASetPrimitiveTopology(command_list, D3D_PRIMITIVE_TOPOLOGY_TRIANGLESTRIP);
+    ID3D12GraphicsCommandList_RSSetScissorRects(command_list, 1, &context.scissor_rect);
+    ID3D12GraphicsCommandList_RSSetViewports(command_list, 1, &context.viewport);
+
+    /* Redundant state changes, and changes to only some of the slots. */
+    ID3D12GraphicsCommandList_IASetVertexBuffers(command_list, 0, 2, NULL);
+    vbv[1].BufferLocation = 0;
+    vbv[1].StrideInBytes = 0;
+    vbv[1].SizeInBytes = 0;
+    ID3D12GraphicsCommandList_IASetVertexBuffers(command_list, 0, ARRAY_SIZE(vbv), vbv);
+    ID3D12GraphicsCommandList_IASetVertexBuffers(command_list, 0, ARRAY_SIZE(vbv), vbv);
+    ID3D12GraphicsCommandList_RSSetScissorRects(command_list, 1, &context.scissor_rect);
+    ID3D12GraphicsCommandList_RSSetViewports(command_list, 1, &context.viewport);
+
+    ID3D12GraphicsCommandList_DrawInstanced(command_list, 4, 4, 0, 0);
+
+    transition_resource_state(command_list, context.render_target,
+            D3D12_RESOURCE_STATE_RENDER_TARGET, D3D12_RESOURCE_STATE_COPY_SOURCE);
+    check_sub_resource_uint(context.render_target, 0, queue, command_list, 0x00000000, 0);
 
     ID3D12Resource_Release(vb);
     destroy_test_context(&context);
@@ -34735,6 +35372,124 @@ done:
     destroy_test_context(&context);
 }
 
+static void test_read_write_subresource_large(void)
+{
+    static const D3D12_CPU_PAGE_PROPERTY page_properties[] =
+    {
+        D3D12_CPU_PAGE_PROPERTY_WRITE_COMBINE,
+        D3D12_CPU_PAGE_PROPERTY_WRITE_BACK,
+    };
+    static const unsigned int width = 1024, height = 1152;
+    unsigned int x, y, i, src_row_length;
+    D3D12_HEAP_PROPERTIES heap_properties;
+    D3D12_RESOURCE_DESC resource_desc;
+    struct test_context_desc desc;
+    struct test_context context;
+    uint32_t *src_data, *dst_data;
+    uint32_t got, expected;
+    ID3D12Resource *texture;
+    ID3D12Device *device;
+    D3D12_BOX box;
+    HRESULT hr;
+
+    /* Subresources of 4 MiB or more are copied in parallel chunks. */
+    memset(&desc, 0, sizeof(desc));
+    desc.no_render_target = true;
+    if (!init_test_context(&context, &desc))
+        return;
+    device = context.device;
+
+    /* Use a source row pitch which differs from any likely image row pitch. */
+    src_row_length = width + 16;
+    src_data = malloc(src_row_length * height * sizeof(*src_data));
+    ok(src_data, "Failed to allocate memory.\n");
+    dst_data = malloc(width * height * sizeof(*dst_data));
+    ok(dst_data, "Failed to allocate memory.\n");
+
+    resource_desc.Dimension = D3D12_RESOURCE_DIMENSION_TEXTURE2D;
+    resource_desc.Alignment = 0;
+    resource_desc.Width = width;
+    resource_desc.Height = height;
+    resource_desc.DepthOrArraySize = 1;
+    resource_desc.MipLevels = 1;
+    resource_desc.Format = DXGI_FORMAT_R8G8B8A8_UINT;
+    resource_desc.SampleDesc.Count = 1;
+    resource_desc.SampleDesc.Quality = 0;
+    resource_desc.Layout = D3D12_TEXTURE_LAYOUT_UNKNOWN;
+    resource_desc.Flags = 0;
+
+    for (i = 0; i < ARRAY_SIZE(page_properties); ++i)
+    {
+        vkd3d_test_push_context("Page property %#x", page_properties[i]);
+
+        memset(&heap_properties, 0, sizeof(heap_properties));
+        heap_properties.Type = D3D12_HEAP_TYPE_CUSTOM;
+        heap_properties.CPUPageProperty = page_properties[i];
+        heap_properties.MemoryPoolPreference = D3D12_MEMORY_POOL_L0;
+        hr = ID3D12Device_CreateCommittedResource(device, &heap_properties, D3D12_HEAP_FLAG_NONE,
+                &resource_desc, D3D12_RESOURCE_STATE_COMMON, NULL, &IID_ID3D12Resource, (void **)&texture);
+        if (FAILED(hr))
+        {
+            skip("Failed to create texture on custom heap.\n");
+            vkd3d_test_pop_context();
+            continue;
+        }
+
+        for (y = 0; y < height; ++y)
+        {
+            for (x = 0; x < src_row_length; ++x)
+                src_data[y * src_row_length + x] = y << 16 | x;
+        }
+        hr = ID3D12Resource_WriteToSubresource(texture, 0, NULL, src_data,
+                src_row_length * sizeof(*src_data), src_row_length * height * sizeof(*src_data));
+        todo_if(is_nvidia_device(device) || is_mvk_device(device))
+        ok(hr == S_OK, "Got unexpected hr %#x.\n", hr);
+
+        /* Overwrite a region with unaligned edges. */
+        for (y = 0; y < height; ++y)
+        {
+            for (x = 0; x < src_row_length; ++x)
+                src_data[y * src_row_length + x] = ~(y << 16 | x);
+        }
+        set_box(&box, 3, 5, 0, width - 7, height - 11, 1);
+        hr = ID3D12Resource_WriteToSubresource(texture, 0, &box, &src_data[box.top * src_row_length + box.left],
+                src_row_length * sizeof(*src_data), src_row_length * height * sizeof(*src_data));
+        todo_if(is_nvidia_device(device) || is_mvk_device(device))
+        ok(hr == S_OK, "Got unexpected hr %#x.\n", hr);
+
+        memset(dst_data, 0, width * height * sizeof(*dst_data));
+        hr = ID3D12Resource_ReadFromSubresource(texture, dst_data,
+                width * sizeof(*dst_data), width * height * sizeof(*dst_data), 0, NULL);
+        todo_if(is_nvidia_device(device) || is_mvk_device(device))
+        ok(hr == S_OK, "Got unexpected hr %#x.\n", hr);
+
+        got = expected = 0;
+        for (y = 0; y < height; ++y)
+        {
+            for (x = 0; x < width; ++x)
+            {
+                expected = y << 16 | x;
+                if (x >= box.left && x < box.right && y >= box.top && y < box.bottom)
+                    expected = ~expected;
+                got = dst_data[y * width + x];
+                if (got != expected)
+                    break;
+            }
+            if (got != expected)
+                break;
+        }
+        todo_if(is_nvidia_device(device) || is_mvk_device(device))
+        ok(got == expected, "Got unexpected value 0x%08x at (%u, %u), expected 0x%08x.\n", got, x, y, expected);
+
+        ID3D12Resource_Release(texture);
+        vkd3d_test_pop_context();
+    }
+
+    free(src_data);
+    free(dst_data);
+    destroy_test_context(&context);
+}
+
 static void test_queue_wait(void)
 {
     D3D12_TEXTURE_COPY_LOCATION dst_location, src_location;
@@ -38098,6 +38853,122 @@ static void test_get_resource_tiling(void)
     destroy_test_context(&context);
 }
 
+static void test_update_tile_mappings(void)
+{
+    D3D12_TILED_RESOURCE_COORDINATE region_start;
+    ID3D12Resource *buffer, *upload, *dst_buffer;
+    ID3D12GraphicsCommandList *command_list;
+    D3D12_TILE_RANGE_FLAGS range_flags[2];
+    UINT heap_offsets[2], tile_counts[2];
+    D3D12_TILE_REGION_SIZE region_size;
+    struct d3d12_resource_readback rb;
+    D3D12_RESOURCE_DESC resource_desc;
+    unsigned int i, expected, value;
+    struct test_context_desc desc;
+    struct test_context context;
+    ID3D12CommandQueue *queue;
+    D3D12_HEAP_DESC heap_desc;
+    ID3D12Heap *heap;
+    uint32_t *data;
+    HRESULT hr;
+
+    static const unsigned int tile_size = D3D12_TILED_RESOURCE_TILE_SIZE_IN_BYTES;
+    static const unsigned int word_count = 2 * D3D12_TILED_RESOURCE_TILE_SIZE_IN_BYTES / sizeof(*data);
+
+    memset(&desc, 0, sizeof(desc));
+    desc.no_render_target = true;
+    if (!init_test_context(&context, &desc))
+        return;
+    command_list = context.list;
+    queue = context.queue;
+
+    if (get_tiled_resources_tier(context.device) < D3D12_TILED_RESOURCES_TIER_1)
+    {
+        skip("Tiled resources not supported by device.\n");
+        destroy_test_context(&context);
+        return;
+    }
+
+    heap_desc.SizeInBytes = 2 * tile_size;
+    memset(&heap_desc.Properties, 0, sizeof(heap_desc.Properties));
+    heap_desc.Properties.Type = D3D12_HEAP_TYPE_DEFAULT;
+    heap_desc.Alignment = 0;
+    heap_desc.Flags = D3D12_HEAP_FLAG_ALLOW_ONLY_BUFFERS;
+    hr = ID3D12Device_CreateHeap(context.device, &heap_desc, &IID_ID3D12Heap, (void **)&heap);
+    ok(hr == S_OK, "Failed to create heap, hr %#x.\n", hr);
+
+    resource_desc.Dimension = D3D12_RESOURCE_DIMENSION_BUFFER;
+    resource_desc.Alignment = 0;
+    resource_desc.Width = 2 * tile_size;
+    resource_desc.Height = 1;
+    resource_desc.DepthOrArraySize = 1;
+    resource_desc.MipLevels = 1;
+    resource_desc.Format = DXGI_FORMAT_UNKNOWN;
+    resource_desc.SampleDesc.Count = 1;
+    resource_desc.SampleDesc.Quality = 0;
+    resource_desc.Layout = D3D12_TEXTURE_LAYOUT_ROW_MAJOR;
+    resource_desc.Flags = D3D12_RESOURCE_FLAG_NONE;
+    hr = ID3D12Device_CreateReservedResource(context.device, &resource_desc,
+            D3D12_RESOURCE_STATE_COPY_DEST, NULL, &IID_ID3D12Resource, (void **)&buffer);
+    ok(hr == S_OK, "Failed to create reserved resource, hr %#x.\n", hr);
+
+    data = malloc(word_count * sizeof(*data));
+    for (i = 0; i < word_count; ++i)
+        data[i] = i;
+    upload = create_upload_buffer(context.device, word_count * sizeof(*data), data);
+    free(data);
+    dst_buffer = create_default_buffer(context.device, word_count * sizeof(*data),
+            D3D12_RESOURCE_FLAG_NONE, D3D12_RESOURCE_STATE_COPY_DEST);
+
+    /* Map both tiles in order and write through them. */
+    memset(&region_start, 0, sizeof(region_start));
+    region_size.NumTiles = 2;
+    region_size.UseBox = FALSE;
+    region_size.Width = 0;
+    region_size.Height = 0;
+    region_size.Depth = 0;
+    range_flags[0] = D3D12_TILE_RANGE_FLAG_NONE;
+    heap_offsets[0] = 0;
+    tile_counts[0] = 2;
+    ID3D12CommandQueue_UpdateTileMappings(queue, buffer, 1, &region_start, &region_size,
+            heap, 1, range_flags, heap_offsets, tile_counts, D3D12_TILE_MAPPING_FLAG_NONE);
+
+    ID3D12GraphicsCommandList_CopyBufferRegion(command_list, buffer, 0, upload, 0, word_count * sizeof(*data));
+    hr = ID3D12GraphicsCommandList_Close(command_list);
+    ok(hr == S_OK, "Failed to close command list, hr %#x.\n", hr);
+    exec_command_list(queue, command_list);
+
+    /* Swap the tiles without waiting; the remap must not overtake the write,
+     * nor the following read. */
+    range_flags[1] = D3D12_TILE_RANGE_FLAG_NONE;
+    heap_offsets[0] = 1;
+    heap_offsets[1] = 0;
+    tile_counts[0] = 1;
+    tile_counts[1] = 1;
+    ID3D12CommandQueue_UpdateTileMappings(queue, buffer, 1, &region_start, &region_size,
+            heap, 2, range_flags, heap_offsets, tile_counts, D3D12_TILE_MAPPING_FLAG_NONE);
+
+    reset_command_list(command_list, context.allocator);
+    transition_resource_state(command_list, buffer, D3D12_RESOURCE_STATE_COPY_DEST, D3D12_RESOURCE_STATE_COPY_SOURCE);
+    ID3D12GraphicsCommandList_CopyBufferRegion(command_list, dst_buffer, 0, buffer, 0, word_count * sizeof(*data));
+    transition_resource_state(command_list, dst_buffer, D3D12_RESOURCE_STATE_COPY_DEST, D3D12_RESOURCE_STATE_COPY_SOURCE);
+    get_buffer_readback_with_command_list(dst_buffer, DXGI_FORMAT_R32_UINT, &rb, queue, command_list);
+    for (i = 0; i < word_count; ++i)
+    {
+        expected = (i + word_count / 2) % word_count;
+        if ((value = get_readback_uint(&rb.rb, i, 0, 0)) != expected)
+            break;
+    }
+    ok(i == word_count, "Got unexpected value %#x at %u, expected %#x.\n", value, i, expected);
+    release_resource_readback(&rb);
+
+    ID3D12Resource_Release(dst_buffer);
+    ID3D12Resource_Release(upload);
+    ID3D12Resource_Release(buffer);
+    ID3D12Heap_Release(heap);
+    destroy_test_context(&context);
+}
+
 static void test_hull_shader_punned_array(void)
 {
     D3D12_GRAPHICS_PIPELINE_STATE_DESC pso_desc;
@@ -39203,6 +40074,7 @@ START_TEST(d3d12)
     run_test(test_create_committed_resource);
     run_test(test_create_heap);
     run_test(test_create_placed_resource);
+    run_test(test_residency);
     run_test(test_create_reserved_resource);
     run_test(test_create_descriptor_heap);
     run_test(test_create_sampler);
@@ -39215,7 +40087,9 @@ START_TEST(d3d12)
     run_test(test_create_fence);
     run_test(test_object_interface);
     run_test(test_multithread_private_data);
+    run_test(test_shared_state_private_data);
     run_test(test_reset_command_allocator);
+    run_test(test_command_allocator_reuse);
     run_test(test_cpu_signal_fence);
     run_test(test_gpu_signal_fence);
     run_test(test_multithread_fence_wait);
@@ -39228,6 +40102,7 @@ START_TEST(d3d12)
     run_test(test_set_render_targets);
     run_test(test_draw_instanced);
     run_test(test_draw_indexed_instanced);
+    run_test(test_debug_markers);
     run_test(test_draw_no_descriptor_bindings);
     run_test(test_multiple_render_targets);
     run_test(test_unknown_rtv_format);
@@ -39266,6 +40141,7 @@ START_TEST(d3d12)
     run_test(test_descriptor_tables);
     run_test(test_descriptor_tables_overlapping_bindings);
     run_test(test_update_root_descriptors);
+    run_test(test_root_constant_buffer_address);
     run_test(test_update_descriptor_tables);
     run_test(test_update_descriptor_heap_after_closing_command_list);
     run_test(test_update_compute_descriptor_tables);
@@ -39347,6 +40223,7 @@ START_TEST(d3d12)
     run_test(test_primitive_restart);
     run_test(test_vertex_shader_stream_output);
     run_test(test_read_write_subresource);
+    run_test(test_read_write_subresource_large);
     run_test(test_queue_wait);
     run_test(test_graphics_compute_queue_synchronization);
     run_test(test_early_depth_stencil_tests);
@@ -39363,6 +40240,7 @@ START_TEST(d3d12)
     run_test(test_clock_calibration);
     run_test(test_readback_map_stability);
     run_test(test_get_resource_tiling);
+    run_test(test_update_tile_mappings);
     run_test(test_hull_shader_punned_array);
     run_test(test_unused_interpolated_input);
     run_test(test_shader_cache);
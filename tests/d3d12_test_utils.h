@@ -200,6 +200,34 @@ static void exec_command_list(ID3D12CommandQueue *queue, ID3D12GraphicsCommandLi
     ID3D12CommandQueue_ExecuteCommandLists(queue, 1, lists);
 }
 
+/* Sets VKD3D_CONFIG for devices created afterwards, and returns a copy of the
+ * previous value to be passed to restore_vkd3d_config(). */
+static inline char *set_vkd3d_config(const char *config)
+{
+    const char *previous = getenv("VKD3D_CONFIG");
+    char *ret = previous ? strdup(previous) : NULL;
+
+#ifdef _WIN32
+    _putenv_s("VKD3D_CONFIG", config);
+#else
+    setenv("VKD3D_CONFIG", config, 1);
+#endif
+    return ret;
+}
+
+static inline void restore_vkd3d_config(char *previous)
+{
+#ifdef _WIN32
+    _putenv_s("VKD3D_CONFIG", previous ? previous : "");
+#else
+    if (previous)
+        setenv("VKD3D_CONFIG", previous, 1);
+    else
+        unsetenv("VKD3D_CONFIG");
+#endif
+    free(previous);
+}
+
 #define reset_command_list(a, b) reset_command_list_(__FILE__, __LINE__, a, b)
 static inline void reset_command_list_(const char *file, unsigned int line,
         ID3D12GraphicsCommandList *list, ID3D12CommandAllocator *allocator)
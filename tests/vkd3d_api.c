@@ -1267,6 +1267,450 @@ static void test_queue_signal_on_cpu(void)
     destroy_test_context(&context);
 }
 
+static void test_device_statistics(void)
+{
+    PFN_vkd3d_get_device_statistics pfn_vkd3d_get_device_statistics = vkd3d_get_device_statistics;
+    struct vkd3d_device_statistics statistics, statistics2;
+    D3D12_SAMPLER_DESC sampler_desc = {0};
+    struct test_context context = {0};
+    struct test_context_desc desc;
+    ID3D12DescriptorHeap *heap;
+    unsigned int refcount;
+    ID3D12Device *device;
+    HRESULT hr;
+
+    memset(&desc, 0, sizeof(desc));
+    desc.no_render_target = true;
+    if (!init_test_context(&context, &desc))
+        return;
+    device = context.device;
+
+    memset(&statistics, 0, sizeof(statistics));
+    statistics.type = VKD3D_STRUCTURE_TYPE_DEVICE_STATISTICS;
+    statistics2 = statistics;
+    pfn_vkd3d_get_device_statistics(device, &statistics);
+
+    heap = create_cpu_descriptor_heap(device, D3D12_DESCRIPTOR_HEAP_TYPE_SAMPLER, 1);
+    sampler_desc.Filter = D3D12_FILTER_MIN_MAG_MIP_POINT;
+    sampler_desc.AddressU = D3D12_TEXTURE_ADDRESS_MODE_CLAMP;
+    sampler_desc.AddressV = D3D12_TEXTURE_ADDRESS_MODE_CLAMP;
+    sampler_desc.AddressW = D3D12_TEXTURE_ADDRESS_MODE_CLAMP;
+    sampler_desc.MaxLOD = D3D12_FLOAT32_MAX;
+    ID3D12Device_CreateSampler(device, &sampler_desc, ID3D12DescriptorHeap_GetCPUDescriptorHandleForHeapStart(heap));
+
+    pfn_vkd3d_get_device_statistics(device, &statistics2);
+    ok(statistics2.vk_sampler_count == statistics.vk_sampler_count + 1,
+            "Got sampler count %"PRIu64", expected %"PRIu64".\n",
+            statistics2.vk_sampler_count, statistics.vk_sampler_count + 1);
+
+    hr = ID3D12GraphicsCommandList_Close(context.list);
+    ok(hr == S_OK, "Failed to close command list, hr %#x.\n", hr);
+    exec_command_list(context.queue, context.list);
+    wait_queue_idle(device, context.queue);
+
+    pfn_vkd3d_get_device_statistics(device, &statistics);
+    ok(statistics.vk_queue_submit_count > statistics2.vk_queue_submit_count,
+            "Got queue submit count %"PRIu64", expected more than %"PRIu64".\n",
+            statistics.vk_queue_submit_count, statistics2.vk_queue_submit_count);
+
+    refcount = ID3D12DescriptorHeap_Release(heap);
+    ok(!refcount, "%u references to descriptor heap leaked.\n", refcount);
+    destroy_test_context(&context);
+}
+
+static bool have_descriptor_buffer_support(ID3D12Device *device)
+{
+    VkPhysicalDeviceDescriptorBufferPropertiesEXT descriptor_buffer_properties;
+    VkPhysicalDeviceDescriptorBufferFeaturesEXT descriptor_buffer_features;
+    PFN_vkGetPhysicalDeviceProperties2 pfn_vkGetPhysicalDeviceProperties2;
+    PFN_vkGetPhysicalDeviceFeatures2 pfn_vkGetPhysicalDeviceFeatures2;
+    VkPhysicalDevice vk_physical_device;
+    VkInstance vk_instance;
+    VkPhysicalDeviceProperties2 properties;
+    VkPhysicalDeviceFeatures2 features;
+    const char *enabled_extensions[6];
+
+    struct vulkan_extension extensions[] =
+    {
+        {VK_EXT_DESCRIPTOR_BUFFER_EXTENSION_NAME},
+        {VK_KHR_BUFFER_DEVICE_ADDRESS_EXTENSION_NAME},
+        {VK_KHR_SYNCHRONIZATION_2_EXTENSION_NAME},
+        {VK_KHR_PUSH_DESCRIPTOR_EXTENSION_NAME},
+        {VK_EXT_MUTABLE_DESCRIPTOR_TYPE_EXTENSION_NAME},
+        {VK_EXT_ROBUSTNESS_2_EXTENSION_NAME},
+    };
+
+    vk_physical_device = vkd3d_get_vk_physical_device(device);
+    if (check_device_extensions(vk_physical_device, enabled_extensions,
+            extensions, ARRAY_SIZE(extensions)) != ARRAY_SIZE(extensions))
+        return false;
+
+    vk_instance = vkd3d_instance_get_vk_instance(vkd3d_instance_from_device(device));
+    pfn_vkGetPhysicalDeviceFeatures2 = (void *)vkGetInstanceProcAddr(vk_instance, "vkGetPhysicalDeviceFeatures2");
+    pfn_vkGetPhysicalDeviceProperties2 = (void *)vkGetInstanceProcAddr(vk_instance, "vkGetPhysicalDeviceProperties2");
+    if (!pfn_vkGetPhysicalDeviceFeatures2 || !pfn_vkGetPhysicalDeviceProperties2)
+        return false;
+
+    memset(&descriptor_buffer_features, 0, sizeof(descriptor_buffer_features));
+    descriptor_buffer_features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_BUFFER_FEATURES_EXT;
+    memset(&features, 0, sizeof(features));
+    features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+    features.pNext = &descriptor_buffer_features;
+    pfn_vkGetPhysicalDeviceFeatures2(vk_physical_device, &features);
+
+    memset(&descriptor_buffer_properties, 0, sizeof(descriptor_buffer_properties));
+    descriptor_buffer_properties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_BUFFER_PROPERTIES_EXT;
+    memset(&properties, 0, sizeof(properties));
+    properties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2;
+    properties.pNext = &descriptor_buffer_properties;
+    pfn_vkGetPhysicalDeviceProperties2(vk_physical_device, &properties);
+
+    return descriptor_buffer_features.descriptorBuffer && descriptor_buffer_features.descriptorBufferPushDescriptors
+            && descriptor_buffer_properties.bufferlessPushDescriptors;
+}
+
+static void test_descriptor_buffer_heap_switch(void)
+{
+    struct vkd3d_device_statistics statistics, statistics2;
+    ID3D12DescriptorHeap *srv_heaps[2], *sampler_heap, *heaps[2];
+    D3D12_ROOT_SIGNATURE_DESC root_signature_desc;
+    D3D12_DESCRIPTOR_RANGE descriptor_ranges[2];
+    D3D12_ROOT_PARAMETER root_parameters[2];
+    ID3D12GraphicsCommandList *command_list;
+    struct d3d12_resource_readback rb;
+    D3D12_SAMPLER_DESC sampler_desc;
+    D3D12_SUBRESOURCE_DATA data;
+    struct test_context_desc desc;
+    struct test_context context;
+    ID3D12Resource *textures[2];
+    D3D12_VIEWPORT viewport;
+    ID3D12CommandQueue *queue;
+    ID3D12Device *device;
+    char *previous;
+    unsigned int i;
+    RECT rect;
+    HRESULT hr;
+
+    static const DWORD ps_code[] =
+    {
+#if 0
+        Texture2D t;
+        SamplerState s;
+
+        float4 main(float4 position : SV_POSITION) : SV_Target
+        {
+            float2 p;
+
+            p.x = position.x / 640.0f;
+            p.y = position.y / 480.0f;
+            return t.Sample(s, p);
+        }
+#endif
+        0x43425844, 0xd48f8d1c, 0x91689a9a, 0x99683e50, 0xae5e3efd, 0x00000001, 0x00000140, 0x00000003,
+        0x0000002c, 0x00000060, 0x00000094, 0x4e475349, 0x0000002c, 0x00000001, 0x00000008, 0x00000020,
+        0x00000000, 0x00000001, 0x00000003, 0x00000000, 0x0000030f, 0x505f5653, 0x5449534f, 0x004e4f49,
+        0x4e47534f, 0x0000002c, 0x00000001, 0x00000008, 0x00000020, 0x00000000, 0x00000000, 0x00000003,
+        0x00000000, 0x0000000f, 0x545f5653, 0x65677261, 0xabab0074, 0x58454853, 0x000000a4, 0x00000050,
+        0x00000029, 0x0100086a, 0x0300005a, 0x00106000, 0x00000000, 0x04001858, 0x00107000, 0x00000000,
+        0x00005555, 0x04002064, 0x00101032, 0x00000000, 0x00000001, 0x03000065, 0x001020f2, 0x00000000,
+        0x02000068, 0x00000001, 0x0a000038, 0x00100032, 0x00000000, 0x00101046, 0x00000000, 0x00004002,
+        0x3acccccd, 0x3b088889, 0x00000000, 0x00000000, 0x8b000045, 0x800000c2, 0x00155543, 0x001020f2,
+        0x00000000, 0x00100046, 0x00000000, 0x00107e46, 0x00000000, 0x00106000, 0x00000000, 0x0100003e,
+    };
+    static const D3D12_SHADER_BYTECODE ps = {ps_code, sizeof(ps_code)};
+    static const unsigned int colours[] = {0xff0000ff, 0xff00ff00};
+    static const float white[] = {1.0f, 1.0f, 1.0f, 1.0f};
+
+    /* Switching only the CBV/SRV/UAV heap rebinds the descriptor buffers,
+     * which must not lose the offsets of the sampler heap. */
+    previous = set_vkd3d_config("descriptor_buffer");
+
+    memset(&desc, 0, sizeof(desc));
+    desc.rt_width = 640;
+    desc.rt_height = 480;
+    desc.no_root_signature = true;
+    desc.no_pipeline = true;
+    if (!init_test_context(&context, &desc))
+    {
+        restore_vkd3d_config(previous);
+        return;
+    }
+    device = context.device;
+    command_list = context.list;
+    queue = context.queue;
+
+    if (!have_descriptor_buffer_support(device))
+    {
+        skip("Descriptor buffers are not supported.\n");
+        destroy_test_context(&context);
+        restore_vkd3d_config(previous);
+        return;
+    }
+
+    memset(&statistics, 0, sizeof(statistics));
+    statistics.type = VKD3D_STRUCTURE_TYPE_DEVICE_STATISTICS;
+    statistics2 = statistics;
+    vkd3d_get_device_statistics(device, &statistics);
+
+    descriptor_ranges[0].RangeType = D3D12_DESCRIPTOR_RANGE_TYPE_SRV;
+    descriptor_ranges[0].NumDescriptors = 1;
+    descriptor_ranges[0].BaseShaderRegister = 0;
+    descriptor_ranges[0].RegisterSpace = 0;
+    descriptor_ranges[0].OffsetInDescriptorsFromTableStart = 0;
+    descriptor_ranges[1].RangeType = D3D12_DESCRIPTOR_RANGE_TYPE_SAMPLER;
+    descriptor_ranges[1].NumDescriptors = 1;
+    descriptor_ranges[1].BaseShaderRegister = 0;
+    descriptor_ranges[1].RegisterSpace = 0;
+    descriptor_ranges[1].OffsetInDescriptorsFromTableStart = 0;
+    for (i = 0; i < ARRAY_SIZE(root_parameters); ++i)
+    {
+        root_parameters[i].ParameterType = D3D12_ROOT_PARAMETER_TYPE_DESCRIPTOR_TABLE;
+        root_parameters[i].DescriptorTable.NumDescriptorRanges = 1;
+        root_parameters[i].DescriptorTable.pDescriptorRanges = &descriptor_ranges[i];
+        root_parameters[i].ShaderVisibility = D3D12_SHADER_VISIBILITY_PIXEL;
+    }
+    memset(&root_signature_desc, 0, sizeof(root_signature_desc));
+    root_signature_desc.NumParameters = ARRAY_SIZE(root_parameters);
+    root_signature_desc.pParameters = root_parameters;
+    hr = create_root_signature(device, &root_signature_desc, &context.root_signature);
+    ok(hr == S_OK, "Failed to create root signature, hr %#x.\n", hr);
+
+    context.pipeline_state = create_pipeline_state(device,
+            context.root_signature, context.render_target_desc.Format, NULL, &ps, NULL);
+
+    for (i = 0; i < ARRAY_SIZE(textures); ++i)
+    {
+        textures[i] = create_default_texture(device, 1, 1, DXGI_FORMAT_R8G8B8A8_UNORM,
+                0, D3D12_RESOURCE_STATE_COPY_DEST);
+        data.pData = &colours[i];
+        data.RowPitch = sizeof(colours[i]);
+        data.SlicePitch = data.RowPitch;
+        upload_texture_data(textures[i], &data, 1, queue, command_list);
+        reset_command_list(command_list, context.allocator);
+        transition_resource_state(command_list, textures[i],
+                D3D12_RESOURCE_STATE_COPY_DEST, D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE);
+
+        srv_heaps[i] = create_gpu_descriptor_heap(device, D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV, 1);
+        ID3D12Device_CreateShaderResourceView(device, textures[i], NULL,
+                ID3D12DescriptorHeap_GetCPUDescriptorHandleForHeapStart(srv_heaps[i]));
+    }
+
+    sampler_heap = create_gpu_descriptor_heap(device, D3D12_DESCRIPTOR_HEAP_TYPE_SAMPLER, 1);
+    memset(&sampler_desc, 0, sizeof(sampler_desc));
+    sampler_desc.Filter = D3D12_FILTER_MIN_MAG_MIP_POINT;
+    sampler_desc.AddressU = D3D12_TEXTURE_ADDRESS_MODE_CLAMP;
+    sampler_desc.AddressV = D3D12_TEXTURE_ADDRESS_MODE_CLAMP;
+    sampler_desc.AddressW = D3D12_TEXTURE_ADDRESS_MODE_CLAMP;
+    ID3D12Device_CreateSampler(device, &sampler_desc,
+            ID3D12DescriptorHeap_GetCPUDescriptorHandleForHeapStart(sampler_heap));
+
+    /* Shader visible heaps are backed by descriptor buffers instead of Vulkan descriptor sets. */
+    vkd3d_get_device_statistics(device, &statistics2);
+    ok(statistics2.vk_descriptor_set_count == statistics.vk_descriptor_set_count,
+            "Got descriptor set count %"PRIu64", expected %"PRIu64".\n",
+            statistics2.vk_descriptor_set_count, statistics.vk_descriptor_set_count);
+
+    ID3D12GraphicsCommandList_ClearRenderTargetView(command_list, context.rtv, white, 0, NULL);
+    ID3D12GraphicsCommandList_OMSetRenderTargets(command_list, 1, &context.rtv, false, NULL);
+    ID3D12GraphicsCommandList_SetGraphicsRootSignature(command_list, context.root_signature);
+    ID3D12GraphicsCommandList_SetPipelineState(command_list, context.pipeline_state);
+    ID3D12GraphicsCommandList_IASetPrimitiveTopology(command_list, D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+    ID3D12GraphicsCommandList_RSSetScissorRects(command_list, 1, &context.scissor_rect);
+
+    heaps[1] = sampler_heap;
+    for (i = 0; i < ARRAY_SIZE(srv_heaps); ++i)
+    {
+        heaps[0] = srv_heaps[i];
+        ID3D12GraphicsCommandList_SetDescriptorHeaps(command_list, ARRAY_SIZE(heaps), heaps);
+        ID3D12GraphicsCommandList_SetGraphicsRootDescriptorTable(command_list, 0,
+                ID3D12DescriptorHeap_GetGPUDescriptorHandleForHeapStart(srv_heaps[i]));
+        if (!i)
+            ID3D12GraphicsCommandList_SetGraphicsRootDescriptorTable(command_list, 1,
+                    ID3D12DescriptorHeap_GetGPUDescriptorHandleForHeapStart(sampler_heap));
+        set_viewport(&viewport, i * 320.0f, 0.0f, 320.0f, 480.0f, 0.0f, 1.0f);
+        ID3D12GraphicsCommandList_RSSetViewports(command_list, 1, &viewport);
+        ID3D12GraphicsCommandList_DrawInstanced(command_list, 3, 1, 0, 0);
+    }
+
+    transition_resource_state(command_list, context.render_target,
+            D3D12_RESOURCE_STATE_RENDER_TARGET, D3D12_RESOURCE_STATE_COPY_SOURCE);
+    get_resource_readback_with_command_list(context.render_target, 0, &rb, queue, command_list);
+    for (i = 0; i < ARRAY_SIZE(colours); ++i)
+    {
+        set_rect(&rect, i * 320, 0, (i + 1) * 320, 480);
+        check_readback_data_uint(&rb.rb, &rect, colours[i], 0);
+    }
+    release_resource_readback(&rb);
+
+    ID3D12DescriptorHeap_Release(sampler_heap);
+    for (i = 0; i < ARRAY_SIZE(textures); ++i)
+    {
+        ID3D12DescriptorHeap_Release(srv_heaps[i]);
+        ID3D12Resource_Release(textures[i]);
+    }
+    destroy_test_context(&context);
+    restore_vkd3d_config(previous);
+}
+
+static void set_quarter_state(struct test_context *context, ID3D12GraphicsCommandList *command_list)
+{
+    ID3D12GraphicsCommandList_OMSetRenderTargets(command_list, 1, &context->rtv, false, NULL);
+    ID3D12GraphicsCommandList_SetGraphicsRootSignature(command_list, context->root_signature);
+    ID3D12GraphicsCommandList_SetPipelineState(command_list, context->pipeline_state);
+    ID3D12GraphicsCommandList_IASetPrimitiveTopology(command_list, D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+    ID3D12GraphicsCommandList_RSSetScissorRects(command_list, 1, &context->scissor_rect);
+}
+
+static void draw_quarter(ID3D12GraphicsCommandList *command_list, unsigned int quarter, const float *colour)
+{
+    D3D12_VIEWPORT viewport;
+
+    set_viewport(&viewport, quarter * 160.0f, 0.0f, 160.0f, 480.0f, 0.0f, 1.0f);
+    ID3D12GraphicsCommandList_RSSetViewports(command_list, 1, &viewport);
+    ID3D12GraphicsCommandList_SetGraphicsRoot32BitConstants(command_list, 0, 4, colour, 0);
+    ID3D12GraphicsCommandList_DrawInstanced(command_list, 3, 1, 0, 0);
+}
+
+static void check_quarters(struct test_context *context, const unsigned int *expected)
+{
+    struct d3d12_resource_readback rb;
+    unsigned int i;
+    RECT rect;
+
+    transition_resource_state(context->list, context->render_target,
+            D3D12_RESOURCE_STATE_RENDER_TARGET, D3D12_RESOURCE_STATE_COPY_SOURCE);
+    get_resource_readback_with_command_list(context->render_target, 0, &rb, context->queue, context->list);
+    for (i = 0; i < 4; ++i)
+    {
+        set_rect(&rect, i * 160, 0, (i + 1) * 160, 480);
+        check_readback_data_uint(&rb.rb, &rect, expected[i], 0);
+    }
+    release_resource_readback(&rb);
+    reset_command_list(context->list, context->allocator);
+}
+
+static void test_deferred_recording(void)
+{
+    struct vkd3d_device_statistics statistics, statistics2;
+    ID3D12GraphicsCommandList *command_list, *command_list2;
+    ID3D12CommandAllocator *allocator2;
+    struct test_context_desc desc;
+    struct test_context context;
+    ID3D12CommandList *lists[2];
+    ID3D12CommandQueue *queue;
+    ID3D12Device *device;
+    char *previous;
+    HRESULT hr;
+
+    static const DWORD ps_code[] =
+    {
+#if 0
+        float4 color;
+
+        float4 main(float4 position : SV_POSITION) : SV_Target
+        {
+            return color;
+        }
+#endif
+        0x43425844, 0xd18ead43, 0x8b8264c1, 0x9c0a062d, 0xfc843226, 0x00000001, 0x000000e0, 0x00000003,
+        0x0000002c, 0x00000060, 0x00000094, 0x4e475349, 0x0000002c, 0x00000001, 0x00000008, 0x00000020,
+        0x00000000, 0x00000001, 0x00000003, 0x00000000, 0x0000000f, 0x505f5653, 0x5449534f, 0x004e4f49,
+        0x4e47534f, 0x0000002c, 0x00000001, 0x00000008, 0x00000020, 0x00000000, 0x00000000, 0x00000003,
+        0x00000000, 0x0000000f, 0x545f5653, 0x65677261, 0xabab0074, 0x58454853, 0x00000044, 0x00000050,
+        0x00000011, 0x0100086a, 0x04000059, 0x00208e46, 0x00000000, 0x00000001, 0x03000065, 0x001020f2,
+        0x00000000, 0x06000036, 0x001020f2, 0x00000000, 0x00208e46, 0x00000000, 0x00000000, 0x0100003e,
+    };
+    static const D3D12_SHADER_BYTECODE ps = {ps_code, sizeof(ps_code)};
+    static const float red[] = {1.0f, 0.0f, 0.0f, 1.0f};
+    static const float green[] = {0.0f, 1.0f, 0.0f, 1.0f};
+    static const float blue[] = {0.0f, 0.0f, 1.0f, 1.0f};
+    static const float yellow[] = {1.0f, 1.0f, 0.0f, 1.0f};
+    static const float white[] = {1.0f, 1.0f, 1.0f, 1.0f};
+    static const unsigned int expected[] = {0xff0000ff, 0xff00ff00, 0xffff0000, 0xffffffff};
+    static const unsigned int expected2[] = {0xff0000ff, 0xff00ff00, 0xffff0000, 0xff00ffff};
+
+    /* Commands are recorded into a command stream, which is translated
+     * after Close(). */
+    previous = set_vkd3d_config("deferred_recording");
+
+    memset(&desc, 0, sizeof(desc));
+    desc.rt_width = 640;
+    desc.rt_height = 480;
+    desc.no_root_signature = true;
+    if (!init_test_context(&context, &desc))
+    {
+        restore_vkd3d_config(previous);
+        return;
+    }
+    device = context.device;
+    command_list = context.list;
+    queue = context.queue;
+
+    context.root_signature = create_32bit_constants_root_signature(device,
+            0, 4, D3D12_SHADER_VISIBILITY_PIXEL);
+    context.pipeline_state = create_pipeline_state(device,
+            context.root_signature, context.render_target_desc.Format, NULL, &ps, NULL);
+
+    hr = ID3D12Device_CreateCommandAllocator(device, D3D12_COMMAND_LIST_TYPE_DIRECT,
+            &IID_ID3D12CommandAllocator, (void **)&allocator2);
+    ok(hr == S_OK, "Failed to create command allocator, hr %#x.\n", hr);
+    hr = ID3D12Device_CreateCommandList(device, 0, D3D12_COMMAND_LIST_TYPE_DIRECT,
+            allocator2, NULL, &IID_ID3D12GraphicsCommandList, (void **)&command_list2);
+    ok(hr == S_OK, "Failed to create command list, hr %#x.\n", hr);
+
+    memset(&statistics, 0, sizeof(statistics));
+    statistics.type = VKD3D_STRUCTURE_TYPE_DEVICE_STATISTICS;
+    statistics2 = statistics;
+    vkd3d_get_device_statistics(device, &statistics);
+
+    ID3D12GraphicsCommandList_ClearRenderTargetView(command_list, context.rtv, white, 0, NULL);
+    set_quarter_state(&context, command_list);
+    draw_quarter(command_list, 0, red);
+    draw_quarter(command_list, 1, green);
+    hr = ID3D12GraphicsCommandList_Close(command_list);
+    ok(hr == S_OK, "Failed to close command list, hr %#x.\n", hr);
+
+    set_quarter_state(&context, command_list2);
+    draw_quarter(command_list2, 2, blue);
+    hr = ID3D12GraphicsCommandList_Close(command_list2);
+    ok(hr == S_OK, "Failed to close command list, hr %#x.\n", hr);
+
+    /* Neither the clear nor the render target binding translate the stream early. */
+    vkd3d_get_device_statistics(device, &statistics2);
+    ok(statistics2.deferred_command_count >= statistics.deferred_command_count + 18,
+            "Got deferred command count %"PRIu64", expected at least %"PRIu64".\n",
+            statistics2.deferred_command_count, statistics.deferred_command_count + 18);
+    ok(statistics2.deferred_flush_count == statistics.deferred_flush_count,
+            "Got deferred flush count %"PRIu64", expected %"PRIu64".\n",
+            statistics2.deferred_flush_count, statistics.deferred_flush_count);
+
+    lists[0] = (ID3D12CommandList *)command_list;
+    lists[1] = (ID3D12CommandList *)command_list2;
+    ID3D12CommandQueue_ExecuteCommandLists(queue, ARRAY_SIZE(lists), lists);
+    wait_queue_idle(device, queue);
+
+    reset_command_list(command_list, context.allocator);
+    check_quarters(&context, expected);
+
+    /* Lists are translated again after Reset(). */
+    reset_command_list(command_list2, allocator2);
+    transition_resource_state(command_list2, context.render_target,
+            D3D12_RESOURCE_STATE_COPY_SOURCE, D3D12_RESOURCE_STATE_RENDER_TARGET);
+    set_quarter_state(&context, command_list2);
+    draw_quarter(command_list2, 3, yellow);
+    hr = ID3D12GraphicsCommandList_Close(command_list2);
+    ok(hr == S_OK, "Failed to close command list, hr %#x.\n", hr);
+    exec_command_list(queue, command_list2);
+    wait_queue_idle(device, queue);
+
+    check_quarters(&context, expected2);
+
+    ID3D12GraphicsCommandList_Release(command_list2);
+    ID3D12CommandAllocator_Release(allocator2);
+    destroy_test_context(&context);
+    restore_vkd3d_config(previous);
+}
+
 static bool have_d3d12_device(void)
 {
     ID3D12Device *device;
@@ -1315,4 +1759,7 @@ LOAD_VK_PFN(vkGetInstanceProcAddr)
     run_test(test_formats);
     run_test(test_application_info);
     run_test(test_queue_signal_on_cpu);
+    run_test(test_device_statistics);
+    run_test(test_descriptor_buffer_heap_switch);
+    run_test(test_deferred_recording);
 }
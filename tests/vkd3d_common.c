@@ -17,8 +17,11 @@
  */
 
 #include "vkd3d_common.h"
+#include "vkd3d_memory.h"
 #include "vkd3d_test.h"
 
+VKD3D_DEBUG_ENV_NAME("VKD3D_DEBUG");
+
 static void check_version(const char *v, int expected_major, int expected_minor)
 {
     int major, minor;
@@ -113,8 +116,59 @@ static void test_bitmask_is_contiguous(void)
     check_contiguous(0x1c000000, true);
 }
 
+static void test_arena(void)
+{
+    struct vkd3d_arena arena;
+    unsigned int i, j;
+    uint8_t *ptr[64];
+    uint32_t *zero;
+
+    vkd3d_arena_init(&arena, 1024);
+
+    for (i = 0; i < ARRAY_SIZE(ptr); ++i)
+    {
+        /* Mix small allocations with ones that need a dedicated block. */
+        size_t size = i % 8 == 7 ? 4096 : i + 1;
+
+        ptr[i] = vkd3d_arena_alloc(&arena, size);
+        ok(ptr[i], "Failed to allocate %zu bytes.\n", size);
+        ok(!((uintptr_t)ptr[i] & 15), "Got unaligned pointer %p.\n", ptr[i]);
+        memset(ptr[i], i, size);
+    }
+    for (i = 0; i < ARRAY_SIZE(ptr); ++i)
+    {
+        size_t size = i % 8 == 7 ? 4096 : i + 1;
+
+        for (j = 0; j < size; ++j)
+        {
+            if (ptr[i][j] != i)
+                break;
+        }
+        ok(j == size, "Allocation %u was overwritten at offset %u.\n", i, j);
+    }
+
+    zero = vkd3d_arena_calloc(&arena, 300, sizeof(*zero));
+    ok(zero, "Failed to allocate.\n");
+    for (i = 0; i < 300; ++i)
+    {
+        if (zero[i])
+            break;
+    }
+    ok(i == 300, "Got non-zero value %#x at index %u.\n", zero[i], i);
+
+    ok(!vkd3d_arena_calloc(&arena, ~(size_t)0, 2), "Expected allocation to fail.\n");
+
+    vkd3d_arena_cleanup(&arena);
+    ok(!arena.blocks, "Got unexpected blocks %p.\n", arena.blocks);
+
+    ptr[0] = vkd3d_arena_alloc(&arena, 16);
+    ok(ptr[0], "Failed to allocate after cleanup.\n");
+    vkd3d_arena_cleanup(&arena);
+}
+
 START_TEST(vkd3d_common)
 {
     run_test(test_parse_version);
     run_test(test_bitmask_is_contiguous);
+    run_test(test_arena);
 }
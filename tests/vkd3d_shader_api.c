@@ -2180,6 +2180,87 @@ static void test_parameters(void)
 #endif
 }
 
+static bool spirv_find_instruction(const struct vkd3d_shader_code *spirv,
+        unsigned int opcode, unsigned int operand)
+{
+    const uint32_t *words = spirv->code;
+    size_t count = spirv->size / sizeof(*words);
+    unsigned int word_count;
+    size_t i;
+
+    /* Skip the header. */
+    for (i = 5; i < count; i += word_count)
+    {
+        if (!(word_count = words[i] >> 16))
+            break;
+        if ((words[i] & 0xffff) == opcode && word_count > 1 && words[i + 1] == operand)
+            return true;
+    }
+
+    return false;
+}
+
+static void test_buffer_address_info(void)
+{
+    struct vkd3d_shader_buffer_address_info address_info = {.type = VKD3D_SHADER_STRUCTURE_TYPE_BUFFER_ADDRESS_INFO};
+    struct vkd3d_shader_interface_info interface_info = {.type = VKD3D_SHADER_STRUCTURE_TYPE_INTERFACE_INFO};
+    struct vkd3d_shader_hlsl_source_info hlsl_info = {.type = VKD3D_SHADER_STRUCTURE_TYPE_HLSL_SOURCE_INFO};
+    struct vkd3d_shader_compile_info info = {.type = VKD3D_SHADER_STRUCTURE_TYPE_COMPILE_INFO};
+    struct vkd3d_shader_push_constant_buffer buffer;
+    struct vkd3d_shader_code spirv;
+    char *messages;
+    int ret;
+
+    static const char ps_code[] =
+        "float4 c[2];\n"
+        "\n"
+        "float4 main() : SV_Target\n"
+        "{\n"
+        "    return c[1];\n"
+        "}";
+
+    info.next = &hlsl_info;
+    info.source.code = ps_code;
+    info.source.size = strlen(ps_code);
+    info.source_type = VKD3D_SHADER_SOURCE_HLSL;
+    info.target_type = VKD3D_SHADER_TARGET_SPIRV_BINARY;
+    info.log_level = VKD3D_SHADER_LOG_WARNING;
+
+    hlsl_info.next = &interface_info;
+    hlsl_info.entry_point = "main";
+    hlsl_info.profile = "ps_4_0";
+
+    interface_info.next = &address_info;
+
+    buffer.register_space = 0;
+    buffer.register_index = 0;
+    buffer.shader_visibility = VKD3D_SHADER_VISIBILITY_ALL;
+    buffer.offset = 8;
+    buffer.size = 0;
+    address_info.buffers = &buffer;
+    address_info.buffer_count = 1;
+
+    ret = vkd3d_shader_compile(&info, &spirv, &messages);
+    ok(!ret, "Failed to compile, error %d.\n", ret);
+    ok(!messages, "Got unexpected messages.\n");
+    vkd3d_shader_free_messages(messages);
+
+    /* OpCapability PhysicalStorageBufferAddresses */
+    ok(spirv_find_instruction(&spirv, 17, 5347), "Capability not found.\n");
+    /* OpMemoryModel PhysicalStorageBuffer64 */
+    ok(spirv_find_instruction(&spirv, 14, 5348), "Memory model not found.\n");
+    vkd3d_shader_free_shader_code(&spirv);
+
+    /* Without the structure, the constant buffer is read through a descriptor. */
+    interface_info.next = NULL;
+    ret = vkd3d_shader_compile(&info, &spirv, &messages);
+    ok(!ret, "Failed to compile, error %d.\n", ret);
+    vkd3d_shader_free_messages(messages);
+    ok(!spirv_find_instruction(&spirv, 17, 5347), "Got unexpected capability.\n");
+    ok(spirv_find_instruction(&spirv, 14, 0), "Memory model not found.\n");
+    vkd3d_shader_free_shader_code(&spirv);
+}
+
 START_TEST(vkd3d_shader_api)
 {
     setlocale(LC_ALL, "");
@@ -2196,4 +2277,5 @@ START_TEST(vkd3d_shader_api)
     run_test(test_emit_signature);
     run_test(test_warning_options);
     run_test(test_parameters);
+    run_test(test_buffer_address_info);
 }